@@ -89,6 +89,7 @@
 #include "../src/gmath/Distribution.h"
 #include "../src/utils/AtomSpecifier.h"
 #include "../src/utils/Neighbours.h"
+#include "../src/utils/CellList.h"
 #include <vector>
 #include <string>
 #include <iomanip>
@@ -305,6 +306,10 @@ int main(int argc, char **argv) {
 
     for (int i = 0; i < grid; i++) iwdcf[i] = 0;
 
+    // the oxygen positions and the with atoms close to a centre
+    std::vector<Vec> withPos(with.size());
+    std::vector<int> candidates;
+
     // loop over all trajectories
     int count_frame = 0;
 
@@ -342,6 +347,11 @@ int main(int argc, char **argv) {
         }
 
 
+        // only the with atoms within the cutoff contribute
+        for (int j = 0; j < with.size(); j++)
+          withPos[j] = sys.sol(0).pos(with.atom(j));
+        CellList cells(withPos, sys, *pbc, cut);
+
         // now really loop over the centre atoms
         for (int i = start; i < centre.size(); i++) {
 
@@ -362,7 +372,9 @@ int main(int argc, char **argv) {
           if (centre.mol(0) == -2) curr = cog;
 
           //loop over the atoms to consider
-          for (int j = 0; j < with.size(); j++) {
+          cells.candidates(curr, candidates);
+          for (unsigned int c = 0; c < candidates.size(); c++) {
+            const int j = candidates[c];
             //calculate distance only if this atom is not the current centre
             if (!(with.mol(j) == centre.mol(i) && with.atom(j) == centre.atom(i))) {
               Vec tmp;
@@ -176,12 +176,12 @@ int main(int argc, char **argv){
 	 << endl;
     
     for(unsigned int i=0; i < as.size(); ++i){
-      if(as.atom()[i]->type()==utils::spec_virtual){
-	utils::AtomSpecifier conf=as.atom()[i]->conf();
+      if(as.type(i)==utils::spec_virtual){
+	utils::AtomSpecifier conf=as.conf(i);
 	cout << "----------------------------------------"
 	     << "--------------------------------\n"
 	     << "virtual atom, ";
-	switch(as.atom()[i]->virtualType()){
+	switch(as.virtualType(i)){
 	  case utils::VirtualAtom::normal: 
 	    cout << "explicit atom:\n";
 	    break;
@@ -61,7 +61,11 @@
  * equations above. Optionally, a bootstrap error can be computed, where the 
  * calculation is repeated the indicated number of times (option \@bootstrap), with 
  * random samples of the original time series. The standard deviation of the bootstrap 
- * estimates is reported.
+ * estimates is reported. Every file is resampled once per bootstrap estimate, such
+ * that the error of the total free energy includes the correlation between 
+ * neighbouring intervals. For correlated time series, blocks of consecutive data 
+ * points can be resampled (\@bootblock). The bootstrap estimates are distributed 
+ * over the OpenMP threads and are reproducible for a given seed (\@bootseed).
  * 
  * The program also computes the overlap integral from distributions of the energy
  * differences @f$ P_{i}(\Delta E) @f$ and @f$ P_{j}(\Delta E) @f$, using
@@ -80,6 +84,8 @@
  * <tr><td> [\@convergence</td><td>&lt;relative change in free energy for convergence (default: 1E-5)&gt;] </td></tr>
  * <tr><td> [\@printdist</td><td>&lt;write out distributions&gt;]</td></tr>
  * <tr><td> [\@bootstrap</td><td>&lt;<number of bootstrap estimates for error estimates (default: 0)&gt;] </td></tr>
+ * <tr><td> [\@bootblock</td><td>&lt;block length for the bootstrap (default: 1)&gt;] </td></tr>
+ * <tr><td> [\@bootseed</td><td>&lt;seed for the bootstrap (default: 4711)&gt;] </td></tr>
  * </table>
  * 
  * Example:
@@ -108,6 +114,8 @@
 
 #include "../src/args/Arguments.h"
 #include "../src/gmath/Stat.h"
+#include "../src/gmath/LogSumExp.h"
+#include "../src/gmath/Bootstrap.h"
 #include "../src/gmath/Physics.h"
 #include "../src/gmath/Expression.h"
 #include "../src/gmath/Distribution.h"
@@ -178,12 +186,64 @@ double compute_overlap(std::vector<double> &E_ii, std::vector<double> &E_ij,
 		       std::vector<double> &E_jj, std::vector<double> &E_ji,
 		       int print);
 
+// the files and columns of the neighbouring states of an interval
+struct barInterval
+{
+  int i, j, i_j, j_i;
+};
+
+// the free energy differences of all intervals and their sum from 
+// resampled files
+class barBootstrap : public gmath::Bootstrap::Estimator
+{
+  const std::vector<barData> &d_data;
+  const std::vector<barInterval> &d_intervals;
+  int d_maxiter;
+  double d_conv_eps, d_kBT;
+
+public:
+  barBootstrap(const std::vector<barData> &data,
+	       const std::vector<barInterval> &intervals,
+	       int maxiter, double conv_eps, double kBT)
+    : d_data(data), d_intervals(intervals), d_maxiter(maxiter),
+      d_conv_eps(conv_eps), d_kBT(kBT) {}
+
+  unsigned int size()const { return d_intervals.size() + 1; }
+
+  void estimate(const std::vector<std::vector<unsigned int> > &index,
+		double *res)const {
+    double total = 0.0;
+    for(unsigned int k=0; k< d_intervals.size(); k++){
+      const barInterval &in = d_intervals[k];
+      const std::vector<unsigned int> &index_i = index[in.i];
+      const std::vector<unsigned int> &index_j = index[in.j];
+      std::vector<double> E_s_i(index_i.size()), E_p_i(index_i.size());
+      std::vector<double> E_s_j(index_j.size()), E_p_j(index_j.size());
+      for(unsigned int n=0; n< index_i.size(); n++){
+	E_s_i[n] = d_data[in.i].E_s[index_i[n]];
+	E_p_i[n] = d_data[in.i].E_p[in.i_j][index_i[n]];
+      }
+      for(unsigned int n=0; n< index_j.size(); n++){
+	E_s_j[n] = d_data[in.j].E_s[index_j[n]];
+	E_p_j[n] = d_data[in.j].E_p[in.j_i][index_j[n]];
+      }
+      // don't compute the statistical error if bootstrapping
+      double err = -1.0;
+      res[k] = do_bar(E_s_i, E_p_i, E_s_j, E_p_j, err,
+		      d_maxiter, d_conv_eps) * d_kBT;
+      total += res[k];
+    }
+    res[d_intervals.size()] = total;
+  }
+};
+
 
   
 int main(int argc, char **argv) {
 
   Argument_List knowns;
-  knowns << "files" << "maxiterations" << "convergence" << "bootstrap" << "temp" << "printdist";
+  knowns << "files" << "maxiterations" << "convergence" << "bootstrap" << "bootblock"
+         << "bootseed" << "temp" << "printdist";
 
   string usage = "# " + string(argv[0]);
   usage += "\n\t@files            <data files (ext_ti_ana bar_data output)>\n";
@@ -192,6 +252,8 @@ int main(int argc, char **argv) {
   usage += "\t[@convergence     <relative change in free energy for convergence (default: 1E-5)>]\n";
   usage += "\t[@printdist       <write out distributions>]\n";
   usage += "\t[@bootstrap       <number of bootstrap estimates for error estimates (default: 0)>]\n";
+  usage += "\t[@bootblock       <block length for the bootstrap (default: 1)>]\n";
+  usage += "\t[@bootseed        <seed for the bootstrap (default: 4711)>]\n";
 
   try {
     Arguments args(argc, argv, knowns, usage);
@@ -205,8 +267,12 @@ int main(int argc, char **argv) {
     if(args.count("printdist")>=0) printdist = true;
  
     int bootstrap = args.getValue<int>("bootstrap", false, 0);
-    // initialize random number generator
-    int ti=time(NULL);
+    int bootblock = args.getValue<int>("bootblock", false, 1);
+    unsigned long bootseed = args.getValue<unsigned long>("bootseed", false, 4711);
+    if (bootstrap < 0)
+      throw gromos::Exception(argv[0], "@bootstrap has to be 0 or larger");
+    if (bootblock < 1)
+      throw gromos::Exception(argv[0], "@bootblock has to be 1 or larger");
 	
     if (args.count("files") <= 1)
       throw gromos::Exception(argv[0], "At least two data files required!\n" +
@@ -299,7 +365,6 @@ int main(int argc, char **argv) {
     
     double DG_tot = 0.0;
     double err_tot = 0.0;
-    double boot_err_tot = 0.0;
     
     std::cout << "#" 
 	      << setw(7) << "lam_i"
@@ -311,6 +376,7 @@ int main(int argc, char **argv) {
 	      << endl;
 
     int nr_intervals = bar_data.size()-1;
+    std::vector<barInterval> intervals(nr_intervals);
     for(int k=0; k< nr_intervals; k++){
       //std::cerr << "interval " << k << endl;
       
@@ -349,6 +415,26 @@ int main(int argc, char **argv) {
       //std::cerr << "lam_j " << lam_s[k+1] << " index " << j << endl;
       //std::cerr << "lam_j in i " << lam_s[k+1] << " index " << i_j << endl;
       //std::cerr << "lam_i in j " << lam_s[k] << " index " << j_i << endl;
+      intervals[k].i = i;
+      intervals[k].j = j;
+      intervals[k].i_j = i_j;
+      intervals[k].j_i = j_i;
+    }
+
+    // bootstrap all intervals and the total at once, every file is 
+    // resampled once per bootstrap sample
+    gmath::Bootstrap boot(bootstrap, bootblock, bootseed);
+    if(bootstrap) {
+      for(unsigned int l=0; l< bar_data.size(); l++)
+	boot.addSeries(bar_data[l].E_s.size());
+      boot.run(barBootstrap(bar_data, intervals, max_iter, conv_eps, kBT));
+    }
+
+    for(int k=0; k< nr_intervals; k++){
+      int i = intervals[k].i;
+      int j = intervals[k].j;
+      int i_j = intervals[k].i_j;
+      int j_i = intervals[k].j_i;
 
       double error=0.0;
       
@@ -365,48 +451,6 @@ int main(int argc, char **argv) {
       DG_tot += DG;
       err_tot += error*error;
 
-      double boot_std;
-     
-      if(bootstrap) {
-	unsigned int seed = ti+k;
-	
-	int length_i = bar_data[i].E_s.size();
-	int length_j = bar_data[j].E_s.size();
-
-	gmath::Stat<double> final_boot;
-	for(int ii=0;ii<bootstrap;ii++){
-	  
-	  std::vector<double> E_s_i, E_p_i, E_s_j, E_p_j;
-	  
-	  for(int jj=0;jj<length_i;jj++){
-	    double r;
-	    r=rand_r(&seed);
-	    int index_i = int((r*length_i)/RAND_MAX);
-	    	    
-	    E_s_i.push_back(bar_data[i].E_s[index_i]);
-	    E_p_i.push_back(bar_data[i].E_p[i_j][index_i]);
-	  }
-	  for(int jj=0; jj<length_j; jj++){
-	    double r;
-	    r=rand_r(&seed);
-	    int index_j = int((r*length_j)/RAND_MAX);
-	    
-	    E_s_j.push_back(bar_data[j].E_s[index_j]);
-	    E_p_j.push_back(bar_data[j].E_p[j_i][index_j]);
-	  }
-	  // don't compute the statistical error if bootstrapping
-	  double err= -1.0;
-	  double dg_boot = do_bar(E_s_i, E_p_i,
-				  E_s_j, E_p_j,
-				  err,
-				  max_iter, conv_eps);
-	  final_boot.addval(dg_boot*kBT);
-	}
-	boot_std = gmath::Stat<double>::covariance(final_boot, final_boot);
-	boot_err_tot += boot_std;
-      }
-      
-	
       // do we want to print the distributions?
       int print = -1;
       if(printdist) print = k;
@@ -423,7 +467,7 @@ int main(int argc, char **argv) {
 		<< setw(15) << setprecision(5) << DG
 		<< " +/- "
 		<< setw(10) << setprecision(5) << error;
-      if(bootstrap) std::cout << setw(15) << setprecision(5) << sqrt(boot_std);
+      if(bootstrap) std::cout << setw(15) << setprecision(5) << boot.error(k);
       std::cout << setw(15) << setprecision(5) << oi
 		<< endl;
     }
@@ -432,7 +476,7 @@ int main(int argc, char **argv) {
 	      << setw(24) << setprecision(5) << DG_tot
 	      << " +/- "
 	      << setw(10) << setprecision(5) << sqrt(err_tot);
-    if(bootstrap) std::cout << setw(15) << setprecision(5) << sqrt(boot_err_tot);
+    if(bootstrap) std::cout << setw(15) << setprecision(5) << boot.error(nr_intervals);
     std::cout << endl;
     
   } catch (const gromos::Exception &e) {
@@ -484,6 +528,10 @@ double do_bar(std::vector<double> &E_ii, std::vector<double> &E_ij,
   for(int nj = 0; nj < N_j; nj++)
     exp_ji.push_back(exp(E_jj[nj] - E_ji[nj] - max_ji));
 
+  // the values of ln f(x) of the iteration
+  std::vector<double> val_ij(N_i);
+  std::vector<double> val_ji(N_j);
+
   // Go into the iterations
   while(k < maxiter && reldiff > conv_eps){
  
@@ -556,20 +604,17 @@ double do_bar(std::vector<double> &E_ii, std::vector<double> &E_ij,
     double mx_ji = M + max_ji - DG;
     double exp_mx_ji = exp(-mx_ji);
 
-    double val=0;
-    double lnsum_ij = -mx_ij - log(exp_mx_ij + exp_ij[0]);
+    for(int ni = 0; ni < N_i; ++ni)
+      val_ij[ni] = -mx_ij - log(exp_mx_ij + exp_ij[ni]);
+    gmath::LogSumExp sum_ij;
+    sum_ij.add(&val_ij[0], NULL, N_i);
+    double lnsum_ij = sum_ij.lnexpave() + log(double(N_i));
 
-    for(unsigned int ni = 1; ni < E_ii.size(); ++ni){
-      val = -mx_ij - log(exp_mx_ij + exp_ij[ni]);
-      lnsum_ij = std::max(lnsum_ij, val) + log(1.0 + exp(std::min(lnsum_ij, val) - std::max(lnsum_ij, val)));
-    }
-
-    double lnsum_ji = -max_ji - log(exp_mx_ji + exp_ji[0]) + E_jj[0] - E_ji[0];
-    
-    for(unsigned int nj = 1; nj < E_jj.size(); ++nj){
-      val = -max_ji - log(exp_mx_ji + exp_ji[nj]) + E_jj[nj] - E_ji[nj];
-      lnsum_ji = std::max(lnsum_ji, val) + log(1.0 + exp(std::min(lnsum_ji, val) - std::max(lnsum_ji, val)));
-    }
+    for(int nj = 0; nj < N_j; ++nj)
+      val_ji[nj] = -max_ji - log(exp_mx_ji + exp_ji[nj]) + E_jj[nj] - E_ji[nj];
+    gmath::LogSumExp sum_ji;
+    sum_ji.add(&val_ji[0], NULL, N_j);
+    double lnsum_ji = sum_ji.lnexpave() + log(double(N_j));
 
     DG += lnsum_ji  - lnsum_ij;
     
@@ -586,11 +631,13 @@ double do_bar(std::vector<double> &E_ii, std::vector<double> &E_ij,
   if(!(error < 0)){
 
     // individual error estimates as in dfmult
-    // in the iteration we computed the lnsum_ij ourselves to avoid copying the data back an forth.
-    // here, we just store the appropriate 'val' in Delta_ij and Delta_ji, such that we can use the
-    // features of the Stat class
+    // the averages and variances of exp('val') follow from the shared
+    // kernel, the statistical inefficiencies need the series of 'val' in
+    // Delta_ij and Delta_ji
     gmath::Stat<double> Delta_ij;
     gmath::Stat<double> Delta_ji;
+    gmath::LogSumExp sum_ij;
+    gmath::LogSumExp sum_ji;
   
     double mx_ij = M + max_ij - DG;
     double exp_mx_ij = exp(-mx_ij);
@@ -599,36 +646,36 @@ double do_bar(std::vector<double> &E_ii, std::vector<double> &E_ij,
     double exp_mx_ji = exp(-mx_ji);
 
     for(unsigned int ni = 0; ni < E_ii.size(); ++ni){
-      Delta_ij.addval(-mx_ij - log(exp_mx_ij + exp_ij[ni]));
+      double val = -mx_ij - log(exp_mx_ij + exp_ij[ni]);
+      Delta_ij.addval(val);
+      sum_ij.add(val);
     }
-    double d_ij = Delta_ij.lnexpave();
+    double d_ij = sum_ij.lnexpave();
     
-    // variance
-    int sign_var_i = 1;
-    double var_i = gmath::Stat<double>::lnexpcovariance(Delta_ij, Delta_ij, sign_var_i);
-    if(sign_var_i < 0)
+    // relative variance
+    double var_i = sum_ij.relvariance();
+    if(var_i < 0)
       throw gromos::Exception("bar", "Got negative variance!");
     // statistical inefficiency
     double si_i = gmath::Stat<double>::lnexp_stat_ineff(Delta_ij, Delta_ij);
     // error estimate contribution
-    double d2i = var_i - log(double(N_i)) + si_i;
-    double error_i2 = exp(d2i - 2*d_ij);
+    double error_i2 = var_i * exp(si_i) / N_i;
     
     for(unsigned int nj = 0; nj < E_jj.size(); ++nj){
-      Delta_ji.addval(-max_ji - log(exp_mx_ji + exp_ji[nj]) + E_jj[nj] - E_ji[nj]);
+      double val = -max_ji - log(exp_mx_ji + exp_ji[nj]) + E_jj[nj] - E_ji[nj];
+      Delta_ji.addval(val);
+      sum_ji.add(val);
     }
-    double d_ji = Delta_ji.lnexpave();
+    double d_ji = sum_ji.lnexpave();
     
-    // variance
-    int sign_var_j = 1;
-    double var_j = gmath::Stat<double>::lnexpcovariance(Delta_ji, Delta_ji, sign_var_j);
-    if(sign_var_j < 0)
+    // relative variance
+    double var_j = sum_ji.relvariance();
+    if(var_j < 0)
       throw gromos::Exception("bar", "Got negative variance!");
     // statistical inefficiency
     double si_j = gmath::Stat<double>::lnexp_stat_ineff(Delta_ji, Delta_ji);
     // error estimate contribution
-    double d2j = var_j - log(double(N_j)) + si_j;
-    double error_j2 = exp(d2j - 2*d_ji);
+    double error_j2 = var_j * exp(si_j) / N_j;
 
     error = sqrt(error_i2 / (d_ij*d_ij) + error_j2 / (d_ji*d_ji));
   }
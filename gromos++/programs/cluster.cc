@@ -49,7 +49,12 @@
  * time.
  *
  * Depending on the settings used for program @ref rmsdmat, the flag human
- * may need to be specified to ensure proper reading in of the matrix.
+ * may need to be specified to ensure proper reading in of the matrix. A
+ * sparse matrix, written by @ref rmsdmat with \@sparse, is recognised
+ * automatically. It only contains the pairs within the cutoff of
+ * @ref rmsdmat, such that large numbers of structures can be clustered. The
+ * cutoff of the clustering can be smaller than the one of the sparse matrix
+ * if it contains the rmsd values, otherwise the two have to be the same.
  *
  * Clusters may be further analysed using program @ref postcluster 
  * "postcluster".
@@ -91,15 +96,14 @@
 #include "../src/args/Arguments.h"
 #include "../src/gio/Ginstream.h"
 #include "../src/gio/gzstream.h"
+#include "../src/gio/NeighbourMatrix.h"
 
 #include <cmath>
+#include <queue>
 
 using namespace std;
 using namespace args;
-
-// change this typedef if you have more than 65536 structures
-// typedef unsigned short the_type;
-// typedef unsigned int the_type;
+using gio::NeighbourMatrix;
 
 class cluster_parameter {
 public:
@@ -121,11 +125,15 @@ public:
   };
 };
 
-template<typename the_type>
-void read_matrix(string const filename, vector< vector < the_type > > &matrix,
+// the neighbours j > i with an rmsd below the cutoff
+void read_matrix(string const filename, NeighbourMatrix &upper,
         bool const human, cluster_parameter & cp, int precision);
 
-template<typename the_type>
+// the neighbours of every structure including the structure itself in
+// compressed sparse row format (as in gio::NeighbourMatrix)
+void neighbour_lists(NeighbourMatrix &upper, int rows,
+        vector<size_t> &offset, vector<unsigned int> &index);
+
 int cluster_analysis(Arguments & args);
 
 int main(int argc, char **argv) {
@@ -144,14 +152,7 @@ int main(int argc, char **argv) {
 
   try {
     Arguments args(argc, argv, knowns, usage);
-    typedef unsigned int uint;
-    typedef unsigned short ushort;
-
-    if (args.getValue<int>("precision", true) > 4) {
-      return cluster_analysis<uint > (args);
-    } else {
-      return cluster_analysis<ushort > (args);
-    }
+    return cluster_analysis(args);
   }  catch (const gromos::Exception &e) {
     cerr << e.what() << endl;
     exit(1);
@@ -159,7 +160,6 @@ int main(int argc, char **argv) {
   return 0;
 }
 
-template<typename the_type>
 int cluster_analysis(Arguments & args) {
   // create the cluster parameters
   cluster_parameter cp;
@@ -199,85 +199,73 @@ int cluster_analysis(Arguments & args) {
       throw gromos::Exception("cluster", "could not read structure number for forced clustering");
   }
 
-  // create the data structure
-  vector< vector <the_type> > pairs;
-
   // read matrix
-  read_matrix(args["rmsdmat"], pairs, human, cp, precision);
+  vector<size_t> offset;
+  vector<unsigned int> pairs;
+  {
+    NeighbourMatrix upper;
+    read_matrix(args["rmsdmat"], upper, human, cp, precision);
+    neighbour_lists(upper, cp.maxstruct, offset, pairs);
+  }
 
   // now we are almost done
-  size_t num = pairs.size();
+  size_t num = offset.size() - 1;
   vector<int> taken(num, -1);
-  vector<the_type> central_member;
-  vector<vector <the_type> > cluster;
-  int remaining = num;
+  vector<unsigned int> central_member;
+  vector<vector <unsigned int> > cluster;
   int clustercount = 0;
 
   // set the first cluster
   central_member.push_back(cp.force_ref);
-  cluster.push_back(pairs[cp.force_ref]);
-
-  if (cp.free)
-    pairs[0].clear();
+  cluster.push_back(vector<unsigned int>(pairs.begin() + offset[cp.force_ref],
+          pairs.begin() + offset[cp.force_ref + 1]));
+  // the reference (structure 0) belongs to cluster 0. It is not in the
+  // neighbour lists of the other structures (see neighbour_lists), so also
+  // in free clustering it is never counted in or added to a later cluster,
+  // as before the neighbour lists were kept in compressed rows. With @force
+  // on another structure it can no longer become the centre of a cluster.
   taken[0] = 0;
-
   if (!cp.free) {
     // mark them as taken
-    for (size_t j = 0, jto = pairs[cp.force_ref].size(); j != jto; ++j) {
-      taken[pairs[cp.force_ref][j]] = 0;
-      pairs[pairs[cp.force_ref][j]].clear();
-    }
-    // Markus: BUG??? changed order
-    // take them out 
-    remaining -= pairs[cp.force_ref].size();
-    pairs[cp.force_ref].clear();
-
-    for (size_t i = 1; i < num; ++i) {
-      vector< the_type > temp;
-      for (size_t j = 0, jto = pairs[i].size(); j != jto; ++j) {
-        if (taken[pairs[i][j]] == -1) {
-          temp.push_back(pairs[i][j]);
-        }
-      }
-      pairs[i] = temp;
-    }
+    for (size_t k = offset[cp.force_ref]; k != offset[cp.force_ref + 1]; ++k)
+      taken[pairs[k]] = 0;
   }
 
-  //while(remaining){
-  while (true) {
+  // the number of neighbours that are not taken yet. The structure with
+  // the largest number (and the lowest index) is found on a heap, which may
+  // contain outdated entries for structures whose number has changed since.
+  vector<unsigned int> degree(num, 0);
+  priority_queue<pair<unsigned int, int> > heap;
+  for (size_t i = 1; i < num; ++i) {
+    if (taken[i] != -1) continue;
+    for (size_t k = offset[i]; k != offset[i + 1]; ++k)
+      if (taken[pairs[k]] == -1) ++degree[i];
+    if (degree[i]) heap.push(make_pair(degree[i], -int(i)));
+  }
 
-    // search for the one with the largest number of neighbours
-    size_t maxsize = 0;
-    size_t maxindex = 0;
-    for (size_t i = 0; i < num; ++i) {
-      if (pairs[i].size() > maxsize) {
-        maxsize = pairs[i].size();
-        maxindex = i;
-      }
-    }
-    if (!maxsize) break;
+  while (!heap.empty()) {
+    const unsigned int maxsize = heap.top().first;
+    const size_t maxindex = -heap.top().second;
+    heap.pop();
+    if (taken[maxindex] != -1 || degree[maxindex] != maxsize) continue;
 
     // put them in
     clustercount++;
     central_member.push_back(maxindex);
-    cluster.push_back(pairs[maxindex]);
+    cluster.push_back(vector<unsigned int>());
+    vector<unsigned int> &members = cluster.back();
+    for (size_t k = offset[maxindex]; k != offset[maxindex + 1]; ++k)
+      if (taken[pairs[k]] == -1) members.push_back(pairs[k]);
 
     // and take them out
-    remaining -= pairs[maxindex].size();
-
-    for (size_t j = 0, jto = pairs[maxindex].size(); j != jto; ++j) {
-      taken[pairs[maxindex][j]] = clustercount;
-      pairs[pairs[maxindex][j]].clear();
-    }
-    pairs[maxindex].clear();
-    for (size_t i = 0; i < num; ++i) {
-      vector< the_type > temp;
-      for (size_t j = 0, jto = pairs[i].size(); j != jto; ++j) {
-        if (taken[pairs[i][j]] == -1) {
-          temp.push_back(pairs[i][j]);
-        }
+    for (size_t m = 0; m < members.size(); ++m)
+      taken[members[m]] = clustercount;
+    for (size_t m = 0; m < members.size(); ++m) {
+      for (size_t k = offset[members[m]]; k != offset[members[m] + 1]; ++k) {
+        const unsigned int j = pairs[k];
+        if (taken[j] == -1)
+          heap.push(make_pair(--degree[j], -int(j)));
       }
-      pairs[i] = temp;
     }
   } // while remaining
 
@@ -288,7 +276,7 @@ int cluster_analysis(Arguments & args) {
     for (size_t i = 1; i < num; ++i) {
       fout << setw(10) << time
               << setw(10) << i
-              << setw(10) << taken[i] << endl;
+              << setw(10) << taken[i] << '\n';
       time += cp.dt;
     }
   }
@@ -371,8 +359,72 @@ int cluster_analysis(Arguments & args) {
   return 0;
 }
 
-template<typename the_type>
-void read_matrix(string const filename, vector< vector < the_type > > &matrix,
+void neighbour_lists(NeighbourMatrix &upper, int rows,
+        vector<size_t> &offset, vector<unsigned int> &index) {
+  // rows beyond the number of structures (@maxstruct) stay empty
+  const int n = upper.rows();
+  offset.assign(rows + 1, 0);
+  for (int i = 0; i < n; ++i) {
+    offset[i + 1] += 1 + upper.offset[i + 1] - upper.offset[i];
+    if (i > 0) {
+      for (size_t k = upper.offset[i]; k != upper.offset[i + 1]; ++k)
+        ++offset[upper.index[k] + 1];
+    }
+  }
+  for (int i = 0; i < rows; ++i)
+    offset[i + 1] += offset[i];
+
+  // the lower neighbours of a row are added before its own row is
+  // reached, so all rows are sorted
+  index.resize(offset.back());
+  vector<size_t> next(offset.begin(), offset.end() - 1);
+  for (int i = 0; i < n; ++i) {
+    index[next[i]++] = i;
+    for (size_t k = upper.offset[i]; k != upper.offset[i + 1]; ++k) {
+      const unsigned int j = upper.index[k];
+      index[next[i]++] = j;
+      // the reference is not a neighbour of the other structures
+      if (i > 0)
+        index[next[j]++] = i;
+    }
+  }
+  upper = NeighbourMatrix();
+}
+
+void read_sparse_matrix(istream &fin, NeighbourMatrix &upper,
+        cluster_parameter & cp, int precision) {
+  if (cp.maxstruct >= 0) cp.maxstruct++;
+  unsigned int icutoff = unsigned(cp.cutoff * precision);
+  upper.read(fin, cp.maxstruct, icutoff);
+  cp.num = upper.num;
+  cp.skip = upper.skip;
+  cp.stride = upper.stride;
+  cp.precision = upper.precision;
+  if (cp.precision != precision)
+    throw gromos::Exception("cluster", "Error while reading rmsdmat file\n"
+          "Matrix has different precision as given in @precision!\n");
+
+  double cuttest = cp.cutoff * cp.precision / 10;
+  if (fabs(double(rint(cuttest)) - cuttest) > cp.cutoff / 100.0)
+    throw gromos::Exception("cluster", "A cutoff with this precision "
+          "requires a higher precision in the rmsd "
+          "matrix. \nYes that means that you have to "
+          "redo your matrix $%^$#$@$%!!");
+  if (cp.maxstruct < 0) cp.maxstruct = cp.num;
+
+  // the sparse matrix has to contain all pairs within the cutoff
+  if (icutoff > upper.icutoff || (!upper.hasValues && icutoff != upper.icutoff)) {
+    ostringstream os;
+    os << "Error while reading rmsdmat file\n"
+            << "The sparse matrix contains the pairs with rmsd < "
+            << double(upper.icutoff) / cp.precision << " only";
+    if (!upper.hasValues) os << " and no rmsd values.\nUse this cutoff.";
+    else os << ".\nUse a smaller cutoff.";
+    throw gromos::Exception("cluster", os.str());
+  }
+}
+
+void read_matrix(string const filename, NeighbourMatrix &upper,
         bool const human, cluster_parameter & cp, int precision) {
   
   if (human) {
@@ -395,14 +447,6 @@ void read_matrix(string const filename, vector< vector < the_type > > &matrix,
     if (cp.num < 0)
       throw gromos::Exception("cluster", "Error while reading rmsdmat file\n"
             "read negative number structures\n");
-    if (cp.num > pow(2.0, 8.0 * sizeof (the_type))) {
-      std::cerr << "number of structures: " << cp.num << "\n"
-              << "maximum number possible: " << pow(2.0, 8.0 * sizeof (the_type))
-              << std::endl;
-      throw gromos::Exception("cluster", "GROMOS96 ERROR: number of "
-              "structures is too large for data type. "
-              "Change typedef in program and recompile");
-    }
 
     if (cp.skip < 0)
       throw gromos::Exception("cluster", "Error while reading rmsdmat file\n"
@@ -433,19 +477,12 @@ void read_matrix(string const filename, vector< vector < the_type > > &matrix,
     if (cp.maxstruct < 0) cp.maxstruct = cp.num;
     else cp.maxstruct++;
 
-    int icutoff = int(cp.cutoff * cp.precision);
-
-    matrix.resize(cp.maxstruct);
+    unsigned int icutoff = unsigned(cp.cutoff * cp.precision);
 
-    int ii, jj, rmsd;
+    int ii, jj;
+    unsigned int rmsd;
 
     for (int i = 0; i < cp.num; ++i) {
-      if (i < cp.maxstruct) {
-        //cout << "diagonal " << i << endl;
-
-        matrix[i].push_back(i);
-      }
-
       for (int j = i + 1; j < cp.num; ++j) {
         gin.getline(sdum);
         is.clear();
@@ -460,12 +497,11 @@ void read_matrix(string const filename, vector< vector < the_type > > &matrix,
           throw gromos::Exception("cluster", os.str());
         }
 
-        if (ii < cp.maxstruct && jj < cp.maxstruct && rmsd < icutoff) {
-          matrix[ii].push_back(jj);
-          if (ii > 0)
-            matrix[jj].push_back(ii);
-        }
+        if (ii < cp.maxstruct && jj < cp.maxstruct && rmsd < icutoff)
+          upper.index.push_back(jj);
       }
+      if (i < cp.maxstruct)
+        upper.offset.push_back(upper.index.size());
     }
     if (!(gin.getline(sdum)))
       throw gromos::Exception("cluster", "Error while reading rmsdmat file\n"
@@ -480,20 +516,13 @@ void read_matrix(string const filename, vector< vector < the_type > > &matrix,
       throw gromos::Exception("cluster", "Error opening rmsdmat file\n");
     }
 
-    if (!fin.read((char*) &cp.num, sizeof (int)))
-      throw gromos::Exception("cluster", "Error while reading rmsdmat file\n"
-            "could not read number of structures\n");
+    if (NeighbourMatrix::readMarker(fin, cp.num)) {
+      read_sparse_matrix(fin, upper, cp, precision);
+      return;
+    }
     if (cp.num < 0)
       throw gromos::Exception("cluster", "Error while reading rmsdmat file\n"
             "read negative number of structures\n");
-    if (cp.num > pow(2.0, 8.0 * sizeof (the_type))) {
-      std::cerr << "number of structures: " << cp.num << "\n"
-              << "maximum number possible: " << pow(2.0, 8.0 * sizeof (the_type))
-              << std::endl;
-      throw gromos::Exception("cluster", "GROMOS96 ERROR: number of "
-              "structures is too large for data type. "
-              "Change typedef in program and recompile");
-    }
     if (!fin.read((char*) &cp.skip, sizeof (int)))
       throw gromos::Exception("cluster", "Error while reading rmsdmat file\n"
             "could not read skip\n");
@@ -528,45 +557,35 @@ void read_matrix(string const filename, vector< vector < the_type > > &matrix,
 
     unsigned int icutoff = unsigned(cp.cutoff * cp.precision);
 
-    matrix.resize(cp.maxstruct);
-
     if (cp.precision < 1e5) {
       typedef unsigned short ushort;
 
       ushort rmsd;
 
       for (int i = 0; i < cp.num; ++i) {
-        if (i < cp.maxstruct)
-          matrix[i].push_back(i);
-
         for (int j = i + 1; j < cp.num; ++j) {
           if (!fin.read((char*) &rmsd, sizeof (ushort)))
             throw gromos::Exception("cluster", "Error while reading rmsdmat file\n"
                   "file corrupt");
-          if (i < cp.maxstruct && j < cp.maxstruct && rmsd < short(icutoff)) {
-            matrix[i].push_back(j);
-            if (i > 0)
-              matrix[j].push_back(i);
-          }
+          if (i < cp.maxstruct && j < cp.maxstruct && rmsd < short(icutoff))
+            upper.index.push_back(j);
         }
+        if (i < cp.maxstruct)
+          upper.offset.push_back(upper.index.size());
       }
     } else {
       unsigned rmsd;
 
       for (int i = 0; i < cp.num; ++i) {
-        if (i < cp.maxstruct)
-          matrix[i].push_back(i);
-
         for (int j = i + 1; j < cp.num; ++j) {
           if (!fin.read((char*) &rmsd, sizeof (unsigned)))
             throw gromos::Exception("cluster", "Error while reading rmsdmat file\n"
                   "file corrupt");
-          if (i < cp.maxstruct && j < cp.maxstruct && rmsd < icutoff) {
-            matrix[i].push_back(j);
-            if (i > 0)
-              matrix[j].push_back(i);
-          }
+          if (i < cp.maxstruct && j < cp.maxstruct && rmsd < icutoff)
+            upper.index.push_back(j);
         }
+        if (i < cp.maxstruct)
+          upper.offset.push_back(upper.index.size());
       }
     } // if precision
   } // if human
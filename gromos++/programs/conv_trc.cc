@@ -0,0 +1,180 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file conv_trc.cc
+ * Converts coordinate trajectories to and from the binary format
+ */
+
+/**
+ * @page programs Program Documentation
+ *
+ * @anchor conv_trc
+ * @section conv_trc Converts coordinate trajectories to and from the binary format
+ * @date 16.10.26
+ *
+ * Program conv_trc converts coordinate trajectories between the text format
+ * (POSITIONRED blocks) and the binary trajectory format. Binary trajectories
+ * store the coordinates rounded to 1/precision nm (default 1000 
+ * nm<sup>-1</sup>, i.e. 0.001 nm) with bit packing of small differences 
+ * between consecutive atoms (similar to the XTC format) and carry the 
+ * TIMESTEP, GENBOX and REMD information of every frame. They are typically
+ * ten times smaller than text trajectories and are read much faster.
+ *
+ * All programs which read coordinate trajectories recognise binary 
+ * trajectories automatically, so the conversion back to text is only 
+ * needed for other software. Input trajectories may be text, binary or
+ * gzip compressed.
+ *
+ * <b>arguments:</b>
+ * <table border=0 cellpadding=0>
+ * <tr><td> \@topo</td><td>&lt;molecular topology file&gt; </td></tr>
+ * <tr><td> \@traj</td><td>&lt;input trajectory file(s)&gt; </td></tr>
+ * <tr><td> [\@outformat</td><td>&lt;btrc [&lt;precision&gt;] (default) or trc&gt;] </td></tr>
+ * <tr><td> \@outfile</td><td>&lt;output file (compressed if it ends in .gz)&gt; </td></tr>
+ * <tr><td> [\@select</td><td>&lt;ALL (default), SOLUTE or SOLVENT&gt;] </td></tr>
+ * <tr><td> [\@time</td><td>&lt;@ref utils::Time "time and dt"&gt;] </td></tr>
+ * </table>
+ *
+ *
+ * Example:
+ * @verbatim
+  conv_trc
+    @topo      ex.top
+    @traj      ex.trc.gz
+    @outformat btrc 1000
+    @outfile   ex.btrc
+ @endverbatim
+ *
+ * <hr>
+ */
+
+#include <cstdlib>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#include "../src/args/Arguments.h"
+#include "../src/gio/InG96.h"
+#include "../src/gio/OutG96.h"
+#include "../src/gio/OutBinTrc.h"
+#include "../src/gio/OutFile.h"
+#include "../src/gcore/System.h"
+#include "../src/gio/InTopology.h"
+#include "../src/utils/groTime.h"
+
+using namespace std;
+using namespace gcore;
+using namespace gio;
+using namespace args;
+
+int main(int argc, char **argv){
+  Argument_List knowns;
+  knowns << "topo" << "traj" << "outformat" << "outfile" << "select" << "time";
+
+  string usage = "# " + string(argv[0]);
+  usage += "\n\t@topo       <molecular topology file>\n";
+  usage += "\t@traj       <input trajectory files>\n";
+  usage += "\t[@outformat <btrc [<precision>] (default) or trc>]\n";
+  usage += "\t@outfile    <output file>\n";
+  usage += "\t[@select    <ALL (default), SOLUTE or SOLVENT>]\n";
+  usage += "\t[@time      <time and dt>]\n";
+
+  try{
+    Arguments args(argc, argv, knowns, usage);
+    
+    utils::Time time(args);
+
+    // read topology
+    InTopology it(args["topo"]);
+    System sys(it.system());
+
+    string select = args.getValue<string>("select", false, "ALL");
+    if (select != "ALL" && select != "SOLUTE" && select != "SOLVENT")
+      throw gromos::Exception(argv[0], "@select has to be ALL, SOLUTE or "
+              "SOLVENT");
+
+    // output format
+    bool binary = true;
+    double precision = 1000.0;
+    if (args.count("outformat") > 0) {
+      Arguments::const_iterator iter = args.lower_bound("outformat"),
+              to = args.upper_bound("outformat");
+      string format = iter->second;
+      transform(format.begin(), format.end(), format.begin(), ::tolower);
+      if (format == "trc") {
+        binary = false;
+      } else if (format != "btrc") {
+        throw gromos::Exception(argv[0], "@outformat has to be btrc or trc");
+      }
+      if (++iter != to) {
+        istringstream is(iter->second);
+        if (!binary || !(is >> precision) || precision <= 0.0)
+          throw gromos::Exception(argv[0], "@outformat btrc precision has "
+                  "to be a positive number");
+      }
+    }
+
+    // output file, compressed if the name ends in .gz
+    args.check("outfile", 1);
+    ostream *os = openOutput(args);
+
+    OutCoordinates *oc;
+    if (binary)
+      oc = new OutBinTrc(*os, precision);
+    else
+      oc = new OutG96(*os);
+    oc->select(select);
+
+    InG96 ic;
+    bool isFirstTraj = true;
+    for(Arguments::const_iterator iter=args.lower_bound("traj");
+      iter!=args.upper_bound("traj"); ++iter){
+
+      ic.open(iter->second);
+      ic.select(select);
+
+      if (isFirstTraj){
+        oc->writeTitle(ic.title());
+        isFirstTraj = false;
+      }
+
+      // loop over all frames
+      while(!ic.eof()){
+        ic >> sys >> time;
+        oc->writeTimestep(time.steps(), time.time());
+        *oc << sys;
+      }    
+    
+      ic.close();
+    }
+    oc->close();
+    delete oc;
+    if (os != &cout) delete os;
+  }
+  catch (const gromos::Exception &e){
+    cerr << e.what() << endl;
+    exit(1);
+  }
+  return 0;
+}
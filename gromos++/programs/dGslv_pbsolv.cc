@@ -68,6 +68,13 @@
  *
  *
  *
+ * The FD equations are solved with an incomplete Cholesky preconditioned conjugate
+ * gradient method (\@solverFD ICCG, default), with multigrid V-cycles (MG) or with a
+ * multigrid preconditioned conjugate gradient method (MGCG). The number of iterations
+ * of the multigrid solvers hardly grows with the grid size, so they are to be
+ * preferred for large grids. The grids coarsen best for odd numbers of grid points
+ * under non-periodic and even numbers under periodic boundary conditions.
+ *
  * The solute will be centered in the computational box, with its center of geometry.
  *
  * The algorithms employed are from these papers:
@@ -91,6 +98,7 @@
  @gridspacing 0.02
  @gridpointsXYZ 158 158 158
  @maxiter 600
+ @solverFD MGCG
  @cubesFFT 4
  @probeIAC 5
  @probeRAD 0.14
@@ -154,12 +162,26 @@ using namespace args;
 using namespace utils;
 using namespace pb;
 
-vector <double> fd_ls_npbc_slv(utils::AtomSpecifier atoms, utils::AtomSpecifier atomsTOcharge, int ngrid_x, int ngrid_y, int ngrid_z, double gridspacing, double epsNPBC,  int maxiter, double convergence_fd, double &result_npbc_slv, double &gridcenterX, double &gridcenterY, double &gridcenterZ, double &gridstartX, double &gridstartY, double &gridstartZ, ofstream &os) {
+// solves for the potential with the finite-difference solver given by
+// @solverFD: ICCG, MG (multigrid V-cycles) or MGCG (multigrid preconditioned CG)
+bool fd_solve(FDPoissonBoltzmann &pbsolv, int ngrid_x, int ngrid_y, int ngrid_z, bool pbc, int maxiter, double convergence_fd, const string &solverFD, ofstream &os) {
+  if (solverFD == "ICCG") {
+    if (pbc) {
+      FDPoissonBoltzmann_ICCG_PBC iccg_pbc(ngrid_x,ngrid_y,ngrid_z);
+      return pbsolv.solveforpotential_pbc(maxiter, convergence_fd, iccg_pbc, os);
+    }
+    FDPoissonBoltzmann_ICCG_NPBC iccg_npbc(ngrid_x,ngrid_y,ngrid_z);
+    return pbsolv.solveforpotential_npbc(maxiter, convergence_fd, iccg_npbc, os);
+  }
+  FDPoissonBoltzmann_MG mg(ngrid_x, ngrid_y, ngrid_z, pbc);
+  return pbsolv.solveforpotential_mg(maxiter, convergence_fd, mg, solverFD == "MGCG", os);
+}
+
+vector <double> fd_ls_npbc_slv(utils::AtomSpecifier atoms, utils::AtomSpecifier atomsTOcharge, int ngrid_x, int ngrid_y, int ngrid_z, double gridspacing, double epsNPBC,  int maxiter, double convergence_fd, double &result_npbc_slv, double &gridcenterX, double &gridcenterY, double &gridcenterZ, double &gridstartX, double &gridstartY, double &gridstartZ, const string &solverFD, ofstream &os) {
 
   // Create vectors for storing the calculated potentials
   vector <double> potentials_npbc_slv (0);
 
-  FDPoissonBoltzmann_ICCG_NPBC iccg_npbc(ngrid_x,ngrid_y,ngrid_z);
   os << "# ************************************************** " <<   endl;  
   os << "# *** FD LS NPBC EPSSOLV *** " <<   endl;
   os << "# ************************************************** " <<   endl;
@@ -167,16 +189,14 @@ vector <double> fd_ls_npbc_slv(utils::AtomSpecifier atoms, utils::AtomSpecifier
   FDPoissonBoltzmann pbsolv_NPBC_epssolvent(atoms,atomsTOcharge,ngrid_x,ngrid_y,ngrid_z, \
 					    gridspacing, false,epsNPBC, os);
   pbsolv_NPBC_epssolvent.setupGrid(true, os);
-  pbsolv_NPBC_epssolvent.solveforpotential_npbc(maxiter, convergence_fd,iccg_npbc, os);
+  fd_solve(pbsolv_NPBC_epssolvent, ngrid_x, ngrid_y, ngrid_z, false, maxiter, convergence_fd, solverFD, os);
   result_npbc_slv = pbsolv_NPBC_epssolvent.dGelec(os, &potentials_npbc_slv);
   return potentials_npbc_slv;
     
 }
 
-vector <double> fd_ls_npbc_vac (utils::AtomSpecifier atoms, utils::AtomSpecifier atomsTOcharge, int ngrid_x, int ngrid_y, int ngrid_z, double gridspacing, double epssolvent, int maxiter, double convergence_fd, double &result_npbc_vac, double &gridcenterX, double &gridcenterY, double &gridcenterZ, double &gridstartX, double &gridstartY, double &gridstartZ, ofstream &os){
+vector <double> fd_ls_npbc_vac (utils::AtomSpecifier atoms, utils::AtomSpecifier atomsTOcharge, int ngrid_x, int ngrid_y, int ngrid_z, double gridspacing, double epssolvent, int maxiter, double convergence_fd, double &result_npbc_vac, double &gridcenterX, double &gridcenterY, double &gridcenterZ, double &gridstartX, double &gridstartY, double &gridstartZ, const string &solverFD, ofstream &os){
   vector <double> potentials_npbc_vac (0);
-  FDPoissonBoltzmann_ICCG_NPBC iccg_npbc(ngrid_x,ngrid_y,ngrid_z);
-  
   os << "# ************************************************** " <<   endl;  
   os << "# *** FD LS NPBC VAC *** " <<   endl;
   os << "# ************************************************** " <<   endl;
@@ -184,16 +204,14 @@ vector <double> fd_ls_npbc_vac (utils::AtomSpecifier atoms, utils::AtomSpecifier
   FDPoissonBoltzmann pbsolv_NPBC_vac(atoms,atomsTOcharge,ngrid_x,ngrid_y,ngrid_z, \
 				     gridspacing, false,1.0, os);
   pbsolv_NPBC_vac.setupGrid(true, os, gridstartX, gridstartY, gridstartZ, gridcenterX, gridcenterY, gridcenterZ);
-  pbsolv_NPBC_vac.solveforpotential_npbc(maxiter, convergence_fd,iccg_npbc, os);
+  fd_solve(pbsolv_NPBC_vac, ngrid_x, ngrid_y, ngrid_z, false, maxiter, convergence_fd, solverFD, os);
   result_npbc_vac = pbsolv_NPBC_vac.dGelec(os, &potentials_npbc_vac);
  
   return potentials_npbc_vac;
 }
 
-vector <double> fd_ls_pbc_slv(utils::AtomSpecifier atoms, utils::AtomSpecifier atomsTOcharge, int ngrid_x, int ngrid_y, int ngrid_z, double gridspacing, double epssolvent, int maxiter, double convergence_fd, double &result_pbc_slv, double &gridcenterX, double &gridcenterY, double &gridcenterZ, double &gridstartX, double &gridstartY, double &gridstartZ, ofstream &os) {
+vector <double> fd_ls_pbc_slv(utils::AtomSpecifier atoms, utils::AtomSpecifier atomsTOcharge, int ngrid_x, int ngrid_y, int ngrid_z, double gridspacing, double epssolvent, int maxiter, double convergence_fd, double &result_pbc_slv, double &gridcenterX, double &gridcenterY, double &gridcenterZ, double &gridstartX, double &gridstartY, double &gridstartZ, const string &solverFD, ofstream &os) {
   vector <double> potentials_pbc_slv (0);
-  FDPoissonBoltzmann_ICCG_PBC iccg_pbc(ngrid_x,ngrid_y,ngrid_z);
-  
   os << "# ************************************************** " <<   endl;
   os << "# *** FD LS PBC EPSSOLV *** " <<   endl;
   os << "# ************************************************** " <<   endl;
@@ -202,7 +220,7 @@ vector <double> fd_ls_pbc_slv(utils::AtomSpecifier atoms, utils::AtomSpecifier a
   FDPoissonBoltzmann pbsolv_PBC_epssolvent(atoms,atomsTOcharge,ngrid_x,ngrid_y,ngrid_z,\
 					   gridspacing, true,epssolvent, os);
   pbsolv_PBC_epssolvent.setupGrid(true, os, gridstartX, gridstartY, gridstartZ, gridcenterX, gridcenterY, gridcenterZ);
-  pbsolv_PBC_epssolvent.solveforpotential_pbc(maxiter, convergence_fd,iccg_pbc, os);
+  fd_solve(pbsolv_PBC_epssolvent, ngrid_x, ngrid_y, ngrid_z, true, maxiter, convergence_fd, solverFD, os);
   result_pbc_slv =  pbsolv_PBC_epssolvent.dGelec(os, &potentials_pbc_slv);
   os << "# ************************************************** " <<   endl;
   
@@ -212,18 +230,15 @@ vector <double> fd_ls_pbc_slv(utils::AtomSpecifier atoms, utils::AtomSpecifier a
 vector <double> fd_ls_pbc_vac(utils::AtomSpecifier atoms, utils::AtomSpecifier atomsTOcharge,	\
 			      int ngrid_x, int ngrid_y, int ngrid_z, double gridspacing,\
 			      int maxiter, double convergence_fd, double &result_pbc_vac, double &gridcenterX, double &gridcenterY, double &gridcenterZ, double &gridstartX, double &gridstartY, double &gridstartZ, 
-			      			\
-			      ofstream &os) {
+			      const string &solverFD, ofstream &os) {
   vector <double> potentials_pbc_vac (0);
-  FDPoissonBoltzmann_ICCG_PBC iccg_pbc(ngrid_x,ngrid_y,ngrid_z);
-  
   os << "# ************************************************** " <<   endl;
   os << "# *** FD LS PBC VAC *** " <<   endl;
   os << "# ************************************************** " <<   endl;
   
   FDPoissonBoltzmann pbsolv_PBC_vac(atoms,atomsTOcharge,ngrid_x,ngrid_y,ngrid_z,gridspacing, true,1.0, os); //vacuum calc
   pbsolv_PBC_vac.setupGrid(true, os, gridstartX, gridstartY, gridstartZ, gridcenterX, gridcenterY, gridcenterZ);
-  pbsolv_PBC_vac.solveforpotential_pbc(maxiter, convergence_fd,iccg_pbc, os);
+  fd_solve(pbsolv_PBC_vac, ngrid_x, ngrid_y, ngrid_z, true, maxiter, convergence_fd, solverFD, os);
   result_pbc_vac = pbsolv_PBC_vac.dGelec(os, &potentials_pbc_vac);
 
   return potentials_pbc_vac;
@@ -335,7 +350,7 @@ int main(int argc, char **argv){
          << "pbc"
          << "atoms" <<  "atomsTOcharge" << "coord" << "pqr" << "schemeELEC" << "epsSOLV"
          << "epsRF" << "rcut"
-         << "gridspacing" << "coordinates" << "maxiter" << "nogridpoints" << "NPBCsize"
+         << "gridspacing" << "coordinates" << "maxiter" << "solverFD" << "nogridpoints" << "NPBCsize"
          << "cubesFFT" << "probeIAC" << "probeRAD" << "HRAD" <<  "epsNPBC" <<  "radscal" << "rminORsigma" << "increasegrid" << "verbose";
 
   string usage = "# " + string(argv[0]);
@@ -393,6 +408,8 @@ int main(int argc, char **argv){
   usage += "\t[@epsNPBC        <relative dielectrict permittivity for calculation of macroscopic,\n";
   usage += "\t                  non-periodic boundary conditions; default 78.4 (for water)>]\n";
   usage += "\t[@maxiter        <maximum number of iteration steps; default 600>]\n";
+  usage += "\t[@solverFD       <FD solver: ICCG, MG (multigrid) or MGCG (multigrid\n";
+  usage += "\t                  preconditioned CG); default ICCG>]\n";
   usage += "\t[@cubesFFT       <number of cubes in the fast Fourier transformation for\n";
   usage += "\t                  boundary smoothing; default 4>]\n";
   usage += "\t[@probeRAD       <probe radius in nm; default 0.14 (for water)>]\n";
@@ -504,6 +521,13 @@ int main(int argc, char **argv){
     if (maxiter<=0)  throw gromos::Exception("dGslv_pbsolv","The maximum number of iterations (maxiter) must be positive. Exiting ...");
     os << "# READ: maxiter " << maxiter << endl;
 
+    // read solverFD
+    string solverFD="ICCG";
+    if(args.count("solverFD")>0) solverFD=args["solverFD"];
+    if (solverFD != "ICCG" && solverFD != "MG" && solverFD != "MGCG")
+      throw gromos::Exception("dGslv_pbsolv","The FD solver (solverFD) must be ICCG, MG or MGCG. Exiting ...");
+    os << "# READ: solverFD " << solverFD << endl;
+
     // read radius definition
     int rminorsigma=0;
     if(args.count("coord")>0) {
@@ -734,8 +758,8 @@ int main(int argc, char **argv){
       vector <double> potentials_fft_ls_pbc;
       vector <double> potentials_fft_rf_pbc;
       
-      potentials_npbc_vac = fd_ls_npbc_vac(cnf_atoms, cnf_atomsTOcharge, ngrid_x_npbc, ngrid_y_npbc, ngrid_z_npbc, gridspacing, epssolvent, maxiter, convergence_fd, result_npbc_vac, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, os);
-      potentials_npbc_slv = fd_ls_npbc_slv(cnf_atoms, cnf_atomsTOcharge, ngrid_x_npbc, ngrid_y_npbc, ngrid_z_npbc, gridspacing, epsNPBC, maxiter, convergence_fd, result_npbc_slv, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, os);
+      potentials_npbc_vac = fd_ls_npbc_vac(cnf_atoms, cnf_atomsTOcharge, ngrid_x_npbc, ngrid_y_npbc, ngrid_z_npbc, gridspacing, epssolvent, maxiter, convergence_fd, result_npbc_vac, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, solverFD, os);
+      potentials_npbc_slv = fd_ls_npbc_slv(cnf_atoms, cnf_atomsTOcharge, ngrid_x_npbc, ngrid_y_npbc, ngrid_z_npbc, gridspacing, epsNPBC, maxiter, convergence_fd, result_npbc_slv, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, solverFD, os);
       double result_ls_npbc = result_npbc_slv - result_npbc_vac;
       os << "# DGRESULT NPBC " << result_ls_npbc << endl;
 
@@ -743,8 +767,8 @@ int main(int argc, char **argv){
       gridstartY = 0;
       gridstartZ = 0;
       
-      potentials_pbc_vac = fd_ls_pbc_vac(cnf_atoms, cnf_atomsTOcharge, ngrid_x, ngrid_y, ngrid_z, gridspacing, maxiter, convergence_fd, result_pbc_vac, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, os);
-      potentials_pbc_slv = fd_ls_pbc_slv(cnf_atoms, cnf_atomsTOcharge, ngrid_x, ngrid_y, ngrid_z, gridspacing, epssolvent, maxiter, convergence_fd, result_pbc_slv, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, os);
+      potentials_pbc_vac = fd_ls_pbc_vac(cnf_atoms, cnf_atomsTOcharge, ngrid_x, ngrid_y, ngrid_z, gridspacing, maxiter, convergence_fd, result_pbc_vac, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, solverFD, os);
+      potentials_pbc_slv = fd_ls_pbc_slv(cnf_atoms, cnf_atomsTOcharge, ngrid_x, ngrid_y, ngrid_z, gridspacing, epssolvent, maxiter, convergence_fd, result_pbc_slv, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, solverFD, os);
       double result_ls_pbc = result_pbc_slv - result_pbc_vac;
       os << "# DGRESULT PBC " << result_ls_pbc << endl;
       
@@ -1024,9 +1048,9 @@ int main(int argc, char **argv){
       vector <double> potentials_fft_ls_pbc;
       vector <double> potentials_fft_rf_pbc;
       
-      potentials_npbc_slv = fd_ls_npbc_slv(pqr_atoms, pqr_atomsTOcharge, ngrid_x_npbc, ngrid_y_npbc, ngrid_z_npbc, gridspacing, epsNPBC, maxiter, convergence_fd, result_npbc_slv, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, os);
+      potentials_npbc_slv = fd_ls_npbc_slv(pqr_atoms, pqr_atomsTOcharge, ngrid_x_npbc, ngrid_y_npbc, ngrid_z_npbc, gridspacing, epsNPBC, maxiter, convergence_fd, result_npbc_slv, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, solverFD, os);
       
-      potentials_npbc_vac = fd_ls_npbc_vac(pqr_atoms, pqr_atomsTOcharge, ngrid_x_npbc, ngrid_y_npbc, ngrid_z_npbc, gridspacing, epssolvent, maxiter, convergence_fd, result_npbc_vac, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, os);
+      potentials_npbc_vac = fd_ls_npbc_vac(pqr_atoms, pqr_atomsTOcharge, ngrid_x_npbc, ngrid_y_npbc, ngrid_z_npbc, gridspacing, epssolvent, maxiter, convergence_fd, result_npbc_vac, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, solverFD, os);
 
       double result_ls_npbc = result_npbc_slv - result_npbc_vac;
       os << "# DGRESULT NPBC " << result_ls_npbc << endl;
@@ -1036,9 +1060,9 @@ int main(int argc, char **argv){
       gridstartZ = 0;
 
       
-      potentials_pbc_slv = fd_ls_pbc_slv(pqr_atoms, pqr_atomsTOcharge, ngrid_x, ngrid_y, ngrid_z, gridspacing, epssolvent, maxiter, convergence_fd, result_pbc_slv, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, os);
+      potentials_pbc_slv = fd_ls_pbc_slv(pqr_atoms, pqr_atomsTOcharge, ngrid_x, ngrid_y, ngrid_z, gridspacing, epssolvent, maxiter, convergence_fd, result_pbc_slv, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, solverFD, os);
       
-      potentials_pbc_vac = fd_ls_pbc_vac(pqr_atoms, pqr_atomsTOcharge, ngrid_x, ngrid_y, ngrid_z, gridspacing, maxiter, convergence_fd, result_pbc_vac, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, os);
+      potentials_pbc_vac = fd_ls_pbc_vac(pqr_atoms, pqr_atomsTOcharge, ngrid_x, ngrid_y, ngrid_z, gridspacing, maxiter, convergence_fd, result_pbc_vac, gridcenterX, gridcenterY, gridcenterZ, gridstartX, gridstartY, gridstartZ, solverFD, os);
 
       double result_ls_pbc = result_pbc_slv - result_pbc_vac;
       os << "# DGRESULT PBC " << result_ls_pbc << endl;
@@ -45,11 +45,20 @@
  * authors. When calculating averages and uncertainties special care is taken
  * in order to avoid overflow (see Comput. Phys. Comm. 2003, 153, 397-406).
  *
+ * Optionally, a bootstrap error (boot err) is calculated from the indicated
+ * number of random samples of the frames (\@bootstrap), optionally in blocks
+ * of consecutive frames (\@bootblock) for correlated time series. The 
+ * samples are distributed over the OpenMP threads and are reproducible for a
+ * given seed (\@bootseed).
+ *
  * <b>arguments:</b>
  * <table border=0 cellpadding=0>
  * <tr><td> \@temp</td><td>&lt;temperature for perturbation&gt; </td></tr>
  * <tr><td> \@stateR</td><td>&lt;energy file for state R&gt; </td></tr>
  * <tr><td> \@endstates</td><td>&lt;energy files of end states&gt; </td></tr>
+ * <tr><td> [\@bootstrap</td><td>&lt;number of bootstrap estimates (default: 0)&gt;] </td></tr>
+ * <tr><td> [\@bootblock</td><td>&lt;block length for the bootstrap (default: 1)&gt;] </td></tr>
+ * <tr><td> [\@bootseed</td><td>&lt;seed for the bootstrap (default: 4711)&gt;] </td></tr>
  * </table>
  *
  * Example:
@@ -72,28 +81,75 @@
 
 #include "../src/args/Arguments.h"
 #include "../src/gmath/Stat.h"
+#include "../src/gmath/LogSumExp.h"
+#include "../src/gmath/Bootstrap.h"
 #include "../src/gmath/Expression.h"
 #include "../src/gmath/Physics.h"
 
 using namespace std;
 using namespace args;
 
+// the free energy differences of all end states from resampled frames,
+// in the order of the output
+class dfBootstrap : public gmath::Bootstrap::Estimator {
+  vector<const vector<double> *> d_exphxhr;
+  double d_kT;
+public:
+  dfBootstrap(const vector<gmath::Stat<double> > &exphxhr, double kT) :
+  d_kT(kT) {
+    for (unsigned int i = 0; i < exphxhr.size(); i++)
+      d_exphxhr.push_back(&exphxhr[i].data());
+  }
+
+  unsigned int size()const {
+    return d_exphxhr.size() * (d_exphxhr.size() + 1) / 2;
+  }
+
+  void estimate(const vector<vector<unsigned int> > &index, double *res)const {
+    const unsigned int num_states = d_exphxhr.size();
+    gmath::LogSumExp expave(num_states);
+    vector<double> frame(num_states);
+    for (unsigned int n = 0; n < index[0].size(); n++) {
+      for (unsigned int i = 0; i < num_states; i++)
+        frame[i] = (*d_exphxhr[i])[index[0][n]];
+      expave.add(&frame[0]);
+    }
+    unsigned int q = 0;
+    for (unsigned int i = 0; i < num_states; i++) {
+      res[q++] = -d_kT * expave.lnexpave(i);
+      for (unsigned int j = i + 1; j < num_states; j++)
+        res[q++] = -d_kT * (expave.lnexpave(j) - expave.lnexpave(i));
+    }
+  }
+};
+
 
 int main(int argc, char** argv) {
   Argument_List knowns;
 
-  knowns << "temp" << "stateR" << "endstates";
+  knowns << "temp" << "stateR" << "endstates" << "bootstrap" << "bootblock"
+          << "bootseed";
 
   string usage = "# " + string(argv[0]);
   usage += "\n\t@temp      <temperature for perturbation>\n";
   usage +=   "\t@stateR    <energy file for state R>\n";
   usage +=   "\t@endstates <energy files of endstates>\n";
+  usage +=   "\t[@bootstrap <number of bootstrap estimates (default: 0)>]\n";
+  usage +=   "\t[@bootblock <block length for the bootstrap (default: 1)>]\n";
+  usage +=   "\t[@bootseed  <seed for the bootstrap (default: 4711)>]\n";
   
   try {
     Arguments args(argc, argv, knowns, usage);
 
     // Get temperature as a double
     double temp = args.getValue<double>("temp");
+    int bootstrap = args.getValue<int>("bootstrap", false, 0);
+    int bootblock = args.getValue<int>("bootblock", false, 1);
+    unsigned long bootseed = args.getValue<unsigned long>("bootseed", false, 4711);
+    if (bootstrap < 0)
+      throw gromos::Exception("dfmult", "@bootstrap has to be 0 or larger");
+    if (bootblock < 1)
+      throw gromos::Exception("dfmult", "@bootblock has to be 1 or larger");
 
     // store all the time series for the error analysis (BIG!!)
     vector<gmath::Stat< double> > allexphxhr;
@@ -188,57 +244,81 @@ int main(int argc, char** argv) {
       
     } // end loop over end states
 
+    // the exponential averages and (co)variances of all end states in one
+    // pass over the frames
+    const unsigned int num_states = allexphxhr.size();
+    const int N = num_states ? allexphxhr[0].n() : 0;
+    for (unsigned int i = 1; i < num_states; i++) {
+      if (allexphxhr[i].n() != N)
+        throw gromos::Exception("dfmult", "Energy files of the end states differ in length!");
+    }
+    gmath::LogSumExp expave(num_states, false, true);
+    vector<double> frame(num_states);
+    for (int n = 0; n < N; n++) {
+      for (unsigned int i = 0; i < num_states; i++)
+        frame[i] = allexphxhr[i].val(n);
+      expave.add(&frame[0]);
+    }
+
+    // bootstrap errors of all free energy differences
+    const double kT = gmath::physConst.get_boltzmann_silent() * temp;
+    gmath::Bootstrap boot(bootstrap, bootblock, bootseed);
+    if (bootstrap) {
+      boot.addSeries(N);
+      boot.run(dfBootstrap(allexphxhr, kT));
+    }
+    unsigned int q = 0;
+
     //cout.setf(ios::fixed, ios::floatfield);
     cout.setf(ios::scientific, ios::floatfield);
     cout.precision(7);
-    cout << setw(36) << "#DF (kJ/mol)" << setw(18) << "err"  << endl;
+    cout << setw(36) << "#DF (kJ/mol)" << setw(18) << "err";
+    if (bootstrap) cout << setw(18) << "boot err";
+    cout << endl;
     // loop over all saved values and calculate free energy differences and uncertainties
-    for(unsigned int i=0;i<allexphxhr.size();i++) {
+    for(unsigned int i=0;i<num_states;i++) {
       //cout << "# i: " << i + 1 << endl;
-      // number of data points
-      int N = allexphxhr.at(i).n();
       // df
-      double df_ir = allexphxhr.at(i).lnexpave();
-      // variance
-      int sign_var_ii = 1;
-      double var_ii = gmath::Stat<double>::lnexpcovariance(allexphxhr.at(i), allexphxhr.at(i), sign_var_ii);
-      if(sign_var_ii < 0)
+      double df_ir = expave.lnexpave(i);
+      // relative variance Var(exp)/<exp>^2
+      double var_ii = expave.relvariance(i);
+      if(var_ii < 0)
         throw gromos::Exception("dfmult", "Got negative variance!");
       // statistical inefficiency
       double si_ii = gmath::Stat<double>::lnexp_stat_ineff(allexphxhr.at(i), allexphxhr.at(i));
       // error estimate contribution
-      double d2i = var_ii - log(double(N)) + si_ii;
+      double d2i = var_ii * exp(si_ii) / N;
       stringstream name;
       name << "DF_" << i + 1 << "_R";
       cout << setw(18) << name.str().c_str()
               << setw(18) << -gmath::physConst.get_boltzmann_silent() * temp * df_ir
-              << setw(18) << gmath::physConst.get_boltzmann_silent() * temp * sqrt(exp(d2i - 2 * df_ir)) << endl;
+              << setw(18) << gmath::physConst.get_boltzmann_silent() * temp * sqrt(d2i);
+      if (bootstrap) cout << setw(18) << boot.error(q);
+      cout << endl;
+      q++;
 
-      for(unsigned int j=(i+1);j<allexphxhr.size();j++){
+      for(unsigned int j=(i+1);j<num_states;j++){
 
         //cout << " # j: " << j + 1 << endl;
         // df
-        double df_jr = allexphxhr.at(j).lnexpave();
-        // variance
-        int sign_var_jj = 1;
-        double var_jj = gmath::Stat<double>::lnexpcovariance(allexphxhr.at(j), allexphxhr.at(j), sign_var_jj);
-        if(sign_var_jj < 0)
+        double df_jr = expave.lnexpave(j);
+        // relative variance
+        double var_jj = expave.relvariance(j);
+        if(var_jj < 0)
           throw gromos::Exception("dfmult","Got negative variance!");
         // statistical inefficiency
         double si_jj = gmath::Stat<double>::lnexp_stat_ineff(allexphxhr.at(j), allexphxhr.at(j));
         // error estimate contribution
-        double d2j = var_jj - log(double(N)) + si_jj;
+        double d2j = var_jj * exp(si_jj) / N;
 
         // df
-        double df_ji = allexphxhr.at(j).lnexpave() - allexphxhr.at(i).lnexpave();
-        // variance
-        int sign_var_ji = 1;
-        double var_ji = gmath::Stat<double>::lnexpcovariance(allexphxhr.at(j), allexphxhr.at(i), sign_var_ji);
+        double df_ji = df_jr - df_ir;
+        // relative covariance
+        double var_ji = expave.relcovariance(j, i);
         // statistical inefficiency
         double si_ji = gmath::Stat<double>::lnexp_stat_ineff(allexphxhr.at(j), allexphxhr.at(i));
         // Ensure that estimate of cross-uncertainty is reasonable (see Appendix).
-        double max_si_ji = log(sqrt(exp(si_ii + si_jj))
-                * abs(sqrt(exp(var_ii + var_jj - 2 * var_ji))) );
+        double max_si_ji = 0.5 * (si_ii + si_jj + log(var_ii * var_jj / (var_ji * var_ji)));
         // log is strictly monotone so < and > holds also for the logarithms
         if ((si_ji > max_si_ji) && (max_si_ji > log(1.0))) {
           cerr << "setting si_ji to max_si_ji" << endl;
@@ -246,16 +326,16 @@ int main(int argc, char** argv) {
         }
         
         // error estimate contribution
-        double djdi = var_ji - log(double(N)) + si_ji;
+        double djdi = var_ji * exp(si_ji) / N;
         stringstream name;
         name << "DF_" << j + 1 << "_" << i + 1;
         cout << setw(18) << name.str().c_str()
                 << setw(18) << -gmath::physConst.get_boltzmann_silent() * temp * df_ji
                 << setw(18) << gmath::physConst.get_boltzmann_silent() * temp *
-                               sqrt(exp(d2i - 2 * df_ir)
-                                  + exp(d2j - 2 * df_jr)
-                              - 2 * exp(djdi - (df_jr + df_ir)) * sign_var_ji)
-                << endl;
+                               sqrt(d2i + d2j - 2 * djdi);
+        if (bootstrap) cout << setw(18) << boot.error(q);
+        cout << endl;
+        q++;
       } // states j
     } // states i
 
@@ -54,6 +54,11 @@
  * It is strongly recommended that the user analyzes the shape of @f$\Delta(t)@f$ and perform the LSF considering 
  * only the region of linearity.
  *
+ * The mean square displacements are calculated for all time differences
+ * using fast Fourier transforms (gmath::MSD), which requires to keep all 
+ * frames in memory. With \@maxlag, only the displacements up to the given
+ * number of frames are calculated and only twice as many frames are kept.
+ *
  * 
  * <b>arguments:</b>
  * <table border=0 cellpadding=0>
@@ -62,6 +67,7 @@
  * <tr><td> [\@time</td><td>&lt;@ref utils::Time "time and dt"&gt;] </td></tr>
  * <tr><td> \@dim</td><td>&lt;dimensions to consider&gt; </td></tr>
  * <tr><td> \@atoms</td><td>&lt;@ref AtomSpecifier "atoms" to follow&gt; </td></tr>
+ * <tr><td> [\@maxlag</td><td>&lt;maximum time difference in frames&gt;] </td></tr>
  * <tr><td> \@traj</td><td>&lt;trajectory files&gt; </td></tr>
  * </table>
  *
@@ -74,6 +80,7 @@
     [@time  0 0.1]
     @dim   x y z
     @atoms s:OW
+    [@maxlag 1000]
     @traj  ex.tr
 
    @endverbatim
@@ -103,6 +110,7 @@
 #include "../src/utils/AtomSpecifier.h"
 #include "../src/utils/groTime.h"
 #include "../src/gmath/Stat.h"
+#include "../src/gmath/MSD.h"
 
 using namespace std;
 using namespace gcore;
@@ -142,7 +150,7 @@ int main(int argc, char **argv) {
 
   Argument_List knowns;
   knowns << "topo" << "pbc" << "time" << "dim" << "atoms"  
-         << "traj";
+         << "maxlag" << "traj";
 
   string usage = "# " + string(argv[0]);
   usage += "\n\t@topo   <molecular topology file>\n";
@@ -150,6 +158,7 @@ int main(int argc, char **argv) {
   usage += "\t[@time   <time and dt>]\n";
   usage += "\t@dim    <dimensions to consider>\n";
   usage += "\t@atoms  <atoms to follow>\n";
+  usage += "\t[@maxlag <maximum time difference in frames>]\n";
   usage += "\t@traj   <trajectory files>\n";
 
 
@@ -286,8 +295,15 @@ int main(int argc, char **argv) {
       throw gromos::Exception("diffus",
             "No atoms to calculate the diffusion for!");
 
+    // the maximum lag (0: all)
+    int maxlag = args.getValue<int>("maxlag", false, 0);
+    if (maxlag < 0)
+      throw gromos::Exception("diffus", "@maxlag must not be negative");
+
     int num_atm = at.size();
-    vector<vector<Vec> > position(num_atm);
+    MSD msd(num_atm, maxlag);
+    msd.setDimensions(vector<int>(dim, dim + ndim));
+    vector<Vec> position(num_atm);
     vector<double> times;
     
     // calculate the com of the reference state
@@ -326,7 +342,8 @@ int main(int argc, char **argv) {
            std::cerr <<  "ERROR: frame " << frames << ": number of solvents is not the same as in the reference\n";
            throw gromos::Exception("diffus", "number of solvents disagrees");
            }
-        times.push_back(time.time());
+        if (maxlag == 0 || int(times.size()) <= maxlag)
+          times.push_back(time.time());
         (*pbc.*gathmethod)();
         comx = Vec(0.0, 0.0, 0.0);
         Stat<double> disp_data;
@@ -334,9 +351,10 @@ int main(int argc, char **argv) {
 
         for(unsigned int i = 0; i < at.size(); i++) {
           at.pos(i) = pbc->nearestImage(old_at.pos(i), at.pos(i), sys.box());
-          position[ i ].push_back(at.pos(i));
+          position[i] = at.pos(i);
           old_at.pos(i) = at.pos(i);
         }
+        msd.add(position);
         comx /= at.size();
         frames++;
       }
@@ -348,35 +366,14 @@ int main(int argc, char **argv) {
 
     vector<double> output_x, output_y;
 
-    //int window=60;
-    for(int it = 0; it < frames; it++) {
-    //for(int it = 0; it < frames-window; it++) {
-      double sum = 0;
-      int counter = 0;
-      double square_d = 0;
-      for(int j = 0; j < frames - it; j++) {
-      //for(int j = it; j < it+window; j++) {
-        counter++;
-        //cout << "  j : " << j << "  it : " << it << endl;
-        for(unsigned int i = 0; i < at.size(); i++) {
-          square_d = 0;
-
-          for(int k = 0; k < ndim; k++) {
-            const double d = (position[i][j])[dim[k]]-(position[i][j + it])[dim[k]];
-            //const double d = (position[i][j])[dim[k]]-(position[i][it])[dim[k]];
-            square_d += d * d;
-          }
-
-          sum += square_d;
-        }
-      }
+    // the mean square displacements for all time differences
+    const vector<double> disp = msd.msd();
+    for(unsigned int it = 0; it < disp.size(); it++) {
       // now print out
       dp << times[it];
-      //const double disp = sum / counter / at.size() / ndim;
-      const double disp = sum / counter / at.size();
-      dp << setw(14) << disp;
+      dp << setw(14) << disp[it];
       dp << endl;
-      output_y.push_back(disp);
+      output_y.push_back(disp[it]);
       output_x.push_back(times[it]);
     }
 
@@ -51,11 +51,16 @@
  * specified through an input parameter. If a topology is supplied, the ene_ana 
  * uses this to define the total solute mass (MASS) and the total number of 
  * solute molecules (NUMMOL).
+ *
+ * Instead of the trajectory files, a binary cache written by @ref ene_cache
+ * can be given. Then, only the values that are needed for the selected
+ * properties are read.
  * 
  * <b>arguments:</b>
  * <table border=0 cellpadding=0>
  * <tr><td> \@en_files</td><td>&lt;energy files&gt; (and/or) </td></tr>
- * <tr><td> \@fr_files</td><td>&lt;free energy files&gt; </td></tr>
+ * <tr><td> \@fr_files</td><td>&lt;free energy files&gt; (or) </td></tr>
+ * <tr><td> \@cache</td><td>&lt;cache file written by @ref ene_cache&gt; </td></tr>
  * <tr><td> \@prop</td><td>&lt;"properties" to monitor&gt; </td></tr>
  * <tr><td> \@library</td><td>&lt;library for property names&gt; [print] </td></tr>
  * <tr><td> [\@topo</td><td>&lt;molecular topology file&gt; (for MASS and NUMMOL)] </td></tr>
@@ -97,6 +102,7 @@
 #include "../src/gmath/Stat.h"
 #include "../src/gmath/Physics.h"
 #include "../src/utils/EnergyTraj.h"
+#include "../src/utils/EnergyCache.h"
 #include "../src/gmath/Expression.h"
 
 using namespace std;
@@ -105,17 +111,24 @@ using namespace gio;
 using namespace gcore;
 
 void print(gmath::Stat<double> &p, string s, vector<double> & time);
+void add_values(utils::EnergyTraj &etrj,
+		vector<utils::EnergyIndex> const & prop_index,
+		vector<utils::EnergyIndex> const & leaves,
+		vector<vector<double> > & columns, unsigned int & nframes,
+		vector<gmath::Stat<double> > & s);
 void set_standards(utils::EnergyTraj &e);
 void read_library(string name, utils::EnergyTraj& e);
 
 int main(int argc, char **argv){
 
   Argument_List knowns; 
-  knowns << "topo" << "time" << "en_files" << "fr_files" << "prop" << "library";
+  knowns << "topo" << "time" << "en_files" << "fr_files" << "cache" << "prop"
+         << "library";
 
   string usage = "# " + string(argv[0]);
   usage += "\n\t@en_files    <energy files> (and/or)\n";
-  usage += "\t@fr_files    <free energy files>\n";
+  usage += "\t@fr_files    <free energy files> (or)\n";
+  usage += "\t@cache       <cache file written by ene_cache>\n";
   usage += "\t@prop        <properties to monitor>\n";
   usage += "\t@library     <library for property names> [print]\n";
   usage += "\t[@topo       <molecular topology file> (for MASS and NUMMOL)]\n";
@@ -143,8 +156,12 @@ int main(int argc, char **argv){
     }
 
     // check whether we are doing anything
-    if(args.count("en_files")<=0 && args.count("fr_files")<=0)
+    bool use_cache = (args.count("cache")>0);
+    if(args.count("en_files")<=0 && args.count("fr_files")<=0 && !use_cache)
       throw gromos::Exception("ene_ana", "no data specified:\n"+usage);
+    if(use_cache && (args.count("en_files")>0 || args.count("fr_files")>0))
+      throw gromos::Exception("ene_ana", "give either @cache or trajectory "
+			      "files:\n"+usage);
     if(args.count("prop") <=0)
       throw gromos::Exception("ene_ana", "no properties to follow:\n"+usage);
     
@@ -205,6 +222,42 @@ int main(int argc, char **argv){
     // prepare for the statistical information
     vector<gmath::Stat<double> > s(num_prop);
 
+    // resolve the property names once. Per frame, only the data elements
+    // the properties depend on are stored; the properties are calculated
+    // for a batch of frames at once
+    vector<utils::EnergyIndex> prop_index(num_prop);
+    vector<utils::EnergyIndex> leaves;
+    for(int i=0; i<num_prop; i++){
+      prop_index[i]=etrj.resolve(prop[i]);
+      etrj.leaves(prop_index[i], leaves);
+    }
+    utils::EnergyIndex time_index;
+    if(!usertime) time_index=etrj.resolve("TIME[2]");
+    const unsigned int batch=1024;
+    vector<vector<double> > columns(leaves.size());
+    for(unsigned int k=0; k<leaves.size(); k++) columns[k].reserve(batch);
+    unsigned int nframes=0;
+
+    if(use_cache){
+      // all frames at once, only the needed values are read
+      utils::EnergyCache cache(etrj);
+      cache.open(args["cache"]);
+      if(!usertime) etrj.leaves(time_index, leaves);
+      cache.columns(leaves, columns);
+      nframes=cache.numFrames();
+      if(usertime){
+	for(unsigned int f=0; f<nframes; f++){
+	  t0+=dt;
+	  time.push_back(t0);
+	}
+      }
+      else{
+	time.resize(nframes);
+	etrj.values(time_index, leaves, columns, time);
+      }
+      add_values(etrj, prop_index, leaves, columns, nframes, s);
+    }
+
     // define two input streams
     Ginstream gin_en;
     Ginstream gin_fr;
@@ -231,7 +284,7 @@ int main(int argc, char **argv){
     //cont=en_cont+fr_cont;
     
     bool version_checked = false;
-    while (true) {
+    while (!use_cache) {
       
       // version number
       if (!version_checked) {
@@ -355,15 +408,20 @@ int main(int argc, char **argv){
       }
       
       
-      // calculate and store the necessary number in the stat-classes
-      for(int i=0; i<num_prop; i++)
-	s[i].addval(etrj[prop[i]]);
+      // store the necessary numbers, the properties are calculated
+      // and added to the stat-classes once the batch is full
+      for(unsigned int k=0; k<leaves.size(); k++)
+	columns[k].push_back(etrj[leaves[k]]);
+      if(++nframes == batch)
+	add_values(etrj, prop_index, leaves, columns, nframes, s);
       if(usertime)
 	t0+=dt;
       else      
-	t0=etrj["TIME[2]"];
+	t0=etrj[time_index];
       time.push_back(t0);
     }
+    add_values(etrj, prop_index, leaves, columns, nframes, s);
+
     bool flag_error= false;
     for ( int i = 0; i < num_prop; i++ ) {
       if ( std::isnan(s[i].ee()) ){ 
@@ -398,6 +456,22 @@ int main(int argc, char **argv){
 
 
 
+void add_values(utils::EnergyTraj &etrj,
+		vector<utils::EnergyIndex> const & prop_index,
+		vector<utils::EnergyIndex> const & leaves,
+		vector<vector<double> > & columns, unsigned int & nframes,
+		vector<gmath::Stat<double> > & s)
+{
+  vector<double> res(nframes);
+  for(unsigned int i=0; i<prop_index.size(); i++){
+    etrj.values(prop_index[i], leaves, columns, res);
+    for(unsigned int f=0; f<nframes; f++)
+      s[i].addval(res[f]);
+  }
+  for(unsigned int k=0; k<columns.size(); k++) columns[k].clear();
+  nframes=0;
+}
+
 void print(gmath::Stat<double> &p, string s, vector<double>& time)
 {
   if(p.n()!=int(time.size())) 
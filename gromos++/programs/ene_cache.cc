@@ -0,0 +1,269 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ene_cache.cc
+ * converts (energy) trajectory files into a binary cache for ene_ana
+ */
+
+/**
+ * @page programs Program Documentation
+ *
+ * @anchor ene_cache
+ * @section ene_cache convert (energy) trajectories into a binary cache
+ * @date 16. 10. 2026
+ *
+ * Program ene_cache reads energy and/or free energy trajectories in the same
+ * way as @ref ene_ana and writes all values of every frame to a binary cache
+ * file (see utils::EnergyCache). In the cache, every element of the blocks
+ * defined in the library (e.g. ENER[3]) is stored as one contiguous array
+ * over all frames. Subsequent analyses with ene_ana \@cache only read the
+ * elements that are needed for the requested properties, instead of parsing
+ * the complete text files again.
+ *
+ * The cache can only be read with a library with the same ENERTRJ and
+ * FRENERTRJ block definitions; the VARIABLES may differ. The elements stored
+ * are the ones present in the first frame.
+ *
+ * <b>arguments:</b>
+ * <table border=0 cellpadding=0>
+ * <tr><td> \@en_files</td><td>&lt;energy files&gt; (and/or) </td></tr>
+ * <tr><td> \@fr_files</td><td>&lt;free energy files&gt; </td></tr>
+ * <tr><td> \@library</td><td>&lt;library for property names&gt; </td></tr>
+ * <tr><td> \@cache</td><td>&lt;cache file to write&gt; </td></tr>
+ * </table>
+ *
+ *
+ * Example:
+ * @verbatim
+  ene_cache
+    @en_files   ex.tre.gz
+    @fr_files   ex.trg.gz
+    @library    ene_ana.lib
+    @cache      ex.tre.cache
+
+   @endverbatim
+ *
+ * <hr>
+ */
+#include <cassert>
+#include <cstdlib>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../src/args/Arguments.h"
+#include "../src/gio/Ginstream.h"
+#include "../src/gmath/Physics.h"
+#include "../src/utils/EnergyTraj.h"
+#include "../src/utils/EnergyCache.h"
+
+using namespace std;
+using namespace args;
+using namespace gio;
+
+void set_standards(utils::EnergyTraj &e);
+void read_library(string name, utils::EnergyTraj& e);
+
+int main(int argc, char **argv){
+
+  Argument_List knowns; 
+  knowns << "en_files" << "fr_files" << "library" << "cache";
+
+  string usage = "# " + string(argv[0]);
+  usage += "\n\t@en_files    <energy files> (and/or)\n";
+  usage += "\t@fr_files    <free energy files>\n";
+  usage += "\t@library     <library for property names>\n";
+  usage += "\t@cache       <cache file to write>\n";
+
+  try{
+    Arguments args(argc, argv, knowns, usage);
+
+    if(args.count("en_files")<=0 && args.count("fr_files")<=0)
+      throw gromos::Exception("ene_cache", "no data specified:\n"+usage);
+    if(args.count("library") <=0)
+      throw gromos::Exception("ene_cache", "no library file specified:\n"+usage);
+    if(args.count("cache") <=0)
+      throw gromos::Exception("ene_cache", "no cache file specified:\n"+usage);
+
+    utils::EnergyTraj etrj;
+    etrj.addConstant("MASS", 0.0);
+    read_library(args["library"], etrj);
+
+    utils::EnergyCache cache(etrj);
+
+    Ginstream gin_en;
+    Ginstream gin_fr;
+    bool do_energy_files     =(args.count("en_files")>0);
+    bool do_free_energy_files=(args.count("fr_files")>0);
+    
+    Arguments::const_iterator it_en=args.lower_bound("en_files"),
+      to_en=args.upper_bound("en_files"),
+      it_fr=args.lower_bound("fr_files"),
+      to_fr=args.upper_bound("fr_files");
+    if(do_energy_files) {
+      gin_en.open(it_en->second.c_str()); 
+      ++it_en; 
+    }
+    if(do_free_energy_files) {
+      gin_fr.open(it_fr->second.c_str());
+      ++it_fr;
+    }
+
+    // read the frames as ene_ana does
+    while(true){
+      if(do_energy_files){
+	int end_of_file=etrj.read_frame(gin_en, "ENERTRJ");
+	if(end_of_file){
+	  if(it_en!=to_en){
+	    gin_en.close();
+	    gin_en.open(it_en->second.c_str());
+	    ++it_en;
+	    //try again...
+	    etrj.read_frame(gin_en, "ENERTRJ");
+	  }
+	  else break;
+	}
+      }
+      if(do_free_energy_files){
+	int end_of_file=etrj.read_frame(gin_fr, "FRENERTRJ");
+	if(end_of_file){
+	  if(it_fr!=to_fr){
+	    gin_fr.close();
+	    gin_fr.open(it_fr->second.c_str());
+	    ++it_fr;
+	    //try again...
+	    etrj.read_frame(gin_fr, "FRENERTRJ");
+	  }
+	  else break;
+	}
+      }
+      if(cache.numFrames() == 0)
+	cache.create(args["cache"]);
+      cache.add_frame();
+    }
+    if(cache.numFrames() == 0)
+      throw gromos::Exception("ene_cache", "no frames read");
+    cache.close();
+
+    cout << "# " << cache.numFrames() << " frames with " 
+	 << cache.numColumns() << " values each written to " 
+	 << args["cache"] << endl;
+  }
+  catch (const gromos::Exception &e){
+    cerr << e.what() << endl;
+    exit(1);
+  }
+  return 0;
+}
+
+void set_standards(utils::EnergyTraj &e)
+{  
+  e.addConstant("BOLTZ", gmath::physConst.get_boltzmann());
+}
+
+void read_library(string name, utils::EnergyTraj& e)
+{
+  Ginstream gin;
+  
+  try{
+    
+    gin.open(name);
+  }
+  catch (const gromos::Exception &ex){
+      throw gromos::Exception("read_library", "failed to open library file "
+			      +name);
+  }
+  while(true){
+    
+    vector<string> buffer;
+    gin.getblock(buffer);
+    if(gin.stream().eof()) break;
+    if(buffer[buffer.size()-1].find("END")!=0)
+      throw gromos::Exception("ene_ana", "Library file " + gin.name() +
+			      " is corrupted. No END in "+buffer[0]+
+			      " block. Got\n"
+			      + buffer[buffer.size()-1]);
+    string sdum;
+    
+    if(buffer[0]=="ENERTRJ" || buffer[0]=="FRENERTRJ"){
+      for(unsigned int i=1; i< buffer.size()-1; i++){
+	e.addBlock(buffer[i], buffer[0]);
+	
+      }
+    }
+    
+    if (buffer[0] == "ENEVERSION") {
+      // This is a ENEVERSION block that was not put directly after the
+      // TITLE block. This is no big deal for the library, it would
+      // however lead to an error in a trajectory.
+      // Shall we disallow this?
+      
+      // Just to make sure there are not two blocks
+      if (gin.has_version() || e.has_version()) {
+        throw gromos::Exception("ene_ana", "Library file " + gin.name() +
+            " is corrupted. Two ENEVERSION blocks found.");
+      }
+      string ver;
+      gio::concatenate(buffer.begin() + 1, buffer.end()-1, ver);
+      ver.erase( std::remove_if( ver.begin(), ver.end(), ::isspace ), ver.end() );
+      e.set_version(ver);
+    }
+
+    vector<string> data;
+    if(buffer[0]=="VARIABLES"){
+      
+      set_standards(e);
+      
+      string bufferstring;
+      
+      gio::concatenate(buffer.begin()+1, buffer.end(), bufferstring);
+      
+      istringstream iss(bufferstring);
+
+      // i am aware of the fact that END will also be stored in data.
+      // This is used in parsing later on
+      while(sdum!="END"){
+	iss >> sdum;
+	data.push_back(sdum);
+      }
+      
+      // now search for the first appearance of "="
+      for(unsigned int i=0; i< data.size(); i++){
+	if(data[i]=="="){
+	  
+	  // search for either the next appearance or the end
+	  unsigned int to=i+1;
+	  for(; to < data.size(); to++) if(data[to]=="=") break;
+	  
+	  // parse the expression part into an ostringstream
+	  ostringstream os;
+	  for(unsigned int j=i+1; j< to-1; j++) os << " " << data[j]; 
+	  e.addKnown(data[i-1], os.str());
+	}
+      }
+    }
+  }
+  if (gin.has_version()) {
+    e.set_version(gin.version());
+  }
+}
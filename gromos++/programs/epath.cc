@@ -140,6 +140,7 @@
 #include "../src/gcore/Box.h"
 #include "../src/utils/AtomSpecifier.h"
 #include "../src/utils/SimplePairlist.h"
+#include "../src/utils/CellList.h"
 #include "../src/gio/InTopology.h"
 #include "../src/gmath/Vec.h"
 #include "../src/utils/Neighbours.h"
@@ -566,6 +567,9 @@ int main(int argc, char **argv) {
                     cerr << "Calculating decay factors..." << endl;
                 }
 
+                // one cell list for the pairlists of this frame
+                const CellList cells(sys, *pbc, cutoff, false);
+
                 bool domore = true;
                 while (visited.size() != allatoms.size() && domore) {
                     ///////////////////
@@ -583,7 +587,7 @@ int main(int argc, char **argv) {
                     // set the starting point
                     around.setAtom(current.mol(0), current.atom(0));
                     around.setType("ATOMIC");
-                    around.calc();
+                    around.calc(cells);
 
                     Neighbours nb(sys, current.mol(0), current.atom(0));
                     // put the pairlist into the pair specifier
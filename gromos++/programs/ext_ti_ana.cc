@@ -102,7 +102,11 @@ END
  * Error estimates can be calculated using bootstrapping. A random set of data points 
  * of the size of the original set will be chosen and the predictions made. This is 
  * repeated for as many bootstrap replicates as requested. The standard deviation over
- * the bootstrap replicates is reported as a bootstrap error.
+ * the bootstrap replicates is reported as a bootstrap error. The same frames are 
+ * drawn for all predicted @f$\lambda@f$ values of a replicate. For correlated time 
+ * series, blocks of consecutive frames can be drawn (\@bootblock). The replicates
+ * are distributed over the threads (\@cpus) and are reproducible for a given seed 
+ * (\@bootseed).
  * 
  * The predicted TI curves from several simulations at different @f$\lambda@f$ values 
  * can be combined using @ref ext_ti_merge .
@@ -139,6 +143,8 @@ END
  * <tr><td> [\@pmin      </td><td>&lt;min index of prediction&gt;] </td></tr>
  * <tr><td> [\@pmax      </td><td>&lt;max index of prediction&gt;] </td></tr>
  * <tr><td> [\@bootstrap </td><td>&lt;no. of bootstraps&gt;] </td></tr>
+ * <tr><td> [\@bootblock </td><td>&lt;block length for the bootstrap, default: 1&gt;] </td></tr>
+ * <tr><td> [\@bootseed  </td><td>&lt;seed for the bootstrap, default: 4711&gt;] </td></tr>
  * <tr><td> [\@outdir    </td><td>&lt;directory to write output to&gt;] </td></tr>
  * <tr><td> [\@lam_precision</td><td> &lt;lambda value precision in outfiles, default: 2&gt;] </td></tr>
  * <tr><td> [\@bar_data   </td><td>&lt;print energies to be used for BAR (not reweighted)&gt;] </td></tr>
@@ -207,6 +213,8 @@ END
 #include "../src/gcore/MoleculeTopology.h"
 #include "../src/gcore/AtomTopology.h"
 #include "../src/gmath/Stat.h"
+#include "../src/gmath/LogSumExp.h"
+#include "../src/gmath/Bootstrap.h"
 #include "../src/gmath/Physics.h"
 #include "../src/utils/EnergyTraj.h"
 #include "../src/gmath/Expression.h"
@@ -271,6 +279,38 @@ int dir_exists(const char *path);
 
 std::map<std::string, vector<double> > read_lambdas(std::vector<ilambdas::lambint> &lambints, std::vector<std::string>  &lambdas_types);
 
+// the predicted dH/dl of all plam from resampled frames
+class tiBootstrap : public gmath::Bootstrap::Estimator {
+  vector<const vector<double> *> d_x, d_vyvr;
+public:
+  tiBootstrap(const vector<gmath::Stat<double> > &x, const vector<gmath::Stat<double> > &vyvr) {
+    for (unsigned int p = 0; p < x.size(); p++) {
+      d_x.push_back(&x[p].data());
+      d_vyvr.push_back(&vyvr[p].data());
+    }
+  }
+
+  unsigned int size()const { return d_x.size(); }
+
+  void estimate(const vector<vector<unsigned int> > &index, double *res)const {
+    const unsigned int nr_plam = d_x.size();
+    gmath::LogSumExp expvyvr(nr_plam, true);
+    vector<double> vyvr_frame(nr_plam), x_frame(nr_plam);
+    for (unsigned int n = 0; n < index[0].size(); n++) {
+      for (unsigned int p = 0; p < nr_plam; p++) {
+        vyvr_frame[p] = (*d_vyvr[p])[index[0][n]];
+        x_frame[p] = (*d_x[p])[index[0][n]];
+      }
+      expvyvr.add(&vyvr_frame[0], &x_frame[0]);
+    }
+    for (unsigned int p = 0; p < nr_plam; p++) {
+      int sign = 0;
+      double lnXexpave = expvyvr.lnXexpave(p, sign);
+      res[p] = exp(lnXexpave - expvyvr.lnexpave(p)) * sign;
+    }
+  }
+};
+
 int main(int argc, char **argv){
   
   Argument_List knowns; 
@@ -281,7 +321,7 @@ int main(int argc, char **argv){
          << "lamslj_sim" << "lamlj_sim" << "lamscrf_sim" << "lamcrf_sim" << "lamkin_sim" 
          << "lambond_sim" << "lamang_sim" << "lamimpr_sim" << "lamdih_sim" << "lamdisres_sim" << "lamdihres_sim" << "lamdisfld_sim" // Betty
          << "no_lj" << "no_crf" << "no_kin" << "no_bond" << "no_ang" << "no_dih" << "no_disres" << "no_dihres" << "no_disfld" // Betty
-         << "no_impr" << "pmin" << "pmax" << "bootstrap" << "countframes" << "lam_precision" << "verbose" 
+         << "no_impr" << "pmin" << "pmax" << "bootstrap" << "bootblock" << "bootseed" << "countframes" << "lam_precision" << "verbose" 
          << "cpus" << "bar_data" << "dHdl_data";
 
   string usage = "# " + string(argv[0]);
@@ -310,6 +350,8 @@ int main(int argc, char **argv){
   usage += "\t[@pmin          <min index of prediction>]\n";
   usage += "\t[@pmax          <max index of prediction>]\n";
   usage += "\t[@bootstrap     <no. of bootstraps>]\n";
+  usage += "\t[@bootblock     <block length for the bootstrap, default: 1>]\n";
+  usage += "\t[@bootseed      <seed for the bootstrap, default: 4711>]\n";
   usage += "\t[@outdir        <directory to write output to>]\n";
   usage += "\t[@cpus           <number of threads> Default: 1]\n";
   usage += "\t[@lam_precision <lambda value precision in outfiles, default: 2>]\n";
@@ -348,6 +390,12 @@ int main(int argc, char **argv){
     if(args.count("verbose")>=0) verbose = true;
 
     int bootstrap = args.getValue<int>("bootstrap",false, 0);
+    int bootblock = args.getValue<int>("bootblock",false, 1);
+    unsigned long bootseed = args.getValue<unsigned long>("bootseed",false, 4711);
+    if (bootstrap < 0)
+      throw gromos::Exception("ext_ti_ana", "@bootstrap has to be 0 or larger");
+    if (bootblock < 1)
+      throw gromos::Exception("ext_ti_ana", "@bootblock has to be 1 or larger");
     // do we calculate error estimates?
     bool no_error=true;
     if(bootstrap) no_error = false;
@@ -629,8 +677,14 @@ int main(int argc, char **argv){
     // declare some vectors which we will need later
     vector<vector<vector<gmath::Stat<double> > > > x( num_slj, vector<vector<gmath::Stat<double> > > (num_scrf, vector<gmath::Stat<double> > (nr_plam)));
     vector<vector<vector<gmath::Stat<double> > > > vyvr( num_slj, vector<vector<gmath::Stat<double> > > (num_scrf, vector<gmath::Stat<double> > (nr_plam)));
-    vector<vector<vector<gmath::Stat<double> > > > expvyvr( num_slj, vector<vector<gmath::Stat<double> > > (num_scrf, vector<gmath::Stat<double> > (nr_plam)));
-    vector<vector<vector<gmath::Stat<double> > > > Xexpvyvr( num_slj, vector<vector<gmath::Stat<double> > > (num_scrf, vector<gmath::Stat<double> > (nr_plam)));
+    // the time series are only needed for the bootstrap and the number of
+    // contributing frames
+    bool store_series = bootstrap || countframes;
+    // the exponential averages of all plam, one sample per frame
+    vector<vector<gmath::LogSumExp> > expvyvr( num_slj, vector<gmath::LogSumExp> (num_scrf, gmath::LogSumExp(nr_plam, true)));
+    // the exponents and dH/dl of the current frame
+    vector<vector<vector<double> > > vyvr_frame( num_slj, vector<vector<double> > (num_scrf, vector<double> (nr_plam)));
+    vector<vector<vector<double> > > x_frame( num_slj, vector<vector<double> > (num_scrf, vector<double> (nr_plam)));
 
     // for BAR we need the reference energy and the energies at the other lambda values
     int nr_bar_lam=0;
@@ -864,11 +918,12 @@ int main(int argc, char **argv){
 
           // prepare for reweighting
           double diff = -(Emult-E_s)/(gmath::physConst.get_boltzmann() * temp);
-          x[i][j][p-pmin].addval(dEmult);
-          double expdiff = exp(diff);
-          vyvr[i][j][p-pmin].addval(diff);
-          expvyvr[i][j][p-pmin].addval(expdiff);
-          Xexpvyvr[i][j][p-pmin].addval(dEmult * expdiff);
+          vyvr_frame[i][j][p-pmin] = diff;
+          x_frame[i][j][p-pmin] = dEmult;
+          if(store_series){
+            x[i][j][p-pmin].addval(dEmult);
+            vyvr[i][j][p-pmin].addval(diff);
+          }
 
 	  if(bar_data) {
 	    if(bar_lam.size()==0) E_bar[i][j][p-pmin].addval(Emult);
@@ -890,8 +945,47 @@ int main(int argc, char **argv){
           }
         }//i
       }//p
+
+      // all plam at once
+      for(unsigned int i=0; i<SLJ.size(); i++)
+        for(unsigned int j=0; j<SCRF.size(); j++)
+          expvyvr[i][j].add(&vyvr_frame[i][j][0], &x_frame[i][j][0]);
     }//frames    
         
+    #ifdef OMP
+        if ((int)num_cpus > omp_get_max_threads()){
+            cerr << "# You specified " << num_cpus << " number of threads. There are only " 
+                 << omp_get_max_threads() << " threads available." << endl;
+            num_cpus = omp_get_max_threads();
+        } 
+        omp_set_num_threads(num_cpus); //set the number of cpus for the bootstrap
+    #else
+        if(num_cpus != 1)
+            throw gromos::Exception("hbond","@cpus: Your compilation does not support multiple threads. Use --enable-openmp for compilation.\n\n" + usage);
+    #endif
+
+    // bootstrap errors of all plam, the bootstrap samples are distributed
+    // over the threads
+    vector<vector<vector<double> > > boot_err( num_slj, vector<vector<double> > (num_scrf, vector<double> (nr_plam)));
+    #ifdef OMP
+    double bootstrap_time=0;
+    double start_boot = omp_get_wtime();
+    #endif
+    if(bootstrap){
+        for(unsigned int i=0; i<SLJ.size(); i++){ 
+            for(unsigned int j=0; j<SCRF.size(); j++){
+                gmath::Bootstrap boot(bootstrap, bootblock, bootseed + i * SCRF.size() + j);
+                boot.addSeries(x[i][j][0].n());
+                boot.run(tiBootstrap(x[i][j], vyvr[i][j]));
+                for(int p=0; p<nr_plam; p++)
+                    boot_err[i][j][p] = boot.error(p);
+            }
+        }
+    }
+    #ifdef OMP
+    bootstrap_time = omp_get_wtime() - start_boot;
+    #endif
+
     #ifdef OMP
         if (num_cpus > SLJ.size()){
             if(int(SLJ.size()) > omp_get_max_threads())
@@ -901,25 +995,13 @@ int main(int argc, char **argv){
             cerr << "# Number of threads > number of trajectory files: not feasible. Corrected to " 
                  << num_cpus << " threads." << endl;
         }
-
-        if ((int)num_cpus > omp_get_max_threads()){
-            cerr << "# You specified " << num_cpus << " number of threads. There are only " 
-                 << omp_get_max_threads() << " threads available." << endl;
-            num_cpus = omp_get_max_threads();
-        } 
         omp_set_num_threads(num_cpus); //set the number of cpus for the parallel section
         if (num_cpus > 1)  cerr << "# Number of threads: " << num_cpus << endl;
-    #else
-        if(num_cpus != 1)
-            throw gromos::Exception("hbond","@cpus: Your compilation does not support multiple threads. Use --enable-openmp for compilation.\n\n" + usage);
     #endif
 
-    //initialize random number generator for bootstraps
-    int ti = time(NULL);
     #ifdef OMP
     double totaltime=0;
-    double bootstrap_time=0;
-    #pragma omp parallel for reduction(+:totaltime,bootstrap_time) //firstprivate(sys, time) 
+    #pragma omp parallel for reduction(+:totaltime) //firstprivate(sys, time) 
     #endif
     // loop over all trajectories
     for(unsigned int i=0; i<SLJ.size(); i++){ 
@@ -931,8 +1013,6 @@ int main(int argc, char **argv){
         double start_tot = omp_get_wtime();
         #endif
 
-        unsigned int seed=ti+i;
-      
         abcde["slj"] = SLJ_abcde[i];
         for(unsigned int j=0; j<SCRF.size(); j++){
             abcde["scrf"] = SCRF_abcde[j];
@@ -1050,43 +1130,14 @@ int main(int argc, char **argv){
         
                 // calculate the final value
                 int sign = 0;
-                double lnXexpave = gmath::Stat<double>::lnXexpave(x[i][j][p], vyvr[i][j][p], sign);
-                double lnexpave = vyvr[i][j][p].lnexpave();
+                double lnXexpave = expvyvr[i][j].lnXexpave(p, sign);
+                double lnexpave = expvyvr[i][j].lnexpave(p);
                 double final = exp(lnXexpave - lnexpave) * sign;
                 oss << " " << setw(15) << final;
 
-                // calculate statistical uncertainty if required
-                if(bootstrap) {
-                    #ifdef OMP
-                    double start_int=omp_get_wtime();
-                    #endif
-                    int length = x[i][j][p].n();
-                    gmath::Stat<double> final_boot;
-                    for(int ii=0;ii<bootstrap;ii++){
-                        gmath::Stat<double> x_new;
-                        gmath::Stat<double> vyvr_new;
-
-                        for(int jj=0;jj<length;jj++){
-                            double r;
-                            #ifdef OMP
-                            #pragma omp critical
-                            #endif
-                            r=rand_r(&seed);
-                            int index = int((r*length)/RAND_MAX);
-                            x_new.addval(x[i][j][p].val(index));
-                            vyvr_new.addval(vyvr[i][j][p].val(index));
-                        }
-                        double lnXexpave = gmath::Stat<double>::lnXexpave(x_new, vyvr_new, sign);
-                        double lnexpave = vyvr_new.lnexpave();
-                        final_boot.addval(exp(lnXexpave - lnexpave) * sign);
-                    }
-                    double boot_std = sqrt(gmath::Stat<double>::covariance(final_boot,final_boot));
-                    oss << " " << setw(15) << boot_std;
-                    
-                    #ifdef OMP
-                    bootstrap_time += omp_get_wtime()-start_int;
-                    #endif
-                }
+                // statistical uncertainty if required
+                if(bootstrap)
+                    oss << " " << setw(15) << boot_err[i][j][p];
             
                 // count nr of contributing frames if required
                 if(countframes){
@@ -1119,7 +1170,8 @@ int main(int argc, char **argv){
     #ifdef OMP
     cout.precision(2);
     //cout << "# Preparation time: " << prep_time << " s" << endl;
-    //cout << "# Total calc time: " << bootstrap_time << " s" << endl;
+    if(bootstrap)
+      cout << "# Bootstrap time: \t" << bootstrap_time << " s" << endl;
     cout << "# Total CPU time: \t" << totaltime << " s" << endl;
     cout << "### Total real time: \t"<< omp_get_wtime()-start_total << " s" << endl;
     #endif
@@ -54,6 +54,7 @@
  * <tr><td> [\@stride</td><td>&lt;write every nth frame (default: 1)&gt;] </td></tr>
  * <tr><td> \@outformat</td><td>&lt;@ref args::OutformatParser "output coordinates format"&gt; </td></tr>
  * <tr><td> \@traj</td><td>&lt;input trajectory file(s)&gt; </td></tr>
+ * <tr><td> [\@outfile</td><td>&lt;output file (default: standard output, compressed if it ends in .gz)&gt;] </td></tr>
  * </table>
  *
  *
@@ -91,6 +92,7 @@
 #include "../src/args/OutformatParser.h"
 #include "../src/gio/InG96.h"
 #include "../src/gio/OutG96.h"
+#include "../src/gio/OutFile.h"
 #include "../src/bound/Boundary.h"
 #include "../src/gcore/System.h"
 #include "../src/gcore/Molecule.h"
@@ -103,6 +105,7 @@
 #include "../src/gcore/Box.h"
 #include "../src/utils/AtomSpecifier.h"
 #include "../src/utils/SimplePairlist.h"
+#include "../src/utils/CellList.h"
 #include "../src/gio/InTopology.h"
 #include "../src/gmath/Vec.h"
 #include "../src/utils/groTime.h"
@@ -117,7 +120,8 @@ int main(int argc, char **argv) {
 
   Argument_List knowns;
   knowns << "topo" << "pbc" << "traj" << "cutoff" << "atoms" << "select"
-         << "reject" << "pairlist" << "outformat" << "stride" << "notimeblock" << "time";
+         << "reject" << "pairlist" << "outformat" << "stride" << "notimeblock" << "time"
+         << "outfile";
 
   string usage = "# " + string(argv[0]);
   usage += "\n\t@topo       <molecular topology file>\n";
@@ -132,6 +136,7 @@ int main(int argc, char **argv) {
   usage += "\t[@time      <time and dt>]\n"; 
   usage += "\t[@stride <write every nth frame> (default: 1)]\n"; 
   usage += "\t@traj       <input trajectory files>\n";
+  usage += "\t[@outfile  <output file>]\n";
 
 
   try {
@@ -220,7 +225,9 @@ int main(int argc, char **argv) {
     // parse outformat
     string ext;
     OutCoordinates & oc = *OutformatParser::parse(args, ext);
-    oc.open(cout);
+    // output to a file (block gzip compressed if the name ends in .gz)
+    ostream *os = openOutput(args);
+    oc.open(*os);
 
     std::ostringstream title;
 
@@ -282,24 +289,27 @@ int main(int argc, char **argv) {
           utils::AtomSpecifier rls = ls;
 
           // add all atoms that need to be added according to the 
-          // distances to reference atoms
+          // distances to reference atoms, searched in one cell list
+          if (ref.size()) {
+            const utils::CellList cells(sys, *pbc, cut, t == "CHARGEGROUP");
 #ifdef OMP
 #pragma omp parallel for 
 #endif
-          for (unsigned int i = 0; i < ref.size(); i++) {
-            utils::SimplePairlist spl(sys, *pbc, cut);
-            spl.setAtom(*ref.atom()[i]);
-            spl.setType(t);
-            spl.calc();
+            for (unsigned int i = 0; i < ref.size(); i++) {
+              utils::SimplePairlist spl(sys, *pbc, cut);
+              spl.setAtom(ref, i);
+              spl.setType(t);
+              spl.calc(cells);
 
-            if ((*ref.atom()[i]).type() != utils::spec_virtual) {
-              spl.addAtom(ref.mol(i), ref.atom(i));
-            }
+              if (ref.type(i) != utils::spec_virtual) {
+                spl.addAtom(ref.mol(i), ref.atom(i));
+              }
 #ifdef OMP
 #pragma omp critical 
 #endif
-            {
-              rls = rls + spl;
+              {
+                rls = rls + spl;
+              }
             }
           }
 
@@ -315,6 +325,8 @@ int main(int argc, char **argv) {
       }
       ic.close();
     }
+    oc.close();
+    if (os != &cout) delete os;
   }  catch (const gromos::Exception &e) {
     cerr << e.what() << endl;
     exit(1);
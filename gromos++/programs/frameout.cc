@@ -321,9 +321,36 @@ int main(int argc, char **argv) {
     for (Arguments::const_iterator iter = args.lower_bound("traj");
             iter != args.upper_bound("traj"); ++iter) {
       ic.open(iter->second);
+      // frames in the previous trajectories
+      const int firstFrame = numFrames;
+      // jump to the requested frames using the frame index (unless the
+      // time has to be calculated from every frame). If the file cannot
+      // be indexed (e.g. a stream), the frames are read one by one.
+      bool seek = spec == "SPEC" && (notimeblock || time.read());
+      int trajFrames = 0;
+      if (seek) {
+        try {
+          trajFrames = ic.numFrames();
+        } catch (const gromos::Exception &e) {
+          seek = false;
+        }
+      }
       // loop over all frames
 
       while (!ic.eof()) {
+        if (seek) {
+          int next = -1;
+          for (unsigned int j = 0; j < fnum.size(); ++j) {
+            if (fnum[j] > numFrames && (next < 0 || fnum[j] < next))
+              next = fnum[j];
+          }
+          if (next < 0 || next - firstFrame > trajFrames) {
+            numFrames = firstFrame + trajFrames;
+            break;
+          }
+          ic.seekFrame(next - firstFrame - 1);
+          numFrames = next - 1;
+        }
         numFrames++;
         ic.select(inc);
         if (!notimeblock) {
@@ -41,6 +41,7 @@
  * <tr><td> \@topo</td><td>&lt;molecular topology file&gt; </td></tr>
  * <tr><td> \@pbc</td><td>&lt;boundary type&gt; &lt;gather method&gt; </td></tr>
  * <tr><td> \@traj</td><td>&lt;trajectory files&gt; </td></tr>
+ * <tr><td> [\@outfile</td><td>&lt;output file (default: standard output, compressed if it ends in .gz)&gt;] </td></tr>
  * </table>
  *
  *
@@ -62,6 +63,7 @@
 #include "../src/args/GatherParser.h"
 #include "../src/gio/InG96.h"
 #include "../src/gio/OutG96.h"
+#include "../src/gio/OutFile.h"
 #include "../src/gcore/System.h"
 #include "../src/gcore/Molecule.h"
 #include "../src/gcore/LJException.h"
@@ -86,12 +88,13 @@ using namespace args;
 int main(int argc, char **argv){
 
   Argument_List knowns; 
-  knowns << "topo" << "pbc" << "traj";
+  knowns << "topo" << "pbc" << "traj" << "outfile";
 
   string usage = argv[0];
   usage += "\n\t@topo <topology>\n";
   usage += "\t@pbc <boundary type>\n";
   usage += "\t@traj <trajectory files>\n";
+  usage += "\t[@outfile <output file>]\n";
  
   try{
     Arguments args(argc, argv, knowns, usage);
@@ -114,7 +117,9 @@ int main(int argc, char **argv){
     // output
     OutCoordinates *oc;
     oc = new OutG96();
-    oc->open(cout);  
+    // output to a file (block gzip compressed if the name ends in .gz)
+    ostream *os = openOutput(args);
+    oc->open(*os);
     oc->writeTitle("gathered trajectory");
 
     // loop over all trajectories
@@ -137,6 +142,7 @@ int main(int argc, char **argv){
       ic.close();
       oc->close();
     }
+    if (os != &cout) delete os;
   }
   catch (const gromos::Exception &e){
     cerr << e.what() << endl;
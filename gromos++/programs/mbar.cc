@@ -0,0 +1,316 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file mbar.cc
+ * Compute free energies of multiple states using the multistate Bennett
+ * acceptance ratio (MBAR)
+ */
+
+/**
+ * @page programs Program Documentation
+ *
+ * @anchor mbar
+ * @section mbar Compute free energies of multiple states using the multistate Bennett acceptance ratio (MBAR)
+ * @date 16. 10. 2026
+ *
+ * Program mbar calculates the free energies of all states of a set of 
+ * simulations at different @f$\lambda@f$ values using the multistate 
+ * Bennett acceptance ratio [Shirts and Chodera, J. Chem. Phys. 129 (2008)
+ * 124105]. Unlike @ref bar, which only uses the energies of the neighbouring
+ * states, all samples of all simulations are combined. The dimensionless 
+ * free energies @f$f_k = G_k / k_B T@f$ are the solution of
+ *
+ * @f[ e^{-f_k} = \sum_{n=1}^{N} \frac{e^{-E_k(x_n)/k_B T}}
+ *            {\sum_l N_l e^{f_l - E_l(x_n)/k_B T}} @f]
+ *
+ * with the sum running over the samples of all simulations. The equations 
+ * are solved by minimising a convex function, either with Newton's method
+ * (the default) or with L-BFGS (\@method lbfgs), which avoids the 
+ * @f$K \times K@f$ Hessian for many states. The iterations stop when the
+ * largest gradient relative to the number of samples of a state is smaller 
+ * than \@tolerance. The sums over the samples are distributed over the 
+ * OpenMP threads. The statistical errors are calculated from the asymptotic
+ * covariance matrix of the free energies (see gmath::MBAR). They do not 
+ * account for correlation between subsequent samples.
+ *
+ * The energies are read from one file per simulated state, as written by
+ * program @ref ext_ti_ana with option \@bar_data, and every file has to 
+ * contain the energies at all lambda values that are included. Lambda 
+ * values which were not simulated, but for which energies were predicted 
+ * in all files, are included as unsampled states; other predicted lambda 
+ * values are ignored.
+ *
+ * The free energy of every state relative to the first one is written out,
+ * followed by the free energy differences between neighbouring states and 
+ * the total free energy difference.
+ *
+ * <b>arguments:</b>
+ * <table border=0 cellpadding=0>
+ * <tr><td> \@files</td><td>&lt;data files (@ref ext_ti_ana output)&gt; </td></tr>
+ * <tr><td> \@temp</td><td>&lt;temperature&gt; </td></tr>
+ * <tr><td> [\@method</td><td>&lt;newton or lbfgs (default: newton)&gt;] </td></tr>
+ * <tr><td> [\@tolerance</td><td>&lt;relative gradient for convergence (default: 1E-10)&gt;] </td></tr>
+ * <tr><td> [\@maxiterations</td><td>&lt;maximum number of iterations (default: 1000)&gt;] </td></tr>
+ * </table>
+ * 
+ * Example:
+ * @verbatim
+  mbar
+    @files           bar_data_0.0.dat bar_data_0.20.dat bar_data_0.40.dat
+    @temp            300
+    @method          newton
+    @tolerance       1E-10
+    @maxiterations   1000
+ @endverbatim
+ *
+ * <hr>
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "../src/args/Arguments.h"
+#include "../src/gmath/MBAR.h"
+#include "../src/gmath/Physics.h"
+
+using namespace args;
+using namespace std;
+
+// the contents of a data file: the energies at the simulated and the 
+// predicted lambda values, one row per data point
+struct mbarData
+{
+  double slam;
+  std::vector<double> plam;
+  std::vector<double> E;
+};
+
+// reads the next line which is not a comment, returns false at the end
+bool next_line(std::istream &is, std::string &line) {
+  while (getline(is, line)) {
+    std::string::size_type first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') continue;
+    return true;
+  }
+  return false;
+}
+
+// the column of a lambda value in a data file, -1 if not present
+int column(const mbarData &d, double lam) {
+  const double eps = 1e-6;
+  if (fabs(d.slam - lam) < eps) return 0;
+  for (unsigned int m = 0; m < d.plam.size(); m++) {
+    if (fabs(d.plam[m] - lam) < eps) return m + 1;
+  }
+  return -1;
+}
+
+// the index of a lambda value in a list, -1 if not present
+int find(const std::vector<double> &lam, double l) {
+  for (unsigned int k = 0; k < lam.size(); k++) {
+    if (fabs(lam[k] - l) < 1e-6) return k;
+  }
+  return -1;
+}
+
+int main(int argc, char **argv) {
+
+  Argument_List knowns;
+  knowns << "files" << "temp" << "method" << "tolerance" << "maxiterations";
+
+  string usage = "# " + string(argv[0]);
+  usage += "\n\t@files            <data files (ext_ti_ana bar_data output)>\n";
+  usage += "\t@temp             <temperature>\n";
+  usage += "\t[@method          <newton or lbfgs (default: newton)>]\n";
+  usage += "\t[@tolerance       <relative gradient for convergence (default: 1E-10)>]\n";
+  usage += "\t[@maxiterations   <maximum number of iterations (default: 1000)>]\n";
+
+  try {
+    Arguments args(argc, argv, knowns, usage);
+
+    double temp = args.getValue<double>("temp", true, 300);
+    double tolerance = args.getValue<double>("tolerance", false, 1E-10);
+    int max_iter = args.getValue<int>("maxiterations", false, 1000);
+    double kBT = gmath::physConst.get_boltzmann() * temp;
+
+    gmath::MBAR::method_enum method = gmath::MBAR::newton;
+    if (args.count("method") > 0) {
+      if (args["method"] == "lbfgs")
+        method = gmath::MBAR::lbfgs;
+      else if (args["method"] != "newton")
+        throw gromos::Exception(argv[0], "unknown method '" + args["method"] +
+              "', use newton or lbfgs");
+    }
+
+    if (args.count("files") <= 0)
+      throw gromos::Exception(argv[0], "No data files given!\n" + usage);
+
+    // read all data files
+    std::vector<mbarData> data;
+    for (Arguments::const_iterator
+      iter = args.lower_bound("files"),
+            to = args.upper_bound("files");
+            iter != to; ++iter) {
+
+      ifstream file(iter->second.c_str());
+      if (!file.is_open())
+        throw gromos::Exception(argv[0], "Could not open file '" + iter->second + "'");
+
+      mbarData d;
+      string line;
+      int nr_bar_lam = 0;
+      istringstream linestream;
+      if (next_line(file, line)) {
+        linestream.str(line);
+        linestream >> nr_bar_lam;
+      }
+      if (!next_line(file, line) || linestream.fail() || nr_bar_lam < 0)
+        throw gromos::Exception(argv[0], "failed to read number of predicted lambda values in " + iter->second);
+      linestream.clear();
+      linestream.str(line);
+      linestream >> d.slam;
+      d.plam.resize(nr_bar_lam);
+      for (int i = 0; i < nr_bar_lam; i++)
+        linestream >> d.plam[i];
+      if (linestream.fail())
+        throw gromos::Exception(argv[0], "failed to read slam and or plam values in " + iter->second);
+
+      const unsigned int cols = nr_bar_lam + 1;
+      std::vector<double> row(cols);
+      while (next_line(file, line)) {
+        linestream.clear();
+        linestream.str(line);
+        for (unsigned int c = 0; c < cols; c++)
+          linestream >> row[c];
+        if (linestream.fail())
+          throw gromos::Exception(argv[0], "failed to read E_s and or E_p values in " + iter->second);
+        d.E.insert(d.E.end(), row.begin(), row.end());
+      }
+      std::cerr << "read file " << iter->second << " with " << nr_bar_lam
+              << " plam values and " << d.E.size() / cols << " data_points" << endl;
+      data.push_back(d);
+    }
+
+    // the states: all simulated lambda values and the predicted ones which
+    // are present in all files
+    std::vector<double> lam;
+    std::vector<double> candidates;
+    for (unsigned int i = 0; i < data.size(); i++) {
+      if (find(lam, data[i].slam) < 0) lam.push_back(data[i].slam);
+      candidates.insert(candidates.end(), data[i].plam.begin(), data[i].plam.end());
+    }
+    for (unsigned int i = 0; i < data.size(); i++) {
+      for (unsigned int k = 0; k < lam.size(); k++) {
+        if (column(data[i], lam[k]) < 0) {
+          stringstream ss;
+          ss << "Could not find data for lambda = " << lam[k]
+                  << " in data file for slam = " << data[i].slam;
+          throw gromos::Exception(argv[0], ss.str());
+        }
+      }
+    }
+    for (unsigned int c = 0; c < candidates.size(); c++) {
+      if (find(lam, candidates[c]) >= 0) continue;
+      bool everywhere = true;
+      for (unsigned int i = 0; i < data.size() && everywhere; i++)
+        everywhere = column(data[i], candidates[c]) >= 0;
+      if (everywhere) lam.push_back(candidates[c]);
+    }
+    std::sort(lam.begin(), lam.end());
+    const unsigned int K = lam.size();
+    if (K < 2)
+      throw gromos::Exception(argv[0], "At least two lambda values required!");
+
+    // the reduced potentials of all samples at all states
+    gmath::MBAR mbar(K);
+    std::vector<double> u(K);
+    std::vector<int> col(K);
+    for (unsigned int i = 0; i < data.size(); i++) {
+      const unsigned int cols = data[i].plam.size() + 1;
+      const unsigned int from = find(lam, data[i].slam);
+      for (unsigned int k = 0; k < K; k++)
+        col[k] = column(data[i], lam[k]);
+      for (unsigned int n = 0; n < data[i].E.size(); n += cols) {
+        for (unsigned int k = 0; k < K; k++)
+          u[k] = data[i].E[n + col[k]] / kBT;
+        mbar.add(from, &u[0]);
+      }
+      // the energies are not needed anymore
+      std::vector<double>().swap(data[i].E);
+    }
+
+    const int iterations = mbar.solve(method, tolerance, max_iter);
+    if (iterations < 0)
+      std::cerr << "WARNING: no convergence after " << -iterations
+            << " iterations" << endl;
+    else
+      std::cerr << "converged after " << iterations << " iterations" << endl;
+
+    std::cout << "#"
+            << setw(7) << "lam"
+            << setw(10) << "N"
+            << setw(15) << "G"
+            << setw(15) << "ee"
+            << endl;
+    for (unsigned int k = 0; k < K; k++) {
+      std::cout << setw(8) << fixed << setprecision(3) << lam[k]
+              << setw(10) << mbar.samples(k)
+              << setw(15) << setprecision(5) << mbar.f(k) * kBT
+              << " +/- "
+              << setw(10) << setprecision(5) << mbar.error(0, k) * kBT
+              << endl;
+    }
+
+    std::cout << endl
+            << "#"
+            << setw(7) << "lam_i"
+            << setw(8) << "lam_j"
+            << setw(15) << "DG"
+            << setw(15) << "ee"
+            << endl;
+    for (unsigned int k = 0; k + 1 < K; k++) {
+      std::cout << setw(8) << fixed << setprecision(3) << lam[k]
+              << setw(8) << fixed << setprecision(3) << lam[k + 1]
+              << setw(15) << setprecision(5) << (mbar.f(k + 1) - mbar.f(k)) * kBT
+              << " +/- "
+              << setw(10) << setprecision(5) << mbar.error(k, k + 1) * kBT
+              << endl;
+    }
+    std::cout << endl
+            << "# total"
+            << setw(24) << setprecision(5) << mbar.f(K - 1) * kBT
+            << " +/- "
+            << setw(10) << setprecision(5) << mbar.error(0, K - 1) * kBT
+            << endl;
+
+  } catch (const gromos::Exception &e) {
+    cerr << e.what() << endl;
+    exit(1);
+  }
+  return 0;
+}
@@ -54,7 +54,9 @@
  * The boundary type of the read systems is read from the GENBOX block of the
  * trajectory files.
  *
- * This program is parallelised.
+ * This program is parallelised. By default the centre atoms of a frame are
+ * distributed over the threads; with \@parallelframes several frames are
+ * analysed at the same time instead, which is faster for few centre atoms.
  *
  * <b>arguments:</b>
  * <table border=0 cellpadding=0>
@@ -65,6 +67,7 @@
  * <tr><td> \@grid</td><td>&lt;number of points&gt; </td></tr>
  * <tr><td> [\@nointra</td><td>&lt;skip all intramolecular contributions&gt;] </td></tr>
  * <tr><td> [\@doDCF</td><td>&lt;calculate the dipole-dipole correlations&gt;] </td></tr>
+ * <tr><td> [\@parallelframes</td><td>&lt;analyse several frames in parallel&gt;] </td></tr>
  * <tr><td> \@traj</td><td>&lt;trajectory files&gt; </td></tr>
  * </table>
  *
@@ -103,7 +106,8 @@ int main(int argc, char **argv) {
 
   Argument_List knowns;
   knowns << "topo" << "centre" << "with"
-          << "cut" << "grid" << "nointra" << "traj" << "pbc" << "doDCF";
+          << "cut" << "grid" << "nointra" << "traj" << "pbc" << "doDCF"
+          << "parallelframes";
 
   string usage = "# " + string(argv[0]);
   usage += "\n\t@topo   <molecular topology file>\n";
@@ -114,6 +118,7 @@ int main(int argc, char **argv) {
   usage += "\t@grid   <number of points>\n";
   usage += "\t[@nointra   <skip intramolecular atoms>]\n";
   usage += "\t[@doDCF     <compute dipole-dipole correlation> <norm>]\n";
+  usage += "\t[@parallelframes <analyse several frames in parallel>]\n";
   usage += "\t@traj   <trajectory files>";
 
 
@@ -162,6 +167,9 @@ int main(int argc, char **argv) {
     bool nointra = false;
     if (args.count("nointra") >= 0) nointra = true;
 
+    // analyse several frames at the same time
+    if (args.count("parallelframes") >= 0) Rdf.setParallelFrames(true);
+
     // calculate the rdf
     if(nointra) {
       Rdf.calculateInter();
@@ -55,6 +55,11 @@
  * written out.
  * When calculating averages and distributions special care is taken
  * in order to avoid overflow (see Comput. Phys. Comm. 2003, 153, 397-406).
+ * Optionally, a bootstrap error of @f$\langle X \rangle_Y@f$ is calculated from
+ * the indicated number of random samples of the time series (\@bootstrap),
+ * optionally in blocks of consecutive values (\@bootblock). It is written after
+ * the error estimate. The samples are distributed over the OpenMP threads and
+ * are reproducible for a given seed (\@bootseed).
  *
  * <b>arguments:</b>
  * <table border=0 cellpadding=0>
@@ -63,6 +68,9 @@
  * <tr><td>  \@vr</td><td>&lt;energy time series of state R&gt; </td></tr>
  * <tr><td>  \@vy</td><td>&lt;energy time series of state Y&gt; </td></tr>
  * <tr><td> [\@bounds</td><td>&lt;lower bound&gt; &lt;upper bound&gt; &lt;grid points&gt;] </td></tr>
+ * <tr><td> [\@bootstrap</td><td>&lt;number of bootstrap estimates (default: 0)&gt;] </td></tr>
+ * <tr><td> [\@bootblock</td><td>&lt;block length for the bootstrap (default: 1)&gt;] </td></tr>
+ * <tr><td> [\@bootseed</td><td>&lt;seed for the bootstrap (default: 4711)&gt;] </td></tr>
  * </table>
  *
  * Example:
@@ -87,6 +95,8 @@
 
 #include "../src/args/Arguments.h"
 #include "../src/gmath/WDistribution.h"
+#include "../src/gmath/LogSumExp.h"
+#include "../src/gmath/Bootstrap.h"
 #include "../src/gmath/Expression.h"
 #include "../src/gmath/Physics.h"
 
@@ -95,11 +105,35 @@ using namespace args;
 
 gmath::Stat<double> read_data(string name, Arguments &args);
 
+// <X>_Y from resampled time series
+class reweightBootstrap : public gmath::Bootstrap::Estimator {
+  const vector<double> &d_x, &d_vr, &d_vy;
+  double d_kT;
+public:
+  reweightBootstrap(const vector<double> &x, const vector<double> &vr,
+          const vector<double> &vy, double kT) :
+  d_x(x), d_vr(vr), d_vy(vy), d_kT(kT) {}
+
+  unsigned int size()const { return 1; }
+
+  void estimate(const vector<vector<unsigned int> > &index, double *res)const {
+    gmath::LogSumExp expvyvr(1, true);
+    for (unsigned int n = 0; n < index[0].size(); n++) {
+      const unsigned int i = index[0][n];
+      expvyvr.add(-(d_vy[i] - d_vr[i]) / d_kT, d_x[i]);
+    }
+    int sign = 0;
+    double lnXexpave = expvyvr.lnXexpave(0, sign);
+    res[0] = exp(lnXexpave - expvyvr.lnexpave()) * sign;
+  }
+};
+
 int main(int argc, char** argv) {
   
   Argument_List knowns;
 
-  knowns << "temp" << "x" << "vr" << "vy" << "bounds";
+  knowns << "temp" << "x" << "vr" << "vy" << "bounds" << "bootstrap"
+          << "bootblock" << "bootseed";
 
   string usage = "# " + string(argv[0]);
   usage += "\n\t@temp     <temperature for perturbation>\n";
@@ -107,6 +141,9 @@ int main(int argc, char** argv) {
   usage +=   "\t@vr       <energy time series of state R>\n";
   usage +=   "\t@vy       <energy time series of state Y>\n";
   usage +=   "\t[@bounds  <lower bound> <upper bound> <grid points>]\n";
+  usage +=   "\t[@bootstrap <number of bootstrap estimates (default: 0)>]\n";
+  usage +=   "\t[@bootblock <block length for the bootstrap (default: 1)>]\n";
+  usage +=   "\t[@bootseed  <seed for the bootstrap (default: 4711)>]\n";
  
   try {
     
@@ -122,6 +159,14 @@ int main(int argc, char** argv) {
     double dist_upper = bounds[1];
     int dist_grid = int(bounds[2]);
 
+    int bootstrap = args.getValue<int>("bootstrap", false, 0);
+    int bootblock = args.getValue<int>("bootblock", false, 1);
+    unsigned long bootseed = args.getValue<unsigned long>("bootseed", false, 4711);
+    if (bootstrap < 0)
+      throw gromos::Exception("reweight", "@bootstrap has to be 0 or larger");
+    if (bootblock < 1)
+      throw gromos::Exception("reweight", "@bootblock has to be 1 or larger");
+
     // read the time series
     bool has_x = false;
     gmath::Stat<double> x;
@@ -136,57 +181,62 @@ int main(int argc, char** argv) {
     if ( x.n()!=vr.n() || x.n()!=vr.n()  )
       throw gromos::Exception("reweight", "Time series files differ in length!\n");
 
-    // save -beta(V_Y - V_R)
-    gmath::Stat<double> vyvr;
-    gmath::Stat<double> Xexpvyvr;
-    gmath::Stat<double> expvyvr;
+    // the averages of exp[-beta(V_Y - V_R)] with and without X
+    gmath::LogSumExp expvyvr(1, true);
     // create a distribution (with weights != 1)
     gmath::WDistribution xexpvyvr(dist_lower,dist_upper,dist_grid);
+    const double kT = gmath::physConst.get_boltzmann() * temp;
      
     /* loop over data that has been read in.
      * If speed turns out to be an issue this can be done
      * also on the fly when reading in the data
      */
     for (int i = 0; i < vr.n(); i++) {
-      double diff = -(vy.data()[i] - vr.data()[i]) / (gmath::physConst.get_boltzmann() * temp);
-      vyvr.addval(diff);
-      expvyvr.addval(exp(diff));
-      Xexpvyvr.addval(x.data()[i] * exp(diff));
+      double diff = -(vy.data()[i] - vr.data()[i]) / kT;
+      expvyvr.add(diff, x.data()[i]);
       if (has_x)
         xexpvyvr.add(x.data()[i],diff);
     }
-    
-    if (has_x)
-    
 
     cout.precision(10);
     // Calculate ln{|<X*exp[-beta(V_Y - V_R)]>_R|}
     int sign = 0;
-    double lnXexpave = gmath::Stat<double>::lnXexpave(x, vyvr, sign);
-    double lnexpave = vyvr.lnexpave();
-    double dii = exp(2 * lnXexpave);
-    double djj = exp(2 * lnexpave);
-    double dji = exp(lnXexpave + lnexpave);
+    double lnXexpave = expvyvr.lnXexpave(0, sign);
+    double lnexpave = expvyvr.lnexpave();
+
+    // the statistical inefficiencies do not depend on the scale, so the 
+    // exponentials are taken relative to the average
+    gmath::Stat<double> Xexpvyvr;
+    gmath::Stat<double> expvyvr_rel;
+    for (int i = 0; i < vr.n(); i++) {
+      double w = exp(-(vy.data()[i] - vr.data()[i]) / kT - lnexpave);
+      expvyvr_rel.addval(w);
+      Xexpvyvr.addval(x.data()[i] * w);
+    }
     
     // calculate statistical uncertainty
     double n = 1.0 / vr.n();
-    double var_ii = gmath::Stat<double>::covariance(Xexpvyvr, Xexpvyvr);
     double si_ii = gmath::Stat<double>::stat_ineff(Xexpvyvr, Xexpvyvr);
-    double d2i = var_ii * si_ii * n;
-    double var_jj = gmath::Stat<double>::covariance(expvyvr, expvyvr);
-    double si_jj = gmath::Stat<double>::stat_ineff(expvyvr, expvyvr);
-    double d2j = var_jj * si_jj * n;
-    double var_ji = gmath::Stat<double>::covariance(Xexpvyvr, expvyvr);
-    double si_ji = gmath::Stat<double>::stat_ineff(Xexpvyvr, expvyvr);
-    double d2ji = var_ji * si_ji * n;
-    double error = sqrt( d2i/dii + d2j/djj - 2*d2ji/dji );
+    double d2i = expvyvr.relXvariance() * si_ii * n;
+    double si_jj = gmath::Stat<double>::stat_ineff(expvyvr_rel, expvyvr_rel);
+    double d2j = expvyvr.relvariance() * si_jj * n;
+    double si_ji = gmath::Stat<double>::stat_ineff(Xexpvyvr, expvyvr_rel);
+    double d2ji = expvyvr.relXcovariance() * sign * si_ji * n;
+    double error = sqrt( d2i + d2j - 2*d2ji );
     
     cout << "# ln{|<X*exp[-beta(V_Y - V_R)]>_R|} = " << lnXexpave << endl;
     cout << "# sign = " << sign << endl;
     // Calculate ln{<exp[-beta(V_Y - V_R)]>_R}
     cout << "# ln{<exp[-beta(V_Y - V_R)]>_R} = " << lnexpave << endl;
     // <X>_Y
-    cout << "# <X>_Y = " << exp(lnXexpave - lnexpave) * sign << setw(18) << error << endl;
+    cout << "# <X>_Y = " << exp(lnXexpave - lnexpave) * sign << setw(18) << error;
+    if (bootstrap) {
+      gmath::Bootstrap boot(bootstrap, bootblock, bootseed);
+      boot.addSeries(vr.n());
+      boot.run(reweightBootstrap(x.data(), vr.data(), vy.data(), kT));
+      cout << setw(18) << boot.error(0);
+    }
+    cout << endl;
 
     // Write out a distribution if the @bounds flag is given
     if (args.count("bounds") >= 0) {
@@ -80,7 +80,7 @@
 #include "../src/args/Arguments.h"
 #include "../src/args/BoundaryParser.h"
 #include "../src/args/GatherParser.h"
-#include "../src/gio/InG96.h"
+#include "../src/gio/InG96Prefetch.h"
 #include "../src/gcore/System.h"
 #include "../src/gcore/Molecule.h"
 #include "../src/gcore/LJException.h"
@@ -152,53 +152,44 @@ int main(int argc, char **argv){
     bool massweighted = false;
     if(args.count("massweighted") >=0) massweighted = true;
     
-    // define input coordinate
-    InG96 ic;
+    // define input coordinate, the frames are read ahead while the radius 
+    // of gyration is calculated
+    InG96Prefetch ip(sys, time);
+    ip.open(args.getValues<string>("traj", args.count("traj")));
 
-    // loop over all trajectories
-    for(Arguments::const_iterator 
-	  iter=args.lower_bound("traj"),
-	  to=args.upper_bound("traj");
-	iter!=to; ++iter){
-      
-      // open file
-      ic.open((iter->second).c_str());
-      
-      // loop over single trajectory
-      while(!ic.eof()){
-	ic >> sys >> time;
-	(*pbc.*gathmethod)();
-	
-	//calculate cm, rgyr
-	Vec cm(0.0,0.0,0.0);
-	for (unsigned int i=0;i < atom.size(); i++) {
-	  cm += atom.pos(i) * atom.mass(i);
-	}
-	cm /= totalMass;
-	
-	double rg=0; 
+    // loop over all frames
+    while(!ip.eof()){
+      ip >> sys >> time;
+      (*pbc.*gathmethod)();
 
-	if(massweighted) {
-	  for(unsigned int i=0; i < atom.size(); ++i){
-	    rg += atom.mass(i)*(atom.pos(i) - cm).abs2();
-	  }
-	  rg = sqrt(rg/totalMass);
-	}
-	else {
-	  for (unsigned int i=0;i < atom.size(); i++) {
-	    // should we correct for periodicity?
-	    // Only if atom contains different molecules.
-	    // But then cm would be wrong already. The user should just use 
-	    // gathermethod cog.
-	    rg += (atom.pos(i)-cm).abs2();
-	  }              
-	  rg = sqrt(rg/(atom.size()));
+      //calculate cm, rgyr
+      Vec cm(0.0,0.0,0.0);
+      for (unsigned int i=0;i < atom.size(); i++) {
+	cm += atom.pos(i) * atom.mass(i);
+      }
+      cm /= totalMass;
+
+      double rg=0; 
+
+      if(massweighted) {
+	for(unsigned int i=0; i < atom.size(); ++i){
+	  rg += atom.mass(i)*(atom.pos(i) - cm).abs2();
 	}
-	
-	cout << time;
-	cout << setw(15) << rg << "\n";
+	rg = sqrt(rg/totalMass);
+      }
+      else {
+	for (unsigned int i=0;i < atom.size(); i++) {
+	  // should we correct for periodicity?
+	  // Only if atom contains different molecules.
+	  // But then cm would be wrong already. The user should just use 
+	  // gathermethod cog.
+	  rg += (atom.pos(i)-cm).abs2();
+	}              
+	rg = sqrt(rg/(atom.size()));
       }
-      ic.close();
+
+      cout << time;
+      cout << setw(15) << rg << "\n";
     }
   }
   
@@ -53,6 +53,8 @@
  * <tr><td> [\@ref</td><td>&lt;reference coordinates (if absent, the first frame of \@traj is reference)&gt;] </td></tr>
  * <tr><td> [\@printatoms</td><td>print list of selected atoms] </td></tr>
  * <tr><td> \@traj</td><td>&lt;trajectory files&gt; </td></tr>
+ * <tr><td> [\@skip</td><td>&lt;skip n first frames&gt;] </td></tr>
+ * <tr><td> [\@stride</td><td>&lt;take every n-th frame&gt;] </td></tr>
  * </table>
  *
  *
@@ -107,6 +109,7 @@
 #include "../src/utils/PropertyContainer.h"
 #include "../src/gmath/Matrix.h"
 #include "../src/fit/FastRotationalFit.h"
+#include "../src/utils/FrameLoop.h"
 
 
 using namespace gcore;
@@ -118,24 +121,129 @@ using namespace fit;
 using namespace std;
 using namespace gmath;
 
-double rmsdproperty(const utils::PropertyContainer &prop_ref, 
-                             const utils::PropertyContainer &prop_sys ){
+/**
+ * fits a frame (on a copy of the system) and calculates the rmsd of the
+ * atoms and the properties, which are printed in the order of the frames
+ */
+class RmsdTask : public FrameTask {
+  const Arguments &d_args;
+  const AtomSpecifier &d_fitatomsref, &d_rmsdatomsref;
+  AtomSpecifier d_fitatoms, d_rmsdatoms;
+  PropertyContainer &d_prop_ref, &d_prop_master;
+  const std::string &d_spec;
+  PropertyContainer *d_prop_sys;
+  FastRotationalFit d_frf;
+  // centred positions, kept to reuse their memory
+  std::vector<gmath::Vec> d_fitref, d_fitsys, d_rmsdref, d_rmsdsys;
+  double d_r;
+public:
+  RmsdTask(const Arguments &args, 
+          const AtomSpecifier &fitatomsref, const AtomSpecifier &fitatoms,
+          const AtomSpecifier &rmsdatomsref, const AtomSpecifier &rmsdatoms,
+          PropertyContainer &prop_ref, PropertyContainer &prop_sys,
+          const std::string &spec) :
+  d_args(args), d_fitatomsref(fitatomsref), d_rmsdatomsref(rmsdatomsref),
+  d_fitatoms(fitatoms), d_rmsdatoms(rmsdatoms), d_prop_ref(prop_ref),
+  d_prop_master(prop_sys), d_spec(spec), d_prop_sys(NULL), d_r(0.0) {
+  }
+  ~RmsdTask() {
+    delete d_prop_sys;
+  }
+  FrameTask *clone(System &sys, Boundary *pbc) {
+    RmsdTask *t = new RmsdTask(*this);
+    t->d_fitatoms.setSystem(sys);
+    t->d_rmsdatoms.setSystem(sys);
+    t->d_prop_sys = new PropertyContainer(sys, pbc);
+    t->d_prop_sys->addSpecifier(d_spec);
+    // only the values are collected, the statistics are kept by the master
+    t->d_prop_sys->setStore(false);
+    return t;
+  }
+  void analyse(System &sys, const utils::Time &time) {
+    if(!sys.hasPos)
+      throw gromos::Exception("rmsd",
+                             "Unable to read POSITION(RED) block from "
+                              "trajectory file.");
+    Matrix rot(3,3,0.0);
+    for(int i=0;i<3;++i){ // initialize as identity matrix
+      rot(i,i)=1.0;
+    }
 
-  double rmsd2=0;
+    // using FastRotationalFit::fit and rmsd methods
+    // they take position vectors as input
+    // shift to cog before rotational fit
+    Vec cogfitref (0,0,0);
+    Vec cogfitsys (0,0,0);
+    if (d_fitatomsref.size()){
+      for(unsigned int i=0;i<d_fitatomsref.size();++i) {
+        cogfitref+=d_fitatomsref.pos(i);
+        cogfitsys+=d_fitatoms.pos(i);
+      }
+      cogfitref/=d_fitatomsref.size();
+      cogfitsys/=d_fitatomsref.size();
+    }
+        
+    d_fitref.clear();
+    d_fitsys.clear();
+    d_rmsdref.clear();
+    d_rmsdsys.clear();
+    if (d_fitatomsref.size()){
+      for(unsigned int i=0;i<d_fitatomsref.size();++i) {
+        d_fitref.push_back(d_fitatomsref.pos(i)-cogfitref);
+        d_fitsys.push_back(d_fitatoms.pos(i)-cogfitsys);
+      }
+      for(unsigned int i=0;i<d_rmsdatomsref.size();++i) {
+        d_rmsdref.push_back(d_rmsdatomsref.pos(i)-cogfitref);
+        d_rmsdsys.push_back(d_rmsdatoms.pos(i)-cogfitsys);
+      }
+      d_frf.fit(rot, d_fitref, d_fitsys);
+    }
 
-  for(unsigned int i=0; i < prop_ref.size(); i++){
-    
-    utils::Value res = abs2(prop_ref[i]->calc() - prop_sys[i]->calc());
-    rmsd2 += res.scalar();
+    d_r = d_frf.rmsd(rot, d_rmsdref, d_rmsdsys);
+    d_prop_sys->calc();
   }
+  void collect(const utils::Time &time) {
+    // the properties of the program keep track of the previous frame 
+    // (e.g. continuous torsions)
+    d_prop_master.collect(*d_prop_sys);
+    double rprop = rmsdproperty(d_prop_ref, d_prop_master);
+
+    if (d_args.count("atomsrmsd") > 0 && d_args.count("prop") > 0) {
+      cout.precision(2);
+      cout << time;
+      cout.precision(9);
+      cout << setw(15) << d_r  << setw(15) << rprop << endl;
+    } else if(d_args.count("atomsrmsd") > 0){
+      cout.precision(2);
+      cout << time;
+      cout.precision(5);
+      cout << setw(10) << d_r  << endl;
+    } else if(d_args.count("prop") > 0){
+      cout.precision(2);
+      cout << time;
+      cout.precision(9);
+      cout << setw(15) << rprop << endl;
+    }
+  }
+private:
+  // the properties of the system are calculated already
+  static double rmsdproperty(utils::PropertyContainer &prop_ref, 
+          const utils::PropertyContainer &prop_sys) {
+    double rmsd2=0;
+
+    for(unsigned int i=0; i < prop_ref.size(); i++){
+      utils::Value res = abs2(prop_ref[i]->calc() - prop_sys[i]->getValue());
+      rmsd2 += res.scalar();
+    }
   
-  return utils::sqrt(rmsd2/prop_ref.size());
-}
+    return utils::sqrt(rmsd2/prop_ref.size());
+  }
+};
 
 int main(int argc, char **argv){
   Argument_List knowns; 
   knowns << "topo" << "traj" << "atomsfit" << "atomsrmsd" << "prop" << "pbc" << "ref"
-         << "time"  << "reftopo" << "refpbc" << "printatoms";
+         << "time"  << "reftopo" << "refpbc" << "printatoms" << "skip" << "stride";
 
   string usage = "# " + string(argv[0]);
   usage += "\n\t@topo       <molecular topology file>\n";
@@ -149,6 +257,8 @@ int main(int argc, char **argv){
   usage += "\t[@ref        <reference coordinates (if absent, the first frame of @traj is reference)>]\n";
   usage += "\t[@printatoms     < print list of selected atoms >]\n";
   usage += "\t@traj       <trajectory files>\n";
+  usage += "\t[@skip       <skip n first frames>]\n";
+  usage += "\t[@stride     <take every n-th frame>]\n";
 
 
   // prepare output
@@ -288,8 +398,8 @@ int main(int argc, char **argv){
     // Property container also for reference system
      PropertyContainer prop_ref(refSys, refpbc);
      PropertyContainer prop_sys(sys, pbc);
+    std::string prop;
     {
-      std::string prop;
       Arguments::const_iterator iter=args.lower_bound("prop");
       Arguments::const_iterator to=args.upper_bound("prop");
       // we read in all properties specified by the user
@@ -304,87 +414,15 @@ int main(int argc, char **argv){
     }
 
 
-   FastRotationalFit frf;
    if(args.count("atomsrmsd") < 0 && args.count("prop") < 0){
     throw gromos::Exception("rmsd", "No rmsd atoms or property specified!");}
 
-    int numFrames = 0;
-
-   
-    // loop over all trajectories
-    for(Arguments::const_iterator iter=args.lower_bound("traj");
-	iter!=args.upper_bound("traj"); ++iter){
-      ic.open(iter->second);
-      
-      // loop over all frames
-      while(!ic.eof()){
-        Matrix rot(3,3,0.0);
-        for(int i=0;i<3;++i){ // initialize as identity matrix
-          rot(i,i)=1.0;
-        }
-          
-          numFrames++;
-          ic.select("ALL");
-	      ic >> sys >> time;
-        if(!sys.hasPos)
-          throw gromos::Exception("rmsd",
-                             "Unable to read POSITION(RED) block from "
-                              "trajectory file.");
-	
-	    (*pbc.*gathmethod)();
-
-        // using FastRotationalFit::fit and rmsd methods
-        // they take position vectors as input
-        // shift to cog before rotational fit
-        Vec cogfitref (0,0,0);
-        Vec cogfitsys (0,0,0);
-        if (fitatomsref.size()){
-          for(unsigned int i=0;i<fitatomsref.size();++i) {
-            cogfitref+=fitatomsref.pos(i);
-            cogfitsys+=fitatoms.pos(i);
-          }
-          cogfitref/=fitatomsref.size();
-          cogfitsys/=fitatomsref.size();
-        }
-        
-        std::vector<gmath::Vec> fitref;
-        std::vector<gmath::Vec> fitsys;
-        std::vector<gmath::Vec> rmsdref;
-        std::vector<gmath::Vec> rmsdsys;
-        if (fitatomsref.size()){
-          for(unsigned int i=0;i<fitatomsref.size();++i) {
-            fitref.push_back(fitatomsref.pos(i)-cogfitref);
-            fitsys.push_back(fitatoms.pos(i)-cogfitsys);
-          }
-          for(unsigned int i=0;i<rmsdatomsref.size();++i) {
-            rmsdref.push_back(rmsdatomsref.pos(i)-cogfitref);
-            rmsdsys.push_back(rmsdatoms.pos(i)-cogfitsys);
-          }
-          frf.fit(rot, fitref, fitsys);
-        }
-
-        double r = frf.rmsd(rot, rmsdref, rmsdsys);
-        double rprop = rmsdproperty(prop_ref, prop_sys);
-
-        if (args.count("atomsrmsd") > 0 && args.count("prop") > 0) {
-          cout.precision(2);
-          cout << time;
-          cout.precision(9);
-          cout << setw(15) << r  << setw(15) << rprop << endl;
-        } else if(args.count("atomsrmsd") > 0){
-          cout.precision(2);
-          cout << time;
-          cout.precision(5);
-          cout << setw(10) << r  << endl;
-        } else if(args.count("prop") > 0){
-          cout.precision(2);
-          cout << time;
-          cout.precision(9);
-          cout << setw(15) << rprop << endl;
-        }
-      }
-      ic.close();
-    }
+    // loop over all trajectories, the frames are fitted in parallel
+    FrameLoop loop(args, sys, pbc, gathmethod, time);
+    loop.select("ALL");
+    RmsdTask task(args, fitatomsref, fitatoms, rmsdatomsref, rmsdatoms,
+            prop_ref, prop_sys, prop);
+    loop.run(task);
 
     //if (rf != NULL) {
      // delete rf->getReference();
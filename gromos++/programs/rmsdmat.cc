@@ -66,6 +66,21 @@
  * 
  * If argument \@dist is specified the distribution of rmsd values is printed to a file.
  *
+ * The pairs are calculated in parallel if the program is compiled with
+ * OpenMP. If only the small rmsds are of interest, e.g. for a clustering
+ * with program @ref cluster, a \@cutoff can be given. Pairs of structures
+ * that are certainly further apart, based on the difference of their radii
+ * of gyration, are then skipped. All rmsds above the cutoff are written as
+ * the largest value of the format (65535 for unsigned short, 4294967295
+ * otherwise) and are not included in the distribution.
+ *
+ * With \@sparse only the pairs within the cutoff are written to RMSDMAT.bin,
+ * in the sparse format of gio::NeighbourMatrix, which program @ref cluster
+ * recognises. If \@sparse rmsd is given, their rmsds are stored as well,
+ * such that the matrix can be clustered with smaller cutoffs, too. The
+ * sparse matrix grows with the number of neighbours rather than with the
+ * square of the number of structures.
+ *
  * <B>arguments:</b>
  * <table border=0 cellpadding=0>
  * <tr><td> \@topo</td><td>&lt;molecular topology file&gt; </td></tr>
@@ -79,6 +94,8 @@
  * <tr><td> [\@human</td><td>(write the matrix in human readable form)] </td></tr>
  * <tr><td> [\@precision</td><td>&lt;number of digits in the matrix (default 4)&gt;] </td></tr>
  * <tr><td> [\@dist</td><td>&lt;binsize for distribution histogram (default:0.02)&gt;]</td></tr>
+ * <tr><td> [\@cutoff</td><td>&lt;only store rmsds up to this value&gt;]</td></tr>
+ * <tr><td> [\@sparse</td><td>[rmsd] (only write the pairs within the cutoff (with their rmsd))]</td></tr>
  * <tr><td> [\@ref</td><td>&lt;reference coordinates&gt;] </td></tr>
  * <tr><td> [\@printatoms</td><td>print list of selected atoms] </td></tr>
  * <tr><td> \@traj</td><td>&lt;trajectory files&gt; </td></tr>
@@ -127,6 +144,8 @@
 #include "../src/utils/Value.h"
 #include "../src/utils/AtomSpecifier.h"
 #include "../src/fit/FastRotationalFit.h"
+#include "../src/fit/PairwiseRmsd.h"
+#include "../src/gio/NeighbourMatrix.h"
 
 using namespace std;
 using namespace gmath;
@@ -151,6 +170,30 @@ double props_rmsd(const vector<vector<Value> > &props, int i, int j) {
   return std::sqrt(rmsd / props[i].size());
 }
 
+// number of matrix elements that are calculated before they are written
+const size_t block_size = 1 << 22;
+
+// rmsds of the rows begin <= i < end of the upper triangle of the matrix
+void rmsd_rows(const PairwiseRmsd &pairs, const vector<vector<Value> > &props,
+        int begin, int end, double cutoff, vector<double> &values) {
+  if (props.empty()) {
+    pairs.rows(begin, end, cutoff, values);
+    return;
+  }
+  const int num = props.size();
+  vector<size_t> offset(end - begin + 1, 0);
+  for (int i = begin; i < end; ++i)
+    offset[i - begin + 1] = offset[i - begin] + (num - 1 - i);
+  values.resize(offset.back());
+#ifdef OMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = begin; i < end; ++i) {
+    for (int j = i + 1; j < num; ++j)
+      values[offset[i - begin] + j - i - 1] = props_rmsd(props, i, j);
+  }
+}
+
 void update_bins(map<int, int > & bins, double bin_size, double x) {
   int i = std::floor(x / bin_size);
   if ( bins.find(i) == bins.end() ) {
@@ -229,7 +272,7 @@ int main(int argc, char **argv) {
   Argument_List knowns;
   knowns << "topo" << "traj" << "pbc" << "ref" << "atomsrmsd" << "atomsfit"
             << "skip" << "stride" << "human" << "precision" << "prop" 
-            << "reftopo" << "dist" << "printatoms";
+            << "reftopo" << "dist" << "printatoms" << "cutoff" << "sparse";
 
   string usage = "# " + string(argv[0]);
   usage += "\n\t@topo         <molecular topology file(s), one for each trajectory group>\n";
@@ -245,6 +288,9 @@ int main(int argc, char **argv) {
   usage += "\t[@precision   <number of digits in the matrix (default 4)>]\n";
   usage += "\t[@ref         <reference coordinates>]\n";
   usage += "\t[@dist        < binsize(default:0.02) >]\n";
+  usage += "\t[@cutoff      <only store rmsds up to this value>]\n";
+  usage += "\t[@sparse      [rmsd] (only write the pairs within the cutoff\n";
+  usage += "\t              (with their rmsd))]\n";
   usage += "\t[@printatoms  < print list of selected atoms >]\n";
   usage += "\t@traj         <groups of trajectory files, separated by keyword 'newgroup'>\n";
 
@@ -257,6 +303,26 @@ int main(int argc, char **argv) {
     
     int skip = args.getValue<int>("skip", false, 0);
     int stride = args.getValue<int>("stride", false, 1);
+    double cutoff = args.getValue<double>("cutoff", false, 0.0);
+
+    // sparse matrix
+    bool do_sparse = false, sparse_values = false;
+    if (args.count("sparse") >= 0) {
+      do_sparse = true;
+      for (Arguments::const_iterator it = args.lower_bound("sparse"),
+              to = args.upper_bound("sparse"); it != to; ++it) {
+        if (it->second == "rmsd")
+          sparse_values = true;
+        else if (it->second != "")
+          throw gromos::Exception(argv[0], "unknown argument of @sparse: "
+                + it->second);
+      }
+      if (cutoff <= 0.0)
+        throw gromos::Exception(argv[0], "@sparse requires a @cutoff");
+      if (args.count("human") >= 0)
+        throw gromos::Exception(argv[0], "@sparse can not be written in "
+              "human readable form");
+    }
 
     // read the precision
     int ii = args.getValue<int>("precision", false, 4);
@@ -279,8 +345,7 @@ int main(int argc, char **argv) {
         throw gromos::Exception(argv[0],
           "specify either atoms (@atomsrmsd or @fitatoms) or properties (@prop), not both!\n");
    
-    // create the vector to store the trajectory or properties
-    vector< vector < Vec > > traj;
+    // create the vector to store the properties
     vector< vector < Value > > props;
     
     // read reference topology
@@ -360,6 +425,7 @@ int main(int argc, char **argv) {
     }
 
     FastRotationalFit frf(fit_spec, rmsd_spec);
+    PairwiseRmsd pairs(fit_spec, rmsd_spec);
 
     // read in properties
     PropertyContainer propspecs(refSys, pbc);
@@ -397,7 +463,8 @@ int main(int argc, char **argv) {
     for (unsigned int i = 0; i < atomspecs.size(); ++i) {
       frame[i] = *atomspecs.coord(i) - cog;
     }
-    traj.push_back(frame);
+    const vector<Vec> reference(frame);
+    if (do_atomrmsd) pairs.addFrame(frame);
     
     
     // parse parameters for printing a distribution
@@ -508,14 +575,16 @@ int main(int argc, char **argv) {
             propcnt++;
           } else {
             Vec cog;
-            for (unsigned int i = 0; i < fitatoms.size(); ++i) {
-              cog += *fitatoms.coord(i);
+            const vector<Vec> &fitpos = fitatoms.gatherPos();
+            for (unsigned int i = 0; i < fitpos.size(); ++i) {
+              cog += fitpos[i];
             }
-            cog /= fitatoms.size();
-            for (unsigned int i = 0; i < atomspecs.size(); ++i) {
-              frame[i] = *atomspecs.coord(i) - cog;
+            cog /= fitpos.size();
+            const vector<Vec> &pos = atomspecs.gatherPos();
+            for (unsigned int i = 0; i < pos.size(); ++i) {
+              frame[i] = pos[i] - cog;
             }
-            int err = frf.fit(traj[0], frame);
+            int err = frf.fit(reference, frame);
 
             if (err) {
               ostringstream os;
@@ -525,8 +594,8 @@ int main(int argc, char **argv) {
               throw gromos::Exception(argv[0], os.str());
             }
 
-            // store coordinates from sys in traj
-            traj.push_back(frame);
+            // store coordinates from sys
+            pairs.addFrame(frame);
           }
         }
         framenum++;
@@ -542,26 +611,35 @@ int main(int argc, char **argv) {
     // open a file
     ofstream fout;
     bool human = false;
-    if (args.count("human") >= 0) {
+    if (args.count("human") >= 0 && !do_sparse) {
       fout.open("RMSDMAT.dat");
       human = true;
     } else {
       fout.open("RMSDMAT.bin", ios::out | ios::binary);
     }
 
-    // make a double loop
-    int num = traj.size();
+    int num = pairs.numFrames();
     if (props.size())
-//      num = props.front()->num();
       num=props.size();
-    Matrix rot(3, 3, 0);
-    Matrix unit(3, 3, 0);
-    for (size_t i = 0; i < 3; i++) unit(i, i) = 1;
 
     cout << "Read " << num << " out of " << framenum
             << " structures from trajectory" << endl;
 
-    if (human) { // human format
+    // which format
+    enum { format_human, format_short, format_int, format_sparse } format = format_human;
+    double max_value = std::numeric_limits<unsigned int>::max();
+    NeighbourMatrix sparse;
+    if (do_sparse) { // only the neighbours within the cutoff
+      std::cout << "using the sparse format" << std::endl;
+      format = format_sparse;
+      sparse.num = num;
+      sparse.skip = skip;
+      sparse.stride = stride;
+      sparse.precision = precision;
+      sparse.icutoff = unsigned(cutoff * precision);
+      sparse.hasValues = sparse_values;
+      sparse.writeHeader(fout);
+    } else if (human) { // human format
       fout << "TITLE\n"
               << "\trmsd-matrix for " << num - 1 << " + 1 (ref) = "
               << num << " structures\n"
@@ -571,37 +649,6 @@ int main(int argc, char **argv) {
               << num << "\t" << skip << "\t" << stride << "\n"
               << "# precision\n"
               << precision << "\n";
-
-      for (int i = 0; i < num; ++i) {
-        for (int j = i + 1; j < num; ++j) {
-          double rmsd = 0.0;
-          if (props.size()) {
-            rmsd = props_rmsd(props, i, j);
-          } else {
-            if (frf.fit(rot, traj[i], traj[j])) {
-              cout << "error rotational fit on frames " << i + 1 << " and "
-                      << j + 1
-                      << "\nfitting to reference structure instead" << endl;
-              rot = unit;
-            }
-
-            rmsd = frf.rmsd(rot, traj[i], traj[j]);
-          }
-          if (do_dist)
-            update_bins(bins, bin_size, rmsd);
-
-          rmsd *= precision;
-          if (rmsd > std::numeric_limits<unsigned int>::max()) {
-            std::cout << "frame " << i << " - " << j << " rmsd " << rmsd << endl;
-            throw gromos::Exception(argv[0], "RMSD value is too big for a 'int'. Adjust @precision.");
-          }
-          fout << setw(8) << i
-                  << setw(8) << j
-                  << setw(8) << unsigned(rmsd)
-                  << endl;
-        }
-      }
-      fout << "END\n";
     } else { // binary format
       fout.write((char*) &num, sizeof (int));
       fout.write((char*) &skip, sizeof (int));
@@ -610,67 +657,97 @@ int main(int argc, char **argv) {
 
       if (precision < 1e5) { // small precision -> short format
         std::cout << "using 'unsigned short' as format" << std::endl;
+        format = format_short;
+        max_value = std::numeric_limits<unsigned short>::max();
+      } else { // higher precision -> int format
+        std::cout << "using 'unsigned int' as format" << std::endl;
+        format = format_int;
+      }
+    }
 
-        typedef unsigned short ushort;
-        ushort irmsd;
-        for (int i = 0; i < num; ++i) {
-          for (int j = i + 1; j < num; ++j) {
-            double rmsd = 0.0;
-            if (props.size()) {
-              rmsd = props_rmsd(props, i, j);
-            } else {
-              if (frf.fit(rot, traj[i], traj[j])) {
-                cout << "error rotational fit on frames " << i + 1 << " and "
-                        << j + 1
-                        << "\nfitting to reference structure instead" << endl;
-                rot = unit;
-              }
-
-              rmsd = frf.rmsd(rot, traj[i], traj[j]);
-            }
+    // calculate and write the matrix in blocks of rows
+    vector<double> values;
+    vector<unsigned short> short_buffer;
+    vector<unsigned int> int_buffer;
+    vector<unsigned int> row_index, row_values;
+    for (int begin = 0; begin < num;) {
+      int end = begin;
+      size_t count = 0;
+      while (end < num && (count == 0 || count + (num - 1 - end) <= block_size)) {
+        count += num - 1 - end;
+        ++end;
+      }
+      rmsd_rows(pairs, props, begin, end, cutoff, values);
+
+      ostringstream os;
+      if (format == format_short)
+        short_buffer.resize(values.size());
+      if (format == format_int)
+        int_buffer.resize(values.size());
+      size_t k = 0;
+      for (int i = begin; i < end; ++i) {
+        row_index.clear();
+        row_values.clear();
+        for (int j = i + 1; j < num; ++j, ++k) {
+          double rmsd = values[k];
+          unsigned int irmsd;
+          if (cutoff > 0.0 && rmsd > cutoff) {
+            irmsd = unsigned(max_value);
+          } else {
             if (do_dist)
               update_bins(bins, bin_size, rmsd);
 
             rmsd *= precision;
-            if (rmsd > std::numeric_limits<unsigned short>::max()) {
+            if (rmsd > max_value) {
               std::cout << "frame " << i << " - " << j << " rmsd " << rmsd << endl;
-              throw gromos::Exception(argv[0], "RMSD value is too big for a 'short'. Adjust @precision.");
+              throw gromos::Exception(argv[0], format == format_short ?
+                      "RMSD value is too big for a 'short'. Adjust @precision." :
+                      "RMSD value is too big for a 'int'. Adjust @precision.");
             }
-            irmsd = ushort(rmsd);
-            fout.write((char*) &irmsd, sizeof (ushort));
+            irmsd = unsigned(rmsd);
           }
-        }
-      } else { // higher precision -> int format
-        std::cout << "using 'unsigned int' as format" << std::endl;
-        unsigned irmsd;
-        for (int i = 0; i < num; ++i) {
-          for (int j = i + 1; j < num; ++j) {
-            double rmsd = 0.0;
-            if (props.size()) {
-              rmsd = props_rmsd(props, i, j);
-            } else {
-              if (frf.fit(rot, traj[i], traj[j])) {
-                cout << "error rotational fit on frames " << i + 1 << " and "
-                        << j + 1
-                        << "\nfitting to reference structure instead" << endl;
-                rot = unit;
+          switch (format) {
+            case format_human:
+              os << setw(8) << i
+                      << setw(8) << j
+                      << ' ' << setw(7) << irmsd
+                      << '\n';
+              break;
+            case format_short:
+              short_buffer[k] = irmsd;
+              break;
+            case format_int:
+              int_buffer[k] = irmsd;
+              break;
+            case format_sparse:
+              if (irmsd < sparse.icutoff) {
+                row_index.push_back(j);
+                row_values.push_back(irmsd);
               }
-
-              rmsd = frf.rmsd(rot, traj[i], traj[j]);
-            }
-            if (do_dist)
-              update_bins(bins, bin_size, rmsd);
-
-            rmsd *= precision;
-            if (rmsd > std::numeric_limits<unsigned int>::max())
-              throw gromos::Exception(argv[0], "RMSD value is too big for a 'int'. Adjust @precision.");
-
-            irmsd = unsigned(rmsd);
-            fout.write((char*) &irmsd, sizeof (unsigned int));
+              break;
           }
         }
-      } // if precision
-    } // if human
+        if (format == format_sparse)
+          sparse.writeRow(fout, row_index.size(), row_index.empty() ? 0 :
+                &row_index[0], row_values.empty() ? 0 : &row_values[0]);
+      }
+      switch (format) {
+        case format_human:
+          fout << os.str();
+          break;
+        case format_short:
+          if (k) fout.write((char*) &short_buffer[0], k * sizeof (unsigned short));
+          break;
+        case format_int:
+          if (k) fout.write((char*) &int_buffer[0], k * sizeof (unsigned int));
+          break;
+        case format_sparse:
+          break;
+      }
+      begin = end;
+    }
+    if (human)
+      fout << "END\n";
     if (do_dist)
        write_bins(bins, bin_size);
   } catch (const gromos::Exception &e) {
@@ -81,6 +81,8 @@
 #include "../src/fit/Reference.h"
 #include "../src/fit/RotationalFit.h"
 #include "../src/gio/InG96.h"
+#include "../src/gio/InG96Prefetch.h"
+#include "../src/utils/groTime.h"
 #include "../src/gcore/System.h"
 #include "../src/gcore/MoleculeTopology.h"
 #include "../src/gcore/AtomTopology.h"
@@ -223,44 +225,39 @@ int main(int argc, char **argv){
     vector<double> apos2;
     vector<double> rmsf;
     
-    //loop over trajectory
-    for(Arguments::const_iterator iter=args.lower_bound("traj");
-	iter!=args.upper_bound("traj"); ++iter){
-      ic.open(iter->second);
-      // loop over all frames
-      while(!ic.eof()){
-        // read frame
-        ic.select("ALL");
-	ic >> sys;
-        // initalize after it is read
-        if (numFrames == 0) {
-          if (rmsfatoms.size() == 0)
-            throw gromos::Exception("rmsf",
-                  "No atoms specified for RMSF calculation");
-          rmsfatoms.sort();
-          apos.resize(rmsfatoms.size(), Vec(0.0, 0.0, 0.0));
-          apos2.resize(rmsfatoms.size(), 0.0);
-          rmsf.resize(rmsfatoms.size(), 0.0);
-          for(unsigned int i = 0; i < rmsfatoms.size(); ++i) {
-            firstpos.push_back(rmsfatoms.pos(i));
-          }
+    //loop over trajectory, the frames are read ahead while the positions
+    //are summed up
+    InG96Prefetch ip(sys, utils::Time());
+    ip.select("ALL");
+    ip.open(args.getValues<string>("traj", args.count("traj")));
+    while(!ip.eof()){
+      // read frame
+      ip >> sys;
+      // initalize after it is read
+      if (numFrames == 0) {
+        if (rmsfatoms.size() == 0)
+          throw gromos::Exception("rmsf",
+                "No atoms specified for RMSF calculation");
+        rmsfatoms.sort();
+        apos.resize(rmsfatoms.size(), Vec(0.0, 0.0, 0.0));
+        apos2.resize(rmsfatoms.size(), 0.0);
+        rmsf.resize(rmsfatoms.size(), 0.0);
+        for(unsigned int i = 0; i < rmsfatoms.size(); ++i) {
+          firstpos.push_back(rmsfatoms.pos(i));
         }
-	numFrames++;
+      }
+      numFrames++;
 
-	
-	(*pbc.*gathmethod)();
-        if (fitatoms.size())
-	  rf->fit(&sys);
-	
-	// calculate <r> and <r^2>
-	for(unsigned int i=0; i< rmsfatoms.size(); ++i){
-          const Vec & gathpos = rmsfatoms.pos(i); // pbc->nearestImage(firstpos[i], rmsfatoms.pos(i), sys.box());
-	  apos[i] += gathpos;
-	  apos2[i] += gathpos.abs2();
-	}
+      (*pbc.*gathmethod)();
+      if (fitatoms.size())
+        rf->fit(&sys);
 
+      // calculate <r> and <r^2>
+      for(unsigned int i=0; i< rmsfatoms.size(); ++i){
+        const Vec & gathpos = rmsfatoms.pos(i); // pbc->nearestImage(firstpos[i], rmsfatoms.pos(i), sys.box());
+        apos[i] += gathpos;
+        apos2[i] += gathpos.abs2();
       }
-      ic.close();
     } //end loop over trajectory
     
     // calculate the rmsf's
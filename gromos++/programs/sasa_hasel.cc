@@ -45,6 +45,9 @@
  * to generate lists of bonded atoms, and then uses these to generate lists of first, 
  * second, third and higher neighbours that are then used in the sasa calculation algorithm.
  * The atoms which belong to different molecules will ALWAYS be higher neighbours.
+ * Higher neighbours only contribute if their spheres overlap, so they are 
+ * taken from the overlapping pairs found by utils::Sasa in every frame.
+ * Every atom type of the solute needs an entry in the sasaspec file.
 
  *
  * <b>arguments:</b>
@@ -81,6 +84,7 @@
  * <hr>
  */
 
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <iostream>
@@ -88,7 +92,6 @@
 #include <sstream>
 #include <set>
 #include <fstream>
-#include <limits>
 
 #include "../src/args/Arguments.h"
 #include "../src/args/BoundaryParser.h"
@@ -113,6 +116,7 @@
 #include "../src/utils/groTime.h"
 #include "../src/utils/Neighbours.h"
 #include "../src/utils/AtomicRadii.h"
+#include "../src/utils/Sasa.h"
 
 using namespace std;
 using namespace args;
@@ -125,11 +129,10 @@ using namespace utils;
 bool compute_sasa(int i, std::string const & timespec, vector<int> const & timepts,
         unsigned int & timesWritten, bool & done);
 
-void calculate_sasa(gcore::System & sys, bool higher, vector<double> surfaces,
-        vector<double> & sasa_areas, unsigned int ii, unsigned int mi, unsigned int i,
-        unsigned int jj, unsigned int mj, unsigned int j,
-        double Ri_Rsolv, const double Rj_Rsolv, const double sum_of_radii,
-        const double p_i, const double p_j, const double pij, const double pi);
+void calculate_sasa(vector<Vec> const & pos, bool higher,
+        vector<double> const & surfaces, vector<double> & sasa_areas,
+        unsigned int ii, unsigned int jj, vector<double> const & radius,
+        vector<double> const & probability, const double pij, const double pi);
 
 struct sasa_parameter {
   double radius;
@@ -307,148 +310,126 @@ int main(int argc, char **argv) {
     // gather
     (*pbc.*gathmethod)();
 
-    // find number of "sasa" atoms and total number of atoms
-    // and store the true atom number of each sasa atom in a list
-    // of size numSasaAtoms
+    // find number of "sasa" atoms and store the true atom number of each 
+    // sasa atom in a list of size numSasaAtoms, together with its parameters
     vector<unsigned int> sasa_atoms;
     vector<unsigned int> sasa_mols;
-    unsigned int numSasaAtoms = 0;
-    unsigned int numAtoms = 0;
+    vector<vector<int> > sasa_index(sys.numMolecules());
+    vector<double> radius, probability, sigma;
     for (int m = 0; m < sys.numMolecules(); ++m) {
-      numAtoms += sys.mol(m).numAtoms();
+      sasa_index[m].resize(sys.mol(m).numAtoms(), -1);
       for (int i = 0; i < sys.mol(m).numAtoms(); ++i) {
         if (!noH || !sys.mol(m).topology().atom(i).isH()) {
-          numSasaAtoms += 1;
+          const int iac = sys.mol(m).topology().atom(i).iac();
+          map<int, sasa_parameter>::const_iterator para = sasa_spec.find(iac);
+          if (para == sasa_spec.end()) {
+            ostringstream msg;
+            msg << "no SASASPEC parameters for IAC " << iac + 1 
+                    << " (atom " << i + 1 << " of molecule " << m + 1 << ")";
+            throw gromos::Exception("sasa_hasel", msg.str());
+          }
+          sasa_index[m][i] = sasa_atoms.size();
           sasa_atoms.push_back(i);
           sasa_mols.push_back(m);
+          radius.push_back(para->second.radius + R_solv);
+          probability.push_back(para->second.probability);
+          sigma.push_back(para->second.sigma);
         }
       }
     }
-
-    // define a bondnumber storage list
-    vector<unsigned int> pathlength(numSasaAtoms * numSasaAtoms);
-    // and fill with large numbers ("infinity")
-    const unsigned int infinity = numeric_limits<unsigned int>::max();
-    for (unsigned int i = 0; i < pathlength.size(); ++i) {
-      pathlength[i] = infinity;
-    }
+    const unsigned int numSasaAtoms = sasa_atoms.size();
 
     // define neighbour lists
     vector<vector<unsigned int> > first_neighbours(numSasaAtoms);
     vector<vector<unsigned int> > second_neighbours(numSasaAtoms);
     vector<vector<unsigned int> > third_neighbours(numSasaAtoms);
-    vector<vector<unsigned int> > higher_neighbours(numSasaAtoms);
     vector<double> surfaces(numSasaAtoms);
     vector<double> sasa_areas(numSasaAtoms);
 
     // define physical constants
     const double pi = gmath::physConst.get_pi();
 
-    // loop through sasa atoms. have to loop over all so that surface is initialised.
+    // the bonds between the sasa atoms
+    vector<vector<unsigned int> > bonded(numSasaAtoms);
     for (unsigned int ii = 0; ii < numSasaAtoms; ++ii) {
-
-      // temporary first neighbour storage
-      vector<unsigned int> fnb;
-
       // first compute and store total surface area of atom ii
-      // and get radius, probability and sigma for atom ii
-      unsigned int mol_i = sasa_mols[ii];
-      unsigned int atom_i = sasa_atoms[ii];
-      map<int, sasa_parameter>::const_iterator para_ii =
-              sasa_spec.find(sys.mol(mol_i).topology().atom(atom_i).iac());
-      const sasa_parameter & s = para_ii->second;
-      const double Rsum = s.radius + R_solv;
-      double S = 4.0 * pi * (Rsum) * (Rsum);
-      surfaces[ii] = S;
+      surfaces[ii] = 4.0 * pi * radius[ii] * radius[ii];
 
       // get the bonded neighbours of atom i in molecule m
-      Neighbours neighbours(sys, mol_i, atom_i);
-      // loop over neighbours
+      const unsigned int mol_i = sasa_mols[ii];
+      Neighbours neighbours(sys, mol_i, sasa_atoms[ii]);
       Neighbours::const_iterator itn = neighbours.begin(), ton = neighbours.end();
       for (; itn != ton; ++itn) {
-        
-        // now loop over all other  sasa atoms jj!=ii
-        for (unsigned int jj = ii + 1; jj < numSasaAtoms; ++jj) {
-
-          unsigned int atom_j = sasa_atoms[jj];
-          unsigned int mol_j = sasa_mols[jj];
-          
-          // if the atoms are not from the same molecule, they are not considered here
-          if (mol_j == mol_i) {        
-            if (*itn == int(atom_j)) { // j is bonded to i
-              // assign ii and jj a pathlength of 1
-              pathlength[ii * numSasaAtoms + jj] = 1;
-              pathlength[jj * numSasaAtoms + ii] = 1;
-              // and store in tmp first neighbours list
-              // note we store indexes not actual atom numbers
-              fnb.push_back(jj);
-            } // end *itn==j
-          }
-        } // end jj
-      } // end neighbours
-      // store first neighbours for atom ii
-      first_neighbours[ii] = fnb;
-    } // end ii
-
-    // do Floyds algorithm to find minimum path lengths
-    for (unsigned int k = 0; k < numSasaAtoms; ++k) {
-      for (unsigned int i = 0; i < numSasaAtoms - 1; ++i) {
-        // stored path between i and k
-        const unsigned int pathlength_ik = pathlength[i * numSasaAtoms + k];
-        if (pathlength_ik < infinity) {
-          // stored path between k and j
-          for (unsigned int j = i + 1; j < numSasaAtoms; ++j) {
-            const unsigned int pathlength_kj = pathlength[k * numSasaAtoms + j];
-            if (pathlength_kj < infinity) {
-              // path between i and j via k
-              const unsigned int complength = pathlength_ik + pathlength_kj;
-              // compare to stored path between i and j
-              if (complength < pathlength[i * numSasaAtoms + j]) {
-                pathlength[i * numSasaAtoms + j] = complength;
+        const int jj = sasa_index[mol_i][*itn];
+        if (jj >= 0) {
+          bonded[ii].push_back(jj);
+          // note we store indexes not actual atom numbers
+          if (jj > int(ii)) first_neighbours[ii].push_back(jj);
+        }
+      }
+    }
+
+    // the second and third neighbours are found with a breadth-first search
+    // along the bonds. Atoms of the same molecule which are not connected
+    // by bonds are not neighbours at all, so the connected fragments are 
+    // numbered as well.
+    vector<unsigned int> pathlength(numSasaAtoms, 0);
+    vector<int> fragment(numSasaAtoms, -1);
+    vector<vector<unsigned int> > close(numSasaAtoms);
+    {
+      int numFragments = 0;
+      vector<unsigned int> queue;
+      for (unsigned int ii = 0; ii < numSasaAtoms; ++ii) {
+        if (fragment[ii] < 0) {
+          queue.assign(1, ii);
+          fragment[ii] = numFragments;
+          for (unsigned int q = 0; q < queue.size(); ++q) {
+            for (unsigned int b = 0; b < bonded[queue[q]].size(); ++b) {
+              const unsigned int jj = bonded[queue[q]][b];
+              if (fragment[jj] < 0) {
+                fragment[jj] = numFragments;
+                queue.push_back(jj);
               }
             }
           }
+          ++numFragments;
         }
-      }
-    } // end floyd's
-
-    // now make the third and higher lists
-    for (unsigned int ii = 0; ii < numSasaAtoms - 1; ++ii) {
-
-      // temporary neighbour lists
-      vector<unsigned int> snb;
-      vector<unsigned int> tnb;
-      vector<unsigned int> hnb;
-      for (unsigned int jj = ii + 1; jj < numSasaAtoms; ++jj) {
-          
-        unsigned int mol_i = sasa_mols[ii];  
-        unsigned int mol_j = sasa_mols[jj];
-          
-        // if the atoms are not from the same molecule, they are not considered only as higher neighbour atoms 
-        if (mol_j != mol_i) {
-          hnb.push_back(jj);   
-        }
-        
-        const unsigned int pathlength_ij = pathlength[ii * numSasaAtoms + jj];
-        if (pathlength_ij < infinity) {
-          if (pathlength_ij == 2) {
-            // store in 2nd neighbours
-            snb.push_back(jj);
+
+        // atoms up to three bonds away
+        queue.assign(1, ii);
+        pathlength[ii] = 1;
+        for (unsigned int q = 0; q < queue.size(); ++q) {
+          const unsigned int kk = queue[q];
+          if (pathlength[kk] > 3) continue;
+          for (unsigned int b = 0; b < bonded[kk].size(); ++b) {
+            const unsigned int jj = bonded[kk][b];
+            if (!pathlength[jj]) {
+              pathlength[jj] = pathlength[kk] + 1;
+              queue.push_back(jj);
+            }
           }
-          if (pathlength_ij == 3) {
-            // store in 3rd neighbours
-            tnb.push_back(jj);
-          } else if (pathlength_ij > 3) {
-            // note we are storing the indexes not the actual atom numbers
-            hnb.push_back(jj);
+        }
+        // pathlength is one more than the number of bonds
+        for (unsigned int q = 0; q < queue.size(); ++q) {
+          const unsigned int jj = queue[q];
+          if (jj > ii) {
+            if (pathlength[jj] == 3) second_neighbours[ii].push_back(jj);
+            else if (pathlength[jj] == 4) third_neighbours[ii].push_back(jj);
+            close[ii].push_back(jj);
           }
+          pathlength[jj] = 0;
         }
+        sort(second_neighbours[ii].begin(), second_neighbours[ii].end());
+        sort(third_neighbours[ii].begin(), third_neighbours[ii].end());
+        sort(close[ii].begin(), close[ii].end());
       }
-      // now put tmp neighbour lists into overall neighbour lists
-      second_neighbours[ii] = snb;
-      third_neighbours[ii] = tnb;
-      higher_neighbours[ii] = hnb; // note last space will not be filled...
-    } // end ii
+    }
+
+    // all other pairs of atoms of different molecules or of the same 
+    // fragment are higher neighbours. They only contribute if the spheres
+    // overlap, so they are taken from the overlapping pairs of every frame.
+    Sasa overlap(radius);
+    vector<Vec> pos(numSasaAtoms);
 
     // declare some variables for averaging
     double ave_phobic_sasa = 0.0;
@@ -507,140 +488,38 @@ int main(int argc, char **argv) {
           // initialise sasa array
           sasa_areas = surfaces;
 
+          for (unsigned int ii = 0; ii < numSasaAtoms; ++ii)
+            pos[ii] = sys.mol(sasa_mols[ii]).pos(sasa_atoms[ii]);
+          overlap.neighbours(pos);
+
           // loop through sasa atoms
           for (unsigned int ii = 0; ii < numSasaAtoms; ++ii) {
 
-            unsigned int atom_i = sasa_atoms[ii];
-            unsigned int mol_i = sasa_mols[ii];
-
-            // get radius, probability and sigma for atom ii
-            map<int, sasa_parameter>::const_iterator para_ii =
-                    sasa_spec.find(sys.mol(mol_i).topology().atom(atom_i).iac());
-
-            const sasa_parameter & s = para_ii->second;
-            const double R_i = s.radius;
-            const double p_i = s.probability;
-            const double Ri_Rsolv = R_i + R_solv;
-
-            // not higher neighbours yet
-            bool higher = false;
-
             // first neighbours
-            for (unsigned int j = 0; j < first_neighbours[ii].size(); ++j) {
-
-              // get atom number
-              unsigned int jj = first_neighbours[ii][j];
-              if (jj < ii) {
-                throw gromos::Exception("sasa_hasel",
-                        "neighbours must have higher sequence numbers");
-              } else {
-                unsigned int atom_j = sasa_atoms[jj];
-                unsigned int mol_j = sasa_mols[jj];
-
-                // get radius (and probability and sigma) for atom jj
-                map<int, sasa_parameter>::const_iterator para_jj =
-                        sasa_spec.find(sys.mol(mol_j).topology().atom(atom_j).iac());
-
-                const sasa_parameter & t = para_jj->second;
-                const double R_j = t.radius;
-                double p_j = t.probability;
-
-                // compute sum of radii
-                const double Rj_Rsolv = R_j + R_solv;
-                const double sum_of_radii = Ri_Rsolv + Rj_Rsolv;
-                
-                calculate_sasa(sys, higher, surfaces, sasa_areas, ii, mol_i, atom_i,
-                        jj, mol_j, atom_j, Ri_Rsolv, Rj_Rsolv, sum_of_radii, p_i, p_j, p_12, pi);
-              }
-
-            } // end j
+            for (unsigned int j = 0; j < first_neighbours[ii].size(); ++j)
+              calculate_sasa(pos, false, surfaces, sasa_areas, ii, 
+                      first_neighbours[ii][j], radius, probability, p_12, pi);
 
             // second neighbours
-            for (unsigned int j = 0; j < second_neighbours[ii].size(); ++j) {
-
-              // get atom number
-              unsigned int jj = second_neighbours[ii][j];
-              if (jj < ii) {
-                throw gromos::Exception("sasa_hasel",
-                        "neighbours must have higher sequence numbers");
-              } else {
-                unsigned int atom_j = sasa_atoms[jj];
-                unsigned int mol_j = sasa_mols[jj];
-
-                // get radius (and probability and sigma) for atom jj
-                map<int, sasa_parameter>::const_iterator para_jj =
-                        sasa_spec.find(sys.mol(mol_j).topology().atom(atom_j).iac());
-
-                const sasa_parameter & t = para_jj->second;
-                const double R_j = t.radius;
-                double p_j = t.probability;
-
-                // compute sum of radii
-                const double Rj_Rsolv = R_j + R_solv;
-                const double sum_of_radii = Ri_Rsolv + Rj_Rsolv;
-
-                calculate_sasa(sys, higher, surfaces, sasa_areas, ii, mol_i, atom_i,
-                        jj, mol_j, atom_j, Ri_Rsolv, Rj_Rsolv, sum_of_radii, p_i, p_j, p_13, pi);
-              }
-            }
+            for (unsigned int j = 0; j < second_neighbours[ii].size(); ++j)
+              calculate_sasa(pos, false, surfaces, sasa_areas, ii, 
+                      second_neighbours[ii][j], radius, probability, p_13, pi);
 
-            higher = true;
             // third neighbours
-            for (unsigned int j = 0; j < third_neighbours[ii].size(); ++j) {
-
-              // get atom number
-              unsigned int jj = third_neighbours[ii][j];
-              if (jj < ii) {
-                throw gromos::Exception("sasa_hasel",
-                        "neighbours must have higher sequence numbers");
-              } else {
-                unsigned int atom_j = sasa_atoms[jj];
-                unsigned int mol_j = sasa_mols[jj];
-
-                // get radius (and probability and sigma) for atom jj
-                map<int, sasa_parameter>::const_iterator para_jj =
-                        sasa_spec.find(sys.mol(mol_j).topology().atom(atom_j).iac());
-
-                const sasa_parameter & t = para_jj->second;
-                const double R_j = t.radius;
-                double p_j = t.probability;
-
-                // compute sum of radii
-                const double Rj_Rsolv = R_j + R_solv;
-                const double sum_of_radii = Ri_Rsolv + Rj_Rsolv;
-
-                calculate_sasa(sys, higher, surfaces, sasa_areas, ii, mol_i, atom_i,
-                        jj, mol_j, atom_j, Ri_Rsolv, Rj_Rsolv, sum_of_radii, p_i, p_j, p_1x, pi);
-              }
-            }
+            for (unsigned int j = 0; j < third_neighbours[ii].size(); ++j)
+              calculate_sasa(pos, true, surfaces, sasa_areas, ii, 
+                      third_neighbours[ii][j], radius, probability, p_1x, pi);
 
             // higher neighbours
-            for (unsigned int j = 0; j < higher_neighbours[ii].size(); ++j) {
-
-              // get atom number
-              unsigned int jj = higher_neighbours[ii][j];
-              if (jj < ii) {
-                throw gromos::Exception("sasa_hasel",
-                        "neighbours must have higher sequence numbers");
-              } else {
-                unsigned int atom_j = sasa_atoms[jj];
-                unsigned int mol_j = sasa_mols[jj];
-
-                // get radius (and probability and sigma) for atom jj
-                map<int, sasa_parameter>::const_iterator para_jj =
-                        sasa_spec.find(sys.mol(mol_j).topology().atom(atom_j).iac());
-
-                const sasa_parameter & t = para_jj->second;
-                const double R_j = t.radius;
-                double p_j = t.probability;
-
-                // compute sum of radii
-                const double Rj_Rsolv = R_j + R_solv;
-                const double sum_of_radii = Ri_Rsolv + Rj_Rsolv;
-
-                calculate_sasa(sys, higher, surfaces, sasa_areas, ii, mol_i, atom_i,
-                        jj, mol_j, atom_j, Ri_Rsolv, Rj_Rsolv, sum_of_radii, p_i, p_j, p_1x, pi);
-              }
+            for (int k = 0; k < overlap.numNeighbours(ii); ++k) {
+              const unsigned int jj = overlap.neighbour(ii, k);
+              if (jj <= ii) continue;
+              if (sasa_mols[jj] == sasa_mols[ii] && 
+                      (fragment[jj] != fragment[ii] ||
+                      binary_search(close[ii].begin(), close[ii].end(), jj)))
+                continue;
+              calculate_sasa(pos, true, surfaces, sasa_areas, ii, jj, 
+                      radius, probability, p_1x, pi);
             }
 
           } // ii
@@ -649,13 +528,7 @@ int main(int argc, char **argv) {
           for (unsigned int ii = 0; ii < numSasaAtoms; ++ii) {
 
             unsigned int atom_i = sasa_atoms[ii];
-            unsigned int mol_i = sasa_mols[ii];
-            // get radius (and probability and sigma) for atom ii
-            map<int, sasa_parameter>::const_iterator para_ii =
-                    sasa_spec.find(sys.mol(mol_i).topology().atom(atom_i).iac());
-
-            const sasa_parameter & s = para_ii->second;
-            const double sigma_i = s.sigma;
+            const double sigma_i = sigma[ii];
 
             // add to total
             tot_sasa += sasa_areas[ii];
@@ -749,16 +622,22 @@ bool compute_sasa(int i, std::string const & timespec, vector<int> const & timep
   return false;
 }
 
-void calculate_sasa(gcore::System & sys, bool higher, vector<double> surfaces,
-        vector<double> & sasa_areas, unsigned int ii, unsigned int mi, unsigned int i,
-        unsigned int jj, unsigned int mj, unsigned int j,
-        const double Ri_Rsolv, const double Rj_Rsolv, const double sum_of_radii,
-        const double p_i, const double p_j, const double pij, const double pi) {
+void calculate_sasa(vector<Vec> const & pos, bool higher,
+        vector<double> const & surfaces, vector<double> & sasa_areas,
+        unsigned int ii, unsigned int jj, vector<double> const & radius,
+        vector<double> const & probability, const double pij, const double pi) {
+
+  const double Ri_Rsolv = radius[ii];
+  const double Rj_Rsolv = radius[jj];
+  const double sum_of_radii = Ri_Rsolv + Rj_Rsolv;
+  const double p_i = probability[ii];
+  const double p_j = probability[jj];
 
   // compute distance between atoms i and j
-  const double rdist = (sys.mol(mi).pos(i) - sys.mol(mj).pos(j)).abs();
+  const double rdist = (pos[ii] - pos[jj]).abs();
 
-  if (!higher) {
+  // higher neighbours only contribute if they overlap
+  if (!higher || rdist <= sum_of_radii) {
     // compute components of area function
     const double c1 = (sum_of_radii - rdist) * pi;
     const double c2 = (Rj_Rsolv - Ri_Rsolv) / rdist;
@@ -770,19 +649,5 @@ void calculate_sasa(gcore::System & sys, bool higher, vector<double> surfaces,
     // modify areas
     sasa_areas[ii] *= (1.0 - bij);
     sasa_areas[jj] *= (1.0 - bji);
-  } else {
-    if (rdist <= sum_of_radii) {
-      // compute components of area function
-      const double c1 = (sum_of_radii - rdist) * pi;
-      const double c2 = (Rj_Rsolv - Ri_Rsolv) / rdist;
-      // note that "bij", "bji" are actually pi*pij*bij/Si
-      const double bij = (c1 * Ri_Rsolv * (1.0 + c2) * pij * p_i) /
-              surfaces[ii];
-      const double bji = (c1 * Rj_Rsolv * (1.0 - c2) * pij * p_j) /
-              surfaces[jj];
-      // modify areas
-      sasa_areas[ii] *= (1.0 - bij);
-      sasa_areas[jj] *= (1.0 - bji);
-    }
   }
 }
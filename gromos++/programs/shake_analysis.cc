@@ -105,6 +105,7 @@
 #include "../src/utils/Property.h"
 #include "../src/utils/PropertyContainer.h"
 #include "../src/utils/SimplePairlist.h"
+#include "../src/utils/CellList.h"
 #include "../src/utils/Energy.h"
 
 using namespace gcore;
@@ -437,6 +438,9 @@ int main(int argc, char **argv) {
     double sum_e_vdw = 0.0, sum_e_crf = 0.0, sum_e_tot = 0.0;
     // double max_e_vdw = 0.0, max_e_crf = 0.0, max_e_tot = 0.0;
 
+    // one cell list for the pairlists of all atoms
+    const CellList cells(sys, *pbc, cut, true);
+
     // loop over the relevant atoms
     for (unsigned int i = 0; i < atoms.size(); i++) {
 
@@ -444,7 +448,7 @@ int main(int argc, char **argv) {
       SimplePairlist pl(sys, *pbc, cut);
       pl.setAtom(atoms.mol(i), atoms.atom(i));
       pl.setType("CHARGEGROUP");
-      pl.calc();
+      pl.calc(cells);
       pl.removeExclusions();
 
       int atom_i = pl.size();
@@ -44,6 +44,11 @@
  * angles including a distribution from 0 to 360 degrees. If the keyword periodic
  * is missing, the distribution is done omitting values outside the specified 
  * range.
+ *
+ * With \@nostore, the values are not kept in memory. The averages and the
+ * distribution are accumulated frame by frame and the error estimate is
+ * based on blocks of 2^k and 3 * 2^k frames (see gmath::Stat). The
+ * distribution then needs its minimum and maximum.
  * 
  * <b>arguments:</b>
  * <table border=0 cellpadding=0>
@@ -54,6 +59,7 @@
  * <tr><td> [\@nots</td><td>(do not write time series)] </td></tr>
  * <tr><td> [\@dist</td><td>&lt;steps [min max] [periodic] </td></tr>
  * <tr><td> [\@norm</td><td>(normalise distribution)] </td></tr>
+ * <tr><td> [\@nostore</td><td>(do not keep the values for the averages; needs min and max for \@dist)] </td></tr>
  * <tr><td> [\@solv</td><td>(read in solvent)] </td></tr>
  * <tr><td> \@traj</td><td>&lt;trajectory files&gt; </td></tr>
  * <tr><td> [\@skip</td><td>&lt;skip n first frames&gt;] </td></tr>
@@ -89,7 +95,6 @@
 #include "../src/args/BoundaryParser.h"
 #include "../src/args/GatherParser.h"
 #include "../src/fit/Reference.h"
-#include "../src/gio/InG96.h"
 #include "../src/gcore/System.h"
 #include "../src/gcore/Molecule.h"
 #include "../src/gcore/Box.h"
@@ -101,6 +106,7 @@
 #include "../src/utils/Property.h"
 #include "../src/utils/PropertyContainer.h"
 #include "../src/utils/groTime.h"
+#include "../src/utils/FrameLoop.h"
 
 using namespace std;
 using namespace gcore;
@@ -109,11 +115,58 @@ using namespace bound;
 using namespace args;
 using namespace utils;
 
+/**
+ * calculates the properties of a frame (on a copy of the system) and
+ * prints them in the order of the frames
+ */
+class TserTask : public FrameTask {
+  PropertyContainer &d_master;
+  const std::string &d_spec;
+  bool d_tser;
+  PropertyContainer *d_props;
+public:
+  TserTask(PropertyContainer &master, const std::string &spec, bool tser) :
+  d_master(master), d_spec(spec), d_tser(tser), d_props(NULL) {
+  }
+  ~TserTask() {
+    delete d_props;
+  }
+  FrameTask *clone(System &sys, Boundary *pbc) {
+    TserTask *t = new TserTask(d_master, d_spec, d_tser);
+    t->d_props = new PropertyContainer(sys, pbc);
+    t->d_props->addSpecifier(d_spec);
+    // only the values are collected, the statistics are kept by the master
+    t->d_props->setStore(false);
+    return t;
+  }
+  void analyse(System &sys, const utils::Time &time) {
+    // calculate the props
+    // this is now the place, where a property-container is very handy
+    // it knows that we want to loop over all properties and calculate
+    // their 'value'.
+    d_props->calc();
+  }
+  void collect(const utils::Time &time) {
+    // the statistics (and continuous torsions) are kept by the properties 
+    // of the program
+    d_master.collect(*d_props);
+
+    // print the properties
+    // this is a time series, so let's just print out the properties
+    // the << operator is overloaded for the property container as well
+    // as for the single properties
+    if (d_tser){
+      cout << time << "\t\t";
+      cout << d_master;
+    }
+  }
+};
+
 int main(int argc, char **argv){
 
   Argument_List knowns;
   knowns << "topo" << "pbc" << "time" << "prop" << "traj" << "skip" << "stride"
-         << "nots" << "dist" << "norm" << "solv";
+         << "nots" << "dist" << "norm" << "solv" << "nostore";
 
   string usage = "# " + string(argv[0]);
   usage += "\n\t@topo      <molecular topology file>\n";
@@ -123,6 +176,7 @@ int main(int argc, char **argv){
   usage += "\t[@nots     (do not write time series)]\n";
   usage += "\t[@dist     <steps [min max] [periodic]>]\n";
   usage += "\t[@norm     (normalise distribution)]\n";
+  usage += "\t[@nostore  (do not keep the values for the averages)]\n";
   usage += "\t[@solv     (read in solvent)]\n";
   usage += "\t@traj      <trajectory files>\n";
   usage += "\t[@skip     <skip n first frames>]\n";
@@ -214,8 +268,8 @@ int main(int argc, char **argv){
     // the PropertyContainer should know about the system, so it can
     // check the input whether ie the atoms exist in the topology
     PropertyContainer props(sys, pbc);
+    std::string prop;
     {
-      std::string prop;
       Arguments::const_iterator iter=args.lower_bound("prop");
       Arguments::const_iterator to=args.upper_bound("prop");
       // we read in all properties specified by the user
@@ -231,15 +285,28 @@ int main(int argc, char **argv){
       props.addSpecifier(prop);
     }
 
-    int skip = args.getValue<int>("skip", false, 0);
-    int stride = args.getValue<int>("stride", false, 1);
-
     bool solvent = false;
     if (args.count("solv") != -1)
       solvent = true;
 
-    // define input coordinate
-    InG96 ic(skip, stride);
+    // only the averages and distributions, not the values
+    bool store = true;
+    if (args.count("nostore") != -1) {
+      store = false;
+      if (do_dist && !dist_boundaries)
+        throw Arguments::Exception("@nostore needs the minimum and maximum "
+                "of the distribution (@dist)");
+      for (unsigned int i = 0; i < props.size(); ++i) {
+        props[i]->setStore(false);
+        if (do_dist)
+          props[i]->getScalarStat().dist_init(dist_min, dist_max, dist_steps, periodic);
+      }
+    }
+
+    // define the loop over the trajectories, the frames are analysed
+    // in parallel
+    FrameLoop loop(args, sys, pbc, gathmethod, time);
+    if (solvent) loop.select("ALL");
 
     // title
     if (do_tser){
@@ -252,40 +319,8 @@ int main(int argc, char **argv){
     }
     
     // loop over all trajectories
-    for(Arguments::const_iterator 
-	  iter=args.lower_bound("traj"),
-	  to=args.upper_bound("traj");
-	iter!=to; ++iter){
-
-      // open file
-      ic.open((iter->second).c_str());
-      if (solvent) ic.select("ALL");
-      
-      // loop over single trajectory
-      while(!ic.eof()){
-	ic >> sys >> time;
-	if (ic.stride_eof()) break;
-      
-	(*pbc.*gathmethod)();
-      
-	// calculate the props
-	// this is now the place, where a property-container is very handy
-	// it knows that we want to loop over all properties and calculate
-	// their 'value'.
-	props.calc();
-
-	// print the properties
-	// this is a time series, so let's just print out the properties
-	// the << operator is overloaded for the property container as well
-	// as for the single properties
-	if (do_tser){
-	  cout << time << "\t\t";
-	  cout << props;
-	}
-      }
-      ic.close();
-    }
-
+    TserTask task(props, prop, do_tser);
+    loop.run(task);
     
     if (do_tser){
       cout << "# Averages over run: (<average> <rmsd> <error estimate>)\n" ;
@@ -302,13 +337,15 @@ int main(int argc, char **argv){
       for(unsigned int i=0; i<props.size(); ++i){
 	
 	gmath::Stat<double> & stat = props[i]->getScalarStat();
-        if (periodic) {
-          stat.dist_init(dist_min, dist_max, dist_steps, true);
-        }
-        else if (dist_boundaries) {
-	  stat.dist_init(dist_min, dist_max, dist_steps, false);
-        } else {
-	  stat.dist_init(dist_steps);
+        if (store) {
+          if (periodic) {
+            stat.dist_init(dist_min, dist_max, dist_steps, true);
+          }
+          else if (dist_boundaries) {
+            stat.dist_init(dist_min, dist_max, dist_steps, false);
+          } else {
+            stat.dist_init(dist_steps);
+          }
         }
 
 	cout << "\n#" << endl;  
@@ -41,6 +41,7 @@
  * <tr><td> \@traj</td><td>&lt;input trajectory file(s)&gt; </td></tr>
  * <tr><td> [\@nthframe</td><td>&lt;write every nth frame (default: 1)&gt;] </td></tr>
  * <tr><td> [\@time</td><td>&lt;@ref utils::Time "time and dt"&gt;] </td></tr>
+ * <tr><td> [\@outfile</td><td>&lt;output file (default: standard output, compressed if it ends in .gz)&gt;] </td></tr>
  * </table>
  *
  *
@@ -65,6 +66,7 @@
 #include "../src/args/Arguments.h"
 #include "../src/gio/InG96.h"
 #include "../src/gio/OutG96.h"
+#include "../src/gio/OutFile.h"
 #include "../src/gcore/System.h"
 #include "../src/gcore/Molecule.h"
 #include "../src/gio/InTopology.h"
@@ -79,13 +81,14 @@ using namespace args;
 
 int main(int argc, char **argv){
   Argument_List knowns;
-  knowns << "topo" << "traj" << "nthframe" << "time";
+  knowns << "topo" << "traj" << "nthframe" << "time" << "outfile";
 
   string usage = "# " + string(argv[0]);
   usage += "\n\t@topo <molecular topology file>\n";
   usage += "\t@traj <input trajectory files>\n";
   usage += "\t[@nthframe <write every nth frame> (default: 1)]\n";
   usage += "\t[@time      <time and dt>]\n";
+  usage += "\t[@outfile   <output file> (default: standard output)]\n";
 
   try{
     Arguments args(argc, argv, knowns, usage);
@@ -105,7 +108,9 @@ int main(int argc, char **argv){
     // loop over all trajectories
     bool isFirstTraj = true;
     int skipFrame = 0;
-    oc->open(cout);     
+    // output to a file (block gzip compressed if the name ends in .gz)
+    ostream *os = openOutput(args);
+    oc->open(*os);
     for(Arguments::const_iterator iter=args.lower_bound("traj");
       iter!=args.upper_bound("traj"); ++iter){
 
@@ -130,6 +135,7 @@ int main(int argc, char **argv){
       ic.close();
     }
     oc->close();
+    if (os != &cout) delete os;
   }
   catch (const gromos::Exception &e){
     cerr << e.what() << endl;
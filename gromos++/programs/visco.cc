@@ -210,6 +210,13 @@ int main(int argc, char **argv) {
       ++it_en;
     }
 
+    // resolve the property names once
+    vector<utils::EnergyIndex> prop_index(num_prop);
+    for(int i=0; i<num_prop; i++)
+      prop_index[i]=etrj.resolve(prop[i]);
+    utils::EnergyIndex time_index;
+    if(!usertime) time_index=etrj.resolve("TIME[2]");
+
     while(true){
 
       // read the numbers into the energy trajectory
@@ -229,11 +236,11 @@ int main(int argc, char **argv) {
       }
       // calculate and store the necessary number in the stat-classes
       for(int i=0; i<num_prop; i++)
-	s[i].addval(etrj[prop[i]]);
+	s[i].addval(etrj[prop_index[i]]);
       if(usertime)
 	t0+=dt;
       else
-	t0=etrj["TIME[2]"];
+	t0=etrj[time_index];
       time.push_back(t0);
       
     }
@@ -147,7 +147,7 @@ namespace args {
      * @param def the default value if no argument is given
      */
     template<typename T>
-    T getValue(const std::string & arg, bool required = true, const T & def = 0);
+    T getValue(const std::string & arg, bool required = true, const T & def = 0)const;
 
     /**
      * Get multiple values as a vector
@@ -157,7 +157,7 @@ namespace args {
      * @param def a vector containing the default values
      */
     template<typename T>
-    std::vector<T> getValues(const std::string & arg, unsigned int num, bool required = true, const std::vector<T> & def = std::vector<T>());
+    std::vector<T> getValues(const std::string & arg, unsigned int num, bool required = true, const std::vector<T> & def = std::vector<T>())const;
 
         /**
      * @struct Exception
@@ -192,7 +192,7 @@ namespace args {
   };
 
   template<typename T>
-  T Arguments::getValue(const std::string & arg, bool required, const T & def) {
+  T Arguments::getValue(const std::string & arg, bool required, const T & def)const {
     Arguments::const_iterator it = lower_bound(arg), to = upper_bound(arg);
     if (it != to) {
       std::istringstream is(it->second);
@@ -222,7 +222,7 @@ namespace args {
   }
 
   template<typename T>
-  std::vector<T> Arguments::getValues(const std::string & arg, unsigned int num, bool required, const std::vector<T> & def) {
+  std::vector<T> Arguments::getValues(const std::string & arg, unsigned int num, bool required, const std::vector<T> & def)const {
     Arguments::const_iterator it = lower_bound(arg), to = upper_bound(arg);
 
     if (it == to) {
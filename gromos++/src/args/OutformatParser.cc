@@ -36,6 +36,7 @@
 #include "../gio/OutPdb.h"
 #include "../gio/Outvmdam.h"
 #include "../gio/OutCif.h"
+#include "../gio/OutBinTrc.h"
 
 using namespace std;
 using namespace gcore;
@@ -101,6 +102,16 @@ OutCoordinates * args::OutformatParser::parse(Arguments & args,
       } else if (format == "trc") {
           oc = new OutG96();
           ext = ".trc";
+      } else if (format == "btrc") {
+          ++it;
+          double precision = 1000.0;
+          if (it != to) {
+              istringstream is(it->second);
+              if (!(is >> precision) || precision <= 0.0)
+                  throw gromos::Exception("OutformatParser", "@outformat btrc precision has to be a positive number.!");
+          }
+          oc = new OutBinTrc(precision);
+          ext = ".btrc";
       } else if (format == "por") {
           oc = new OutG96S(true);
           ext = ".por";
@@ -124,6 +135,8 @@ OutCoordinates * args::OutformatParser::parse(Arguments & args,
               << "      Configuration format containing the POSITION block." << endl
               << "    - trc" << endl
               << "      Trajectory format containing the POSITIONRED block." << endl
+              << "    - btrc [<precision in 1/nm, 1000.0>]" << endl
+              << "      Binary trajectory format (compressed coordinates)." << endl
               << "    - por" << endl
               << "      Position restraints specification format." << endl
               << "    - pdb [<factor to convert length unit to Angstrom, 10.0>]" << endl
@@ -42,7 +42,9 @@ class Arguments;
  * <tr><th>Argument</th><th>Description</th></tr>
  * <tr><td>cnf</td><td>Configuration format containing the POSITION
  * block.</td></tr> <tr><td>trc</td><td>Trajectory format containing the
- * POSITIONRED block.</td></tr> <tr><td>por</td><td>Position restraints
+ * POSITIONRED block.</td></tr> <tr><td>btrc [&lt;precision in 1/nm, 
+ * 1000.0&gt;]</td><td>Binary trajectory format with compressed coordinates
+ * (see gio::OutBinTrc).</td></tr> <tr><td>por</td><td>Position restraints
  * specification format.</td></tr> <tr><td>pdb [&lt;factor to convert length
  * unit to Angstrom, 10.0&gt; and/or &lt;"renumber" keyword to start numbering
  * at 1 at each molecule&gt;] </td><td>Protein Data Bank (PDB) format.</td></tr>
@@ -171,6 +171,18 @@ bool Boundary::inBox(const Vec &ref, const Vec &v, const gcore::Box &box) const
            (fabs(v[2] - nim[2]) < tol[2]);
 }
 
+void Boundary::nearestImageVectors(const Vec &r1, const Vec *r2, int n,
+        const gcore::Box &box, Vec *v) const {
+  for (int i = 0; i < n; ++i)
+    v[i] = nearestImage(r1, r2[i], box) - r1;
+}
+
+void Boundary::nearestImageDistances2(const Vec &r1, const Vec *r2, int n,
+        const gcore::Box &box, double *d2) const {
+  for (int i = 0; i < n; ++i)
+    d2[i] = (nearestImage(r1, r2[i], box) - r1).abs2();
+}
+
 void Boundary::nogather() {
 
 }
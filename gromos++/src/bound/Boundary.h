@@ -130,6 +130,29 @@ namespace bound{
     virtual gmath::Vec nearestImage(const gmath::Vec &r1,
 				    const  gmath::Vec &r2, 
 				    const gcore::Box &box) const = 0;
+
+    /**
+     * Batch version of nearestImage for n positions stored contiguously,
+     * e.g. in gcore::Molecule::positions(). Writes the minimum image
+     * vectors v[i] = nearestImage(r1, r2[i], box) - r1.
+     * The periodic boundaries compute the box-derived constants once per
+     * call and use AVX2 or AVX-512 instructions if compiled for them
+     * (compiler flags such as -march=native, not set by configure).
+     * Without these instructions the triclinic version is not faster
+     * than calling nearestImage (see bound::batch).
+     */
+    virtual void nearestImageVectors(const gmath::Vec &r1,
+                                     const gmath::Vec *r2, int n,
+                                     const gcore::Box &box,
+                                     gmath::Vec *v) const;
+    /**
+     * As nearestImageVectors, but writes the squared lengths of the
+     * minimum image vectors to d2.
+     */
+    virtual void nearestImageDistances2(const gmath::Vec &r1,
+                                        const gmath::Vec *r2, int n,
+                                        const gcore::Box &box,
+                                        double *d2) const;
    
     /**
      * Using nearestImage, check if the v is in the same box as the ref
@@ -0,0 +1,117 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// bound_Boundary.t.cc
+
+// checks the batch nearest image functions against nearestImage for all
+// boundaries and compares their timings
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Boundary.h"
+#include "RectBox.h"
+#include "Triclinic.h"
+#include "TruncOct.h"
+#include "Vacuum.h"
+#include "../gcore/System.h"
+#include "../gcore/Box.h"
+#include "../gmath/Vec.h"
+
+using namespace std;
+using gmath::Vec;
+using gcore::Box;
+
+double random(double range) {
+  return range * (2.0 * rand() / RAND_MAX - 1.0);
+}
+
+void check(const string &name, bound::Boundary &pbc, const Box &box) {
+  // an odd number of positions to test the remainder
+  const int n = 100003;
+  const double range = 2.0 * box.K().abs();
+  vector<Vec> pos(n);
+  for (int i = 0; i < n; ++i)
+    pos[i] = Vec(random(range), random(range), random(range));
+  // differences of exactly zero
+  pos[1] = pos[0];
+  pos[2] = Vec(pos[0][0], pos[0][1] + 0.7, pos[0][2]);
+
+  vector<Vec> v(n), v_batch(n);
+  vector<double> d2(n), d2_batch(n);
+  const int repeat = 20;
+
+  clock_t start = clock();
+  for (int r = 0; r < repeat; ++r) {
+    const Vec &ref = pos[r];
+    for (int i = 0; i < n; ++i) {
+      v[i] = pbc.nearestImage(ref, pos[i], box) - ref;
+      d2[i] = v[i].abs2();
+    }
+  }
+  const double t_scalar = double(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (int r = 0; r < repeat; ++r)
+    pbc.nearestImageDistances2(pos[r], &pos[0], n, box, &d2_batch[0]);
+  const double t_batch = double(clock() - start) / CLOCKS_PER_SEC;
+
+  pbc.nearestImageVectors(pos[repeat - 1], &pos[0], n, box, &v_batch[0]);
+  // bitwise, such that NaN compare equal
+  assert(memcmp(&v[0], &v_batch[0], n * sizeof(Vec)) == 0);
+  // abs2() may be contracted to fused multiply-adds
+  for (int i = 0; i < n; ++i)
+    assert(d2[i] != d2[i] || fabs(d2[i] - d2_batch[i]) <= 1e-15 * d2[i]);
+
+  cout << name << ": " << t_scalar << " s (nearestImage), " << t_batch
+          << " s (nearestImageDistances2), speedup " << t_scalar / t_batch
+          << endl;
+}
+
+int main() {
+  srand(3);
+  gcore::System sys;
+
+  Box rect(3.1, 3.7, 4.3);
+  rect.setNtb(Box::rectangular);
+  bound::RectBox rectbox(&sys);
+  check("rectangular", rectbox, rect);
+
+  Box tric(Vec(3.5, 0.0, 0.0), Vec(1.0, 3.3, 0.0), Vec(0.7, -0.9, 3.9));
+  tric.setNtb(Box::triclinic);
+  tric.update_triclinic();
+  bound::Triclinic triclinic(&sys);
+  check("triclinic  ", triclinic, tric);
+
+  Box oct(5.0, 5.0, 5.0);
+  oct.setNtb(Box::truncoct);
+  bound::TruncOct truncoct(&sys);
+  check("truncoct   ", truncoct, oct);
+
+  bound::Vacuum vacuum(&sys);
+  check("vacuum     ", vacuum, rect);
+  return 0;
+}
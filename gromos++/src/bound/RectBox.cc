@@ -24,11 +24,31 @@
 #include "../gmath/Vec.h"
 #include "../gcore/Box.h"
 #include "RectBox.h"
+#include "BatchImage.h"
 
 using bound::RectBox;
 using gmath::Vec;
 using gcore::Box;
 
+namespace {
+  // minimum image in a rectangular box, as RectBox::nearestImage
+  struct RectKernel {
+    double kabs, labs, mabs;
+
+    RectKernel(const Box &box) :
+    kabs(box.K().abs()), labs(box.L().abs()), mabs(box.M().abs()) {
+    }
+
+    template<class P>
+    void image(typename P::reg &x, typename P::reg &y, typename P::reg &z) const {
+      const typename P::reg k = P::set(kabs), l = P::set(labs), m = P::set(mabs);
+      x = P::sub(x, P::mul(k, P::round(P::div(x, k))));
+      y = P::sub(y, P::mul(l, P::round(P::div(y, l))));
+      z = P::sub(z, P::mul(m, P::round(P::div(z, m))));
+    }
+  };
+}
+
 Vec RectBox::nearestImage(const Vec &r1, const Vec &r2, const Box &box)const {
   Vec diff = r2 - r1;
   Vec a;
@@ -43,4 +63,14 @@ Vec RectBox::nearestImage(const Vec &r1, const Vec &r2, const Box &box)const {
   return rec;
 }
 
+void RectBox::nearestImageVectors(const Vec &r1, const Vec *r2, int n,
+        const Box &box, Vec *v)const {
+  bound::batch::run(RectKernel(box), r1, reinterpret_cast<const double *>(r2), n,
+          reinterpret_cast<double *>(v), NULL);
+}
 
+void RectBox::nearestImageDistances2(const Vec &r1, const Vec *r2, int n,
+        const Box &box, double *d2)const {
+  bound::batch::run(RectKernel(box), r1, reinterpret_cast<const double *>(r2), n,
+          NULL, d2);
+}
@@ -24,11 +24,42 @@
 #include "../gmath/Vec.h"
 #include "../gcore/Box.h"
 #include "Triclinic.h"
+#include "BatchImage.h"
 
 using bound::Triclinic;
 using gmath::Vec;
 using gcore::Box;
 
+namespace {
+  // minimum image in a triclinic box, as Triclinic::nearestImage
+  struct TriclinicKernel {
+    double c[3][3], b[3][3];
+
+    TriclinicKernel(const Box &box) {
+      for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j)
+          c[i][j] = box.cross_K_L_M()[i][j];
+        b[0][i] = box.K()[i];
+        b[1][i] = box.L()[i];
+        b[2][i] = box.M()[i];
+      }
+    }
+
+    template<class P>
+    void image(typename P::reg &x, typename P::reg &y, typename P::reg &z) const {
+      typedef typename P::reg reg;
+      reg n[3];
+      for (int i = 0; i < 3; ++i)
+        n[i] = P::round(P::add(P::add(P::mul(P::set(c[i][0]), x),
+              P::mul(P::set(c[i][1]), y)), P::mul(P::set(c[i][2]), z)));
+      reg *a[3] = {&x, &y, &z};
+      for (int j = 0; j < 3; ++j)
+        *a[j] = P::add(*a[j], P::add(P::add(P::mul(P::set(b[0][j]), n[0]),
+              P::mul(P::set(b[1][j]), n[1])), P::mul(P::set(b[2][j]), n[2])));
+    }
+  };
+}
+
 Vec Triclinic::nearestImage(const Vec &r1, const Vec &r2, const Box &box)const{
   Vec P = r2 - r1;
   int k,l,m;
@@ -39,3 +70,15 @@ Vec Triclinic::nearestImage(const Vec &r1, const Vec &r2, const Box &box)const{
   P += box.K() * k + box.L() * l + box.M() * m;
   return r1 + P;
 }
+
+void Triclinic::nearestImageVectors(const Vec &r1, const Vec *r2, int n,
+        const Box &box, Vec *v)const {
+  bound::batch::run(TriclinicKernel(box), r1, reinterpret_cast<const double *>(r2), n,
+          reinterpret_cast<double *>(v), NULL);
+}
+
+void Triclinic::nearestImageDistances2(const Vec &r1, const Vec *r2, int n,
+        const Box &box, double *d2)const {
+  bound::batch::run(TriclinicKernel(box), r1, reinterpret_cast<const double *>(r2), n,
+          NULL, d2);
+}
@@ -44,6 +44,12 @@ namespace bound{
     virtual gmath::Vec nearestImage(const gmath::Vec &r1,
 			    const  gmath::Vec &r2, 
 			    const gcore::Box &box) const;
+    virtual void nearestImageVectors(const gmath::Vec &r1,
+                            const gmath::Vec *r2, int n,
+                            const gcore::Box &box, gmath::Vec *v) const;
+    virtual void nearestImageDistances2(const gmath::Vec &r1,
+                            const gmath::Vec *r2, int n,
+                            const gcore::Box &box, double *d2) const;
   };
     
 }
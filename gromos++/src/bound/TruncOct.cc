@@ -25,6 +25,7 @@
 #include <sstream>
 #include <set>
 #include "TruncOct.h"
+#include "BatchImage.h"
 #include "../gmath/Vec.h"
 #include "../gcore/System.h"
 #include "../gcore/Solvent.h"
@@ -39,6 +40,30 @@ using bound::TruncOct;
 using gmath::Vec;
 using gcore::Box;
 
+namespace {
+  // minimum image in a truncated octahedron, as TruncOct::nearestImage
+  struct TruncOctKernel {
+    double kabs;
+
+    TruncOctKernel(const Box &box) : kabs(box.K().abs()) {
+    }
+
+    template<class P>
+    void image(typename P::reg &x, typename P::reg &y, typename P::reg &z) const {
+      typedef typename P::reg reg;
+      const reg k = P::set(kabs), half = P::set(0.5 * kabs);
+      x = P::sub(x, P::mul(k, P::round(P::div(x, k))));
+      y = P::sub(y, P::mul(k, P::round(P::div(y, k))));
+      z = P::sub(z, P::mul(k, P::round(P::div(z, k))));
+      const reg ax = P::abs(x), ay = P::abs(y), az = P::abs(z);
+      const reg outside = P::sub(P::sub(P::sub(P::set(0.75 * kabs), ax), ay), az);
+      x = P::selectNegative(outside, x, P::sub(x, P::mul(P::div(x, ax), half)));
+      y = P::selectNegative(outside, y, P::sub(y, P::mul(P::div(y, ay), half)));
+      z = P::selectNegative(outside, z, P::sub(z, P::mul(P::div(z, az), half)));
+    }
+  };
+}
+
 Vec TruncOct::nearestImage(const Vec &r1, const Vec &r2, const Box &box)const{
   Vec diff=r2-r1;
   Vec a;
@@ -58,3 +83,15 @@ Vec TruncOct::nearestImage(const Vec &r1, const Vec &r2, const Box &box)const{
 
   return r1 + a;
 }
+
+void TruncOct::nearestImageVectors(const Vec &r1, const Vec *r2, int n,
+        const Box &box, Vec *v)const {
+  bound::batch::run(TruncOctKernel(box), r1, reinterpret_cast<const double *>(r2), n,
+          reinterpret_cast<double *>(v), NULL);
+}
+
+void TruncOct::nearestImageDistances2(const Vec &r1, const Vec *r2, int n,
+        const Box &box, double *d2)const {
+  bound::batch::run(TruncOctKernel(box), r1, reinterpret_cast<const double *>(r2), n,
+          NULL, d2);
+}
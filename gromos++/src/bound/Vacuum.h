@@ -53,6 +53,20 @@ namespace bound {
       return r2;
     }
 
+    virtual void nearestImageVectors(const gmath::Vec &r1,
+            const gmath::Vec *r2, int n,
+            const gcore::Box &box, gmath::Vec *v) const {
+      for (int i = 0; i < n; ++i)
+        v[i] = r2[i] - r1;
+    }
+
+    virtual void nearestImageDistances2(const gmath::Vec &r1,
+            const gmath::Vec *r2, int n,
+            const gcore::Box &box, double *d2) const {
+      for (int i = 0; i < n; ++i)
+        d2[i] = (r2[i] - r1).abs2();
+    }
+
     // overwrite gathering methods as they do not make sense for vacuum
     virtual void nogather() {
     }
@@ -41,6 +41,7 @@
 #include "../utils/AtomSpecifier.h"
 
 #include "FastRotationalFit.h"
+#include "QuaternionFit.h"
 
 using gmath::Matrix;
 using gmath::Vec;
@@ -107,11 +108,7 @@ int FastRotationalFit::fit(utils::AtomSpecifier & ref_spec,
   }
   
   Matrix rot(3,3,0.0);
-  int error;
-  if (d_kabsch_fit)
-    error = kabsch_fit(rot, v_ref, v_sys);
-  else
-    error = fit(rot, v_ref, v_sys);
+  int error = fit(rot, v_ref, v_sys);
   
   if (error){
     std::ostringstream os;
@@ -127,12 +124,7 @@ int FastRotationalFit::fit(vector<Vec> const &ref,
 			   vector<Vec> &sys)const{
 
   Matrix r(3,3,0);
-  int error;
-
-  if (d_kabsch_fit)
-    error = kabsch_fit(r,ref, sys);
-  else
-    error = fit(r,ref, sys);
+  int error = fit(r,ref, sys);
 
   if(error)
     return error;
@@ -148,6 +140,69 @@ int FastRotationalFit::fit(vector<Vec> const &ref,
 int FastRotationalFit::fit(Matrix &rot,
 			   vector<Vec> const &ref, 
 			   vector<Vec> const &sys)const{
+  if (d_kabsch_fit)
+    return kabsch_fit(rot, ref, sys);
+  if (d_eigen_fit)
+    return eigen_fit(rot, ref, sys);
+
+  double r[9];
+  qcp_fit(r, ref, sys);
+  for(int i=0;i<3;++i)
+    for(int j=0;j<3;++j)
+      rot(i,j) = r[3 * i + j];
+  return 0;
+}
+
+double FastRotationalFit::qcp_fit(double *rot,
+				  vector<Vec> const &ref,
+				  vector<Vec> const &sys)const{
+  const int num = ref.size();
+  double A[9];
+  double E0;
+  if (d_fit_spec.size()) {
+    E0 = QuaternionFit::innerProduct(A, num, &ref[0], &sys[0], &d_fit_weight[0]);
+    return QuaternionFit::rmsd(A, E0, d_fit_num_atoms, rot);
+  }
+  E0 = QuaternionFit::innerProduct(A, num, &ref[0], &sys[0]);
+  return QuaternionFit::rmsd(A, E0, num, rot);
+}
+
+int FastRotationalFit::fit_rmsd(double &rmsd,
+				vector<Vec> const &ref,
+				vector<Vec> const &sys)const{
+  if (d_kabsch_fit || d_eigen_fit) {
+    Matrix rot(3,3,0.0);
+    int error = fit(rot, ref, sys);
+    if (!error)
+      rmsd = this->rmsd(rot, ref, sys);
+    return error;
+  }
+  // the fitted atoms are the rmsd atoms
+  if (d_rmsd_spec == d_fit_spec) {
+    rmsd = qcp_fit(NULL, ref, sys);
+    return 0;
+  }
+
+  double rot[9];
+  qcp_fit(rot, ref, sys);
+  double rmsd2 = 0.0;
+  int num = 0;
+  for (size_t i = 0; i < ref.size(); ++i) {
+    if (d_rmsd_spec.size() && !d_rmsd_spec[i]) continue;
+    for (int j = 0; j < 3; ++j) {
+      const double temp = rot[3 * j] * sys[i][0] + rot[3 * j + 1] * sys[i][1]
+              + rot[3 * j + 2] * sys[i][2];
+      rmsd2 += (ref[i][j] - temp) * (ref[i][j] - temp);
+    }
+    ++num;
+  }
+  rmsd = sqrt(rmsd2 / num);
+  return 0;
+}
+
+int FastRotationalFit::eigen_fit(Matrix &rot,
+				 vector<Vec> const &ref, 
+				 vector<Vec> const &sys)const{
   
   size_t num = ref.size();
   
@@ -32,7 +32,11 @@ namespace fit{
    * This class performs a rotational fit on a set of coordinates
    *
    * A least squares fitting of one set of atoms is performed relative to 
-   * another. 
+   * another. By default the rotation is calculated by the quaternion
+   * characteristic polynomial method (fit::QuaternionFit), which needs no
+   * memory allocation and gives the rmsd of the fitted atoms in closed
+   * form. The previous eigenvector method (using GSL) and the Kabsch
+   * algorithm can be selected instead, e.g. for validation.
    *
    * @class FastRotationalFit
    * @author Markus Christen, Chris Oostenbrink
@@ -63,13 +67,22 @@ namespace fit{
      * use Kabsch rotational fit
      */
     bool d_kabsch_fit;
+    /**
+     * use the eigenvectors of the 6x6 omega matrix (GSL)
+     */
+    bool d_eigen_fit;
+    /**
+     * d_fit_spec as weights of one and zero
+     */
+    std::vector<double> d_fit_weight;
     
   public:
     /**
      * Constructor: no specifications
      */
     FastRotationalFit() 
-      : d_fit_spec(0), d_fit_num_atoms(0), d_rmsd_spec(0), d_rmsd_num_atoms(0), d_kabsch_fit(false)  {};
+      : d_fit_spec(0), d_fit_num_atoms(0), d_rmsd_spec(0), d_rmsd_num_atoms(0), d_kabsch_fit(false),
+	d_eigen_fit(false)  {};
     /**
      * Constructor
      */
@@ -78,9 +91,14 @@ namespace fit{
 	d_fit_num_atoms(0),
 	d_rmsd_spec(rmsd_spec),
 	d_rmsd_num_atoms(0),
-	d_kabsch_fit(false) {
+	d_kabsch_fit(false),
+	d_eigen_fit(false),
+	d_fit_weight(fit_spec.size(), 0.0) {
       for(size_t i=0; i<d_fit_spec.size(); ++i)
-	if(d_fit_spec[i]) ++d_fit_num_atoms;
+	if(d_fit_spec[i]) {
+	  ++d_fit_num_atoms;
+	  d_fit_weight[i] = 1.0;
+	}
       for(size_t i=0; i<d_rmsd_spec.size(); ++i)
 	if(d_rmsd_spec[i]) ++d_rmsd_num_atoms;
     };
@@ -126,6 +144,31 @@ namespace fit{
     int kabsch_fit(gmath::Matrix &rot,
 		   std::vector<gmath::Vec> const &ref,
 		   std::vector<gmath::Vec> const &sys)const;
+
+    /**
+     * calculate rotation matrix to do a rotational fit
+     * using the atoms specified for fitting
+     * uses the eigenvectors of the 6x6 omega matrix (GSL)
+     * @param rot [out] rotation matrix
+     * @param ref reference coordinates
+     * @param sys coordinates to fit
+     */
+    int eigen_fit(gmath::Matrix &rot,
+		  std::vector<gmath::Vec> const &ref,
+		  std::vector<gmath::Vec> const &sys)const;
+
+    /**
+     * quaternion characteristic polynomial fit using the atoms
+     * specified for fitting
+     * @param rot [out] rotation matrix (row major), only calculated if
+     *            not NULL
+     * @param ref reference coordinates
+     * @param sys coordinates to fit
+     * @return rmsd of the atoms used for fitting after the fit
+     */
+    double qcp_fit(double *rot,
+		   std::vector<gmath::Vec> const &ref,
+		   std::vector<gmath::Vec> const &sys)const;
     
     /**
      * calculate the rmsd (using atoms specified for rmsd) on (reduced) atom positions
@@ -134,12 +177,32 @@ namespace fit{
     double rmsd(gmath::Matrix const & rot,
 		std::vector<gmath::Vec> const &ref,
 		std::vector<gmath::Vec> const &sys)const;
+
+    /**
+     * calculate the rmsd (using atoms specified for rmsd) after a
+     * rotational fit (using atoms specified for fitting) of sys to ref.
+     * With the default (QCP) method and the same atoms for fit and rmsd
+     * the rotation is not calculated.
+     * @param rmsd [out] the rmsd
+     * @return error code of the fit (see fit)
+     */
+    int fit_rmsd(double &rmsd,
+		 std::vector<gmath::Vec> const &ref,
+		 std::vector<gmath::Vec> const &sys)const;
     
     void set_kabsch_fit(bool b)
     {
       d_kabsch_fit = b;
     }
 
+    /**
+     * use the eigenvector method (GSL) instead of QCP
+     */
+    void set_eigen_fit(bool b)
+    {
+      d_eigen_fit = b;
+    }
+
     /**
      * FastRotationalFit exception
      */
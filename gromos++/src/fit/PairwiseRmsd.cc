@@ -0,0 +1,154 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// fit_PairwiseRmsd.cc
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "../gmath/Vec.h"
+#include "../gromos/Exception.h"
+#include "QuaternionFit.h"
+#include "PairwiseRmsd.h"
+
+using fit::PairwiseRmsd;
+using fit::QuaternionFit;
+using gmath::Vec;
+using namespace std;
+
+PairwiseRmsd::PairwiseRmsd(const vector<bool> &fit_spec,
+        const vector<bool> &rmsd_spec) :
+d_fit_spec(fit_spec), d_rmsd_spec(rmsd_spec),
+d_same(fit_spec == rmsd_spec), d_num_fit(0), d_num_rmsd(0),
+d_num_frames(0) {
+}
+
+// appends the selected positions in structure of arrays layout, returns
+// their summed squared norm
+static double append(const vector<Vec> &frame, const vector<bool> &spec,
+        int num, vector<double> &data) {
+  const size_t start = data.size();
+  data.resize(start + 3 * num);
+  double *x = &data[start], *y = x + num, *z = y + num;
+  double norm = 0.0;
+  for (size_t i = 0, k = 0; i < frame.size(); ++i) {
+    if (spec.size() && !spec[i]) continue;
+    x[k] = frame[i][0];
+    y[k] = frame[i][1];
+    z[k] = frame[i][2];
+    norm += frame[i].abs2();
+    ++k;
+  }
+  return norm;
+}
+
+static int count(const vector<bool> &spec, int size) {
+  if (spec.empty()) return size;
+  int n = 0;
+  for (size_t i = 0; i < spec.size(); ++i)
+    if (spec[i]) ++n;
+  return n;
+}
+
+void PairwiseRmsd::addFrame(const vector<Vec> &frame) {
+  if (d_num_frames == 0) {
+    d_num_fit = count(d_fit_spec, frame.size());
+    d_num_rmsd = count(d_rmsd_spec, frame.size());
+  }
+  if ((d_fit_spec.size() && d_fit_spec.size() != frame.size()) ||
+          (d_rmsd_spec.size() && d_rmsd_spec.size() != frame.size()) ||
+          (d_fit_spec.empty() && d_num_fit != int(frame.size())))
+    throw gromos::Exception("PairwiseRmsd",
+          "all structures need the same number of atoms");
+
+  d_fit_norm.push_back(append(frame, d_fit_spec, d_num_fit, d_fit));
+  if (!d_same)
+    d_rmsd_norm.push_back(append(frame, d_rmsd_spec, d_num_rmsd, d_rmsd));
+  ++d_num_frames;
+}
+
+double PairwiseRmsd::rmsd(int i, int j)const {
+  assert(i >= 0 && i < d_num_frames && j >= 0 && j < d_num_frames);
+  const int n = d_num_fit;
+  const double *r = &d_fit[3 * size_t(i) * n], *s = &d_fit[3 * size_t(j) * n];
+  double A[9];
+  QuaternionFit::correlation(A, n, r, r + n, r + 2 * n, s, s + n, s + 2 * n);
+  const double E0 = 0.5 * (d_fit_norm[i] + d_fit_norm[j]);
+  if (d_same)
+    return QuaternionFit::rmsd(A, E0, n);
+
+  // sum (r - R s)^2 = |r|^2 + |s|^2 - 2 sum_kl R_kl A_kl
+  double rot[9];
+  QuaternionFit::rmsd(A, E0, n, rot);
+  const int m = d_num_rmsd;
+  r = &d_rmsd[3 * size_t(i) * m];
+  s = &d_rmsd[3 * size_t(j) * m];
+  QuaternionFit::correlation(A, m, r, r + m, r + 2 * m, s, s + m, s + 2 * m);
+  double trace = 0.0;
+  for (int k = 0; k < 9; ++k)
+    trace += rot[k] * A[k];
+  const double rmsd2 = (d_rmsd_norm[i] + d_rmsd_norm[j] - 2.0 * trace) / m;
+  return rmsd2 > 0.0 ? sqrt(rmsd2) : 0.0;
+}
+
+double PairwiseRmsd::lowerBound(int i, int j)const {
+  // |r - R s| >= | |r| - |s| | for any rotation R
+  const vector<double> &norm = d_same ? d_fit_norm : d_rmsd_norm;
+  const int n = d_same ? d_num_fit : d_num_rmsd;
+  return fabs(sqrt(norm[i] / n) - sqrt(norm[j] / n));
+}
+
+void PairwiseRmsd::rows(int begin, int end, double cutoff,
+        vector<double> &values)const {
+  assert(begin >= 0 && begin <= end && end <= d_num_frames);
+  const int N = d_num_frames;
+  // offset of row i in values
+  vector<size_t> offset(end - begin + 1, 0);
+  for (int i = begin; i < end; ++i)
+    offset[i - begin + 1] = offset[i - begin] + (N - 1 - i);
+  values.resize(offset.back());
+  if (values.empty()) return;
+
+  // a tile holds the structures jb <= j < jb + tile, which are compared
+  // to all structures of the rows while they are in the cache
+  const int first = begin + 1;
+  const int num_tiles = (N - first + tile - 1) / tile;
+  const double inf = numeric_limits<double>::infinity();
+
+#ifdef OMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int t = 0; t < num_tiles; ++t) {
+    const int jb = first + t * tile;
+    const int je = (jb + tile < N) ? jb + tile : N;
+    for (int i = begin; i < end && i + 1 < je; ++i) {
+      // row i starts with j = i + 1
+      const size_t row = offset[i - begin];
+      for (int j = (jb > i + 1 ? jb : i + 1); j < je; ++j) {
+        if (cutoff > 0.0 && lowerBound(i, j) > cutoff)
+          values[row + j - i - 1] = inf;
+        else
+          values[row + j - i - 1] = rmsd(i, j);
+      }
+    }
+  }
+}
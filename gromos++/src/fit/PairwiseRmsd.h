@@ -0,0 +1,121 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// fit_PairwiseRmsd.h
+
+#ifndef INCLUDED_FIT_PAIRWISERMSD
+#define INCLUDED_FIT_PAIRWISERMSD
+
+#include <vector>
+
+namespace gmath{
+  class Vec;
+}
+
+namespace fit{
+  /**
+   * Class PairwiseRmsd
+   * rmsds after a rotational fit between all pairs of a set of structures
+   *
+   * The structures are added once, centred by the caller, and stored as
+   * structure of arrays. Their norms are calculated when they are added,
+   * such that a pair only needs the correlation matrix of its positions
+   * and the closed form rmsd of fit::QuaternionFit. If the atoms used for
+   * the rmsd differ from those used for the fit, the rmsd follows from the
+   * rotation and a second correlation matrix.
+   *
+   * rows() calculates consecutive rows of the upper triangle of the rmsd
+   * matrix in tiles of structures that fit into the cache, distributed
+   * over the OpenMP threads. Pairs that are certainly further apart than
+   * a cutoff are skipped using the difference of the norms (radii of
+   * gyration) of the structures as a lower bound of their rmsd.
+   *
+   * The atom specifications follow fit::FastRotationalFit: an empty
+   * specification selects all atoms.
+   *
+   * @class PairwiseRmsd
+   * @ingroup fit
+   * @sa fit::FastRotationalFit
+   * @sa fit::QuaternionFit
+   */
+  class PairwiseRmsd{
+    std::vector<bool> d_fit_spec;
+    std::vector<bool> d_rmsd_spec;
+    bool d_same;
+    int d_num_fit;
+    int d_num_rmsd;
+    int d_num_frames;
+    /**
+     * fit (and rmsd) atoms: x, y and z of frame f start at 3 * f * d_num_fit
+     */
+    std::vector<double> d_fit;
+    /**
+     * rmsd atoms, if they differ from the fit atoms
+     */
+    std::vector<double> d_rmsd;
+    std::vector<double> d_fit_norm;
+    std::vector<double> d_rmsd_norm;
+
+  public:
+    /**
+     * number of structures in a tile of rows()
+     */
+    static const int tile = 64;
+    /**
+     * Constructor
+     * @param fit_spec atoms to fit to
+     * @param rmsd_spec atoms to take into account for the rmsd
+     */
+    PairwiseRmsd(const std::vector<bool> &fit_spec = std::vector<bool>(),
+            const std::vector<bool> &rmsd_spec = std::vector<bool>());
+    /**
+     * adds a structure. All structures need the same number of positions
+     * and have to be centred (at the centre of geometry of the fit atoms).
+     */
+    void addFrame(const std::vector<gmath::Vec> &frame);
+    /**
+     * Accessor, returns the number of structures
+     */
+    int numFrames()const;
+    /**
+     * rmsd between structures i and j after fitting j onto i
+     */
+    double rmsd(int i, int j)const;
+    /**
+     * a lower bound of rmsd(i, j): the difference of the root mean
+     * square distances of the atoms from the origin
+     */
+    double lowerBound(int i, int j)const;
+    /**
+     * calculates rmsd(i, j) for the rows begin <= i < end and all j > i,
+     * stored row after row in values. If cutoff is positive, the pairs
+     * with a lower bound above the cutoff are not calculated but set to
+     * infinity.
+     */
+    void rows(int begin, int end, double cutoff,
+            std::vector<double> &values)const;
+  };
+
+  inline int PairwiseRmsd::numFrames()const{
+    return d_num_frames;
+  }
+}
+
+#endif
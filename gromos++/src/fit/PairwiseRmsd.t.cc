@@ -0,0 +1,142 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// fit_PairwiseRmsd.t.cc
+
+// compares the rmsd matrix of PairwiseRmsd with FastRotationalFit
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "../gmath/Vec.h"
+#include "../gmath/Matrix.h"
+#include "../utils/AtomSpecifier.h"
+#include "FastRotationalFit.h"
+#include "PairwiseRmsd.h"
+
+using namespace std;
+using namespace fit;
+using gmath::Vec;
+using gmath::Matrix;
+
+double random(double range) {
+  return range * (2.0 * rand() / RAND_MAX - 1.0);
+}
+
+// perturbed copies of a structure, centred at the centre of the fit atoms
+void trajectory(int n, int frames, const vector<bool> &fit_spec,
+        vector<vector<Vec> > &traj) {
+  vector<Vec> base(n);
+  for (int i = 0; i < n; ++i)
+    base[i] = Vec(random(1.5), random(1.0), random(0.7));
+  traj.resize(frames);
+  for (int f = 0; f < frames; ++f) {
+    traj[f].resize(n);
+    const double noise = 0.05 + 0.3 * f / frames;
+    const Vec shift(random(1.0), random(1.0), random(1.0));
+    Vec cog;
+    int num = 0;
+    for (int i = 0; i < n; ++i) {
+      traj[f][i] = base[i] + shift +
+              Vec(random(noise), random(noise), random(noise));
+      if (fit_spec.empty() || fit_spec[i]) {
+        cog += traj[f][i];
+        ++num;
+      }
+    }
+    for (int i = 0; i < n; ++i) traj[f][i] -= cog / num;
+  }
+}
+
+void compare(const vector<bool> &fit_spec, const vector<bool> &rmsd_spec,
+        const vector<vector<Vec> > &traj) {
+  PairwiseRmsd pairs(fit_spec, rmsd_spec);
+  for (size_t f = 0; f < traj.size(); ++f)
+    pairs.addFrame(traj[f]);
+  const int N = pairs.numFrames();
+  assert(N == int(traj.size()));
+
+  FastRotationalFit frf(fit_spec, rmsd_spec);
+  Matrix rot(3, 3, 0.0);
+  vector<double> values;
+  // two blocks of rows
+  const int split = N / 3;
+  for (int b = 0; b < 2; ++b) {
+    const int begin = b ? split : 0, end = b ? N : split;
+    pairs.rows(begin, end, 0.0, values);
+    size_t k = 0;
+    for (int i = begin; i < end; ++i) {
+      for (int j = i + 1; j < N; ++j, ++k) {
+        frf.fit(rot, traj[i], traj[j]);
+        const double r = frf.rmsd(rot, traj[i], traj[j]);
+        assert(fabs(values[k] - r) < 1e-7);
+        assert(fabs(pairs.rmsd(i, j) - values[k]) < 1e-12);
+        assert(pairs.lowerBound(i, j) <= r + 1e-12);
+      }
+    }
+    assert(k == values.size());
+  }
+
+  // with a cutoff, only pairs that may be closer are calculated
+  const double cutoff = 0.15;
+  pairs.rows(0, N, cutoff, values);
+  size_t k = 0;
+  for (int i = 0; i < N; ++i) {
+    for (int j = i + 1; j < N; ++j, ++k) {
+      if (pairs.lowerBound(i, j) > cutoff)
+        assert(values[k] == numeric_limits<double>::infinity());
+      else
+        assert(values[k] == pairs.rmsd(i, j));
+    }
+  }
+}
+
+int main() {
+  srand(12);
+  vector<vector<Vec> > traj;
+  const int n = 90;
+  vector<bool> fit_spec(n, false), rmsd_spec(n, true), none;
+  for (int i = 0; i < n; i += 3) fit_spec[i] = true;
+
+  // more frames than a tile, with and without separate rmsd atoms
+  trajectory(n, 2 * PairwiseRmsd::tile + 17, none, traj);
+  compare(none, none, traj);
+  trajectory(n, 2 * PairwiseRmsd::tile + 17, fit_spec, traj);
+  compare(fit_spec, fit_spec, traj);
+  compare(fit_spec, rmsd_spec, traj);
+
+  // timing of a full matrix
+  trajectory(300, 1000, none, traj);
+  PairwiseRmsd pairs;
+  for (size_t f = 0; f < traj.size(); ++f)
+    pairs.addFrame(traj[f]);
+  vector<double> values;
+  clock_t start = clock();
+  pairs.rows(0, pairs.numFrames(), 0.0, values);
+  const double t = double(clock() - start) / CLOCKS_PER_SEC;
+  cout << values.size() << " rmsds of 300 atoms: " << t << " s" << endl;
+  return 0;
+}
@@ -0,0 +1,290 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// fit_QuaternionFit.cc
+
+#include <cmath>
+
+#include "../gmath/Vec.h"
+#include "../gmath/Matrix.h"
+#include "QuaternionFit.h"
+
+using fit::QuaternionFit;
+using gmath::Vec;
+using gmath::Matrix;
+
+// positions transposed at once by the gmath::Vec version of innerProduct
+static const int block = 64;
+
+double QuaternionFit::innerProduct(double A[9], int n,
+        const double *rx, const double *ry, const double *rz,
+        const double *sx, const double *sy, const double *sz,
+        const double *w) {
+  double a0 = 0.0, a1 = 0.0, a2 = 0.0, a3 = 0.0, a4 = 0.0, a5 = 0.0,
+          a6 = 0.0, a7 = 0.0, a8 = 0.0, g = 0.0;
+  if (w == 0) {
+#ifdef OMP
+#pragma omp simd reduction(+:a0,a1,a2,a3,a4,a5,a6,a7,a8,g)
+#endif
+    for (int i = 0; i < n; ++i) {
+      g += rx[i] * rx[i] + ry[i] * ry[i] + rz[i] * rz[i]
+              + sx[i] * sx[i] + sy[i] * sy[i] + sz[i] * sz[i];
+      a0 += rx[i] * sx[i]; a1 += rx[i] * sy[i]; a2 += rx[i] * sz[i];
+      a3 += ry[i] * sx[i]; a4 += ry[i] * sy[i]; a5 += ry[i] * sz[i];
+      a6 += rz[i] * sx[i]; a7 += rz[i] * sy[i]; a8 += rz[i] * sz[i];
+    }
+  } else {
+#ifdef OMP
+#pragma omp simd reduction(+:a0,a1,a2,a3,a4,a5,a6,a7,a8,g)
+#endif
+    for (int i = 0; i < n; ++i) {
+      const double wrx = w[i] * rx[i], wry = w[i] * ry[i], wrz = w[i] * rz[i];
+      g += wrx * rx[i] + wry * ry[i] + wrz * rz[i]
+              + w[i] * (sx[i] * sx[i] + sy[i] * sy[i] + sz[i] * sz[i]);
+      a0 += wrx * sx[i]; a1 += wrx * sy[i]; a2 += wrx * sz[i];
+      a3 += wry * sx[i]; a4 += wry * sy[i]; a5 += wry * sz[i];
+      a6 += wrz * sx[i]; a7 += wrz * sy[i]; a8 += wrz * sz[i];
+    }
+  }
+  A[0] = a0; A[1] = a1; A[2] = a2;
+  A[3] = a3; A[4] = a4; A[5] = a5;
+  A[6] = a6; A[7] = a7; A[8] = a8;
+  return 0.5 * g;
+}
+
+void QuaternionFit::correlation(double A[9], int n,
+        const double *rx, const double *ry, const double *rz,
+        const double *sx, const double *sy, const double *sz) {
+  double a0 = 0.0, a1 = 0.0, a2 = 0.0, a3 = 0.0, a4 = 0.0, a5 = 0.0,
+          a6 = 0.0, a7 = 0.0, a8 = 0.0;
+#ifdef OMP
+#pragma omp simd reduction(+:a0,a1,a2,a3,a4,a5,a6,a7,a8)
+#endif
+  for (int i = 0; i < n; ++i) {
+    a0 += rx[i] * sx[i]; a1 += rx[i] * sy[i]; a2 += rx[i] * sz[i];
+    a3 += ry[i] * sx[i]; a4 += ry[i] * sy[i]; a5 += ry[i] * sz[i];
+    a6 += rz[i] * sx[i]; a7 += rz[i] * sy[i]; a8 += rz[i] * sz[i];
+  }
+  A[0] = a0; A[1] = a1; A[2] = a2;
+  A[3] = a3; A[4] = a4; A[5] = a5;
+  A[6] = a6; A[7] = a7; A[8] = a8;
+}
+
+double QuaternionFit::innerProduct(double A[9], int n,
+        const Vec *r, const Vec *s, const double *w) {
+  double rx[block], ry[block], rz[block], sx[block], sy[block], sz[block];
+  double E0 = 0.0;
+  for (int k = 0; k < 9; ++k) A[k] = 0.0;
+  for (int b = 0; b < n; b += block) {
+    const int m = (n - b < block) ? n - b : block;
+    for (int i = 0; i < m; ++i) {
+      rx[i] = r[b + i][0]; ry[i] = r[b + i][1]; rz[i] = r[b + i][2];
+      sx[i] = s[b + i][0]; sy[i] = s[b + i][1]; sz[i] = s[b + i][2];
+    }
+    double Ab[9];
+    E0 += innerProduct(Ab, m, rx, ry, rz, sx, sy, sz, w ? w + b : 0);
+    for (int k = 0; k < 9; ++k) A[k] += Ab[k];
+  }
+  return E0;
+}
+
+// the largest eigenvalue of the (symmetric) key matrix and its eigenvector
+// from the diagonalisation
+static double largestEigenvalue(const double key[4][4],
+        double &q1, double &q2, double &q3, double &q4) {
+  Matrix m(4, 4);
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      m(i, j) = key[i][j];
+  double eigenValues[4];
+  const Matrix evec = m.diagonaliseSymmetric(eigenValues);
+  q1 = evec(0, 0);
+  q2 = evec(1, 0);
+  q3 = evec(2, 0);
+  q4 = evec(3, 0);
+  return eigenValues[0];
+}
+
+double QuaternionFit::rmsd(const double A[9], double E0, double wsum,
+        double *rot) {
+  const double Sxx = A[0], Sxy = A[1], Sxz = A[2];
+  const double Syx = A[3], Syy = A[4], Syz = A[5];
+  const double Szx = A[6], Szy = A[7], Szz = A[8];
+
+  const double Sxx2 = Sxx * Sxx, Syy2 = Syy * Syy, Szz2 = Szz * Szz;
+  const double Sxy2 = Sxy * Sxy, Syz2 = Syz * Syz, Sxz2 = Sxz * Sxz;
+  const double Syx2 = Syx * Syx, Szy2 = Szy * Szy, Szx2 = Szx * Szx;
+
+  const double SyzSzymSyySzz2 = 2.0 * (Syz * Szy - Syy * Szz);
+  const double Sxx2Syy2Szz2Syz2Szy2 = Syy2 + Szz2 - Sxx2 + Syz2 + Szy2;
+
+  // coefficients of the characteristic polynomial
+  // x^4 + c2 x^2 + c1 x + c0 of the key matrix
+  const double c2 = -2.0 * (Sxx2 + Syy2 + Szz2 + Sxy2 + Syx2 + Sxz2 + Szx2
+          + Syz2 + Szy2);
+  const double c1 = 8.0 * (Sxx * Syz * Szy + Syy * Szx * Sxz + Szz * Sxy * Syx
+          - Sxx * Syy * Szz - Syz * Szx * Sxy - Szy * Syx * Sxz);
+
+  const double SxzpSzx = Sxz + Szx, SyzpSzy = Syz + Szy, SxypSyx = Sxy + Syx;
+  const double SyzmSzy = Syz - Szy, SxzmSzx = Sxz - Szx, SxymSyx = Sxy - Syx;
+  const double SxxpSyy = Sxx + Syy, SxxmSyy = Sxx - Syy;
+  const double Sxy2Sxz2Syx2Szx2 = Sxy2 + Sxz2 - Syx2 - Szx2;
+
+  const double c0 = Sxy2Sxz2Syx2Szx2 * Sxy2Sxz2Syx2Szx2
+          + (Sxx2Syy2Szz2Syz2Szy2 + SyzSzymSyySzz2)
+          * (Sxx2Syy2Szz2Syz2Szy2 - SyzSzymSyySzz2)
+          + (-SxzpSzx * SyzmSzy + SxymSyx * (SxxmSyy - Szz))
+          * (-SxzmSzx * SyzpSzy + SxymSyx * (SxxmSyy + Szz))
+          + (-SxzpSzx * SyzpSzy - SxypSyx * (SxxpSyy - Szz))
+          * (-SxzmSzx * SyzmSzy - SxypSyx * (SxxpSyy + Szz))
+          + (SxypSyx * SyzpSzy + SxzpSzx * (SxxmSyy + Szz))
+          * (-SxymSyx * SyzmSzy + SxzpSzx * (SxxpSyy + Szz))
+          + (SxypSyx * SyzmSzy + SxzmSzx * (SxxmSyy - Szz))
+          * (-SxymSyx * SyzpSzy + SxzmSzx * (SxxpSyy - Szz));
+
+  // all positions at the origin
+  if (E0 == 0.0) {
+    if (rot != 0)
+      for (int k = 0; k < 9; ++k)
+        rot[k] = (k % 4 == 0) ? 1.0 : 0.0;
+    return 0.0;
+  }
+
+  // the key matrix
+  const double key[4][4] = {
+    {SxxpSyy + Szz, SyzmSzy, -SxzmSzx, SxymSyx},
+    {SyzmSzy, SxxmSyy - Szz, SxypSyx, SxzpSzx},
+    {-SxzmSzx, SxypSyx, Syy - Sxx - Szz, SyzpSzy},
+    {SxymSyx, SxzpSzx, SyzpSzy, Szz - SxxpSyy}};
+
+  // Newton-Raphson from the upper bound E0 to the largest root. The steps
+  // decrease lambda and stay above the root, which is not negative (the
+  // key matrix has no trace). Near a double root (collinear groups, two
+  // atoms) the derivative vanishes and rounding spoils the steps, then
+  // the key matrix is diagonalised instead.
+  double lambda = E0;
+  bool converged = false;
+  for (int i = 0; i < 50 && !converged; ++i) {
+    const double x2 = lambda * lambda;
+    const double b = (x2 + c2) * lambda;
+    const double a = b + c1;
+    const double step = (a * lambda + c0) / (2.0 * x2 * lambda + b + a);
+    converged = fabs(step) <= fabs(1.0e-15 * lambda);
+    if (!converged && !(step > 0.0 && step <= lambda))
+      break;
+    lambda -= step;
+  }
+
+  double q1 = 0.0, q2 = 0.0, q3 = 0.0, q4 = 0.0, qsqr = 0.0;
+  if (!converged) {
+    lambda = largestEigenvalue(key, q1, q2, q3, q4);
+    qsqr = 1.0;
+  }
+  const double rmsd = sqrt(fabs(2.0 * (E0 - lambda) / wsum));
+  if (rot == 0)
+    return rmsd;
+
+  if (converged) {
+    // the eigenvector of lambda from the cofactors of the shifted key
+    // matrix
+    const double a11 = key[0][0] - lambda, a12 = key[0][1],
+            a13 = key[0][2], a14 = key[0][3];
+    const double a21 = key[1][0], a22 = key[1][1] - lambda,
+            a23 = key[1][2], a24 = key[1][3];
+    const double a31 = key[2][0], a32 = key[2][1],
+            a33 = key[2][2] - lambda, a34 = key[2][3];
+    const double a41 = key[3][0], a42 = key[3][1], a43 = key[3][2],
+            a44 = key[3][3] - lambda;
+    const double a3344_4334 = a33 * a44 - a43 * a34,
+            a3244_4234 = a32 * a44 - a42 * a34;
+    const double a3243_4233 = a32 * a43 - a42 * a33,
+            a3143_4133 = a31 * a43 - a41 * a33;
+    const double a3144_4134 = a31 * a44 - a41 * a34,
+            a3142_4132 = a31 * a42 - a41 * a32;
+
+    q1 = a22 * a3344_4334 - a23 * a3244_4234 + a24 * a3243_4233;
+    q2 = -a21 * a3344_4334 + a23 * a3144_4134 - a24 * a3143_4133;
+    q3 = a21 * a3244_4234 - a22 * a3144_4134 + a24 * a3142_4132;
+    q4 = -a21 * a3243_4233 + a22 * a3143_4133 - a23 * a3142_4132;
+    qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+
+    // if a column of cofactors vanishes (degenerate eigenvalues), try the
+    // others. The cofactors are cubic in the key matrix, whose entries are
+    // bounded by E0, so the threshold is relative to E0^6 and does not
+    // depend on the length unit or the size of the group.
+    const double E03 = E0 * E0 * E0;
+    const double evecprec = 1.0e-6 * E03 * E03;
+    if (qsqr <= evecprec) {
+      q1 = a12 * a3344_4334 - a13 * a3244_4234 + a14 * a3243_4233;
+      q2 = -a11 * a3344_4334 + a13 * a3144_4134 - a14 * a3143_4133;
+      q3 = a11 * a3244_4234 - a12 * a3144_4134 + a14 * a3142_4132;
+      q4 = -a11 * a3243_4233 + a12 * a3143_4133 - a13 * a3142_4132;
+      qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+    }
+    if (qsqr <= evecprec) {
+      const double a1324_1423 = a13 * a24 - a14 * a23,
+              a1224_1422 = a12 * a24 - a14 * a22;
+      const double a1223_1322 = a12 * a23 - a13 * a22,
+              a1124_1421 = a11 * a24 - a14 * a21;
+      const double a1123_1321 = a11 * a23 - a13 * a21,
+              a1122_1221 = a11 * a22 - a12 * a21;
+
+      q1 = a42 * a1324_1423 - a43 * a1224_1422 + a44 * a1223_1322;
+      q2 = -a41 * a1324_1423 + a43 * a1124_1421 - a44 * a1123_1321;
+      q3 = a41 * a1224_1422 - a42 * a1124_1421 + a44 * a1122_1221;
+      q4 = -a41 * a1223_1322 + a42 * a1123_1321 - a43 * a1122_1221;
+      qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+
+      if (qsqr <= evecprec) {
+        q1 = a32 * a1324_1423 - a33 * a1224_1422 + a34 * a1223_1322;
+        q2 = -a31 * a1324_1423 + a33 * a1124_1421 - a34 * a1123_1321;
+        q3 = a31 * a1224_1422 - a32 * a1124_1421 + a34 * a1122_1221;
+        q4 = -a31 * a1223_1322 + a32 * a1123_1321 - a33 * a1122_1221;
+        qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+      }
+    }
+    // all cofactors vanish if the largest eigenvalue is degenerate
+    if (qsqr <= evecprec) {
+      largestEigenvalue(key, q1, q2, q3, q4);
+      qsqr = 1.0;
+    }
+  }
+
+  const double normq = sqrt(qsqr);
+  q1 /= normq;
+  q2 /= normq;
+  q3 /= normq;
+  q4 /= normq;
+
+  const double a2 = q1 * q1, x2 = q2 * q2, y2 = q3 * q3, z2 = q4 * q4;
+  const double xy = q2 * q3, az = q1 * q4, zx = q4 * q2;
+  const double ay = q1 * q3, yz = q3 * q4, ax = q1 * q2;
+
+  rot[0] = a2 + x2 - y2 - z2;
+  rot[1] = 2.0 * (xy + az);
+  rot[2] = 2.0 * (zx - ay);
+  rot[3] = 2.0 * (xy - az);
+  rot[4] = a2 - x2 + y2 - z2;
+  rot[5] = 2.0 * (yz + ax);
+  rot[6] = 2.0 * (zx + ay);
+  rot[7] = 2.0 * (yz - ax);
+  rot[8] = a2 - x2 - y2 + z2;
+  return rmsd;
+}
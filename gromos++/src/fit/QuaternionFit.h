@@ -0,0 +1,102 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// fit_QuaternionFit.h
+
+#ifndef INCLUDED_FIT_QUATERNIONFIT
+#define INCLUDED_FIT_QUATERNIONFIT
+
+namespace gmath{
+  class Vec;
+}
+
+namespace fit{
+  /**
+   * Class QuaternionFit
+   * least squares superposition by the quaternion characteristic
+   * polynomial (QCP) method
+   *
+   * The largest eigenvalue of the 4x4 key matrix of the quaternion
+   * formulation is found by Newton iterations on its characteristic
+   * polynomial, which gives the minimal rmsd in closed form. The rotation
+   * is only calculated if it is requested, from the eigenvector of that
+   * eigenvalue. Nothing is allocated, such that it can be called for every
+   * pair of structures.
+   *
+   * The coordinates have to be centred (at their weighted centre of
+   * geometry) by the caller. The rotation R minimises
+   * @f$\sum_n w_n (\mathbf{r}_n - R \mathbf{s}_n)^2@f$ for reference
+   * positions r and positions s and is always proper.
+   *
+   * References: D. L. Theobald, Acta Cryst. A61, 478 (2005);
+   * P. Liu, D. K. Agrafiotis, D. L. Theobald, J. Comput. Chem. 31, 1561
+   * (2010)
+   *
+   * @class QuaternionFit
+   * @ingroup fit
+   * @sa fit::FastRotationalFit
+   * @sa fit::RotationalFit
+   */
+  class QuaternionFit{
+    // not implemented
+    QuaternionFit();
+  public:
+    /**
+     * calculates the inner products of n positions given as structure of
+     * arrays.
+     * @param A [out] correlation matrix, A[3*i+j] = sum w r[i] s[j]
+     * @param w weights, or NULL for weights of one
+     * @return E0, half the sum of the weighted squared norms of all
+     *         positions
+     */
+    static double innerProduct(double A[9], int n,
+            const double *rx, const double *ry, const double *rz,
+            const double *sx, const double *sy, const double *sz,
+            const double *w = 0);
+    /**
+     * calculates only the correlation matrix of n positions given as
+     * structure of arrays, for callers that know the norms of the
+     * positions already
+     * @param A [out] correlation matrix, A[3*i+j] = sum r[i] s[j]
+     */
+    static void correlation(double A[9], int n,
+            const double *rx, const double *ry, const double *rz,
+            const double *sx, const double *sy, const double *sz);
+    /**
+     * calculates the inner products of n positions stored as gmath::Vec.
+     * They are transposed in blocks (on the stack) to structure of arrays
+     * layout.
+     */
+    static double innerProduct(double A[9], int n,
+            const gmath::Vec *r, const gmath::Vec *s, const double *w = 0);
+    /**
+     * calculates the rmsd after the optimal superposition and, if rot is
+     * given, the rotation
+     * @param A, E0 as calculated by innerProduct
+     * @param wsum the sum of the weights (number of atoms)
+     * @param rot [out] rotation matrix (row major) to apply to the
+     *            positions s
+     */
+    static double rmsd(const double A[9], double E0, double wsum,
+            double *rot = 0);
+  };
+}
+
+#endif
@@ -0,0 +1,216 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// fit_QuaternionFit.t.cc
+
+// compares the QCP fit of FastRotationalFit and RotationalFit with the
+// eigenvector method and times both
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+#include "../gmath/Vec.h"
+#include "../gmath/Matrix.h"
+#include "../utils/AtomSpecifier.h"
+#include "QuaternionFit.h"
+#include "FastRotationalFit.h"
+
+using namespace std;
+using namespace fit;
+using gmath::Vec;
+using gmath::Matrix;
+
+double random(double range) {
+  return range * (2.0 * rand() / RAND_MAX - 1.0);
+}
+
+// a random rotation from a random unit quaternion
+Matrix randomRotation() {
+  double q[4], norm = 0.0;
+  for (int i = 0; i < 4; ++i) {
+    q[i] = random(1.0);
+    norm += q[i] * q[i];
+  }
+  for (int i = 0; i < 4; ++i) q[i] /= sqrt(norm);
+  Matrix R(3, 3, 0.0);
+  R(0, 0) = 1 - 2 * (q[2] * q[2] + q[3] * q[3]);
+  R(0, 1) = 2 * (q[1] * q[2] - q[0] * q[3]);
+  R(0, 2) = 2 * (q[1] * q[3] + q[0] * q[2]);
+  R(1, 0) = 2 * (q[1] * q[2] + q[0] * q[3]);
+  R(1, 1) = 1 - 2 * (q[1] * q[1] + q[3] * q[3]);
+  R(1, 2) = 2 * (q[2] * q[3] - q[0] * q[1]);
+  R(2, 0) = 2 * (q[1] * q[3] - q[0] * q[2]);
+  R(2, 1) = 2 * (q[2] * q[3] + q[0] * q[1]);
+  R(2, 2) = 1 - 2 * (q[1] * q[1] + q[2] * q[2]);
+  return R;
+}
+
+// centred reference and a rotated, perturbed copy of it
+void structures(int n, double noise, vector<Vec> &ref, vector<Vec> &sys,
+        double scale = 1.0) {
+  ref.resize(n);
+  sys.resize(n);
+  Vec cr, cs;
+  for (int i = 0; i < n; ++i) {
+    ref[i] = scale * Vec(random(1.5), random(1.0), random(0.7));
+    cr += ref[i];
+  }
+  const Matrix R = randomRotation();
+  for (int i = 0; i < n; ++i) {
+    ref[i] -= cr / n;
+    sys[i] = R * (ref[i] + Vec(random(noise), random(noise), random(noise)));
+    cs += sys[i];
+  }
+  for (int i = 0; i < n; ++i) sys[i] -= cs / n;
+}
+
+void compare(FastRotationalFit &frf, const vector<Vec> &ref,
+        const vector<Vec> &sys) {
+  Matrix rot(3, 3, 0.0), rot_eigen(3, 3, 0.0);
+  frf.set_eigen_fit(false);
+  assert(frf.fit(rot, ref, sys) == 0);
+  const double r = frf.rmsd(rot, ref, sys);
+  double r_closed;
+  assert(frf.fit_rmsd(r_closed, ref, sys) == 0);
+
+  frf.set_eigen_fit(true);
+  assert(frf.eigen_fit(rot_eigen, ref, sys) == 0);
+  const double r_eigen = frf.rmsd(rot_eigen, ref, sys);
+
+  assert(fabs(r - r_eigen) < 1e-8);
+  // the closed form loses digits by cancellation for tiny rmsds
+  assert(fabs(r_closed - r) < 1e-7);
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      assert(fabs(rot(i, j) - rot_eigen(i, j)) < 1e-6);
+  frf.set_eigen_fit(false);
+}
+
+int main() {
+  srand(11);
+  vector<Vec> ref, sys;
+
+  // all atoms, different noise levels
+  for (int k = 0; k < 50; ++k) {
+    structures(5 + k * 7, 0.02 * (k % 5), ref, sys);
+    FastRotationalFit frf;
+    compare(frf, ref, sys);
+  }
+
+  // small groups of a few atoms at the nm scale: the returned rmsd has to be
+  // the residual of the returned rotation
+  for (int k = 0; k < 40; ++k) {
+    structures(3 + k % 8, 0.05, ref, sys, 0.15);
+    FastRotationalFit frf;
+    Matrix rot(3, 3, 0.0);
+    double r;
+    assert(frf.fit_rmsd(r, ref, sys) == 0);
+    assert(frf.fit(rot, ref, sys) == 0);
+    assert(r > 1e-3);
+    assert(fabs(frf.rmsd(rot, ref, sys) - r) < 1e-8);
+    // three atoms are planar, the eigenvector fit may return a reflection
+    if (ref.size() > 3) compare(frf, ref, sys);
+  }
+
+  // collinear groups and pairs of atoms: the largest eigenvalue is
+  // degenerate, but the rotation still has to give the returned rmsd
+  for (int k = 0; k < 20; ++k) {
+    const int n = 2 + k % 4;
+    const Matrix R = randomRotation();
+    const Vec axis(random(1.0), random(1.0), random(1.0));
+    ref.resize(n);
+    sys.resize(n);
+    Vec cr, cs;
+    for (int i = 0; i < n; ++i) {
+      ref[i] = (0.1 * i + random(0.05)) * axis;
+      cr += ref[i];
+    }
+    for (int i = 0; i < n; ++i) {
+      ref[i] -= cr / n;
+      // exactly collinear for even k, slightly bent for odd k
+      const double noise = (k % 2) ? 1e-4 : 0.0;
+      sys[i] = R * (ref[i] + Vec(random(noise), random(noise), random(noise)));
+      cs += sys[i];
+    }
+    for (int i = 0; i < n; ++i) sys[i] -= cs / n;
+    FastRotationalFit frf;
+    Matrix rot(3, 3, 0.0);
+    double r;
+    assert(frf.fit_rmsd(r, ref, sys) == 0);
+    assert(frf.fit(rot, ref, sys) == 0);
+    assert(fabs(frf.rmsd(rot, ref, sys) - r) < 1e-6);
+  }
+
+  // identical structures: identity
+  structures(40, 0.0, ref, ref);
+  {
+    FastRotationalFit frf;
+    Matrix rot(3, 3, 0.0);
+    frf.fit(rot, ref, ref);
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        assert(fabs(rot(i, j) - (i == j ? 1.0 : 0.0)) < 1e-10);
+    double r;
+    frf.fit_rmsd(r, ref, ref);
+    assert(r < 1e-6);
+  }
+
+  // different atoms for fit and rmsd
+  structures(120, 0.1, ref, sys);
+  vector<bool> fit_spec(120, false), rmsd_spec(120, true);
+  for (int i = 0; i < 120; i += 3) fit_spec[i] = true;
+  {
+    FastRotationalFit frf(fit_spec, rmsd_spec);
+    compare(frf, ref, sys);
+    FastRotationalFit same(fit_spec, fit_spec);
+    compare(same, ref, sys);
+  }
+
+  // timing for a protein backbone sized fit
+  structures(300, 0.1, ref, sys);
+  const int repeat = 20000;
+  FastRotationalFit frf;
+  Matrix rot(3, 3, 0.0);
+  double sum = 0.0;
+  clock_t start = clock();
+  frf.set_eigen_fit(true);
+  for (int k = 0; k < repeat; ++k) {
+    frf.fit(rot, ref, sys);
+    sum += frf.rmsd(rot, ref, sys);
+  }
+  const double t_eigen = double(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  frf.set_eigen_fit(false);
+  for (int k = 0; k < repeat; ++k) {
+    double r;
+    frf.fit_rmsd(r, ref, sys);
+    sum -= r;
+  }
+  const double t_qcp = double(clock() - start) / CLOCKS_PER_SEC;
+  assert(fabs(sum) < 1e-6 * repeat);
+
+  cout << repeat << " fits of 300 atoms: " << t_eigen << " s (eigenvectors), "
+          << t_qcp << " s (QCP)" << endl;
+  return 0;
+}
@@ -25,6 +25,7 @@
 #include "RotationalFit.h"
 #include "Reference.h"
 #include "PositionUtils.h"
+#include "QuaternionFit.h"
 #include "../gcore/System.h"
 #include "../gcore/Molecule.h"
 #include "../gcore/Box.h"
@@ -49,13 +50,16 @@ using utils::AtomSpecifier;
 // constructs the rotation Matrix
 static void rotationMatrix(gmath::Matrix *mat, const gcore::System &mol, const fit::Reference &w);
 static void rotationMatrix(gmath::Matrix *mat, AtomSpecifier& refatoms, AtomSpecifier& fitatoms);
+// constructs the rotation Matrix from the eigenvectors of the omega matrix
+static void eigenRotationMatrix(gmath::Matrix *mat, const gcore::System &mol, const fit::Reference &w);
+static void eigenRotationMatrix(gmath::Matrix *mat, AtomSpecifier& refatoms, AtomSpecifier& fitatoms);
 
-RotationalFit::RotationalFit(Reference *w){
+RotationalFit::RotationalFit(Reference *w) : d_eigen_fit(false) {
   d_ref=w;
   PositionUtils::shiftToCog(&w->sys(),*w);
 }
 
-RotationalFit::RotationalFit(AtomSpecifier& refatoms){
+RotationalFit::RotationalFit(AtomSpecifier& refatoms) : d_eigen_fit(false) {
   //System & ref = *(refatoms.sys());
   PositionUtils::shiftToCog(refatoms.sys(),refatoms);
 }
@@ -75,7 +79,10 @@ void RotationalFit::fit(gcore::System *sys)const{
 	  
   PositionUtils::shiftToCog(sys,*d_ref);
   Matrix rot(3,3);
-  rotationMatrix(&rot,*sys,*d_ref);
+  if (d_eigen_fit)
+    eigenRotationMatrix(&rot,*sys,*d_ref);
+  else
+    rotationMatrix(&rot,*sys,*d_ref);
 
   sys->box().K()=rot*sys->box().K();
   sys->box().L()=rot*sys->box().L();
@@ -98,7 +105,10 @@ void RotationalFit::fit( AtomSpecifier& refatoms, AtomSpecifier& fitatoms)const{
 	  
   PositionUtils::shiftToCog(&sys, fitatoms);
   Matrix rot(3,3);
-  rotationMatrix(&rot, refatoms, fitatoms);
+  if (d_eigen_fit)
+    eigenRotationMatrix(&rot, refatoms, fitatoms);
+  else
+    rotationMatrix(&rot, refatoms, fitatoms);
   PositionUtils::rotate(fitatoms.sys(),rot);
 }
 
@@ -106,6 +116,55 @@ void RotationalFit::fit( AtomSpecifier& refatoms, AtomSpecifier& fitatoms)const{
 static void rotationMatrix(Matrix *mat, const System &sys, const Reference &r){
 
   const System &ref = r.sys();
+
+  // A(i,j) = sum w ref[i] sys[j] and E0
+  double A[9] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  double E0 = 0.0, wsum = 0.0;
+  for(int m=0;m<ref.numMolecules();++m)
+    for(int n=0;n<ref.mol(m).numAtoms();++n){
+      const double w = r.weight(m,n);
+      if(w){
+        const Vec &x = ref.mol(m).pos(n), &y = sys.mol(m).pos(n);
+        for(int i=0;i<3;++i)
+          for(int j=0;j<3;++j)
+            A[3*i+j] += w*x[i]*y[j];
+        E0 += 0.5*w*(x.abs2() + y.abs2());
+        wsum += w;
+      }
+    }
+
+  double rot[9];
+  fit::QuaternionFit::rmsd(A, E0, wsum, rot);
+  for(int i=0;i<3;++i)
+    for(int j=0;j<3;++j)
+      (*mat)(i,j) = rot[3*i+j];
+}
+
+static void rotationMatrix(Matrix *mat, AtomSpecifier& refatoms, AtomSpecifier& fitatoms){
+
+  if (refatoms.size() != fitatoms.size())
+     throw RotationalFit::Exception("Number of reference and fit atoms for the Rotational Fit have to be the same!");
+
+  double A[9] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  double E0 = 0.0;
+  for(unsigned int m=0;m<refatoms.size();++m){
+    const Vec x = refatoms.pos(m), y = fitatoms.pos(m);
+    for(int i=0;i<3;++i)
+      for(int j=0;j<3;++j)
+        A[3*i+j] += x[i]*y[j];
+    E0 += 0.5*(x.abs2() + y.abs2());
+  }
+
+  double rot[9];
+  fit::QuaternionFit::rmsd(A, E0, refatoms.size(), rot);
+  for(int i=0;i<3;++i)
+    for(int j=0;j<3;++j)
+      (*mat)(i,j) = rot[3*i+j];
+}
+
+static void eigenRotationMatrix(Matrix *mat, const System &sys, const Reference &r){
+
+  const System &ref = r.sys();
   
   
   Matrix U(3,3,0);
@@ -190,7 +249,7 @@ static void rotationMatrix(Matrix *mat, const System &sys, const Reference &r){
  
 }
 
-static void rotationMatrix(Matrix *mat, AtomSpecifier& refatoms, AtomSpecifier& fitatoms){
+static void eigenRotationMatrix(Matrix *mat, AtomSpecifier& refatoms, AtomSpecifier& fitatoms){
 
   if (refatoms.size() != fitatoms.size())
      throw RotationalFit::Exception("Number of reference and fit atoms for the Rotational Fit have to be the same!");
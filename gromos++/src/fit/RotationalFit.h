@@ -40,7 +40,9 @@ namespace fit{
    *
    * A least squares fitting of one system is performed relative to a
    * reference system. The atoms that are taken into account are defined
-   * by the Reference class
+   * by the Reference class. The rotation is calculated by the quaternion
+   * characteristic polynomial method (fit::QuaternionFit); the previous
+   * eigenvector method (GSL) can be selected with setEigenFit.
    *
    * @class RotationalFit
    * @author R. Buergi
@@ -51,6 +53,7 @@ namespace fit{
    */
   class RotationalFit{
     Reference *d_ref;
+    bool d_eigen_fit;
 
     // not implemented
     RotationalFit();
@@ -86,6 +89,12 @@ namespace fit{
      * accessor to the reference;
      */
     Reference * getReference() { return d_ref; }
+
+    /**
+     * use the eigenvectors of the 6x6 omega matrix (GSL) instead of the
+     * quaternion method
+     */
+    void setEigenFit(bool b) { d_eigen_fit = b; }
     
     struct Exception: public gromos::Exception{
       Exception(const std::string &what): 
@@ -48,49 +48,27 @@ Molecule::Molecule(const MoleculeTopology &mt):
 
 Molecule::Molecule(const Molecule &mol):
   d_mt(new MoleculeTopology(*mol.d_mt)),
-  d_pos(mol.d_pos.size()),
-  d_vel(mol.d_vel.size()),
+  d_pos(mol.d_pos),
+  d_vel(mol.d_vel),
   d_bfac(mol.d_bfac.size()),
-  d_cosDisplacement(mol.d_cosDisplacement.size())
+  d_cosDisplacement(mol.d_cosDisplacement)
 {
-  for(int i=0; i<mol.numPos();++i)
-  {
-    d_pos[i]=new Vec(mol.pos(i));
-  }
-  for(int i=0; i<mol.numVel();++i){
-    d_vel[i]=new Vec(mol.vel(i));
-  }
   for(int i=0; i<mol.numBfac();++i){
     d_bfac[i]=0.0;
   }
-  for(int i=0; i<mol.numCosDisplacements();++i){
-    d_cosDisplacement[i] = new Vec(mol.cosDisplacement(i));
-  }
 }
 
 Molecule::~Molecule(){
   delete d_mt;
-  for(unsigned int i=0; i<d_pos.size();++i)
-    delete d_pos[i];
-
-  for(unsigned int i=0; i<d_vel.size();++i)
-    delete d_vel[i];
-
-  for(unsigned int i=0; i<d_cosDisplacement.size();++i)
-    delete d_cosDisplacement[i];
 }
 
 void Molecule::initPos(){
+  d_pos.clear();
   d_pos.resize(numAtoms());
-  for(int i=0; i < numAtoms(); ++i){
-    d_pos[i]=new Vec();
-  }
 }
 void Molecule::initVel(){
+  d_vel.clear();
   d_vel.resize(numAtoms());
-  for(int i=0; i < numAtoms(); ++i){
-    d_vel[i]=new Vec();
-  }
 }
 void Molecule::initBfac(){
   d_bfac.resize(numAtoms());
@@ -102,10 +80,8 @@ void Molecule::setBfac(int i, double b){
     d_bfac[i]=b;
 }
 void Molecule::initCosDisplacements(){
+  d_cosDisplacement.clear();
   d_cosDisplacement.resize(numAtoms());
-  for(int i=0; i < numAtoms(); ++i){
-    d_cosDisplacement[i]=new Vec();
-  }
 }
 MoleculeTopology &Molecule::topology()
 {
@@ -31,9 +31,7 @@
 #include <vector>
 #include <cassert>
 
-namespace gmath{
-class Vec;
-}
+#include "../gmath/VecArray.h"
 
 using gmath::Vec;
 
@@ -59,10 +57,10 @@ namespace gcore{
 
   class Molecule{
     MoleculeTopology *d_mt;
-    std::vector<Vec*> d_pos;
-    std::vector<Vec*> d_vel; 
+    gmath::VecArray d_pos;
+    gmath::VecArray d_vel; 
     std::vector<double> d_bfac; 
-    std::vector<Vec*> d_cosDisplacement;
+    gmath::VecArray d_cosDisplacement;
     
     // not implemented
     Molecule();
@@ -143,6 +141,25 @@ namespace gcore{
      * @return A gmath::Vec of three corrdinates
      */
     const Vec &cosDisplacement(int i)const;
+    /**
+     * Accessor, returns the contiguous coordinate array of the Molecule.
+     * positions().data() gives the coordinates as interleaved doubles
+     */
+    gmath::VecArray &positions();
+    /**
+     * Accessor, returns the contiguous coordinate array of the Molecule
+     * as a const
+     */
+    const gmath::VecArray &positions()const;
+    /**
+     * Accessor, returns the contiguous velocity array of the Molecule
+     */
+    gmath::VecArray &velocities();
+    /**
+     * Accessor, returns the contiguous velocity array of the Molecule
+     * as a const
+     */
+    const gmath::VecArray &velocities()const;
 
     /**
      * function to resize the coordinate array to the number of atoms
@@ -199,34 +216,50 @@ namespace gcore{
 
   inline Vec &Molecule::pos(int i){
     assert(i < this->numPos());
-    return *d_pos[i];
+    return d_pos[i];
   }
 
   inline const Vec &Molecule::pos(int i)const{
     assert (i < this->numPos());
-    return *d_pos[i];
+    return d_pos[i];
   }
 
   inline Vec &Molecule::vel(int i){
     assert(i < this->numVel());
-    return *d_vel[i];
+    return d_vel[i];
   }
   
   inline Vec &Molecule::cosDisplacement(int i){
     assert(i < this->numCosDisplacements());
-    return *d_cosDisplacement[i];
+    return d_cosDisplacement[i];
   }
 
   inline const Vec &Molecule::cosDisplacement(int i)const{
     assert (i < this->numCosDisplacements());
-    return *d_cosDisplacement[i];
+    return d_cosDisplacement[i];
   }
 
   inline const Vec &Molecule::vel(int i)const{
     assert (i < this->numVel());
-    return *d_vel[i];
+    return d_vel[i];
   }
   
+  inline gmath::VecArray &Molecule::positions(){
+    return d_pos;
+  }
+
+  inline const gmath::VecArray &Molecule::positions()const{
+    return d_pos;
+  }
+
+  inline gmath::VecArray &Molecule::velocities(){
+    return d_vel;
+  }
+
+  inline const gmath::VecArray &Molecule::velocities()const{
+    return d_vel;
+  }
+
   inline double Molecule::bfac(int i) const{
     assert(i < this->numBfac());
     return d_bfac[i];
@@ -48,75 +48,49 @@ d_numCosDisplacements(0) {
 
 Solvent::Solvent(const Solvent &solv):
   d_mt(new SolventTopology(*solv.d_mt)),
-  d_pos(solv.d_pos.size()),
-  d_vel(solv.d_vel.size()),
-  d_cosDisplacement(solv.d_cosDisplacement.size())
+  d_pos(solv.d_pos),
+  d_numPos(solv.d_numPos),
+  d_vel(solv.d_vel),
+  d_numVel(solv.d_numVel),
+  d_cosDisplacement(solv.d_cosDisplacement),
+  d_numCosDisplacements(solv.d_numCosDisplacements)
 {
-  for(int i=0; i<solv.numPos();++i){
-    d_pos[i]=new Vec(solv.pos(i));
-  }
-  d_numPos=solv.d_numPos;
-  for(int i=0; i<solv.numVel();++i){
-    d_vel[i]=new Vec(solv.vel(i));
-  }
-  d_numVel=solv.d_numVel;
-  for(int i=0; i<solv.numCosDisplacements();++i){
-    d_cosDisplacement[i]=new Vec(solv.cosDisplacement(i));
-  }
-  d_numCosDisplacements=solv.d_numCosDisplacements;
 }
 
 Solvent::~Solvent(){
   delete d_mt;
-  for(unsigned int i=0; i<d_pos.size();++i)
-    delete d_pos[i];
-  
-  for(unsigned int i=0; i<d_vel.size();++i)
-    delete d_vel[i];
-  
-  for(unsigned int i=0; i<d_cosDisplacement.size();++i)
-    delete d_cosDisplacement[i];
 }
 
 void Solvent::addPos(Vec v){
-  d_pos.push_back(new Vec(v));
+  d_pos.push_back(v);
   d_numPos++;
   return;
 }
 
 void Solvent::addVel(Vec v){
-  d_vel.push_back(new Vec(v));
+  d_vel.push_back(v);
   d_numVel++;
   return;
 }
 
 void Solvent::addCosDisplacement(Vec v){
-  d_cosDisplacement.push_back(new Vec(v));
+  d_cosDisplacement.push_back(v);
   d_numCosDisplacements++;
   return;
 }
 
 void Solvent::setNumPos(int i){
   d_numPos = i;
-  for(int j=d_pos.size();j > i;--j)
-    delete d_pos[j-1];
-
   d_pos.resize(i);
 }
 
 void Solvent::setNumVel(int i){
   d_numVel = i;
-  for(int j=d_vel.size();j > i;--j)
-    delete d_vel[j-1];
-
   d_vel.resize(i);
 }
 
 void Solvent::setNumCosDisplacements(int i){
   d_numCosDisplacements = i;
-  for(int j=d_cosDisplacement.size();j > i;--j)
-    delete d_cosDisplacement[j-1];
-
   d_cosDisplacement.resize(i);
 }
 
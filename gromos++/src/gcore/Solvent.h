@@ -31,9 +31,7 @@
 #include <vector>
 #include <cassert>
 
-namespace gmath{
-class Vec;
-}
+#include "../gmath/VecArray.h"
 
 using gmath::Vec;
 
@@ -60,11 +58,11 @@ namespace gcore{
    */
   class Solvent{
     SolventTopology *d_mt;
-    std::vector<Vec*> d_pos;
+    gmath::VecArray d_pos;
     int d_numPos;
-    std::vector<Vec*> d_vel;
+    gmath::VecArray d_vel;
     int d_numVel;
-    std::vector<Vec*> d_cosDisplacement;
+    gmath::VecArray d_cosDisplacement;
     int d_numCosDisplacements;
 
     // not implemented
@@ -145,6 +143,25 @@ namespace gcore{
      * @return A gmath::Vec containing three coordinates
      */
     const Vec &cosDisplacement(int i)const;
+    /**
+     * Accessor, returns the contiguous coordinate array of all solvent
+     * atoms. positions().data() gives the coordinates as interleaved doubles
+     */
+    gmath::VecArray &positions();
+    /**
+     * Accessor, returns the contiguous coordinate array of all solvent
+     * atoms as a const
+     */
+    const gmath::VecArray &positions()const;
+    /**
+     * Accessor, returns the contiguous velocity array of all solvent atoms
+     */
+    gmath::VecArray &velocities();
+    /**
+     * Accessor, returns the contiguous velocity array of all solvent atoms
+     * as a const
+     */
+    const gmath::VecArray &velocities()const;
     /**
      * Accessor, returns a SolventTopology containing the topological 
      * information for one (1) solvent molecule
@@ -162,8 +179,8 @@ namespace gcore{
      * Method to rescale the number of atoms in the Solvent
      *
      * This method allows you to set the total number of solvent atoms we have
-     * If i < numCoords then the memory containing the coordinates for all 
-     * atoms >i is released.
+     * If i < numCoords then the coordinates of all atoms >i are dropped,
+     * the memory is kept to be reused for the next configuration.
      * @param i The new total number of Solvent atoms in the class
      */
     void setNumPos(int i);
@@ -187,8 +204,8 @@ namespace gcore{
      * Method to rescale the number of velocity coordinates in the Solvent
      * velocity configuration.
      * This method allows you to set the total number of solvent atoms we have
-     * If i < numCoords then the memory containing the coordinates for all 
-     * atoms >i is released.
+     * If i < numCoords then the coordinates of all atoms >i are dropped,
+     * the memory is kept to be reused for the next configuration.
      * @param i The new total number of Solvent atoms in the class
      */
     void setNumVel(int i);
@@ -212,8 +229,8 @@ namespace gcore{
      * Method to rescale the number of COS displacements in the Solvent
      * configuration.
      * This method allows you to set the total number of solvent atoms we have
-     * If i < numCoords then the memory containing the coordinates for all 
-     * atoms >i is released.
+     * If i < numCoords then the coordinates of all atoms >i are dropped,
+     * the memory is kept to be reused for the next configuration.
      * @param i The new total number of Solvent atoms in the class
      */
     void setNumCosDisplacements(int i);
@@ -235,32 +252,48 @@ namespace gcore{
 
   inline Vec &Solvent::pos(int i){
     assert(i < (this->numPos()));
-    return *d_pos[i];
+    return d_pos[i];
   }
 
   inline const Vec &Solvent::pos(int i)const{
     assert (i < (this->numPos()));
-    return *d_pos[i];
+    return d_pos[i];
   }
 
   inline Vec &Solvent::vel(int i){
     assert(i < (this->numVel()));
-    return *d_vel[i];
+    return d_vel[i];
   }
 
   inline const Vec &Solvent::vel(int i)const{
     assert (i < (this->numVel()));
-    return *d_vel[i];
+    return d_vel[i];
   }
   
+  inline gmath::VecArray &Solvent::positions(){
+    return d_pos;
+  }
+
+  inline const gmath::VecArray &Solvent::positions()const{
+    return d_pos;
+  }
+
+  inline gmath::VecArray &Solvent::velocities(){
+    return d_vel;
+  }
+
+  inline const gmath::VecArray &Solvent::velocities()const{
+    return d_vel;
+  }
+
   inline Vec &Solvent::cosDisplacement(int i){
     assert(i < (this->numCosDisplacements()));
-    return *d_cosDisplacement[i];
+    return d_cosDisplacement[i];
   }
 
   inline const Vec &Solvent::cosDisplacement(int i)const{
     assert (i < (this->numCosDisplacements()));
-    return *d_cosDisplacement[i];
+    return d_cosDisplacement[i];
   }
   
 } /* Namespace */ 
@@ -20,6 +20,7 @@
 
 // gcore_System.cc
 
+#include <algorithm>
 #include <cassert>
 #include <set>
 #include <new>
@@ -120,6 +121,58 @@ System &System::operator=(const System &sys){
   return *this;
 }
 
+void System::copyConfiguration(const System &sys, bool solute, bool solvent){
+  const int numMol = std::min(numMolecules(), sys.numMolecules());
+  for (int m = 0; m < numMol; ++m) {
+    Molecule &mol = this->mol(m);
+    const Molecule &from = sys.mol(m);
+    if (sys.hasPos && (solute || !mol.numPos()))
+      mol.positions() = from.positions();
+    if (sys.hasVel && (solute || !mol.numVel()))
+      mol.velocities() = from.velocities();
+    if (sys.hasCosDisplacements && (solute || !mol.numCosDisplacements())) {
+      if (mol.numCosDisplacements() != from.numCosDisplacements())
+        mol.initCosDisplacements();
+      for (int i = 0; i < from.numCosDisplacements(); ++i)
+        mol.cosDisplacement(i) = from.cosDisplacement(i);
+    }
+    if (!mol.numBfac())
+      mol.initBfac();
+  }
+
+  if (solvent && numSolvents() && sys.numSolvents()) {
+    Solvent &sol = this->sol(0);
+    const Solvent &from = sys.sol(0);
+    if (sys.hasPos) {
+      sol.setNumPos(from.numPos());
+      for (int i = 0; i < from.numPos(); ++i)
+        sol.pos(i) = from.pos(i);
+    }
+    if (sys.hasVel) {
+      sol.setNumVel(from.numVel());
+      for (int i = 0; i < from.numVel(); ++i)
+        sol.vel(i) = from.vel(i);
+    }
+    if (sys.hasCosDisplacements) {
+      sol.setNumCosDisplacements(from.numCosDisplacements());
+      for (int i = 0; i < from.numCosDisplacements(); ++i)
+        sol.cosDisplacement(i) = from.cosDisplacement(i);
+    }
+  }
+
+  if (sys.hasBox)
+    box() = sys.box();
+  if (sys.hasRemd)
+    remd() = sys.remd();
+
+  hasPos = sys.hasPos;
+  hasLatticeshifts = sys.hasLatticeshifts;
+  hasVel = sys.hasVel;
+  hasCosDisplacements = sys.hasCosDisplacements;
+  hasBox = sys.hasBox;
+  hasRemd = sys.hasRemd;
+}
+
 void System::addMolecule(const Molecule &mol){
   d_mol.push_back(new Molecule(mol));
 }
@@ -117,6 +117,17 @@ namespace gcore{
      * Member operator = copies one System into the other
      */
     System &operator=(const System &sys);
+    /**
+     * Copies the configuration of a system with the same topology: 
+     * positions, velocities, COS displacements, box and REMD information
+     * (as far as sys has them, see hasPos etc.). The coordinate memory is
+     * reused, so references to coordinates of this system stay valid.
+     * @param sys the system to copy from
+     * @param solute copy the solute
+     * @param solvent copy the solvent
+     */
+    void copyConfiguration(const System &sys, bool solute = true, 
+            bool solvent = true);
     /**
      * Method to add a Molecule to your system
      *
@@ -43,18 +43,18 @@ VirtualAtoms::VirtualAtoms(){}
 VirtualAtoms::VirtualAtoms(utils::AtomSpecifier as, gcore::GromosForceField &gff)
 {
   for(unsigned int i =0; i< as.size(); i++){
-    if(as.atom()[i]->type()==utils::spec_virtual){ 
+    if(as.type(i)==utils::spec_virtual){ 
       utils::VirtualAtom va(*(as.sys()), 
- 	                    as.atom()[i]->conf(), 
-                            static_cast<utils::VirtualAtom::virtual_type>(as.atom()[i]->virtualType()));
-      va.setDish(gff.virtualAtomType(as.atom()[i]->virtualType()).dis1());
-      va.setDisc(gff.virtualAtomType(as.atom()[i]->virtualType()).dis2());
+ 	                    as.conf(i), 
+                            static_cast<utils::VirtualAtom::virtual_type>(as.virtualType(i)));
+      va.setDish(gff.virtualAtomType(as.virtualType(i)).dis1());
+      va.setDisc(gff.virtualAtomType(as.virtualType(i)).dis2());
       d_vas.push_back(va);
       d_iac.push_back(-1);
       d_charge.push_back(0.0);
       d_exclusion.push_back(gcore::Exclusion());
       d_exclusion14.push_back(gcore::Exclusion());
-    } else if(as.atom()[i]->type()==utils::spec_solute){
+    } else if(as.type(i)==utils::spec_solute){
       utils::VirtualAtom va(*(as.sys()),
                             as.mol(i),
                             as.atom(i),
@@ -88,18 +88,18 @@ VirtualAtoms::~VirtualAtoms()
 void VirtualAtoms::addVirtualAtom(utils::AtomSpecifier as, gcore::GromosForceField &gff, int iac, double charge, gcore::Exclusion e, gcore::Exclusion e14)
 {
 for(unsigned int i =0; i< as.size(); i++){
-    if(as.atom()[i]->type()==utils::spec_virtual){
+    if(as.type(i)==utils::spec_virtual){
       utils::VirtualAtom va(*(as.sys()),
-                            as.atom()[i]->conf(),
-                            static_cast<utils::VirtualAtom::virtual_type>(as.atom()[i]->virtualType()));
-      va.setDish(gff.virtualAtomType(as.atom()[i]->virtualType()).dis1());
-      va.setDisc(gff.virtualAtomType(as.atom()[i]->virtualType()).dis2());
+                            as.conf(i),
+                            static_cast<utils::VirtualAtom::virtual_type>(as.virtualType(i)));
+      va.setDish(gff.virtualAtomType(as.virtualType(i)).dis1());
+      va.setDisc(gff.virtualAtomType(as.virtualType(i)).dis2());
       d_vas.push_back(va);
       d_iac.push_back(iac);
       d_charge.push_back(charge);
       d_exclusion.push_back(e);
       d_exclusion14.push_back(e14);
-    } else if(as.atom()[i]->type()==utils::spec_solute){
+    } else if(as.type(i)==utils::spec_solute){
       utils::VirtualAtom va(*(as.sys()),
                             as.mol(i),
                             as.atom(i),
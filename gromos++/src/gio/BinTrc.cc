@@ -0,0 +1,439 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_BinTrc.cc
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <stdint.h>
+
+#include "BinTrc.h"
+#include "../gmath/Vec.h"
+#include "../gcore/Remd.h"
+
+namespace {
+  const char magic[8] = {'G', 'B', 'T', 'R', 'C', '\0', '0', '1'};
+  // "FRME"
+  const uint32_t frameMarker = 0x454d5246;
+
+  enum frameFlags {
+    hasTimestep = 1, hasBox = 2, hasRemd = 4
+  };
+
+  // little endian numbers appended to a string
+  class ByteWriter {
+    std::string &d_out;
+  public:
+    ByteWriter(std::string &out) : d_out(out) {}
+
+    void u32(uint32_t v) {
+      char b[4] = {char(v), char(v >> 8), char(v >> 16), char(v >> 24)};
+      d_out.append(b, 4);
+    }
+
+    void i32(int v) {
+      u32(uint32_t(int32_t(v)));
+    }
+
+    void u8(unsigned int v) {
+      d_out.push_back(char(v));
+    }
+
+    void f64(double v) {
+      uint64_t u;
+      memcpy(&u, &v, 8);
+      u32(uint32_t(u));
+      u32(uint32_t(u >> 32));
+    }
+  };
+
+  // little endian numbers read from a buffer
+  class ByteReader {
+    const unsigned char *d_p;
+    const unsigned char *d_end;
+  public:
+    ByteReader(const char *b, const char *e) :
+    d_p(reinterpret_cast<const unsigned char *>(b)),
+    d_end(reinterpret_cast<const unsigned char *>(e)) {}
+
+    const unsigned char *need(size_t n) {
+      if (size_t(d_end - d_p) < n)
+        throw gio::BinTrc::Exception("frame is corrupted (too short)");
+      const unsigned char *p = d_p;
+      d_p += n;
+      return p;
+    }
+
+    uint32_t u32() {
+      const unsigned char *p = need(4);
+      return uint32_t(p[0]) | (uint32_t(p[1]) << 8) |
+              (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    int i32() {
+      return int32_t(u32());
+    }
+
+    unsigned int u8() {
+      return *need(1);
+    }
+
+    double f64() {
+      uint64_t u = u32();
+      u |= uint64_t(u32()) << 32;
+      double v;
+      memcpy(&v, &u, 8);
+      return v;
+    }
+
+    const char *bytes(size_t n) {
+      return reinterpret_cast<const char *>(need(n));
+    }
+  };
+
+  // bits appended to a string, lowest bits first
+  class BitWriter {
+    std::string &d_out;
+    uint64_t d_acc;
+    int d_num;
+  public:
+    BitWriter(std::string &out) : d_out(out), d_acc(0), d_num(0) {}
+
+    // bits <= 32
+    void put(uint32_t v, int bits) {
+      if (bits == 0) return;
+      d_acc |= uint64_t(v) << d_num;
+      d_num += bits;
+      while (d_num >= 8) {
+        d_out.push_back(char(d_acc));
+        d_acc >>= 8;
+        d_num -= 8;
+      }
+    }
+
+    void flush() {
+      if (d_num > 0) d_out.push_back(char(d_acc));
+      d_acc = 0;
+      d_num = 0;
+    }
+  };
+
+  class BitReader {
+    const unsigned char *d_p;
+    const unsigned char *d_end;
+    uint64_t d_acc;
+    int d_num;
+  public:
+    BitReader(const char *b, const char *e) :
+    d_p(reinterpret_cast<const unsigned char *>(b)),
+    d_end(reinterpret_cast<const unsigned char *>(e)), d_acc(0), d_num(0) {}
+
+    uint32_t get(int bits) {
+      if (bits == 0) return 0;
+      while (d_num < bits) {
+        if (d_p == d_end)
+          throw gio::BinTrc::Exception("frame is corrupted (coordinates)");
+        d_acc |= uint64_t(*d_p++) << d_num;
+        d_num += 8;
+      }
+      const uint32_t v = uint32_t(d_acc & ((uint64_t(1) << bits) - 1));
+      d_acc >>= bits;
+      d_num -= bits;
+      return v;
+    }
+  };
+
+  // number of bits needed for v
+  int numBits(uint64_t v) {
+    int n = 0;
+    for (; v; v >>= 1) ++n;
+    return n;
+  }
+
+  void encodeCoordinates(const std::vector<gmath::Vec> &pos, double precision,
+          std::string &out) {
+    ByteWriter w(out);
+    const size_t n = pos.size();
+    w.u32(uint32_t(n));
+    if (n == 0) return;
+    if (!(precision > 0.0))
+      throw gio::BinTrc::Exception("precision has to be positive");
+    w.f64(precision);
+
+    // fixed point coordinates and their range
+    std::vector<int64_t> q(3 * n);
+    int64_t minq[3], maxq[3];
+    for (size_t i = 0; i < n; ++i) {
+      for (int d = 0; d < 3; ++d) {
+        const double v = pos[i][d] * precision;
+        if (!(std::abs(v) < 1073741824.0))
+          throw gio::BinTrc::Exception("coordinate too large for the "
+                "precision of the binary trajectory");
+        const int64_t x = int64_t(std::floor(v + 0.5));
+        q[3 * i + d] = x;
+        if (i == 0 || x < minq[d]) minq[d] = x;
+        if (i == 0 || x > maxq[d]) maxq[d] = x;
+      }
+    }
+    int bits[3];
+    int fullBits = 1;
+    for (int d = 0; d < 3; ++d) {
+      bits[d] = numBits(uint64_t(maxq[d] - minq[d]));
+      fullBits += bits[d];
+    }
+
+    // bits needed for the difference to the previous atom
+    std::vector<unsigned char> need(n, 33);
+    std::vector<size_t> histogram(34, 0);
+    for (size_t i = 1; i < n; ++i) {
+      int s = 0;
+      for (int d = 0; d < 3; ++d) {
+        const int64_t delta = q[3 * i + d] - q[3 * (i - 1) + d];
+        const int b = numBits(uint64_t(delta >= 0 ? delta : -delta - 1)) + 1;
+        if (b > s) s = b;
+      }
+      need[i] = s;
+      ++histogram[s];
+    }
+    // the number of bits for differences which gives the smallest frame
+    int small = 1;
+    uint64_t best = 0;
+    for (int s = 1; s <= 32; ++s) {
+      uint64_t numSmall = 0;
+      for (int k = 0; k <= s; ++k) numSmall += histogram[k];
+      const uint64_t size = numSmall * (1 + 3 * s) + (n - numSmall) * fullBits;
+      if (s == 1 || size < best) {
+        best = size;
+        small = s;
+      }
+    }
+
+    for (int d = 0; d < 3; ++d) w.i32(int(minq[d]));
+    for (int d = 0; d < 3; ++d) w.u8(bits[d]);
+    w.u8(small);
+    std::string packed;
+    packed.reserve(best / 8 + 1);
+    BitWriter bw(packed);
+    const int64_t offset = int64_t(1) << (small - 1);
+    for (size_t i = 0; i < n; ++i) {
+      if (need[i] <= small) {
+        bw.put(1, 1);
+        for (int d = 0; d < 3; ++d)
+          bw.put(uint32_t(q[3 * i + d] - q[3 * (i - 1) + d] + offset), small);
+      } else {
+        bw.put(0, 1);
+        for (int d = 0; d < 3; ++d)
+          bw.put(uint32_t(q[3 * i + d] - minq[d]), bits[d]);
+      }
+    }
+    bw.flush();
+    w.u32(uint32_t(packed.size()));
+    out += packed;
+  }
+
+  void decodeCoordinates(ByteReader &r, double &precision,
+          std::vector<gmath::Vec> &pos) {
+    const size_t n = r.u32();
+    pos.resize(n);
+    if (n == 0) return;
+    precision = r.f64();
+    if (!(precision > 0.0))
+      throw gio::BinTrc::Exception("frame is corrupted (precision)");
+    int64_t minq[3];
+    int bits[3];
+    for (int d = 0; d < 3; ++d) minq[d] = r.i32();
+    for (int d = 0; d < 3; ++d) bits[d] = r.u8();
+    const int small = r.u8();
+    if (bits[0] > 32 || bits[1] > 32 || bits[2] > 32 || small < 1 ||
+            small > 32)
+      throw gio::BinTrc::Exception("frame is corrupted (bits)");
+    const size_t size = r.u32();
+    const char *packed = r.bytes(size);
+    BitReader br(packed, packed + size);
+
+    const int64_t offset = int64_t(1) << (small - 1);
+    int64_t prev[3] = {0, 0, 0};
+    for (size_t i = 0; i < n; ++i) {
+      int64_t x[3];
+      if (br.get(1)) {
+        if (i == 0)
+          throw gio::BinTrc::Exception("frame is corrupted (first atom)");
+        for (int d = 0; d < 3; ++d)
+          x[d] = prev[d] + int64_t(br.get(small)) - offset;
+      } else {
+        for (int d = 0; d < 3; ++d)
+          x[d] = minq[d] + int64_t(br.get(bits[d]));
+      }
+      for (int d = 0; d < 3; ++d) {
+        pos[i][d] = double(x[d]) / precision;
+        prev[d] = x[d];
+      }
+    }
+  }
+
+  // reads the frame marker and size, false at the end of the file
+  bool readFrameHeader(std::istream &is, uint32_t &size) {
+    char b[8];
+    is.read(b, 8);
+    if (is.gcount() == 0 && is.eof()) return false;
+    if (is.gcount() != 8)
+      throw gio::BinTrc::Exception("binary trajectory is truncated");
+    ByteReader r(b, b + 8);
+    if (r.u32() != frameMarker)
+      throw gio::BinTrc::Exception("binary trajectory is corrupted "
+            "(no frame marker)");
+    size = r.u32();
+    return true;
+  }
+}
+
+bool gio::BinTrc::readMagic(std::istream &is) {
+  char b[8];
+  is.read(b, 8);
+  return is.gcount() == 8 && memcmp(b, magic, 8) == 0;
+}
+
+void gio::BinTrc::writeHeader(std::ostream &os, const std::string &title) {
+  std::string out(magic, 8);
+  ByteWriter w(out);
+  w.u32(uint32_t(title.size()));
+  out += title;
+  os.write(out.data(), out.size());
+}
+
+std::string gio::BinTrc::readTitle(std::istream &is) {
+  char b[4];
+  is.read(b, 4);
+  if (is.gcount() != 4)
+    throw Exception("binary trajectory is truncated (title)");
+  ByteReader r(b, b + 4);
+  std::string title(r.u32(), ' ');
+  if (!title.empty())
+    is.read(&title[0], title.size());
+  if (size_t(is.gcount()) != title.size())
+    throw Exception("binary trajectory is truncated (title)");
+  return title;
+}
+
+void gio::BinTrc::write(std::ostream &os, const Frame &frame) {
+  std::string payload;
+  ByteWriter w(payload);
+  w.u32((frame.hasTime ? hasTimestep : 0) | (frame.hasBox ? hasBox : 0) |
+          (frame.hasRemd ? hasRemd : 0));
+  if (frame.hasTime) {
+    w.i32(frame.step);
+    w.f64(frame.time);
+  }
+  if (frame.hasBox) {
+    w.i32(frame.ntb);
+    w.i32(frame.boxformat);
+    for (int d = 0; d < 3; ++d) w.f64(frame.K[d]);
+    for (int d = 0; d < 3; ++d) w.f64(frame.L[d]);
+    for (int d = 0; d < 3; ++d) w.f64(frame.M[d]);
+  }
+  if (frame.hasRemd) {
+    const gcore::Remd &remd = frame.remd;
+    w.i32(remd.id());
+    w.i32(remd.run());
+    w.i32(remd.Ti());
+    w.i32(remd.li());
+    w.i32(remd.Tj());
+    w.i32(remd.lj());
+    w.i32(remd.reeval());
+    w.f64(remd.temperature());
+    w.f64(remd.lambda());
+  }
+  encodeCoordinates(frame.pos, frame.precision, payload);
+
+  std::string header;
+  ByteWriter h(header);
+  h.u32(frameMarker);
+  h.u32(uint32_t(payload.size()));
+  os.write(header.data(), header.size());
+  os.write(payload.data(), payload.size());
+}
+
+bool gio::BinTrc::read(std::istream &is, Frame &frame) {
+  uint32_t size;
+  if (!readFrameHeader(is, size)) return false;
+  std::vector<char> payload(size);
+  if (size) is.read(&payload[0], size);
+  if (uint32_t(is.gcount()) != size)
+    throw Exception("binary trajectory is truncated");
+
+  ByteReader r(payload.empty() ? NULL : &payload[0],
+          payload.empty() ? NULL : &payload[0] + size);
+  const uint32_t flags = r.u32();
+  frame.hasTime = flags & hasTimestep;
+  if (frame.hasTime) {
+    frame.step = r.i32();
+    frame.time = r.f64();
+  }
+  frame.hasBox = flags & hasBox;
+  if (frame.hasBox) {
+    frame.ntb = r.i32();
+    frame.boxformat = r.i32();
+    for (int d = 0; d < 3; ++d) frame.K[d] = r.f64();
+    for (int d = 0; d < 3; ++d) frame.L[d] = r.f64();
+    for (int d = 0; d < 3; ++d) frame.M[d] = r.f64();
+  }
+  frame.hasRemd = flags & hasRemd;
+  if (frame.hasRemd) {
+    gcore::Remd &remd = frame.remd;
+    remd.id() = r.i32();
+    remd.run() = r.i32();
+    remd.Ti() = r.i32();
+    remd.li() = r.i32();
+    remd.Tj() = r.i32();
+    remd.lj() = r.i32();
+    remd.reeval() = r.i32();
+    remd.temperature() = r.f64();
+    remd.lambda() = r.f64();
+  }
+  decodeCoordinates(r, frame.precision, frame.pos);
+  return true;
+}
+
+bool gio::BinTrc::skip(std::istream &is, bool &hasTime, int &step,
+        double &time) {
+  uint32_t size;
+  if (!readFrameHeader(is, size)) return false;
+  char b[16];
+  const std::streamsize n = size < 16 ? size : 16;
+  is.read(b, n);
+  if (is.gcount() != n)
+    throw Exception("binary trajectory is truncated");
+  ByteReader r(b, b + n);
+  hasTime = r.u32() & hasTimestep;
+  if (hasTime) {
+    step = r.i32();
+    time = r.f64();
+  }
+  if (size > n) {
+    is.seekg(size - n, std::ios::cur);
+    if (!is)
+      throw Exception("binary trajectory is truncated");
+  }
+  return true;
+}
@@ -0,0 +1,120 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_BinTrc.h
+
+#ifndef INCLUDED_GIO_BINTRC
+#define INCLUDED_GIO_BINTRC
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include "../gmath/Vec.h"
+#include "../gcore/Remd.h"
+#include "../gromos/Exception.h"
+
+namespace gio{
+
+  /**
+   * Class BinTrc
+   * Encoding of the frames of binary coordinate trajectories (written by 
+   * gio::OutBinTrc and read by gio::InBinTrc or gio::InG96).
+   *
+   * A file starts with an 8 byte magic number and the title, followed by
+   * the frames. Every frame starts with a marker and the size of the frame
+   * in bytes such that frames can be skipped without decoding them. All 
+   * numbers are stored little endian.
+   *
+   * The coordinates are rounded to integer multiples of 1/precision and
+   * bit packed like in the XTC format: an atom is either stored relative 
+   * to the minimum of the frame with the number of bits needed for the 
+   * range of the frame, or, if it is close to the previous atom, as a 
+   * difference to the previous atom with a smaller number of bits. The 
+   * number of bits for the differences is chosen per frame such that 
+   * the frame gets smallest. With the default precision (1000 nm^-1) the
+   * frames are about ten times smaller than POSITIONRED blocks.
+   *
+   * @class BinTrc
+   * @ingroup gio
+   * @sa gio::OutBinTrc gio::InBinTrc
+   */
+  class BinTrc{
+  public:
+    /**
+     * A frame: coordinates and the TIMESTEP, box and REMD information
+     */
+    struct Frame{
+      bool hasTime;
+      int step;
+      double time;
+      bool hasBox;
+      int ntb;
+      int boxformat;
+      gmath::Vec K, L, M;
+      bool hasRemd;
+      gcore::Remd remd;
+      /**
+       * coordinates are stored to 1/precision
+       */
+      double precision;
+      std::vector<gmath::Vec> pos;
+
+      Frame() : hasTime(false), step(0), time(0.0), hasBox(false), ntb(0),
+      boxformat(0), hasRemd(false), precision(1000.0) {}
+    };
+
+    /**
+     * true if the stream starts with the magic number of binary 
+     * trajectories. The stream is positioned after the magic number.
+     */
+    static bool readMagic(std::istream &is);
+    /**
+     * write magic number and title
+     */
+    static void writeHeader(std::ostream &os, const std::string &title);
+    /**
+     * read the title (after the magic number)
+     */
+    static std::string readTitle(std::istream &is);
+    /**
+     * write a frame
+     */
+    static void write(std::ostream &os, const Frame &frame);
+    /**
+     * read a frame, returns false at the end of the file
+     */
+    static bool read(std::istream &is, Frame &frame);
+    /**
+     * skip a frame but read its time information, returns false at the end
+     * of the file
+     */
+    static bool skip(std::istream &is, bool &hasTime, int &step, 
+            double &time);
+
+    /**
+     * Exception
+     */
+    struct Exception: public gromos::Exception{
+      Exception(const std::string& what_arg) : 
+      gromos::Exception("BinTrc", what_arg){}
+    };
+  };
+}
+#endif
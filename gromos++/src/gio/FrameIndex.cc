@@ -0,0 +1,232 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_FrameIndex.cc
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <sys/stat.h>
+
+#include "FrameIndex.h"
+#include "Ginstream.h"
+#include "gzstream.h"
+
+gio::FrameIndex::FrameIndex(const std::string &name, bool build)
+: d_offset(),
+d_step(),
+d_time(),
+d_end(0),
+d_first(),
+d_hasTime(false) {
+  struct stat st;
+  if (stat(name.c_str(), &st) != 0)
+    throw Exception("could not stat file " + name);
+
+  if (readCache(name, st.st_size, st.st_mtime) || !build)
+    return;
+
+  this->build(name);
+  writeCache(name, st.st_size, st.st_mtime);
+}
+
+std::string gio::FrameIndex::cacheName(const std::string &name) {
+  return name + ".fidx";
+}
+
+int gio::FrameIndex::frameAt(double time)const {
+  if (!d_hasTime)
+    throw Exception("trajectory does not contain a TIMESTEP block in "
+          "every frame");
+  return std::lower_bound(d_time.begin(), d_time.end(), time) - d_time.begin();
+}
+
+void gio::FrameIndex::build(const std::string &name) {
+  // the file is scanned line by line (as seen by Ginstream::getline) 
+  // without any parsing except for the TIMESTEP blocks. igzstream reads 
+  // compressed (block gzip in parallel) and uncompressed files and the 
+  // offsets are counted in uncompressed bytes like seekg expects them.
+  igzstream file(name.c_str());
+  if (!file.is_open())
+    throw Exception("could not open file " + name);
+
+  d_offset.clear();
+  d_step.clear();
+  d_time.clear();
+  d_first = "";
+
+  std::vector<char> buffer(1 << 20);
+  // the beginning of a line which did not fit into the buffer
+  std::string carry;
+  std::streamoff pos = 0, lineStart = 0;
+  bool inside = false, timestep = false;
+  int numTime = 0;
+
+  std::streamsize num;
+  while ((num = file.rdbuf()->sgetn(&buffer[0], buffer.size())) > 0) {
+    const char *p = &buffer[0];
+    const char * const bufEnd = p + num;
+    while (p < bufEnd) {
+      const char *nl = static_cast<const char *> (memchr(p, '\n', bufEnd - p));
+      if (nl == NULL) {
+        carry.append(p, bufEnd);
+        break;
+      }
+      if (carry.empty()) {
+        scanLine(p, nl, lineStart, inside, timestep, numTime);
+      } else {
+        carry.append(p, nl);
+        scanLine(carry.data(), carry.data() + carry.size(), lineStart,
+                inside, timestep, numTime);
+        carry.clear();
+      }
+      p = nl + 1;
+      lineStart = pos + (p - &buffer[0]);
+    }
+    pos += num;
+  }
+  // last line without newline
+  if (!carry.empty())
+    scanLine(carry.data(), carry.data() + carry.size(), lineStart,
+          inside, timestep, numTime);
+  file.close();
+
+  d_end = pos;
+  d_hasTime = !d_offset.empty() && numTime == int(d_offset.size());
+}
+
+void gio::FrameIndex::scanLine(const char *b, const char *e,
+        std::streamoff start, bool &inside, bool &timestep, int &numTime) {
+  // remove comments and trailing spaces
+  const char *hash = static_cast<const char *> (memchr(b, '#', e - b));
+  if (hash == b) return;
+  if (hash != NULL) e = hash;
+  while (e > b && e[-1] == ' ') --e;
+  if (e == b) return;
+
+  if (inside) {
+    if (e - b >= 3 && strncmp(b, "END", 3) == 0) {
+      inside = false;
+    } else if (timestep) {
+      std::istringstream line(std::string(b, e));
+      line >> d_step.back() >> d_time.back();
+      if (!line.fail()) ++numTime;
+      timestep = false;
+    }
+    return;
+  }
+
+  // a block name
+  const std::string block(b, e);
+  inside = true;
+  if (d_first.empty() && block != "TITLE" && block != "ENEVERSION")
+    d_first = block;
+  if (block == d_first) {
+    d_offset.push_back(start);
+    d_step.push_back(0);
+    d_time.push_back(0.0);
+  }
+  timestep = (block == "TIMESTEP" && !d_offset.empty());
+}
+
+bool gio::FrameIndex::readCache(const std::string &name, long long size,
+        long long mtime) {
+  std::ifstream test(cacheName(name).c_str());
+  if (!test.good()) return false;
+  test.close();
+
+  try {
+    Ginstream gin(cacheName(name));
+    std::vector<std::string> buffer;
+    gin.getblock(buffer);
+    gin.close();
+    if (buffer.size() < 5 || buffer[0] != "FRAMEINDEX" ||
+            buffer[buffer.size() - 1].find("END") != 0)
+      return false;
+
+    long long s, m;
+    std::istringstream is(buffer[1]);
+    is >> s >> m;
+    if (is.fail() || s != size || m != mtime)
+      return false;
+
+    d_first = buffer[2];
+    int n, hasTime;
+    is.clear();
+    is.str(buffer[3]);
+    is >> n >> d_end >> hasTime;
+    if (is.fail() || n < 0 || int(buffer.size()) != n + 5) {
+      d_first = "";
+      return false;
+    }
+    d_hasTime = hasTime != 0;
+
+    d_offset.resize(n);
+    d_step.resize(n);
+    d_time.resize(n);
+    for (int i = 0; i < n; ++i) {
+      is.clear();
+      is.str(buffer[i + 4]);
+      is >> d_offset[i] >> d_step[i] >> d_time[i];
+      if (is.fail()) {
+        d_first = "";
+        return false;
+      }
+    }
+  } catch (const gromos::Exception &e) {
+    d_first = "";
+    return false;
+  }
+  return true;
+}
+
+void gio::FrameIndex::writeCache(const std::string &name, long long size,
+        long long mtime)const {
+  // write to a temporary file first such that no one reads a partial cache
+  const std::string tmp = cacheName(name) + ".tmp";
+  std::ofstream os(tmp.c_str());
+  if (!os.good()) return;
+
+  os << "TITLE\n"
+          << "frame index of " << name << "\n"
+          << "END\n"
+          << "FRAMEINDEX\n"
+          << "# size and modification time of the trajectory\n"
+          << size << " " << mtime << "\n"
+          << "# first block of a frame\n"
+          << d_first << "\n"
+          << "# frames, end, TIMESTEP in every frame\n"
+          << d_offset.size() << " " << d_end << " " << d_hasTime << "\n"
+          << "# offset, step, time\n";
+  os.precision(17);
+  for (unsigned int i = 0; i < d_offset.size(); ++i) {
+    os << d_offset[i] << " " << d_step[i] << " " << d_time[i] << "\n";
+  }
+  os << "END\n";
+  os.close();
+
+  if (os.fail() || std::rename(tmp.c_str(), cacheName(name).c_str()) != 0)
+    std::remove(tmp.c_str());
+}
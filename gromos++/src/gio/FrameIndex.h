@@ -0,0 +1,154 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_FrameIndex.h
+
+#ifndef INCLUDED_GIO_FRAMEINDEX
+#define INCLUDED_GIO_FRAMEINDEX
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include "../gromos/Exception.h"
+
+namespace gio{
+
+  /**
+   * Class FrameIndex
+   * The positions of the frames in a GROMOS trajectory.
+   *
+   * The index holds the offset (in uncompressed bytes) of the first block
+   * of every frame and the information of the TIMESTEP blocks. It is built
+   * by scanning the trajectory once and cached next to the trajectory 
+   * (trajectory name + ".fidx"). A cached index is only used if size and 
+   * modification time of the trajectory did not change since it was 
+   * written. If the cache cannot be written the index is only kept in 
+   * memory.
+   *
+   * @class FrameIndex
+   * @ingroup gio
+   * @sa gio::InG96
+   */
+  class FrameIndex{
+    std::vector<std::streamoff> d_offset;
+    std::vector<int> d_step;
+    std::vector<double> d_time;
+    std::streamoff d_end;
+    std::string d_first;
+    bool d_hasTime;
+
+  public:
+    /**
+     * Constructor, loads the cached index or builds it
+     * @param name   : trajectory file
+     * @param build  : build the index if there is no valid cache
+     */
+    FrameIndex(const std::string &name, bool build = true);
+
+    /**
+     * true if the index could be loaded or was built
+     */
+    bool valid()const;
+    /**
+     * name of the first block of every frame
+     */
+    const std::string &firstBlock()const;
+    /**
+     * number of frames
+     */
+    int numFrames()const;
+    /**
+     * offset of the first block of a frame
+     */
+    std::streamoff offset(int frame)const;
+    /**
+     * offset of the end of the trajectory
+     */
+    std::streamoff end()const;
+    /**
+     * true if every frame has a TIMESTEP block
+     */
+    bool hasTime()const;
+    /**
+     * the step of a frame (from the TIMESTEP block)
+     */
+    int step(int frame)const;
+    /**
+     * the time of a frame (from the TIMESTEP block)
+     */
+    double time(int frame)const;
+    /**
+     * the first frame with a time larger or equal to time. Returns
+     * numFrames() if there is no such frame.
+     */
+    int frameAt(double time)const;
+    /**
+     * name of the cache file of a trajectory
+     */
+    static std::string cacheName(const std::string &name);
+
+    /**
+     * Exception
+     */
+    struct Exception: public gromos::Exception{
+      Exception(const std::string& what_arg) : gromos::Exception("FrameIndex", what_arg){}
+    };
+
+  private:
+    void build(const std::string &name);
+    void scanLine(const char *b, const char *e, std::streamoff start,
+            bool &inside, bool &timestep, int &numTime);
+    bool readCache(const std::string &name, long long size, long long mtime);
+    void writeCache(const std::string &name, long long size, long long mtime)const;
+  };
+
+  inline bool FrameIndex::valid()const{
+    return !d_first.empty();
+  }
+
+  inline const std::string &FrameIndex::firstBlock()const{
+    return d_first;
+  }
+
+  inline int FrameIndex::numFrames()const{
+    return d_offset.size();
+  }
+
+  inline std::streamoff FrameIndex::offset(int frame)const{
+    return d_offset[frame];
+  }
+
+  inline std::streamoff FrameIndex::end()const{
+    return d_end;
+  }
+
+  inline bool FrameIndex::hasTime()const{
+    return d_hasTime;
+  }
+
+  inline int FrameIndex::step(int frame)const{
+    return d_step[frame];
+  }
+
+  inline double FrameIndex::time(int frame)const{
+    return d_time[frame];
+  }
+}
+#endif
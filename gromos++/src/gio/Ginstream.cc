@@ -33,21 +33,14 @@
 #include "Ginstream.h"
 #include <cstdio>
 #include "gzstream.h"
+#include "mmapstream.h"
 
 template<class size_type>
 inline std::basic_string<size_type>&
 trim_right( std::basic_string<size_type>& str )
 {
-    return( str = str.substr( 0, str.find_last_not_of( ' ' ) + 1 ) );
-}
-
-
-template<class size_type>
-inline std::basic_string<size_type>&
-trim( std::basic_string<size_type>& str )
-{
-  if (str.find_first_not_of( ' ' ) == std::string::npos) return (str = "");  // line of whitespaces
-  return( trim_right( str ) );  //remove trailing whitespace from string
+  // erase in place, a line of whitespaces becomes empty
+  return( str.erase( str.find_last_not_of( ' ' ) + 1 ) );
 }
 
 
@@ -67,40 +60,42 @@ gio::Ginstream::Ginstream(gio::Ginstream &gin)
   _version = gin._version;
 }
 
-void gio::Ginstream::open(const std::string s, std::ios::openmode mode)
+// regular uncompressed files are memory mapped, everything else is read
+// through igzstream (which also reads uncompressed data)
+static std::istream *openStream(const std::string &s, std::ios::openmode mode)
 {
+  if (gio::mmapstreambuf::mappable(s.c_str())) {
+    gio::immapstream *ims = new gio::immapstream(s.c_str());
+    if (ims->is_open())
+      return ims;
+    delete ims;
+  }
   igzstream *gis = new igzstream(s.c_str(), mode);
   if (gis == NULL){
     throw gromos::Exception("Ginstream", "could not create a std::ifstream( " + s + ")");
   }
   if(!gis->good()){
+    delete gis;
     throw gromos::Exception("Ginstream", "Could not open file '" + s + "'");
   }  
   if(!gis->is_open()){
+    delete gis;
     throw gromos::Exception("Ginstream", "could not open file '" + s + "'");
   }
-  
-  stream(*gis, true);
+  return gis;
+}
+
+void gio::Ginstream::open(const std::string s, std::ios::openmode mode)
+{
+  stream(*openStream(s, mode), true);
   if (!_has_version) {
     // We tried to read ENEVERSION, but apparently, there was none.
     // Our stream isn't usable anymore - we started reading the 
     // next block - probably TIMESTEP.
     // Rewind operations (seekg() and the like) don't seem to work - 
     // so let's recreate it. (Yeah, not THAT elegant...)
-    gis->close();
-    delete gis;
-    igzstream *gis = new igzstream(s.c_str(), mode);
-    if (gis == NULL){
-      throw gromos::Exception("Ginstream", "could not create a std::ifstream( " + s + ")");
-    }
-    if(!gis->good()){
-      throw gromos::Exception("Ginstream", "Could not open file '" + s + "'");
-    }  
-    if(!gis->is_open()){
-      throw gromos::Exception("Ginstream", "could not open file '" + s + "'");
-    }
-    
-    stream(*gis, false);
+    close();
+    stream(*openStream(s, mode), false);
   }
   _name=s;
 }
@@ -111,12 +106,14 @@ void gio::Ginstream::close()
   // std::cerr << "closing _is" << std::endl;
 
   std::ifstream * ifs = dynamic_cast<std::ifstream *>(_is);
+  gio::immapstream * ims = dynamic_cast<gio::immapstream *>(_is);
+  igzstream * igzs = dynamic_cast<igzstream *>(_is);
   if (ifs != NULL)
     ifs->close();
-  else{
-    igzstream * igzs = dynamic_cast<igzstream *>(_is);
+  else if (ims != NULL)
+    ims->close();
+  else if (igzs != NULL)
     igzs->close();
-  }
 
   // _is->close();
   _title="";
@@ -171,7 +168,7 @@ std::istream& gio::Ginstream::getline(std::string& s,
       break;
     }
   }
-  s = trim(s);  // remove trailing whitespace from line
+  trim_right(s);  // remove trailing whitespace from line
 
   return *_is;
 }
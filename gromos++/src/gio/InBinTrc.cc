@@ -0,0 +1,274 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_InBinTrc.cc
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+
+#include "InBinTrc.h"
+#include "BinTrc.h"
+#include "gzstream.h"
+#include "../gcore/System.h"
+#include "../gcore/Molecule.h"
+#include "../gcore/MoleculeTopology.h"
+#include "../gcore/Solvent.h"
+#include "../gcore/SolventTopology.h"
+#include "../gcore/Box.h"
+#include "../gcore/Remd.h"
+#include "../gmath/Vec.h"
+
+using gio::InBinTrc;
+using namespace gcore;
+
+class gio::InBinTrc_i {
+  friend class gio::InBinTrc;
+
+  igzstream d_is;
+  std::string d_name;
+  std::string d_title;
+  int d_switch;
+  // the frame which is read next
+  int d_frame;
+  bool d_eof;
+  BinTrc::Frame d_buffer;
+
+  // frame offsets (collected on demand)
+  bool d_indexed;
+  std::streamoff d_end;
+  std::vector<std::streamoff> d_offset;
+  std::vector<double> d_time;
+  bool d_hasTime;
+
+  InBinTrc_i(const std::string &name)
+  : d_name(name), d_switch(0), d_frame(0), d_eof(false), d_indexed(false),
+  d_end(0), d_hasTime(true) {
+    d_is.open(name.c_str());
+    if (!d_is.is_open() || !d_is.good())
+      throw InBinTrc::Exception("could not open file '" + name + "'");
+    if (!BinTrc::readMagic(d_is))
+      throw InBinTrc::Exception(name + " is not a binary trajectory");
+    d_title = BinTrc::readTitle(d_is);
+    checkEof();
+  }
+
+  void checkEof() {
+    d_eof = d_is.peek() == EOF;
+    if (d_eof) d_is.clear();
+  }
+  void buildIndex();
+  void assign(System &sys);
+};
+
+InBinTrc::InBinTrc(const std::string &name)
+: d_this(new InBinTrc_i(name)) {
+}
+
+InBinTrc::~InBinTrc() {
+  delete d_this;
+}
+
+bool InBinTrc::isBinTrc(const std::string &name) {
+  igzstream is(name.c_str());
+  return is.is_open() && is.good() && BinTrc::readMagic(is);
+}
+
+void InBinTrc::select(const std::string &thing) {
+  if (thing == "ALL") {
+    d_this->d_switch = 1;
+  } else if (thing == "SOLVENT") {
+    d_this->d_switch = 2;
+  } else {
+    d_this->d_switch = 0;
+  }
+}
+
+InBinTrc &InBinTrc::operator>>(System &sys) {
+  if (d_this->d_eof)
+    throw Exception("no frame left in " + name());
+  try {
+    if (!BinTrc::read(d_this->d_is, d_this->d_buffer))
+      throw Exception("no frame left in " + name());
+  } catch (const BinTrc::Exception &e) {
+    std::ostringstream os;
+    os << "frame " << d_this->d_frame << " of " << name() << ": " << e.what();
+    throw Exception(os.str());
+  }
+  ++d_this->d_frame;
+  d_this->checkEof();
+  d_this->assign(sys);
+  return *this;
+}
+
+void gio::InBinTrc_i::assign(System &sys) {
+  const std::vector<gmath::Vec> &pos = d_buffer.pos;
+  unsigned int na = 0;
+  for (int m = 0; m < sys.numMolecules(); m++) {
+    if (!sys.mol(m).numPos()) {
+      sys.mol(m).initPos();
+    }
+    na += sys.mol(m).numAtoms();
+  }
+
+  // solute?
+  if (d_switch < 2) {
+    if (pos.size() < na) {
+      std::ostringstream os;
+      os << "Coordinate file " << d_name << " corrupted.\n"
+              << "Failed to read " << na << " solute coordinates, the frame "
+              << "contains " << pos.size() << " coordinates";
+      throw InBinTrc::Exception(os.str());
+    }
+    unsigned int i = 0;
+    for (int m = 0; m < sys.numMolecules(); m++)
+      for (int a = 0; a < sys.mol(m).numAtoms(); a++)
+        sys.mol(m).pos(a) = pos[i++];
+  }
+
+  // solvent?
+  if (d_switch > 0) {
+    sys.sol(0).setNumPos(0);
+    for (unsigned int i = na; i < pos.size(); ++i)
+      sys.sol(0).addPos(pos[i]);
+    if (sys.sol(0).numPos() % sys.sol(0).topology().numAtoms() != 0) {
+      std::ostringstream os;
+      os << "Coordinate file " << d_name << " corrupted.\n"
+              << "Atom count mismatch while reading solvent coordinates.\n"
+              << "Read " << sys.sol(0).numPos() << " coordinates for solvent "
+              << "with " << sys.sol(0).topology().numAtoms() 
+              << " atoms per molecule\n";
+      throw InBinTrc::Exception(os.str());
+    }
+  }
+
+  if (d_buffer.hasBox) {
+    Box box(d_buffer.K, d_buffer.L, d_buffer.M);
+    box.update_triclinic();
+    box.setNtb(Box::boxshape_enum(d_buffer.ntb));
+    box.boxformat() = Box::boxformat_enum(d_buffer.boxformat);
+    sys.box() = box;
+  }
+  if (d_buffer.hasRemd)
+    sys.remd() = d_buffer.remd;
+
+  sys.hasPos = true;
+  sys.hasLatticeshifts = false;
+  sys.hasVel = false;
+  sys.hasCosDisplacements = false;
+  sys.hasBox = d_buffer.hasBox;
+  sys.hasRemd = d_buffer.hasRemd;
+}
+
+bool InBinTrc::timeRead()const {
+  return d_this->d_buffer.hasTime;
+}
+
+int InBinTrc::step()const {
+  return d_this->d_buffer.step;
+}
+
+double InBinTrc::time()const {
+  return d_this->d_buffer.time;
+}
+
+std::string InBinTrc::title()const {
+  return d_this->d_title;
+}
+
+std::string InBinTrc::name()const {
+  return d_this->d_name;
+}
+
+bool InBinTrc::eof()const {
+  return d_this->d_eof;
+}
+
+void gio::InBinTrc_i::buildIndex() {
+  // walk through the frame headers, the current position is restored
+  const std::streamoff current = d_is.tellg();
+  d_is.clear();
+  d_is.seekg(0);
+  if (!BinTrc::readMagic(d_is))
+    throw InBinTrc::Exception("could not index " + d_name);
+  BinTrc::readTitle(d_is);
+  d_offset.clear();
+  d_time.clear();
+  d_hasTime = true;
+  d_end = d_is.tellg();
+  try {
+    while (true) {
+      const std::streamoff offset = d_end;
+      bool hasTime;
+      int step;
+      double time;
+      if (!BinTrc::skip(d_is, hasTime, step, time)) break;
+      d_offset.push_back(offset);
+      d_time.push_back(time);
+      d_hasTime = d_hasTime && hasTime;
+      d_end = d_is.tellg();
+    }
+  } catch (const BinTrc::Exception &e) {
+    throw InBinTrc::Exception("could not index " + d_name + ": " + e.what());
+  }
+  d_is.clear();
+  d_is.seekg(current);
+  d_indexed = true;
+}
+
+int InBinTrc::numFrames() {
+  if (!d_this->d_indexed)
+    d_this->buildIndex();
+  return d_this->d_offset.size();
+}
+
+int InBinTrc::frame()const {
+  return d_this->d_frame;
+}
+
+void InBinTrc::seekFrame(int frame) {
+  if (frame < 0)
+    throw Exception("cannot seek to a negative frame");
+  const int n = numFrames();
+  d_this->d_is.clear();
+  if (frame >= n) {
+    d_this->d_is.seekg(d_this->d_end);
+    d_this->d_frame = n;
+  } else {
+    d_this->d_is.seekg(d_this->d_offset[frame]);
+    d_this->d_frame = frame;
+  }
+  if (!d_this->d_is)
+    throw Exception("could not position file " + name());
+  d_this->checkEof();
+}
+
+void InBinTrc::seekTime(double time) {
+  numFrames();
+  if (!d_this->d_hasTime)
+    throw Exception("trajectory " + name() + " does not contain the time "
+          "of every frame");
+  seekFrame(std::lower_bound(d_this->d_time.begin(), d_this->d_time.end(),
+          time) - d_this->d_time.begin());
+}
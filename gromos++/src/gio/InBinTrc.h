@@ -0,0 +1,130 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_InBinTrc.h
+
+#ifndef INCLUDED_GIO_INBINTRC
+#define INCLUDED_GIO_INBINTRC
+
+#include <string>
+#include "../gromos/Exception.h"
+
+namespace gcore{
+  class System;
+}
+
+namespace gio{
+
+  class InBinTrc_i;
+  /**
+   * Class InBinTrc
+   * Reads binary coordinate trajectories (see gio::BinTrc). The file may
+   * be gzip compressed.
+   *
+   * Programs do not need to use this class: gio::InG96 recognises binary
+   * trajectories and reads them through InBinTrc (including skip, stride
+   * and positioning).
+   *
+   * @class InBinTrc
+   * @ingroup gio
+   * @sa gio::OutBinTrc gio::InG96
+   */
+  class InBinTrc{
+    InBinTrc_i *d_this;
+    // prevent copying and assignment
+    InBinTrc(const InBinTrc&);
+    InBinTrc &operator=(const InBinTrc&);
+  public:
+    /**
+     * Constructor
+     * @param name : trajectory file
+     */
+    InBinTrc(const std::string &name);
+    ~InBinTrc();
+    /**
+     * true if the file is a binary trajectory
+     */
+    static bool isBinTrc(const std::string &name);
+
+    /**
+     * select SOLUTE, SOLVENT, ALL
+     * (the frame holds the solute coordinates followed by the solvent 
+     * coordinates, as for a POSITIONRED block).
+     */
+    void select(const std::string &thing);
+    /**
+     * read the next frame
+     */
+    InBinTrc &operator>>(gcore::System &sys);
+    /**
+     * the frame which was read last had time information
+     */
+    bool timeRead()const;
+    /**
+     * step of the frame which was read last
+     */
+    int step()const;
+    /**
+     * time of the frame which was read last
+     */
+    double time()const;
+
+    /**
+     * title (of the trajectory)
+     */
+    std::string title()const;
+    /**
+     * name of the file
+     */
+    std::string name()const;
+    /**
+     * no more frames
+     */
+    bool eof()const;
+
+    /**
+     * number of frames (the frame offsets are collected on the first call)
+     */
+    int numFrames();
+    /**
+     * the frame (starting with 0) which is read next
+     */
+    int frame()const;
+    /**
+     * position the trajectory such that frame is read next. Positioning 
+     * at or after the last frame results in end of file.
+     */
+    void seekFrame(int frame);
+    /**
+     * position the trajectory at the first frame with a time larger or
+     * equal to time
+     */
+    void seekTime(double time);
+
+    /**
+     * Exception
+     */
+    struct Exception: public gromos::Exception{
+      Exception(const std::string& what_arg) : 
+      gromos::Exception("InBinTrc", what_arg){}
+    };
+  };
+}
+#endif
@@ -27,6 +27,8 @@
 #include "../gmath/Vec.h"
 #include "../gmath/Matrix.h"
 #include "Ginstream.h"
+#include "FrameIndex.h"
+#include "InBinTrc.h"
 #include "../gcore/Solvent.h"
 #include "../gcore/SolventTopology.h"
 #include "../gcore/Box.h"
@@ -59,6 +61,96 @@ const BT blocktypes[] = {BT("TITLE", titleblock),
 
 static std::map<std::string, blocktype> BLOCKTYPE(blocktypes, blocktypes + 13);
 
+namespace {
+  // powers of ten which are exactly representable as a double
+  const double exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' ||
+            c == '\v' || c == '\f';
+  }
+
+  inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+  }
+
+  /**
+   * locale independent parsing of a floating point number in fixed or
+   * scientific notation from a null terminated line. Only numbers for
+   * which the result is guaranteed to be correctly rounded (at most 
+   * 2^53 as integer mantissa and a power of ten of at most 22, Clinger's
+   * fast path) are accepted, such that the result is identical to the one 
+   * of operator>>. In any other case false is returned and the caller 
+   * has to fall back to the stream.
+   */
+  inline bool parseDouble(const char *&p, double &x) {
+    const char *c = p;
+    while (is_space(*c)) ++c;
+
+    bool negative = false;
+    if (*c == '-') {
+      negative = true;
+      ++c;
+    } else if (*c == '+') {
+      ++c;
+    }
+
+    unsigned long long mantissa = 0;
+    int digits = 0, exponent = 0;
+    const char *first = c;
+    for (; is_digit(*c); ++c) {
+      if (mantissa || *c != '0') {
+        if (++digits > 18) return false;
+      }
+      mantissa = 10 * mantissa + (*c - '0');
+    }
+    bool any = c != first;
+    if (*c == '.') {
+      first = ++c;
+      for (; is_digit(*c); ++c, --exponent) {
+        if (mantissa || *c != '0') {
+          if (++digits > 18) return false;
+        }
+        mantissa = 10 * mantissa + (*c - '0');
+      }
+      any = any || c != first;
+    }
+    if (!any) return false;
+
+    if (*c == 'e' || *c == 'E') {
+      ++c;
+      bool negexp = false;
+      if (*c == '-') {
+        negexp = true;
+        ++c;
+      } else if (*c == '+') {
+        ++c;
+      }
+      if (!is_digit(*c)) return false;
+      int e = 0;
+      for (; is_digit(*c); ++c) {
+        if (e > 1000) return false;
+        e = 10 * e + (*c - '0');
+      }
+      exponent += negexp ? -e : e;
+    }
+    // the number has to be terminated
+    if (*c != '\0' && !is_space(*c)) return false;
+    if (mantissa > (1ULL << 53) || exponent < -22 || exponent > 22)
+      return false;
+
+    x = double(mantissa);
+    if (exponent < 0) x /= exact_pow10[-exponent];
+    else x *= exact_pow10[exponent];
+    if (negative) x = -x;
+    p = c;
+    return true;
+  }
+}
+
 using gio::InG96;
 using namespace gcore;
 
@@ -76,6 +168,25 @@ class gio::InG96_i : public gio::Ginstream {
   int d_step;
   double d_time;
 
+  // the frame which is read next
+  int d_frame;
+  // the frame index (if it was loaded)
+  FrameIndex *d_index;
+  // building the frame index failed
+  bool d_noIndex;
+  // there is no cached frame index
+  bool d_noCache;
+  // the reader of binary trajectories (or NULL)
+  InBinTrc *d_bin;
+
+  // line buffers for the blocks which are parsed while they are read
+  std::string d_line;
+  std::string d_prevLine;
+
+  enum lineType {
+    dataLine, endLine, eofLine
+  };
+
   InG96_i(const std::string &name, int skip, int stride)
   : d_current(),
   d_switch(),
@@ -83,16 +194,57 @@ class gio::InG96_i : public gio::Ginstream {
   d_stride(stride),
   d_time_read(false),
   d_step(0),
-  d_time(0.0) {
-    open(name);
-    getline(d_current);
+  d_time(0.0),
+  d_frame(0),
+  d_index(NULL),
+  d_noIndex(false),
+  d_noCache(false),
+  d_bin(NULL) {
+    if (InBinTrc::isBinTrc(name)) {
+      d_bin = new InBinTrc(name);
+    } else {
+      open(name);
+      getline(d_current);
+    }
     d_switch = 0;
   }
 
   ~InG96_i() {
+    if (d_index) delete d_index;
+    if (d_bin) delete d_bin;
   }
 
   // method
+  /**
+   * load the frame index, build it if build is true and there is no
+   * cache. Returns false if there is no index.
+   */
+  bool frameIndex(bool build);
+  /**
+   * position the stream at the beginning of frame
+   */
+  void gotoFrame(int frame);
+  /**
+   * apply skip and stride if the number of frames is known: frame is 
+   * advanced to the frame which is read next. Returns false (and sets
+   * stride_eof) if the end of the file is reached.
+   */
+  bool skipFrames(int numFrames, int &frame, int &stride_eof);
+  /**
+   * read the next line of a block and classify it as data line,
+   * END line or the last line before the end of the file
+   */
+  void nextBlockLine(std::string &line, lineType &type);
+  /**
+   * read the remaining lines of a block, throws if there is no END
+   */
+  void finishBlock(const std::string &block, std::string &line,
+          lineType &type);
+  /**
+   * parse three doubles starting at position begin of line
+   */
+  bool parseVec(const std::string &line, std::string::size_type begin,
+          gmath::Vec &v);
   void readTimestep();
   void readPosition(gcore::System &sys);
   void readLatticeshifts(gcore::System &sys);
@@ -140,7 +292,8 @@ void InG96::open(const std::string &name) {
 
 void InG96::close() {
   if (d_this) {
-    d_this->close();
+    if (!d_this->d_bin)
+      d_this->close();
 
     d_skip = d_this->d_skip;
     d_stride = d_this->d_stride;
@@ -165,12 +318,16 @@ void InG96::select(const std::string &thing) {
   } else {
     d_this->d_switch = 0;
   }
+  if (d_this->d_bin)
+    d_this->d_bin->select(thing);
 }
 
 bool InG96::eof()const {
   if (!d_this) {
     throw InG96::Exception("eof, but no open file");
   }
+  if (d_this->d_bin)
+    return d_this->d_bin->eof();
 
   return d_this->stream().eof();
 }
@@ -179,9 +336,75 @@ std::string InG96::title()const {
   if (!d_this) {
     throw InG96::Exception("no open file");
   }
+  if (d_this->d_bin)
+    return d_this->d_bin->title();
   return d_this->title();
 }
 
+bool gio::InG96_i::frameIndex(bool build) {
+  if (d_index != NULL) return true;
+  if (d_noIndex || (d_noCache && !build)) return false;
+
+  try {
+    d_index = new FrameIndex(name(), build);
+  } catch (const gromos::Exception &e) {
+    d_noIndex = true;
+    return false;
+  }
+  if (!d_index->valid()) {
+    delete d_index;
+    d_index = NULL;
+    if (build) d_noIndex = true;
+    else d_noCache = true;
+    return false;
+  }
+  return true;
+}
+
+void gio::InG96_i::gotoFrame(int frame) {
+  stream().clear();
+  if (frame >= d_index->numFrames()) {
+    // read beyond the end to set end of file
+    stream().seekg(d_index->end());
+    d_frame = d_index->numFrames();
+  } else {
+    stream().seekg(d_index->offset(frame));
+    d_frame = frame;
+  }
+  if (!stream())
+    throw InG96::Exception("could not position file " + name() + 
+          " at frame in frame index");
+  getline(d_current);
+}
+
+bool gio::InG96_i::skipFrames(int numFrames, int &frame, int &stride_eof) {
+  if (d_skip > 0) {
+    if (d_skip >= numFrames - frame) {
+      // skip the rest in the next file
+      d_skip -= numFrames - frame;
+      stride_eof = true;
+      return false;
+    }
+    frame += d_skip;
+    d_skip = 0;
+  }
+
+  // only stride if not skip because of eof during last stride
+  if (stride_eof == false && d_stride > 1) {
+    if (d_stride - 1 >= numFrames - frame) {
+      // save remaining strides in skip for next file
+      std::cerr << "stride eof: " << d_stride
+              << "\ti: " << numFrames - frame << std::endl;
+
+      d_skip = d_stride - (numFrames - frame) - 1;
+      stride_eof = true;
+      return false;
+    }
+    frame += d_stride - 1;
+  }
+  return true;
+}
+
 void gio::InG96_i::readTimestep() {
   std::vector<std::string> buffer;
   getblock(buffer);
@@ -205,19 +428,50 @@ void gio::InG96_i::readTimestep() {
   d_time_read = true;
 }
 
-void gio::InG96_i::readPosition(gcore::System &sys) {
-  std::vector<std::string> buffer;
-  std::vector<std::string>::iterator it;
-  getblock(buffer);
-  if (buffer[buffer.size() - 1].find("END") != 0)
+void gio::InG96_i::nextBlockLine(std::string &line, lineType &type) {
+  // keep the previous line: at the end of the file getblock reports the
+  // last non-empty line of the block
+  d_prevLine.swap(line);
+  getline(line);
+  if (stream().eof()) {
+    if (line.empty()) line.swap(d_prevLine);
+    type = line.find("END") == 0 ? endLine : eofLine;
+  } else {
+    type = line.find("END") == 0 ? endLine : dataLine;
+  }
+}
+
+void gio::InG96_i::finishBlock(const std::string &block,
+        std::string &line, lineType &type) {
+  while (type == dataLine)
+    nextBlockLine(line, type);
+  if (type == eofLine)
     throw InG96::Exception("Coordinate file " + name() +
-          " is corrupted. No END in POSITION"
+          " is corrupted. No END in " + block +
           " block. Got\n"
-          + buffer[buffer.size() - 1]);
+          + line);
+}
 
-  it = buffer.begin();
-  std::string dummy;
-  int begin = 0;
+bool gio::InG96_i::parseVec(const std::string &line,
+        std::string::size_type begin, gmath::Vec &v) {
+  const char *p = line.c_str() + begin;
+  if (parseDouble(p, v[0]) && parseDouble(p, v[1]) && parseDouble(p, v[2]))
+    return true;
+  // anything unusual: let the stream decide
+  _lineStream.clear();
+  _lineStream.str(line.substr(begin, line.size()));
+  _lineStream >> v[0] >> v[1] >> v[2];
+  return !_lineStream.fail();
+}
+
+void gio::InG96_i::readPosition(gcore::System &sys) {
+  // the block is parsed line by line while it is read. Errors are only
+  // reported after the rest of the block has been checked for END, such
+  // that the diagnostics are the same as if the block was read at once.
+  std::string &line = d_line;
+  lineType type = dataLine;
+
+  std::string::size_type begin = 0;
   if (d_current == "POSITION") begin = 24;
   int na = 0;
   for (int m = 0; m < sys.numMolecules(); m++) {
@@ -230,24 +484,23 @@ void gio::InG96_i::readPosition(gcore::System &sys) {
   // solute?
   if (d_switch < 2) {
     for (int m = 0; m < sys.numMolecules(); m++) {
-      for (int a = 0; a < sys.mol(m).numAtoms(); a++, ++it) {
-        if (unsigned (begin) >= (*it).size()) {
+      for (int a = 0; a < sys.mol(m).numAtoms(); a++) {
+        nextBlockLine(line, type);
+        if (type == eofLine) finishBlock("POSITION", line, type);
+
+        if (begin >= line.size()) {
           std::ostringstream os;
           os << "Coordinate file " << name() << " corrupted.\n"
                   << "Failed to read coordinates from line \n"
-                  << *it
+                  << line
                   << "\nfrom POSITION or POSITIONRED block";
-          throw InG96::Exception(os.str());
+          const std::string msg = os.str();
+          finishBlock("POSITION", line, type);
+          throw InG96::Exception(msg);
         }
 
-        _lineStream.clear();
-        _lineStream.str((*it).substr(begin, (*it).size()));
-        _lineStream >> sys.mol(m).pos(a)[0]
-                >> sys.mol(m).pos(a)[1]
-                >> sys.mol(m).pos(a)[2];
-
-
-        if (_lineStream.fail()) {
+        if (!parseVec(line, begin, sys.mol(m).pos(a))) {
+          finishBlock("POSITION", line, type);
           std::ostringstream os;
           os << "Coordinate file " << name() << " corrupted.\n"
                   << "Failed to read " << na << " solute coordinates"
@@ -257,27 +510,38 @@ void gio::InG96_i::readPosition(gcore::System &sys) {
       }
 
     }
-  } else it += na;
+  } else {
+    for (int i = 0; i < na && type == dataLine; ++i) {
+      nextBlockLine(line, type);
+      if (type == eofLine) finishBlock("POSITION", line, type);
+    }
+  }
 
   // Solvent?
   if (d_switch > 0) {
     sys.sol(0).setNumPos(0);
     gmath::Vec v;
 
-    for (; it != buffer.end() - 1; ++it) {
-      if (unsigned(begin) >= (*it).size()) {
+    // an END which was read while skipping the solute is parsed as a
+    // solvent line (and fails)
+    bool skippedEnd = type == endLine;
+    if (type == dataLine)
+      nextBlockLine(line, type);
+    for (; type == dataLine || skippedEnd; nextBlockLine(line, type)) {
+      skippedEnd = false;
+      if (begin >= line.size()) {
         std::ostringstream os;
         os << "Coordinate file " << name() << " corrupted.\n"
                 << "Failed to read coordinates from line \n"
-                << *it
+                << line
                 << "\nfrom POSITION or POSITIONRED block";
-        throw InG96::Exception(os.str());
+        const std::string msg = os.str();
+        finishBlock("POSITION", line, type);
+        throw InG96::Exception(msg);
       }
-      _lineStream.clear();
-      _lineStream.str((*it).substr(begin, (*it).size()));
-      _lineStream >> v[0] >> v[1] >> v[2];
 
-      if (_lineStream.fail()) {
+      if (!parseVec(line, begin, v)) {
+        finishBlock("POSITION", line, type);
         std::ostringstream os;
         os << "Coordinate file " << name() << " corrupted.\n"
                 << "Failed while reading solvent coordinates"
@@ -286,6 +550,7 @@ void gio::InG96_i::readPosition(gcore::System &sys) {
       }
       sys.sol(0).addPos(v);
     }
+    finishBlock("POSITION", line, type);
 
     if (sys.sol(0).numPos() % sys.sol(0).topology().numAtoms() != 0) {
       std::ostringstream os;
@@ -295,6 +560,9 @@ void gio::InG96_i::readPosition(gcore::System &sys) {
               << "with " << sys.sol(0).topology().numAtoms() << " atoms per molecule\n";
       throw InG96::Exception(os.str());
     }
+  } else {
+    // the solvent coordinates are not needed
+    finishBlock("POSITION", line, type);
   }
 }
 
@@ -642,6 +910,28 @@ InG96 &InG96::operator>>(System &sys) {
     throw InG96::Exception("read in frame, but no open file");
   }
 
+  if (d_this->d_bin) {
+    // binary trajectory, the frame offsets are known
+    InBinTrc &bin = *d_this->d_bin;
+    d_this->initializeBfactors(sys);
+    if (d_this->d_skip > 0 || (d_this->d_stride > 1 && !d_stride_eof)) {
+      const int numFrames = bin.numFrames();
+      int frame = bin.frame();
+      if (!d_this->skipFrames(numFrames, frame, d_stride_eof)) {
+        bin.seekFrame(numFrames);
+        return *this;
+      }
+      if (frame != bin.frame())
+        bin.seekFrame(frame);
+    }
+    d_stride_eof = false;
+    bin >> sys;
+    d_this->d_time_read = bin.timeRead();
+    d_this->d_step = bin.step();
+    d_this->d_time = bin.time();
+    return *this;
+  }
+
   if (!d_this->stream())
     throw Exception("File " + name() + " is corrupted.");
 
@@ -657,10 +947,29 @@ InG96 &InG96::operator>>(System &sys) {
   
   d_this->initializeBfactors(sys);
 
+  // jump over the skipped frames if there is a frame index. When striding
+  // it is worth building the index as most of the trajectory is skipped.
+  bool indexed = false;
+  if ((d_this->d_skip > 0 || (d_this->d_stride > 1 && !d_stride_eof)) &&
+          d_this->frameIndex(d_this->d_stride > 1) &&
+          d_this->d_index->firstBlock() == first) {
+    indexed = true;
+    const int numFrames = d_this->d_index->numFrames();
+    int frame = d_this->d_frame;
+
+    if (!d_this->skipFrames(numFrames, frame, d_stride_eof)) {
+      d_this->gotoFrame(numFrames);
+      return *this;
+    }
+
+    if (frame != d_this->d_frame)
+      d_this->gotoFrame(frame);
+  }
+
   // skip frames
   // std::cerr << "operator<< : skip=" << d_this->d_skip << std::endl;
 
-  for (; d_this->d_skip > 0; --d_this->d_skip) {
+  for (; !indexed && d_this->d_skip > 0; --d_this->d_skip) {
 
     do {
       // std::cerr << "skipping block " << d_this->d_current << std::endl;
@@ -670,6 +979,7 @@ InG96 &InG96::operator>>(System &sys) {
 
     } while (d_this->d_current != first &&
             (!d_this->stream().eof()));
+    ++d_this->d_frame;
 
     if (d_this->stream().eof()) {
       // std::cerr << "skip eof: " << d_this->d_skip << std::endl;
@@ -682,7 +992,7 @@ InG96 &InG96::operator>>(System &sys) {
   }
 
   // only stride if not skip because of eof during last stride
-  if (d_stride_eof == false) {
+  if (!indexed && d_stride_eof == false) {
     int i = 1;
     for (; i < d_this->d_stride; ++i) {
 
@@ -693,6 +1003,7 @@ InG96 &InG96::operator>>(System &sys) {
 
       } while (d_this->d_current != first &&
               (!d_this->stream().eof()));
+      ++d_this->d_frame;
 
       if (d_this->stream().eof()) {
         // save remaining strides in skip for next file
@@ -770,6 +1081,7 @@ InG96 &InG96::operator>>(System &sys) {
     }
     d_this->getline(d_this->d_current);
   } while (d_this->d_current != first && !d_this->stream().eof());
+  ++d_this->d_frame;
 
   sys.hasPos = readpos;
   sys.hasLatticeshifts = readlatticeshifts;
@@ -799,6 +1111,8 @@ InG96 &InG96::operator>>(utils::Time &time) {
 }
 
 std::string InG96::name()const {
+  if (d_this->d_bin)
+    return d_this->d_bin->name();
   return d_this->name();
 }
 
@@ -831,3 +1145,54 @@ void InG96::stride(int stride) {
 bool InG96::stride_eof()const {
   return d_stride_eof;
 }
+
+int InG96::numFrames() {
+  if (!d_this) {
+    throw InG96::Exception("numFrames, but no open file");
+  }
+  if (d_this->d_bin)
+    return d_this->d_bin->numFrames();
+  if (!d_this->frameIndex(true))
+    throw InG96::Exception("could not build frame index of " + name());
+  return d_this->d_index->numFrames();
+}
+
+int InG96::frame()const {
+  if (!d_this) {
+    throw InG96::Exception("frame, but no open file");
+  }
+  if (d_this->d_bin)
+    return d_this->d_bin->frame();
+  return d_this->d_frame;
+}
+
+void InG96::seekFrame(int frame) {
+  if (!d_this) {
+    throw InG96::Exception("seekFrame, but no open file");
+  }
+  if (frame < 0)
+    throw InG96::Exception("cannot seek to a negative frame");
+  if (d_this->d_bin) {
+    d_this->d_bin->seekFrame(frame);
+    return;
+  }
+  if (!d_this->frameIndex(true))
+    throw InG96::Exception("could not build frame index of " + name());
+  d_this->gotoFrame(frame);
+}
+
+void InG96::seekTime(double time) {
+  if (!d_this) {
+    throw InG96::Exception("seekTime, but no open file");
+  }
+  if (d_this->d_bin) {
+    d_this->d_bin->seekTime(time);
+    return;
+  }
+  if (!d_this->frameIndex(true))
+    throw InG96::Exception("could not build frame index of " + name());
+  if (!d_this->d_index->hasTime())
+    throw InG96::Exception("trajectory " + name() + " does not contain a "
+          "TIMESTEP block in every frame");
+  d_this->gotoFrame(d_this->d_index->frameAt(time));
+}
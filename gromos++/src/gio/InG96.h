@@ -45,6 +45,12 @@ namespace gio{
    * The instream can handle POSITION POSITIONRED VELOCITY and VELOCITYRED 
    * blocks in GROMOS files
    *
+   * Skipped frames are jumped over using a frame index 
+   * (gio::FrameIndex) if a cached index of the trajectory exists. When 
+   * striding the index is built (and cached) on the first read.
+   * Binary trajectories (see gio::OutBinTrc) are recognised when they are
+   * opened and read through gio::InBinTrc.
+   *
    * @class InG96
    * @ingroup gio
    * @author R. Buergi
@@ -163,6 +169,28 @@ namespace gio{
      */
     bool stride_eof()const;
 
+    // Random access
+    /**
+     * number of frames in the trajectory.
+     * The frame index (see gio::FrameIndex) is built if necessary.
+     */
+    int numFrames();
+    /**
+     * the frame (starting with 0) which is read next
+     */
+    int frame()const;
+    /**
+     * position the trajectory such that frame is read next (skip and 
+     * stride still apply to the next read). Positioning at or after the
+     * last frame results in end of file.
+     */
+    void seekFrame(int frame);
+    /**
+     * position the trajectory at the first frame with a time (from the
+     * TIMESTEP block) larger or equal to time
+     */
+    void seekTime(double time);
+
     //Exceptions
     /**
      * Exception
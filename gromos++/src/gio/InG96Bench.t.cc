@@ -0,0 +1,181 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_InG96Bench.t.cc
+// compares the time needed to read a POSITIONRED trajectory with InG96 to
+// the time needed by the generic block reader (getblock and one 
+// istringstream per line) which was used before.
+
+#include <cassert>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <cmath>
+#include <set>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+
+#include "InG96.h"
+#include "OutG96.h"
+#include "Ginstream.h"
+#include "../gcore/System.h"
+#include "../gcore/Molecule.h"
+#include "../gcore/MoleculeTopology.h"
+#include "../gcore/AtomTopology.h"
+#include "../gcore/Solvent.h"
+#include "../gcore/SolventTopology.h"
+#include "../gmath/Vec.h"
+
+using namespace std;
+using namespace gcore;
+using namespace gio;
+
+// reads a POSITIONRED block the way InG96 did before
+void readLegacy(Ginstream &gin, System &sys) {
+  std::vector<std::string> buffer;
+  std::istringstream is;
+  gin.getblock(buffer);
+  if (buffer[buffer.size() - 1].find("END") != 0) {
+    cerr << "no END in block" << endl;
+    exit(1);
+  }
+  std::vector<std::string>::iterator it = buffer.begin();
+  for (int m = 0; m < sys.numMolecules(); ++m) {
+    for (int a = 0; a < sys.mol(m).numAtoms(); ++a, ++it) {
+      is.clear();
+      is.str((*it).substr(0, (*it).size()));
+      is >> sys.mol(m).pos(a)[0] >> sys.mol(m).pos(a)[1] >> sys.mol(m).pos(a)[2];
+      if (is.fail()) {
+        cerr << "bad line: " << *it << endl;
+        exit(1);
+      }
+    }
+  }
+  sys.sol(0).setNumPos(0);
+  gmath::Vec v;
+  for (; it != buffer.end() - 1; ++it) {
+    is.clear();
+    is.str((*it).substr(0, (*it).size()));
+    is >> v[0] >> v[1] >> v[2];
+    if (is.fail()) {
+      cerr << "bad line: " << *it << endl;
+      exit(1);
+    }
+    sys.sol(0).addPos(v);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int numSolute = 1000, numSolvent = 33000, numFrames = 10;
+  if (argc > 1) numSolute = atoi(argv[1]);
+  if (argc > 2) numSolvent = atoi(argv[2]);
+  if (argc > 3) numFrames = atoi(argv[3]);
+  const string file = "InG96Bench.trc";
+
+  // build a system with one solute molecule and SPC like solvent
+  MoleculeTopology mt;
+  AtomTopology at;
+  at.setName("C");
+  for (int i = 0; i < numSolute; ++i) {
+    mt.addAtom(at);
+    mt.setResNum(i, i / 10);
+  }
+  mt.setResName(0, "RES");
+  SolventTopology st;
+  at.setName("OW");
+  st.addAtom(at);
+  at.setName("HW");
+  st.addAtom(at);
+  st.addAtom(at);
+  st.setSolvName("SPC");
+
+  System sys;
+  sys.addMolecule(Molecule(mt));
+  sys.addSolvent(Solvent(st));
+  sys.mol(0).initPos();
+  srand(1234);
+  for (int a = 0; a < numSolute; ++a)
+    for (int i = 0; i < 3; ++i)
+      sys.mol(0).pos(a)[i] = 10.0 * rand() / RAND_MAX - 5.0;
+  for (int a = 0; a < 3 * numSolvent; ++a)
+    sys.sol(0).addPos(gmath::Vec(10.0 * rand() / RAND_MAX - 5.0,
+          10.0 * rand() / RAND_MAX - 5.0, 10.0 * rand() / RAND_MAX - 5.0));
+
+  {
+    ofstream os(file.c_str());
+    OutG96 oc(os);
+    oc.select("ALL");
+    oc.writeTitle("InG96 benchmark");
+    for (int f = 0; f < numFrames; ++f)
+      oc << sys;
+  }
+
+  System sys_new(sys), sys_old(sys);
+  sys_new.sol(0).setNumPos(0);
+  sys_old.sol(0).setNumPos(0);
+
+  clock_t start = clock();
+  InG96 ic(file);
+  ic.select("ALL");
+  int frames = 0;
+  while (!ic.eof()) {
+    ic >> sys_new;
+    ++frames;
+  }
+  ic.close();
+  const double t_new = double(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  Ginstream gin(file);
+  std::string block;
+  int frames_old = 0;
+  while (!gin.getline(block).eof()) {
+    if (block == "POSITIONRED") {
+      readLegacy(gin, sys_old);
+      ++frames_old;
+    } else {
+      gin.skipblock();
+    }
+  }
+  gin.close();
+  const double t_old = double(clock() - start) / CLOCKS_PER_SEC;
+
+  // both readers have to give the same coordinates
+  assert(frames == numFrames && frames_old == numFrames);
+  assert(sys_new.sol(0).numPos() == sys_old.sol(0).numPos());
+  for (int a = 0; a < numSolute; ++a)
+    for (int i = 0; i < 3; ++i)
+      assert(sys_new.mol(0).pos(a)[i] == sys_old.mol(0).pos(a)[i]);
+  for (int a = 0; a < sys_old.sol(0).numPos(); ++a)
+    for (int i = 0; i < 3; ++i)
+      assert(sys_new.sol(0).pos(a)[i] == sys_old.sol(0).pos(a)[i]);
+
+  cout << "read " << numFrames << " frames of " 
+          << numSolute + 3 * numSolvent << " atoms" << endl
+          << "InG96          : " << t_new << " s" << endl
+          << "getblock/stream: " << t_old << " s" << endl
+          << "speedup        : " << t_old / t_new << endl;
+
+  remove(file.c_str());
+  return 0;
+}
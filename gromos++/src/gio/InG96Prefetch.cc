@@ -0,0 +1,290 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_InG96Prefetch.cc
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <string>
+#include <vector>
+
+#ifdef OMP
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#include "InG96Prefetch.h"
+#include "InG96.h"
+#include "../gcore/System.h"
+#include "../utils/groTime.h"
+
+using gio::InG96Prefetch;
+using gcore::System;
+
+class gio::InG96Prefetch_i {
+public:
+  // a frame which was read ahead
+  struct Slot {
+    System *sys;
+    utils::Time time;
+    // programs which do not use the time may read trajectories without
+    // TIMESTEP blocks
+    std::exception_ptr timeError;
+    std::string name;
+  };
+
+  // reader side
+  InG96 d_ic;
+  utils::Time d_time;
+  std::string d_select;
+  int d_switch;
+  std::vector<std::string> d_files;
+  unsigned int d_file;
+  bool d_open;
+
+  std::vector<Slot> d_slots;
+  std::deque<int> d_full;
+  std::deque<int> d_free;
+  bool d_done;
+  bool d_stop;
+  std::exception_ptr d_error;
+
+  // program side
+  utils::Time d_lastTime;
+  std::exception_ptr d_timeError;
+  std::string d_name;
+
+#ifdef OMP
+  std::thread d_thread;
+  std::mutex d_mutex;
+  std::condition_variable d_cond;
+#endif
+
+  InG96Prefetch_i(const System &sys, const utils::Time &time,
+          int skip, int stride, int depth) :
+  d_ic(skip, stride), d_time(time), d_select("SOLUTE"), d_switch(0),
+  d_file(0), d_open(false), d_done(false), d_stop(false),
+  d_lastTime(time) {
+    d_slots.resize(std::max(depth, 1));
+    for (unsigned int i = 0; i < d_slots.size(); ++i) {
+      d_slots[i].sys = new System(sys);
+      d_free.push_back(i);
+    }
+  }
+
+  ~InG96Prefetch_i() {
+    for (unsigned int i = 0; i < d_slots.size(); ++i)
+      delete d_slots[i].sys;
+  }
+
+  bool read(Slot &slot);
+  void fill();
+  bool wait();
+};
+
+// reads the next frame into slot. Returns false after the last frame.
+bool gio::InG96Prefetch_i::read(Slot &slot) {
+  while (true) {
+    if (!d_open) {
+      if (d_file == d_files.size())
+        return false;
+      d_ic.open(d_files[d_file]);
+      d_ic.select(d_select);
+      d_open = true;
+    }
+    if (!d_ic.eof()) {
+      d_ic >> *slot.sys;
+      if (!d_ic.stride_eof()) {
+        slot.timeError = std::exception_ptr();
+        try {
+          d_ic >> d_time;
+        } catch (const gromos::Exception &) {
+          slot.timeError = std::current_exception();
+        }
+        slot.time = d_time;
+        slot.name = d_files[d_file];
+        return true;
+      }
+    }
+    d_ic.close();
+    d_open = false;
+    ++d_file;
+  }
+}
+
+// reads frames while there are spare systems
+void gio::InG96Prefetch_i::fill() {
+#ifdef OMP
+  std::unique_lock<std::mutex> lock(d_mutex);
+  while (true) {
+    d_cond.wait(lock, [this] {
+      return d_stop || !d_free.empty();
+    });
+    if (d_stop) return;
+    const int s = d_free.front();
+    d_free.pop_front();
+    lock.unlock();
+
+    bool got = false;
+    try {
+      got = read(d_slots[s]);
+    } catch (...) {
+      d_error = std::current_exception();
+    }
+
+    lock.lock();
+    if (got)
+      d_full.push_back(s);
+    else {
+      d_free.push_back(s);
+      d_done = true;
+    }
+    d_cond.notify_all();
+    if (!got) return;
+  }
+#else
+  while (!d_done && !d_free.empty() && d_full.empty()) {
+    const int s = d_free.front();
+    bool got = false;
+    try {
+      got = read(d_slots[s]);
+    } catch (...) {
+      d_error = std::current_exception();
+    }
+    if (got) {
+      d_free.pop_front();
+      d_full.push_back(s);
+    } else
+      d_done = true;
+  }
+#endif
+}
+
+// waits for the next frame, returns false if there is none
+bool gio::InG96Prefetch_i::wait() {
+#ifdef OMP
+  std::unique_lock<std::mutex> lock(d_mutex);
+  d_cond.wait(lock, [this] {
+    return d_done || !d_full.empty();
+  });
+#else
+  fill();
+#endif
+  if (!d_full.empty())
+    return true;
+  if (d_error)
+    std::rethrow_exception(d_error);
+  return false;
+}
+
+InG96Prefetch::InG96Prefetch(const gcore::System &sys, const utils::Time &time,
+        int skip, int stride, int depth) :
+d_this(new InG96Prefetch_i(sys, time, skip, stride, depth)) {
+}
+
+InG96Prefetch::~InG96Prefetch() {
+#ifdef OMP
+  if (d_this->d_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(d_this->d_mutex);
+      d_this->d_stop = true;
+    }
+    d_this->d_cond.notify_all();
+    d_this->d_thread.join();
+  }
+#endif
+  delete d_this;
+}
+
+void InG96Prefetch::select(const std::string &thing) {
+  if (!d_this->d_files.empty())
+    throw Exception("select must be called before open");
+  d_this->d_select = thing;
+  if (thing == "ALL")
+    d_this->d_switch = 1;
+  else if (thing == "SOLVENT")
+    d_this->d_switch = 2;
+  else
+    d_this->d_switch = 0;
+}
+
+void InG96Prefetch::open(const std::vector<std::string> &files) {
+  if (!d_this->d_files.empty())
+    throw Exception("trajectory files can only be opened once");
+  d_this->d_files = files;
+  if (files.empty()) {
+    d_this->d_done = true;
+    return;
+  }
+#ifdef OMP
+  d_this->d_thread = std::thread(&InG96Prefetch_i::fill, d_this);
+#endif
+}
+
+bool InG96Prefetch::eof() {
+  return !d_this->wait();
+}
+
+InG96Prefetch &InG96Prefetch::operator>>(gcore::System &sys) {
+  if (!d_this->wait())
+    throw Exception("read in frame, but no frame left");
+
+  InG96Prefetch_i::Slot *slot;
+  int s;
+  {
+#ifdef OMP
+    std::lock_guard<std::mutex> lock(d_this->d_mutex);
+#endif
+    s = d_this->d_full.front();
+    d_this->d_full.pop_front();
+    slot = &d_this->d_slots[s];
+  }
+
+  // the slot is not touched by the reading thread until it is returned
+  sys.copyConfiguration(*slot->sys, d_this->d_switch < 2, 
+          d_this->d_switch > 0);
+  d_this->d_lastTime = slot->time;
+  d_this->d_timeError = slot->timeError;
+  d_this->d_name = slot->name;
+
+  {
+#ifdef OMP
+    std::lock_guard<std::mutex> lock(d_this->d_mutex);
+#endif
+    d_this->d_free.push_back(s);
+  }
+#ifdef OMP
+  d_this->d_cond.notify_all();
+#endif
+  return *this;
+}
+
+InG96Prefetch &InG96Prefetch::operator>>(utils::Time &time) {
+  if (d_this->d_timeError)
+    std::rethrow_exception(d_this->d_timeError);
+  time = d_this->d_lastTime;
+  return *this;
+}
+
+std::string InG96Prefetch::name()const {
+  return d_this->d_name;
+}
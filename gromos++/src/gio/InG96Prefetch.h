@@ -0,0 +1,129 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_InG96Prefetch.h
+
+#ifndef INCLUDED_GIO_ING96PREFETCH
+#define INCLUDED_GIO_ING96PREFETCH
+
+#include <string>
+#include <vector>
+#include "../gromos/Exception.h"
+
+namespace gcore{
+  class System;
+}
+
+namespace utils{
+  class Time;
+}
+
+namespace gio{
+
+  class InG96Prefetch_i;
+  /**
+   * Class InG96Prefetch
+   * Reads the frames of one or more trajectory files (through gio::InG96)
+   * ahead of the analysis.
+   *
+   * When compiled with OpenMP support, a background thread reads the next
+   * frames into spare systems while the program analyses the current
+   * frame. Skipping and striding (also across the trajectory files) are
+   * done by that thread. Without OpenMP the frames are read when they are
+   * requested.
+   *
+   * A frame is handed over by copying its coordinates (positions, 
+   * velocities, COS displacements, box and REMD information) into the 
+   * system of the program, so references into that system (e.g. of a 
+   * bound::Boundary) stay valid. The loop over the trajectory files 
+   * becomes
+   * @verbatim
+   gio::InG96Prefetch ip(sys, time, skip, stride);
+   ip.select("ALL");
+   ip.open(args.getValues<std::string>("traj", args.count("traj")));
+   while(!ip.eof()){
+     ip >> sys >> time;
+     // analyse frame
+   }
+   @endverbatim
+   *
+   * @class InG96Prefetch
+   * @ingroup gio
+   * @sa gio::InG96
+   */
+  class InG96Prefetch{
+    InG96Prefetch_i *d_this;
+    // prevent copying and assignment
+    InG96Prefetch(const InG96Prefetch&);
+    InG96Prefetch &operator=(const InG96Prefetch&);
+  public:
+    /**
+     * Constructor
+     * @param sys    : system the frames are read into (it is copied to 
+     *                 create the spare systems)
+     * @param time   : time settings (\@time), the time is updated as with
+     *                 gio::InG96
+     * @param skip   : skip frames
+     * @param stride : take only every n-th frame
+     * @param depth  : number of frames which are read ahead
+     */
+    InG96Prefetch(const gcore::System &sys, const utils::Time &time,
+            int skip = 0, int stride = 1, int depth = 1);
+    /**
+     * Destructor, stops reading
+     */
+    ~InG96Prefetch();
+    /**
+     * select SOLUTE, SOLVENT, ALL
+     */
+    void select(const std::string &thing);
+    /**
+     * open the trajectory files and start reading. Skip and stride 
+     * continue from one file to the next.
+     */
+    void open(const std::vector<std::string> &files);
+    /**
+     * true if all frames were read. Waits until the reading thread knows
+     * whether there is another frame.
+     */
+    bool eof();
+    /**
+     * get the next frame
+     */
+    InG96Prefetch &operator>>(gcore::System &sys);
+    /**
+     * get the time of the frame which was got last
+     */
+    InG96Prefetch &operator>>(utils::Time &time);
+    /**
+     * name of the file from which the last frame was read
+     */
+    std::string name()const;
+
+    /**
+     * Exception
+     */
+    struct Exception: public gromos::Exception{
+      Exception(const std::string& what_arg) : 
+        gromos::Exception("InG96Prefetch", what_arg){}
+    };
+  };
+}
+#endif
@@ -0,0 +1,247 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_InG96Prefetch.t.cc
+// reads three trajectory files with InG96 and with InG96Prefetch (for
+// several skip, stride and prefetch depths) and checks that the same
+// frames are delivered. The wall clock time of a loop with a simulated
+// analysis is compared.
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "InG96.h"
+#include "InG96Prefetch.h"
+#include "OutG96.h"
+#include "gzstream.h"
+#include "../gcore/System.h"
+#include "../gcore/Molecule.h"
+#include "../gcore/MoleculeTopology.h"
+#include "../gcore/AtomTopology.h"
+#include "../gcore/Solvent.h"
+#include "../gcore/SolventTopology.h"
+#include "../gcore/Box.h"
+#include "../gmath/Vec.h"
+#include "../utils/groTime.h"
+
+using namespace std;
+using namespace gcore;
+using namespace gio;
+
+const int numSolute = 1000, numSolvent = 10000;
+
+System makeSystem() {
+  MoleculeTopology mt;
+  AtomTopology at;
+  for (int i = 0; i < numSolute; ++i) {
+    mt.addAtom(at);
+    mt.setResNum(i, i / 10);
+  }
+  SolventTopology st;
+  st.addAtom(at);
+  st.addAtom(at);
+  st.addAtom(at);
+  System sys;
+  sys.addMolecule(Molecule(mt));
+  sys.addSolvent(Solvent(st));
+  sys.mol(0).initPos();
+  return sys;
+}
+
+void makeFrame(System &sys, int f) {
+  for (int a = 0; a < numSolute; ++a)
+    sys.mol(0).pos(a) = gmath::Vec(f, a, 0.001 * a);
+  sys.sol(0).setNumPos(0);
+  for (int a = 0; a < 3 * numSolvent; ++a)
+    sys.sol(0).addPos(gmath::Vec(-f, 0.01 * a, a % 7));
+  sys.box() = Box(gmath::Vec(3.0 + f, 0.0, 0.0),
+          gmath::Vec(0.0, 3.0, 0.0), gmath::Vec(0.0, 0.0, 3.0));
+  sys.box().setNtb(Box::rectangular);
+  sys.box().boxformat() = Box::genbox;
+}
+
+void writeTrajectory(ostream &os, int first, int num) {
+  System sys = makeSystem();
+  OutG96 oc(os);
+  oc.select("ALL");
+  oc.writeTitle("prefetch test");
+  for (int f = first; f < first + num; ++f) {
+    makeFrame(sys, f);
+    oc.writeTimestep(f, 0.5 * f);
+    oc << sys;
+  }
+  oc.close();
+}
+
+// a frame as seen by the program
+struct Frame {
+  double step, time, box, solute, solvent;
+  int numSolvent;
+
+  Frame(const System &sys, const utils::Time &t) :
+  step(t.steps()), time(t.time()), box(sys.box().K()[0]),
+  solute(sys.mol(0).pos(numSolute - 1)[2]),
+  solvent(sys.sol(0).pos(sys.sol(0).numPos() - 1)[1]),
+  numSolvent(sys.sol(0).numPos()) {
+  }
+
+  bool operator==(const Frame &f)const {
+    return step == f.step && time == f.time && box == f.box &&
+            solute == f.solute && solvent == f.solvent &&
+            numSolvent == f.numSolvent;
+  }
+};
+
+void analyse(const System &sys, double work) {
+  // stands in for an analysis (sleeping, such that the overlap with 
+  // reading also shows on a single core)
+  if (work > 0.0)
+    std::this_thread::sleep_for(std::chrono::microseconds(int(work * 1e6)));
+}
+
+vector<Frame> readSerial(const vector<string> &files, int skip, int stride,
+        double work = 0.0) {
+  System sys = makeSystem();
+  utils::Time t;
+  vector<Frame> frames;
+  InG96 ic(skip, stride);
+  for (unsigned int i = 0; i < files.size(); ++i) {
+    ic.open(files[i]);
+    ic.select("ALL");
+    while (!ic.eof()) {
+      ic >> sys;
+      if (ic.stride_eof()) break;
+      ic >> t;
+      frames.push_back(Frame(sys, t));
+      analyse(sys, work);
+    }
+    ic.close();
+  }
+  return frames;
+}
+
+vector<Frame> readPrefetch(const vector<string> &files, int skip, int stride,
+        int depth, double work = 0.0) {
+  System sys = makeSystem();
+  // keep a reference like bound::Boundary does
+  const gmath::Vec *first = &sys.mol(0).pos(0);
+  utils::Time t;
+  vector<Frame> frames;
+  InG96Prefetch ip(sys, t, skip, stride, depth);
+  ip.select("ALL");
+  ip.open(files);
+  while (!ip.eof()) {
+    ip >> sys >> t;
+    assert(first == &sys.mol(0).pos(0));
+    frames.push_back(Frame(sys, t));
+    analyse(sys, work);
+  }
+  return frames;
+}
+
+int main() {
+  vector<string> files;
+  files.push_back("InG96Prefetch_test1.trc");
+  files.push_back("InG96Prefetch_test2.trc.gz");
+  files.push_back("InG96Prefetch_test3.trc");
+  {
+    ofstream f1(files[0].c_str());
+    writeTrajectory(f1, 0, 7);
+    ogzstream f2(files[1].c_str());
+    writeTrajectory(f2, 7, 5);
+    f2.close();
+    ofstream f3(files[2].c_str());
+    writeTrajectory(f3, 12, 9);
+  }
+
+  const int skipStride[][2] = {
+    {0, 1}, {3, 1}, {0, 3}, {2, 5}, {1, 7}, {9, 2}, {30, 1}
+  };
+  for (unsigned int i = 0; i < sizeof (skipStride) / sizeof (skipStride[0]); ++i) {
+    const int skip = skipStride[i][0], stride = skipStride[i][1];
+    const vector<Frame> ref = readSerial(files, skip, stride);
+    for (int depth = 1; depth <= 3; ++depth) {
+      const vector<Frame> got = readPrefetch(files, skip, stride, depth);
+      assert(got == ref);
+    }
+  }
+
+  // errors are reported when the frame is requested
+  {
+    vector<string> missing(files);
+    missing.push_back("InG96Prefetch_missing.trc");
+    System sys = makeSystem();
+    utils::Time t;
+    InG96Prefetch ip(sys, t);
+    ip.select("ALL");
+    ip.open(missing);
+    int frames = 0;
+    bool thrown = false;
+    try {
+      while (!ip.eof()) {
+        ip >> sys >> t;
+        ++frames;
+      }
+    } catch (const gromos::Exception &e) {
+      thrown = true;
+    }
+    assert(thrown && frames == 21);
+  }
+
+  // a frame which is not requested must not block the destructor
+  {
+    System sys = makeSystem();
+    utils::Time t;
+    InG96Prefetch ip(sys, t, 0, 1, 2);
+    ip.select("ALL");
+    ip.open(files);
+    ip >> sys;
+  }
+
+  // an analysis which takes as long as reading the frame
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  readSerial(files, 0, 1);
+  const double work = std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - start).count() / 21;
+  start = std::chrono::steady_clock::now();
+  readSerial(files, 0, 1, work);
+  std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+  readPrefetch(files, 0, 1, 2, work);
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  cout << "21 frames of " << numSolute + 3 * numSolvent << " atoms, "
+          << work << " s analysis per frame" << endl
+          << "InG96         : "
+          << std::chrono::duration<double>(middle - start).count() << " s" << endl
+          << "InG96Prefetch : "
+          << std::chrono::duration<double>(end - middle).count() << " s" << endl;
+
+  for (unsigned int i = 0; i < files.size(); ++i)
+    remove(files[i].c_str());
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_NeighbourMatrix.cc
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "NeighbourMatrix.h"
+
+using gio::NeighbourMatrix;
+
+namespace {
+  const int marker = -1;
+  const int version = 1;
+
+  template<typename T>
+  void writeValue(std::ostream &os, const T &v) {
+    os.write((const char*) &v, sizeof (T));
+  }
+
+  template<typename T>
+  void readValue(std::istream &is, T &v, const char *what) {
+    if (!is.read((char*) &v, sizeof (T)))
+      throw NeighbourMatrix::Exception(std::string("could not read ") + what);
+  }
+}
+
+void NeighbourMatrix::writeHeader(std::ostream &os)const {
+  writeValue(os, marker);
+  writeValue(os, version);
+  writeValue(os, num);
+  writeValue(os, skip);
+  writeValue(os, stride);
+  writeValue(os, precision);
+  writeValue(os, icutoff);
+  const int values = hasValues ? 1 : 0;
+  writeValue(os, values);
+}
+
+void NeighbourMatrix::writeRow(std::ostream &os, unsigned int count,
+        const unsigned int *index, const unsigned int *value)const {
+  writeValue(os, count);
+  if (count == 0) return;
+  os.write((const char*) index, count * sizeof (unsigned int));
+  if (hasValues)
+    os.write((const char*) value, count * sizeof (unsigned int));
+}
+
+bool NeighbourMatrix::readMarker(std::istream &is, int &first) {
+  first = 0;
+  if (!is.read((char*) &first, sizeof (int)))
+    throw Exception("could not read number of structures");
+  return first == marker;
+}
+
+void NeighbourMatrix::read(std::istream &is, int maxrows,
+        unsigned int maxvalue) {
+  int v, values;
+  readValue(is, v, "version");
+  if (v != version)
+    throw Exception("unknown version of the sparse rmsd matrix format");
+  readValue(is, num, "number of structures");
+  if (num < 0)
+    throw Exception("read negative number of structures");
+  readValue(is, skip, "skip");
+  readValue(is, stride, "stride");
+  if (skip < 0 || stride < 0)
+    throw Exception("read negative skip or stride");
+  readValue(is, precision, "precision");
+  if (precision < 0)
+    throw Exception("read negative precision");
+  readValue(is, icutoff, "cutoff");
+  readValue(is, values, "flag for values");
+  hasValues = values != 0;
+
+  const int n = (maxrows >= 0 && maxrows < num) ? maxrows : num;
+  const unsigned int limit = unsigned(n);
+  offset.assign(1, 0);
+  index.clear();
+  value.clear();
+  std::vector<unsigned int> row_index, row_value;
+  for (int i = 0; i < num; ++i) {
+    unsigned int count;
+    readValue(is, count, "number of neighbours");
+    row_index.resize(count);
+    row_value.resize(count);
+    if (count && !is.read((char*) &row_index[0], count * sizeof (unsigned int)))
+      throw Exception("file corrupt (neighbours)");
+    if (count && hasValues &&
+            !is.read((char*) &row_value[0], count * sizeof (unsigned int)))
+      throw Exception("file corrupt (values)");
+    if (i >= n) continue;
+    for (unsigned int k = 0; k < count; ++k) {
+      if (row_index[k] <= unsigned(i) || row_index[k] >= unsigned(num))
+        throw Exception("file corrupt (neighbour out of range)");
+      if (row_index[k] >= limit) break;
+      if (hasValues) {
+        if (row_value[k] >= maxvalue) continue;
+        value.push_back(row_value[k]);
+      }
+      index.push_back(row_index[k]);
+    }
+    offset.push_back(index.size());
+  }
+}
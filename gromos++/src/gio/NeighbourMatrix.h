@@ -0,0 +1,118 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_NeighbourMatrix.h
+
+#ifndef INCLUDED_GIO_NEIGHBOURMATRIX
+#define INCLUDED_GIO_NEIGHBOURMATRIX
+
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+#include "../gromos/Exception.h"
+
+namespace gio{
+
+  /**
+   * Class NeighbourMatrix
+   * Sparse rmsd matrix that only contains the pairs of structures with an
+   * rmsd below a cutoff, as written by program rmsdmat (\@sparse) and read
+   * by program cluster.
+   *
+   * In memory, the upper triangle is stored in compressed sparse row
+   * format: the neighbours j > i of structure i are
+   * index[offset[i]] ... index[offset[i + 1] - 1] in increasing order,
+   * and, if the matrix has values, value[k] is the rmsd of the pair k
+   * multiplied by the precision.
+   *
+   * The binary file starts like the dense RMSDMAT.bin, but with a marker
+   * (-1, an invalid number of structures) and a version in front of the
+   * number of structures, skip, stride and precision. The header ends with
+   * the integer cutoff (pairs with rmsd * precision < cutoff are stored)
+   * and a flag for the values. Every row follows as the number of
+   * neighbours, their indices and, optionally, their values. All numbers
+   * are 4 byte integers in the byte order of the machine, like in
+   * RMSDMAT.bin.
+   *
+   * @class NeighbourMatrix
+   * @ingroup gio
+   */
+  class NeighbourMatrix{
+  public:
+    int num;
+    int skip;
+    int stride;
+    int precision;
+    /**
+     * pairs with rmsd * precision < icutoff are stored
+     */
+    unsigned int icutoff;
+    bool hasValues;
+    std::vector<size_t> offset;
+    std::vector<unsigned int> index;
+    std::vector<unsigned int> value;
+
+    NeighbourMatrix() : num(0), skip(0), stride(1), precision(10000),
+    icutoff(0), hasValues(false), offset(1, 0) {}
+
+    /**
+     * number of rows
+     */
+    int rows()const { return offset.size() - 1; }
+    /**
+     * number of stored pairs
+     */
+    size_t size()const { return index.size(); }
+
+    /**
+     * writes the header
+     */
+    void writeHeader(std::ostream &os)const;
+    /**
+     * writes the neighbours of the next row. The values are only
+     * written if the header announced them.
+     */
+    void writeRow(std::ostream &os, unsigned int count,
+            const unsigned int *index, const unsigned int *value)const;
+    /**
+     * true if the stream starts with the marker of the sparse format.
+     * The stream is positioned after the marker, otherwise after the 
+     * first integer (the number of structures of a dense matrix), which
+     * is returned in first.
+     */
+    static bool readMarker(std::istream &is, int &first);
+    /**
+     * reads the header and the rows after the marker. Only the rows and
+     * neighbours below maxrows (if >= 0) are kept and, if the matrix has
+     * values, only the pairs with a value below maxvalue.
+     */
+    void read(std::istream &is, int maxrows = -1,
+            unsigned int maxvalue = ~0u);
+
+    /**
+     * Exception
+     */
+    struct Exception: public gromos::Exception{
+      Exception(const std::string& what_arg) : 
+      gromos::Exception("NeighbourMatrix", what_arg){}
+    };
+  };
+}
+#endif
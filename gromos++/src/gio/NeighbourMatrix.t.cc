@@ -0,0 +1,101 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_NeighbourMatrix.t.cc
+// writes a random sparse matrix and reads it back, completely and with a
+// smaller number of rows and a smaller cutoff
+
+#include <cassert>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+#include "NeighbourMatrix.h"
+
+using namespace std;
+using gio::NeighbourMatrix;
+
+int main() {
+  srand(13);
+  const int num = 200;
+  NeighbourMatrix out;
+  out.num = num;
+  out.skip = 2;
+  out.stride = 3;
+  out.precision = 1000;
+  out.icutoff = 150;
+  out.hasValues = true;
+
+  // values[i][j]: rmsd of the pair (i, j) times the precision
+  vector<vector<unsigned int> > values(num, vector<unsigned int>(num));
+  ostringstream os;
+  out.writeHeader(os);
+  for (int i = 0; i < num; ++i) {
+    vector<unsigned int> index, value;
+    for (int j = i + 1; j < num; ++j) {
+      values[i][j] = rand() % 1000;
+      if (values[i][j] < out.icutoff) {
+        index.push_back(j);
+        value.push_back(values[i][j]);
+      }
+    }
+    out.writeRow(os, index.size(), index.empty() ? 0 : &index[0],
+            value.empty() ? 0 : &value[0]);
+  }
+
+  for (int test = 0; test < 2; ++test) {
+    const int maxrows = test ? 120 : -1;
+    const unsigned int maxvalue = test ? 80 : out.icutoff;
+    const int rows = test ? maxrows : num;
+
+    istringstream is(os.str());
+    NeighbourMatrix in;
+    int first;
+    assert(NeighbourMatrix::readMarker(is, first));
+    in.read(is, maxrows, maxvalue);
+    assert(in.num == num && in.skip == 2 && in.stride == 3);
+    assert(in.precision == 1000 && in.icutoff == 150 && in.hasValues);
+    assert(in.rows() == rows);
+    assert(in.value.size() == in.size());
+
+    size_t k = 0;
+    for (int i = 0; i < rows; ++i) {
+      assert(in.offset[i] == k);
+      for (int j = i + 1; j < rows; ++j) {
+        if (values[i][j] < maxvalue) {
+          assert(in.index[k] == unsigned(j));
+          assert(in.value[k] == values[i][j]);
+          ++k;
+        }
+      }
+    }
+    assert(in.offset[rows] == k && in.size() == k);
+  }
+
+  // a dense matrix starts with the number of structures
+  {
+    ostringstream dense;
+    dense.write((const char*) &num, sizeof (int));
+    istringstream is(dense.str());
+    int first;
+    assert(!NeighbourMatrix::readMarker(is, first) && first == num);
+  }
+  return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_OutBinTrc.cc
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include "../gromos/Exception.h"
+#include "../gcore/System.h"
+#include "../gcore/Molecule.h"
+#include "../gcore/Solvent.h"
+#include "../gcore/Box.h"
+#include "../gcore/Remd.h"
+#include "../gmath/Vec.h"
+#include "../utils/AtomSpecifier.h"
+#include "../utils/VirtualAtom.h"
+#include "BinTrc.h"
+#include "OutBinTrc.h"
+
+using gio::OutBinTrc;
+using namespace gcore;
+using namespace std;
+
+class gio::OutBinTrc_i{
+  friend class gio::OutBinTrc;
+  ostream &d_os;
+  int d_switch;
+  bool d_header;
+  BinTrc::Frame d_frame;
+  OutBinTrc_i(ostream &os, double precision):
+    d_os(os), d_switch(0), d_header(false)
+  {d_frame.precision = precision;}
+  ~OutBinTrc_i(){}
+
+  void writeHeader(const string &title);
+  void writeFrame(const System &sys);
+};
+
+OutBinTrc::OutBinTrc(double precision):
+  OutCoordinates(),
+  d_this(0),
+  d_precision(precision){}
+
+OutBinTrc::OutBinTrc(ostream &os, double precision):
+  OutCoordinates(),
+  d_this(new OutBinTrc_i(os, precision)),
+  d_precision(precision){}
+
+OutBinTrc::~OutBinTrc(){
+  if(d_this)delete d_this;
+}
+
+void OutBinTrc::open(ostream &os){
+  int sel = 0;
+  if(d_this){
+    sel = d_this->d_switch;
+    delete d_this;
+  }
+  d_this=new OutBinTrc_i(os, d_precision);
+  d_this->d_switch = sel;
+}
+
+void OutBinTrc::close(){
+  if(d_this){
+    d_this->d_os.flush();
+    delete d_this;
+  }
+  d_this=0;
+}
+
+void OutBinTrc::select(const string &thing){
+  if (thing == "ALL"){
+    d_this->d_switch = 1;
+  } else if (thing =="SOLVENT"){
+    d_this->d_switch = 2;
+  } else if (thing == "SOLUTEV") {
+    d_this->d_switch = 3;
+  } else if (thing == "ALLV") {
+    d_this->d_switch = 4;
+  } else if (thing == "SOLVENTV") {
+    d_this->d_switch = 5;
+  } else {
+    d_this->d_switch = 0;
+  }
+}
+
+void OutBinTrc::writeTitle(const string &title){
+  if (d_this->d_header)
+    throw gromos::Exception("OutBinTrc", "the title has to be written "
+          "before the first frame");
+  d_this->writeHeader(title);
+}
+
+void OutBinTrc::writeTimestep(const int step, const double time){
+  d_this->d_frame.hasTime = true;
+  d_this->d_frame.step = step;
+  d_this->d_frame.time = time;
+}
+
+OutBinTrc &OutBinTrc::operator<<(const System &sys){
+  vector<gmath::Vec> &pos = d_this->d_frame.pos;
+  pos.clear();
+  const int sw = d_this->d_switch;
+  if (sw == 0 || sw == 1 || sw == 3 || sw == 4) {
+    for(int m = 0; m < sys.numMolecules(); ++m)
+      for(int a = 0; a < sys.mol(m).numPos(); ++a)
+        pos.push_back(sys.mol(m).pos(a));
+  }
+  if (sw == 3 || sw == 4 || sw == 5) {
+    for (unsigned int i = 0; i < sys.vas().numVirtualAtoms(); ++i)
+      pos.push_back(sys.vas().atom(i).pos());
+  }
+  if (sw == 1 || sw == 2 || sw == 4 || sw == 5) {
+    for(int s = 0; s < sys.numSolvents(); ++s)
+      for(int a = 0; a < sys.sol(s).numPos(); ++a)
+        pos.push_back(sys.sol(s).pos(a));
+  }
+  d_this->writeFrame(sys);
+  return *this;
+}
+
+OutBinTrc &OutBinTrc::operator<<(const utils::AtomSpecifier & atoms){
+  vector<gmath::Vec> &pos = d_this->d_frame.pos;
+  pos.resize(atoms.size());
+  for (unsigned int i = 0; i < atoms.size(); ++i)
+    pos[i] = atoms.pos(i);
+  d_this->writeFrame(*atoms.sys());
+  return *this;
+}
+
+void gio::OutBinTrc_i::writeHeader(const string &title){
+  BinTrc::writeHeader(d_os, title);
+  d_header = true;
+}
+
+void gio::OutBinTrc_i::writeFrame(const System &sys){
+  if (!d_header)
+    writeHeader("");
+  // like OutG96 the box is always written
+  d_frame.hasBox = true;
+  d_frame.ntb = sys.box().ntb();
+  d_frame.boxformat = sys.box().boxformat();
+  d_frame.K = sys.box().K();
+  d_frame.L = sys.box().L();
+  d_frame.M = sys.box().M();
+  d_frame.hasRemd = sys.hasRemd;
+  if (sys.hasRemd)
+    d_frame.remd = sys.remd();
+  BinTrc::write(d_os, d_frame);
+  if (!d_os.good())
+    throw gromos::Exception("OutBinTrc", "could not write frame");
+  // the time has to be given for every frame
+  d_frame.hasTime = false;
+}
@@ -0,0 +1,80 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_OutBinTrc.h
+
+#ifndef INCLUDED_GIO_OUTBINTRC
+#define INCLUDED_GIO_OUTBINTRC
+
+#include<string>
+#include "OutCoordinates.h"
+
+namespace gcore{
+  class System;
+}
+
+namespace utils {
+  class AtomSpecifier;
+}
+
+namespace gio{
+  class OutBinTrc_i;
+  /**
+   * Class OutBinTrc
+   * is of type OutCoordinates and writes a binary coordinate trajectory
+   * (see gio::BinTrc) with the coordinates, the TIMESTEP, box and REMD 
+   * information. The coordinates are stored to 1/precision nm. 
+   * The stream should be opened in binary mode.
+   *
+   * @class OutBinTrc
+   * @ingroup gio
+   * @sa gio::InBinTrc
+   */
+  class OutBinTrc: public OutCoordinates{
+    OutBinTrc_i *d_this;
+    double d_precision;
+    // prevent copying and assignment
+    OutBinTrc(const OutBinTrc &);
+    OutBinTrc &operator=(const OutBinTrc&);
+  public:
+    /**
+     * Constructor
+     * @param precision : coordinates are rounded to 1/precision nm
+     */
+    OutBinTrc(double precision = 1000.0);
+    OutBinTrc(std::ostream &os, double precision = 1000.0);
+    ~OutBinTrc();
+    void select(const std::string &thing);
+    void open(std::ostream &os);
+    void close();
+    /**
+     * the title has to be written before the first frame
+     */
+    void writeTitle(const std::string &title);
+    /**
+     * the time is stored with the next frame
+     */
+    void writeTimestep(const int step, const double time);
+    OutBinTrc &operator<<(const gcore::System &sys);
+    OutBinTrc &operator<<(const utils::AtomSpecifier & atoms);
+  };
+}
+
+#endif
@@ -0,0 +1,247 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_OutBinTrc.t.cc
+// writes a trajectory with OutBinTrc, reads it back with InG96 and checks
+// coordinates (to the precision), time, box and REMD information as well
+// as skipping, striding and positioning. Sizes and reading times are 
+// compared to the POSITIONRED trajectory written by OutG96.
+
+#include <cassert>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <cmath>
+#include <set>
+#include <string>
+#include <fstream>
+#include <iostream>
+
+#include "InG96.h"
+#include "OutG96.h"
+#include "OutBinTrc.h"
+#include "gzstream.h"
+#include "../gcore/System.h"
+#include "../gcore/Molecule.h"
+#include "../gcore/MoleculeTopology.h"
+#include "../gcore/AtomTopology.h"
+#include "../gcore/Solvent.h"
+#include "../gcore/SolventTopology.h"
+#include "../gcore/Box.h"
+#include "../gcore/Remd.h"
+#include "../gmath/Vec.h"
+#include "../utils/groTime.h"
+
+using namespace std;
+using namespace gcore;
+using namespace gio;
+
+const int numSolute = 500, numSolvent = 5000, numFrames = 20;
+const double precision = 1000.0;
+
+double random(double range) {
+  return range * rand() / RAND_MAX - 0.5 * range;
+}
+
+// coordinates of frame f
+void makeFrame(System &sys, int f) {
+  srand(1000 + f);
+  gmath::Vec p(0.0, 0.0, 0.0);
+  for (int a = 0; a < numSolute; ++a) {
+    p += gmath::Vec(random(0.18), random(0.18), random(0.18));
+    sys.mol(0).pos(a) = p;
+  }
+  sys.sol(0).setNumPos(0);
+  for (int m = 0; m < numSolvent; ++m) {
+    gmath::Vec o(random(5.0), random(5.0), random(5.0));
+    sys.sol(0).addPos(o);
+    sys.sol(0).addPos(o + gmath::Vec(0.1, 0.0, 0.0));
+    sys.sol(0).addPos(o + gmath::Vec(-0.033, 0.094, 0.0));
+  }
+  sys.box() = Box(gmath::Vec(5.0 + 0.01 * f, 0.0, 0.0), 
+          gmath::Vec(0.0, 5.0, 0.0), gmath::Vec(0.0, 0.0, 5.0));
+  sys.box().setNtb(Box::rectangular);
+  sys.box().boxformat() = Box::genbox;
+  sys.remd() = Remd(f, 2 * f, 3, 4, 5, 6, 7, 300.0 + f, 0.5);
+}
+
+int time(int f, double &t) {
+  t = 0.002 * 1000 * f;
+  return 1000 * f;
+}
+
+System makeSystem() {
+  MoleculeTopology mt;
+  AtomTopology at;
+  for (int i = 0; i < numSolute; ++i) {
+    mt.addAtom(at);
+    mt.setResNum(i, i / 10);
+  }
+  SolventTopology st;
+  st.addAtom(at);
+  st.addAtom(at);
+  st.addAtom(at);
+  System sys;
+  sys.addMolecule(Molecule(mt));
+  sys.addSolvent(Solvent(st));
+  sys.mol(0).initPos();
+  sys.hasRemd = true;
+  return sys;
+}
+
+long fileSize(const string &name) {
+  ifstream f(name.c_str(), ios::binary | ios::ate);
+  return f.tellg();
+}
+
+// reads the frames (with skip and stride) and checks them. Like for 
+// G96 trajectories frames skip + stride - 1, skip + 2 * stride - 1, ... 
+// are read.
+int readBack(const string &name, int skip, int stride) {
+  System sys = makeSystem(), ref = makeSystem();
+  utils::Time t;
+  t.read() = true;
+  InG96 ic(skip, stride);
+  ic.open(name);
+  assert(ic.title() == "binary test");
+  ic.select("ALL");
+  int frame = skip + stride - 1, frames = 0;
+  while (!ic.eof()) {
+    ic >> sys >> t;
+    if (ic.stride_eof()) break;
+    makeFrame(ref, frame);
+    double tref;
+    assert(t.steps() == time(frame, tref) && t.time() == tref);
+    assert(sys.sol(0).numPos() == ref.sol(0).numPos());
+    for (int a = 0; a < numSolute; ++a)
+      for (int i = 0; i < 3; ++i)
+        assert(fabs(sys.mol(0).pos(a)[i] - ref.mol(0).pos(a)[i]) <= 
+               0.5 / precision + 1e-12);
+    for (int a = 0; a < ref.sol(0).numPos(); ++a)
+      for (int i = 0; i < 3; ++i)
+        assert(fabs(sys.sol(0).pos(a)[i] - ref.sol(0).pos(a)[i]) <= 
+               0.5 / precision + 1e-12);
+    assert(sys.hasBox && sys.box().K()[0] == ref.box().K()[0]);
+    assert(sys.box().ntb() == Box::rectangular);
+    assert(sys.box().boxformat() == Box::genbox);
+    assert(sys.hasRemd && sys.remd().id() == frame && 
+           sys.remd().temperature() == 300.0 + frame);
+    ++frames;
+    frame += stride;
+  }
+  ic.close();
+  return frames;
+}
+
+int main() {
+  const string text = "OutBinTrc_test.trc", bin = "OutBinTrc_test.btrc",
+          gz = "OutBinTrc_test.btrc.gz";
+
+  System sys = makeSystem();
+  ofstream ft(text.c_str());
+  OutG96 ot(ft);
+  ofstream fb(bin.c_str(), ios::binary);
+  OutBinTrc ob(fb, precision);
+  ogzstream fz(gz.c_str());
+  OutBinTrc oz(fz, precision);
+  ot.select("ALL");
+  ob.select("ALL");
+  oz.select("ALL");
+  ot.writeTitle("binary test");
+  ob.writeTitle("binary test");
+  oz.writeTitle("binary test");
+  for (int f = 0; f < numFrames; ++f) {
+    makeFrame(sys, f);
+    double t;
+    const int step = time(f, t);
+    ot.writeTimestep(step, t);
+    ob.writeTimestep(step, t);
+    oz.writeTimestep(step, t);
+    ot << sys;
+    ob << sys;
+    oz << sys;
+  }
+  ot.close();
+  ob.close();
+  oz.close();
+  ft.close();
+  fb.close();
+  fz.close();
+
+  // round trip, also with skip and stride
+  clock_t start = clock();
+  assert(readBack(bin, 0, 1) == numFrames);
+  const double t_bin = double(clock() - start) / CLOCKS_PER_SEC;
+  assert(readBack(gz, 0, 1) == numFrames);
+  assert(readBack(bin, 3, 1) == numFrames - 3);
+  assert(readBack(bin, 0, 3) == numFrames / 3);
+  assert(readBack(bin, 2, 5) == (numFrames - 2) / 5);
+  assert(readBack(gz, 1, 7) == (numFrames - 1) / 7);
+
+  // positioning
+  {
+    System s = makeSystem(), ref = makeSystem();
+    InG96 ic(bin);
+    ic.select("ALL");
+    assert(ic.numFrames() == numFrames);
+    ic.seekFrame(7);
+    assert(ic.frame() == 7);
+    ic >> s;
+    makeFrame(ref, 7);
+    assert(fabs(s.sol(0).pos(10)[1] - ref.sol(0).pos(10)[1]) <= 
+           0.5 / precision + 1e-12);
+    double t;
+    time(12, t);
+    ic.seekTime(t);
+    assert(ic.frame() == 12);
+    ic.seekFrame(numFrames);
+    assert(ic.eof());
+  }
+
+  // the text trajectory for comparison
+  start = clock();
+  {
+    System s = makeSystem();
+    InG96 ic(text);
+    ic.select("ALL");
+    int frames = 0;
+    while (!ic.eof()) {
+      ic >> s;
+      ++frames;
+    }
+    assert(frames == numFrames);
+  }
+  const double t_text = double(clock() - start) / CLOCKS_PER_SEC;
+
+  cout << numFrames << " frames of " << numSolute + 3 * numSolvent 
+          << " atoms" << endl
+          << "POSITIONRED   : " << fileSize(text) << " bytes, read in " 
+          << t_text << " s" << endl
+          << "binary        : " << fileSize(bin) << " bytes, read in " 
+          << t_bin << " s" << endl
+          << "binary gzip   : " << fileSize(gz) << " bytes" << endl
+          << "size ratio    : " << double(fileSize(text)) / fileSize(bin) 
+          << endl;
+
+  remove(text.c_str());
+  remove(bin.c_str());
+  remove(gz.c_str());
+  return 0;
+}
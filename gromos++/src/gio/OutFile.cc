@@ -0,0 +1,48 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_OutFile.cc
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../args/Arguments.h"
+#include "../gromos/Exception.h"
+#include "gzstream.h"
+#include "OutFile.h"
+
+std::ostream *gio::openOutput(const args::Arguments &args,
+        const std::string &name) {
+  if (args.count(name) <= 0)
+    return &std::cout;
+
+  const std::string file = args.find(name)->second;
+  std::ostream *os;
+  if (file.size() > 3 && file.substr(file.size() - 3) == ".gz")
+    os = new ogzstream(file.c_str());
+  else
+    os = new std::ofstream(file.c_str(), std::ios::out | std::ios::binary);
+  if (!os->good()) {
+    delete os;
+    throw gromos::Exception("openOutput", "could not open " + file);
+  }
+  return os;
+}
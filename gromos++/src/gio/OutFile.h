@@ -0,0 +1,52 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_OutFile.h
+
+#ifndef INCLUDED_GIO_OUTFILE
+#define INCLUDED_GIO_OUTFILE
+
+#include <iosfwd>
+#include <string>
+
+namespace args{
+  class Arguments;
+}
+
+namespace gio{
+
+  /**
+   * Opens the output file of a program, given by argument name. The file
+   * is block gzip compressed (gio::ogzstream) if its name ends in .gz.
+   * Without the argument the output goes to std::cout. Throws a
+   * gromos::Exception if the file cannot be opened.
+   *
+   * @param args the arguments of the program
+   * @param name the argument holding the file name
+   * @return the stream, to be deleted (unless it is std::cout) to close
+   *         the file
+   * @ingroup gio
+   */
+  std::ostream *openOutput(const args::Arguments &args,
+          const std::string &name = "outfile");
+
+}
+
+#endif
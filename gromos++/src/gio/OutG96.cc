@@ -250,9 +250,9 @@ void gio::OutG96_i::writeTrajM(const Molecule &mol){
     ++d_count;
     d_os << setw(15) << mol.pos(i)[0]
 	 << setw(15) << mol.pos(i)[1]
-	 << setw(15) << mol.pos(i)[2]<< endl;
+	 << setw(15) << mol.pos(i)[2]<< '\n';
     if(!(d_count%10))
-      d_os << "#" << setw(10)<<d_count<<endl;
+      d_os << "#" << setw(10)<<d_count<< '\n';
   } 
 }
 void gio::OutG96_i::writeTrajV(const gcore::System &sys){
@@ -262,9 +262,9 @@ void gio::OutG96_i::writeTrajV(const gcore::System &sys){
     ++d_count;
     d_os << setw(15) << sys.vas().atom(i).pos()[0]
 	 << setw(15) << sys.vas().atom(i).pos()[1]
-	 << setw(15) << sys.vas().atom(i).pos()[2]<< endl;
+	 << setw(15) << sys.vas().atom(i).pos()[2]<< '\n';
     if(!(d_count%10))
-      d_os << "#" << setw(10)<<d_count<<endl;
+      d_os << "#" << setw(10)<<d_count<< '\n';
   } 
 }
 void gio::OutG96_i::writeTrajS(const Solvent &sol){
@@ -274,9 +274,9 @@ void gio::OutG96_i::writeTrajS(const Solvent &sol){
     ++d_count;
     d_os << setw(15) << sol.pos(i)[0]
 	 << setw(15) << sol.pos(i)[1]
-	 << setw(15) << sol.pos(i)[2]<< endl;
+	 << setw(15) << sol.pos(i)[2]<< '\n';
     if(!(d_count%10))
-      d_os << "#" << setw(10)<<d_count<<endl;
+      d_os << "#" << setw(10)<<d_count<< '\n';
   } 
 }
 
@@ -287,18 +287,18 @@ void gio::OutG96_i::writeBox(const Box &box){
 
   d_os << setw(15) << box.K()[0]
        << setw(15) << box.L()[1]
-       << setw(15) << box.M()[2] << endl;
+       << setw(15) << box.M()[2] << '\n';
 }
 
 void gio::OutG96_i::writeTriclinicBox(const Box &box){
   d_os.setf(ios::fixed, ios::floatfield);
   d_os.precision(9);
 
-  d_os << setw(8) << box.ntb() << endl;
+  d_os << setw(8) << box.ntb() << '\n';
   for(int i=0; i<3; ++i){
     d_os << setw(15) << box.K()[i] 
 	 << setw(15) << box.L()[i]
-	 << setw(15) << box.M()[i] << endl;
+	 << setw(15) << box.M()[i] << '\n';
   }
 }
 
@@ -308,19 +308,19 @@ void gio::OutG96_i::writeGenBox(const Box &box){
   const double k=box.K().abs();
   const double l=box.L().abs();
   const double m=box.M().abs();
-  d_os << setw(8) << box.ntb() << endl;
+  d_os << setw(8) << box.ntb() << '\n';
   if(box.ntb()==gcore::Box::vacuum)
-    d_os << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << endl
-	 << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << endl
-          << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << endl
-          << setw(15) << box.X() << setw(15) << box.Y() << setw(15) << box.Z() << endl;
+    d_os << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << '\n'
+	 << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << '\n'
+          << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << '\n'
+          << setw(15) << box.X() << setw(15) << box.Y() << setw(15) << box.Z() << '\n';
   else{
     d_os << setw(15) << k
 	 << setw(15) << l
-	 << setw(15) << m << endl;
+	 << setw(15) << m << '\n';
     d_os << setw(15) << acos(box.L().dot(box.M())/(l*m))*180/M_PI
 	 << setw(15) << acos(box.K().dot(box.M())/(k*m))*180/M_PI
-	 << setw(15) << acos(box.K().dot(box.L())/(k*l))*180/M_PI << endl;
+	 << setw(15) << acos(box.K().dot(box.L())/(k*l))*180/M_PI << '\n';
 
     // calculate the Euler rotation angles as described in Phils manuscript:
     // "GROMOS01: Description of the changes", Philippe Huenenberger, October 5, 2004
@@ -353,19 +353,19 @@ void gio::OutG96_i::writeGenBox(const Box &box){
     
     d_os << setw(15) << phi/M_PI*180
 	 << setw(15) << theta/M_PI*180
-	 << setw(15) << psi/M_PI*180 << endl;
+	 << setw(15) << psi/M_PI*180 << '\n';
 
     d_os << setw(15) << box.X()
             << setw(15) << box.Y()
-            << setw(15) << box.Z() << endl;
+            << setw(15) << box.Z() << '\n';
   }
 }
 
 void gio::OutG96_i::writeAtomSpecifier(const AtomSpecifier& atoms) {
-  d_os << "POSITIONRED" << endl;
+  d_os << "POSITIONRED" << '\n';
   d_os.setf(ios::fixed, ios::floatfield);
   d_os.precision(9);
-  d_os << "# selected " << atoms.size() << " atoms" << endl;
+  d_os << "# selected " << atoms.size() << " atoms" << '\n';
   for (unsigned int i = 0; i < atoms.size(); ++i) {
     d_os << setw(15) << atoms.pos(i)[0]
             << setw(15) << atoms.pos(i)[1]
@@ -375,9 +375,9 @@ void gio::OutG96_i::writeAtomSpecifier(const AtomSpecifier& atoms) {
       d_os << "s";
     else 
       d_os << atoms.mol(i) + 1;
-    d_os << ":" << atoms.atom(i) + 1 << endl;
+    d_os << ":" << atoms.atom(i) + 1 << '\n';
     if (!((i + 1) % 10))
-      d_os << "#" << setw(10) << i + 1 << endl;
+      d_os << "#" << setw(10) << i + 1 << '\n';
   }
-  d_os << "END" << endl;
+  d_os << "END" << '\n';
 }
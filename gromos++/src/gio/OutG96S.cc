@@ -342,18 +342,18 @@ void gio::OutG96S_i::writeBox(const Box &box) {
 
   d_os << setw(15) << box.K()[0]
           << setw(15) << box.L()[1]
-          << setw(15) << box.M()[2] << endl;
+          << setw(15) << box.M()[2] << '\n';
 }
 
 void gio::OutG96S_i::writeTriclinicBox(const Box &box) {
   d_os.setf(ios::fixed, ios::floatfield);
   d_os.precision(9);
 
-  d_os << setw(8) << box.ntb() << endl;
+  d_os << setw(8) << box.ntb() << '\n';
   for (int i = 0; i < 3; ++i) {
     d_os << setw(15) << box.K()[i]
             << setw(15) << box.L()[i]
-            << setw(15) << box.M()[i] << endl;
+            << setw(15) << box.M()[i] << '\n';
   }
 
 }
@@ -373,11 +373,11 @@ void gio::OutG96S_i::writeSingleM(const Molecule &mol) {
     d_os.setf(ios::right, ios::adjustfield);
     d_os << setw(6) << d_count;
     if (posres) {
-      d_os << endl;
+      d_os << '\n';
     } else {
       d_os << setw(15) << mol.pos(i)[0]
               << setw(15) << mol.pos(i)[1]
-              << setw(15) << mol.pos(i)[2] << endl;
+              << setw(15) << mol.pos(i)[2] << '\n';
     }
   }
   d_res_off += mol.topology().numRes();
@@ -404,11 +404,11 @@ void gio::OutG96S_i::writeSingleV(const gcore::System &sys) {
     d_os.setf(ios::right, ios::adjustfield);
     d_os << setw(8) << d_count;
     if (posres) {
-      d_os << endl;
+      d_os << '\n';
     } else {
       d_os << setw(15) << sys.vas().atom(i).pos()[0]
               << setw(15) << sys.vas().atom(i).pos()[1]
-              << setw(15) << sys.vas().atom(i).pos()[2] << endl;
+              << setw(15) << sys.vas().atom(i).pos()[2] << '\n';
     }
   }
 }
@@ -430,11 +430,11 @@ void gio::OutG96S_i::writeSingleS(const Solvent &sol) {
     d_os.setf(ios::right, ios::adjustfield);
     d_os << setw(6) << d_count;
     if (posres) {
-      d_os << endl;
+      d_os << '\n';
     } else {
       d_os << setw(15) << sol.pos(i)[0]
               << setw(15) << sol.pos(i)[1]
-              << setw(15) << sol.pos(i)[2] << endl;
+              << setw(15) << sol.pos(i)[2] << '\n';
     }
   }
   //d_res_off += sol.numPos()/na;
@@ -456,7 +456,7 @@ void gio::OutG96S_i::writeSingleM_vel(const Molecule &mol) {
     d_os << setw(6) << d_count
             << setw(15) << mol.vel(i)[0]
             << setw(15) << mol.vel(i)[1]
-            << setw(15) << mol.vel(i)[2] << endl;
+            << setw(15) << mol.vel(i)[2] << '\n';
   }
   d_res_off += mol.topology().numRes();
 }
@@ -478,7 +478,7 @@ void gio::OutG96S_i::writeSingleS_vel(const Solvent &sol) {
     d_os << setw(6) << d_count
             << setw(15) << sol.vel(i)[0]
             << setw(15) << sol.vel(i)[1]
-            << setw(15) << sol.vel(i)[2] << endl;
+            << setw(15) << sol.vel(i)[2] << '\n';
   }
   //d_res_off += sol.numVel()/na;
 }
@@ -489,19 +489,19 @@ void gio::OutG96S_i::writeGenBox(const Box &box) {
   const double k = box.K().abs();
   const double l = box.L().abs();
   const double m = box.M().abs();
-  d_os << setw(8) << box.ntb() << endl;
+  d_os << setw(8) << box.ntb() << '\n';
   if (box.ntb() == gcore::Box::vacuum) {
-    d_os << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << endl
-            << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << endl
-            << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << endl
-            << setw(15) << box.X() << setw(15) << box.Y() << setw(15) << box.Z() << endl;
+    d_os << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << '\n'
+            << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << '\n'
+            << setw(15) << 0.0 << setw(15) << 0.0 << setw(15) << 0.0 << '\n'
+            << setw(15) << box.X() << setw(15) << box.Y() << setw(15) << box.Z() << '\n';
   } else {
     d_os << setw(15) << k
             << setw(15) << l
-            << setw(15) << m << endl;
+            << setw(15) << m << '\n';
     d_os << setw(15) << acos(box.L().dot(box.M()) / (l * m))*180 / M_PI
             << setw(15) << acos(box.K().dot(box.M()) / (k * m))*180 / M_PI
-            << setw(15) << acos(box.K().dot(box.L()) / (k * l))*180 / M_PI << endl;
+            << setw(15) << acos(box.K().dot(box.L()) / (k * l))*180 / M_PI << '\n';
 
     // calculate the Euler rotation angles as described in Phils manuscript:
     // "GROMOS01: Description of the changes", Philippe Huenenberger, October 5, 2004
@@ -534,25 +534,25 @@ void gio::OutG96S_i::writeGenBox(const Box &box) {
     
     d_os << setw(15) << phi/M_PI*180
 	 << setw(15) << theta/M_PI*180
-	 << setw(15) << psi/M_PI*180 << endl;
+	 << setw(15) << psi/M_PI*180 << '\n';
 
     d_os << setw(15) << box.X()
             << setw(15) << box.Y()
-            << setw(15) << box.Z() << endl;
+            << setw(15) << box.Z() << '\n';
   }
 }
 
 void gio::OutG96S_i::writeAtomSpecifier(const AtomSpecifier & atoms, bool vel) {
   if (posres)
-    d_os << "POSRESSPEC" << endl;
+    d_os << "POSRESSPEC" << '\n';
   else if (vel)
-    d_os << "VELOCITY" << endl;
+    d_os << "VELOCITY" << '\n';
   else
-    d_os << "POSITION" << endl;
+    d_os << "POSITION" << '\n';
 
   d_os.setf(ios::fixed, ios::floatfield);
   d_os.precision(9);
-  d_os << "# selected " << atoms.size() << " atoms" << endl;
+  d_os << "# selected " << atoms.size() << " atoms" << '\n';
   d_os.setf(ios::unitbuf);
 
   for (unsigned int i = 0; i < atoms.size(); ++i) {
@@ -572,19 +572,19 @@ void gio::OutG96S_i::writeAtomSpecifier(const AtomSpecifier & atoms, bool vel) {
     d_os.setf(ios::right, ios::adjustfield);
     d_os << setw(6) << atoms.gromosAtom(i) + 1;
     if (posres) {
-      d_os << endl;
+      d_os << '\n';
     } else {
       if (!vel) {
         d_os << setw(15) << atoms.pos(i)[0]
                 << setw(15) << atoms.pos(i)[1]
-                << setw(15) << atoms.pos(i)[2] << endl;
+                << setw(15) << atoms.pos(i)[2] << '\n';
       } else {
         d_os << setw(15) << atoms.vel(i)[0]
                 << setw(15) << atoms.vel(i)[1]
-                << setw(15) << atoms.vel(i)[2] << endl;
+                << setw(15) << atoms.vel(i)[2] << '\n';
       }
     }
   }
-  d_os << "END" << endl;
+  d_os << "END" << '\n';
 }
 
@@ -49,6 +49,11 @@
 #include <gzstream.h>
 #include <iostream>
 #include <cstring>  // for memcpy
+#include <algorithm>
+#include <sys/types.h>
+#ifdef OMP
+#include <omp.h>
+#endif
 
 #ifdef GZSTREAM_NAMESPACE
 namespace GZSTREAM_NAMESPACE {
@@ -58,6 +63,329 @@ namespace GZSTREAM_NAMESPACE {
 // Internal classes to implement gzstream. See header file for user classes.
 // ----------------------------------------------------------------------------
 
+// --------------------------------------
+// class bgzfreader:
+// --------------------------------------
+
+namespace {
+    // number of members compressed or decompressed in one go
+    int batch_size() {
+#ifdef OMP
+        return 4 * omp_get_max_threads();
+#else
+        return 4;
+#endif
+    }
+
+    inline unsigned int get16( const unsigned char* p) {
+        return p[0] | (p[1] << 8);
+    }
+
+    inline unsigned int get32( const unsigned char* p) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+    }
+
+    inline void put16( unsigned char* p, unsigned int v) {
+        p[0] = v & 0xff; p[1] = (v >> 8) & 0xff;
+    }
+
+    inline void put32( unsigned char* p, unsigned int v) {
+        p[0] = v & 0xff; p[1] = (v >> 8) & 0xff;
+        p[2] = (v >> 16) & 0xff; p[3] = (v >> 24) & 0xff;
+    }
+
+    // the size of the member from the BC subfield of the header (the 
+    // header has to be 12 + xlen bytes long), 0 if it is not a BGZF member.
+    int member_size( const unsigned char* header, int xlen) {
+        const unsigned char* extra = header + 12;
+        for ( int i = 0; i + 4 <= xlen; ) {
+            int slen = get16( extra + i + 2);
+            if ( extra[i] == 'B' && extra[i+1] == 'C' && slen == 2 
+                 && i + 6 <= xlen)
+                return get16( extra + i + 4) + 1;
+            i += 4 + slen;
+        }
+        return 0;
+    }
+
+    // reads the fixed part of a member header, returns xlen (0 at the
+    // end of the file, -1 if it is not a BGZF member).
+    int read_header( FILE* file, unsigned char* header) {
+        size_t n = fread( header, 1, 12, file);
+        if ( n == 0)
+            return 0;
+        if ( n != 12 || header[0] != 0x1f || header[1] != 0x8b
+             || header[2] != 8 || ! (header[3] & 4))
+            return -1;
+        int xlen = get16( header + 10);
+        return xlen < 6 ? -1 : xlen;
+    }
+}
+
+bool bgzfreader::is_bgzf( const char* name) {
+    FILE* f = fopen( name, "rb");
+    if ( f == 0)
+        return false;
+    unsigned char header[12 + 256];
+    int xlen = read_header( f, header);
+    bool bgzf = xlen > 0 && xlen <= 256 
+                && fread( header + 12, 1, xlen, f) == size_t(xlen)
+                && member_size( header, xlen) > 0;
+    fclose( f);
+    return bgzf;
+}
+
+bool bgzfreader::open( const char* name) {
+    close();
+    file = fopen( name, "rb");
+    position = 0;
+    skip = 0;
+    index_compressed.clear();
+    index_uncompressed.clear();
+    return file != 0;
+}
+
+void bgzfreader::close() {
+    if ( file) {
+        fclose( file);
+        file = 0;
+    }
+}
+
+int bgzfreader::read_member( std::vector<int>& start, 
+                             std::vector<int>& isize) {
+    // reads one member into the compressed buffer
+    unsigned char header[12];
+    int xlen = read_header( file, header);
+    if ( xlen <= 0)
+        return xlen;
+    int offset = compressed.size();
+    compressed.resize( offset + 12 + xlen);
+    memcpy( &compressed[offset], header, 12);
+    unsigned char* p = reinterpret_cast<unsigned char*>( &compressed[offset]);
+    if ( fread( p + 12, 1, xlen, file) != size_t(xlen))
+        return -1;
+    int size = member_size( p, xlen);
+    if ( size < 12 + xlen + 8)
+        return -1;
+    compressed.resize( offset + size);
+    p = reinterpret_cast<unsigned char*>( &compressed[offset]);
+    if ( fread( p + 12 + xlen, 1, size - 12 - xlen, file) 
+         != size_t(size - 12 - xlen))
+        return -1;
+    start.push_back( offset);
+    isize.push_back( get32( p + size - 4));
+    return size;
+}
+
+int bgzfreader::read( char*& out) {
+    if ( ! file)
+        return -1;
+    // collect a batch of members (serial). Batches of empty members only
+    // (the end of file markers of concatenated files) are passed over.
+    const int batch = batch_size();
+    std::vector<int> start, isize;
+    std::vector<size_t> first( 1, 0);
+    bool end = false;
+    while ( first.back() == 0 && ! end) {
+        start.clear();
+        isize.clear();
+        compressed.clear();
+        for ( int i = 0; i < batch; ++i) {
+            int size = read_member( start, isize);
+            if ( size < 0)
+                return -1;
+            if ( size == 0) {
+                end = true;
+                break;
+            }
+        }
+        first.assign( start.size() + 1, 0);
+        for ( size_t i = 0; i < start.size(); ++i)
+            first[i+1] = first[i] + isize[i];
+    }
+    const int members = start.size();
+    data.resize( first[members]);
+
+    // ... and decompress them in parallel
+    bool error = false;
+#ifdef OMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(||:error)
+#endif
+    for ( int i = 0; i < members; ++i) {
+        const unsigned char* p = 
+            reinterpret_cast<const unsigned char*>( &compressed[start[i]]);
+        const int size = ( i + 1 < members ? start[i+1] : compressed.size()) 
+                         - start[i];
+        const int header = 12 + get16( p + 10);
+        if ( isize[i] == 0)
+            continue;
+        z_stream zs;
+        memset( &zs, 0, sizeof(zs));
+        if ( inflateInit2( &zs, -15) != Z_OK) {
+            error = true;
+            continue;
+        }
+        zs.next_in = const_cast<Bytef*>( p + header);
+        zs.avail_in = size - header - 8;
+        zs.next_out = reinterpret_cast<Bytef*>( &data[first[i]]);
+        zs.avail_out = isize[i];
+        int ret = inflate( &zs, Z_FINISH);
+        inflateEnd( &zs);
+        if ( ret != Z_STREAM_END || zs.total_out != (uLong)isize[i]
+             || crc32( crc32( 0L, Z_NULL, 0), 
+                       reinterpret_cast<const Bytef*>( &data[first[i]]),
+                       isize[i]) != get32( p + size - 8))
+            error = true;
+    }
+    if ( error)
+        return -1;
+
+    position += first[members];
+    // data before the position requested by seek
+    size_t s = skip;
+    skip = 0;
+    if ( s > data.size())
+        return -1;
+    out = data.empty() ? 0 : &data[0] + s;
+    return data.size() - s;
+}
+
+bool bgzfreader::build_index() {
+    // walks through the headers of all members
+    z_off_t current = ftello( file);
+    if ( fseeko( file, 0, SEEK_SET) != 0)
+        return false;
+    z_off_t c = 0, u = 0;
+    unsigned char header[12 + 256], trailer[4];
+    while ( true) {
+        int xlen = read_header( file, header);
+        if ( xlen == 0)
+            break;
+        if ( xlen < 0 || xlen > 256 
+             || fread( header + 12, 1, xlen, file) != size_t(xlen))
+            return false;
+        int size = member_size( header, xlen);
+        if ( size < 12 + xlen + 8 
+             || fseeko( file, c + size - 4, SEEK_SET) != 0
+             || fread( trailer, 1, 4, file) != 4)
+            return false;
+        index_compressed.push_back( c);
+        index_uncompressed.push_back( u);
+        c += size;
+        u += get32( trailer);
+    }
+    // the end of the file
+    index_compressed.push_back( c);
+    index_uncompressed.push_back( u);
+    return fseeko( file, current, SEEK_SET) == 0;
+}
+
+bool bgzfreader::seek( z_off_t pos) {
+    if ( ! file || pos < 0)
+        return false;
+    if ( index_compressed.empty() && ! build_index()) {
+        index_compressed.clear();
+        index_uncompressed.clear();
+        return false;
+    }
+    if ( pos > index_uncompressed.back())
+        return false;
+    // last member starting at or before pos
+    size_t i = std::upper_bound( index_uncompressed.begin(), 
+                                 index_uncompressed.end(), pos) 
+               - index_uncompressed.begin() - 1;
+    if ( fseeko( file, index_compressed[i], SEEK_SET) != 0)
+        return false;
+    clearerr( file);
+    position = index_uncompressed[i];
+    skip = pos - position;
+    return true;
+}
+
+// --------------------------------------
+// class bgzfwriter:
+// --------------------------------------
+
+bool bgzfwriter::open( const char* name) {
+    close();
+    file = fopen( name, "wb");
+    data.resize( size_t( batch_size()) * blockSize);
+    return file != 0;
+}
+
+bool bgzfwriter::close() {
+    if ( ! file)
+        return false;
+    // empty member marking the end of the file
+    static const unsigned char eof[28] = {
+        0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0, 
+        0x1b, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    bool ok = fwrite( eof, 1, 28, file) == 28;
+    ok = ( fclose( file) == 0) && ok;
+    file = 0;
+    return ok;
+}
+
+bool bgzfwriter::flush() {
+    return file && fflush( file) == 0;
+}
+
+bool bgzfwriter::write( int n) {
+    if ( ! file)
+        return false;
+    static const int maxSize = 65536;
+    static const int header = 18;
+    const int blocks = ( n + blockSize - 1) / blockSize;
+    std::vector<std::vector<unsigned char> > member( blocks);
+    bool error = false;
+#ifdef OMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(||:error)
+#endif
+    for ( int i = 0; i < blocks; ++i) {
+        const int size = std::min( blockSize, n - i * blockSize);
+        const Bytef* in = reinterpret_cast<const Bytef*>( &data[i * blockSize]);
+        std::vector<unsigned char>& m = member[i];
+        m.resize( maxSize);
+        int deflated = -1;
+        // incompressible data are stored (level 0)
+        const int levels[2] = { Z_DEFAULT_COMPRESSION, 0 };
+        for ( int l = 0; l < 2 && deflated < 0; ++l) {
+            z_stream zs;
+            memset( &zs, 0, sizeof(zs));
+            if ( deflateInit2( &zs, levels[l], Z_DEFLATED, -15, 8, 
+                               Z_DEFAULT_STRATEGY) != Z_OK)
+                break;
+            zs.next_in = const_cast<Bytef*>( in);
+            zs.avail_in = size;
+            zs.next_out = &m[header];
+            zs.avail_out = maxSize - header - 8;
+            if ( deflate( &zs, Z_FINISH) == Z_STREAM_END)
+                deflated = zs.total_out;
+            deflateEnd( &zs);
+        }
+        if ( deflated < 0) {
+            error = true;
+            continue;
+        }
+        const int total = header + deflated + 8;
+        static const unsigned char h[16] = {
+            0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0 };
+        memcpy( &m[0], h, 16);
+        put16( &m[16], total - 1);
+        put32( &m[header + deflated], crc32( crc32( 0L, Z_NULL, 0), in, size));
+        put32( &m[header + deflated + 4], size);
+        m.resize( total);
+    }
+    if ( error)
+        return false;
+    for ( int i = 0; i < blocks; ++i)
+        if ( fwrite( &member[i][0], 1, member[i].size(), file) 
+             != member[i].size())
+            return false;
+    return true;
+}
+
 // --------------------------------------
 // class gzstreambuf:
 // --------------------------------------
@@ -78,17 +406,53 @@ gzstreambuf* gzstreambuf::open( const char* name, int open_mode) {
         *fmodeptr++ = 'w';
     *fmodeptr++ = 'b';
     *fmodeptr = '\0';
+    if ( mode & std::ios::out) {
+        writer = new bgzfwriter;
+        if ( ! writer->open( name)) {
+            delete writer;
+            writer = 0;
+            return (gzstreambuf*)0;
+        }
+        setp( writer->buffer(), writer->buffer() + (writer->capacity()-1));
+        opened = 1;
+        return this;
+    }
+    if ( bgzfreader::is_bgzf( name)) {
+        reader = new bgzfreader;
+        if ( ! reader->open( name)) {
+            delete reader;
+            reader = 0;
+            return (gzstreambuf*)0;
+        }
+        setg( buffer + 4, buffer + 4, buffer + 4);
+        opened = 1;
+        return this;
+    }
     file = gzopen( name, fmode);
     if (file == 0)
         return (gzstreambuf*)0;
+    setg( buffer + 4, buffer + 4, buffer + 4);
     opened = 1;
     return this;
 }
 
 gzstreambuf * gzstreambuf::close() {
     if ( is_open()) {
-        sync();
         opened = 0;
+        if ( writer) {
+            bool ok = flush_buffer() != EOF;
+            ok = writer->close() && ok;
+            delete writer;
+            writer = 0;
+            setp( buffer, buffer + (bufferSize-1));
+            return ok ? this : (gzstreambuf*)0;
+        }
+        if ( reader) {
+            delete reader;
+            reader = 0;
+            return this;
+        }
+        sync();
         if ( gzclose( file) == Z_OK)
             return this;
     }
@@ -101,6 +465,15 @@ int gzstreambuf::underflow() { // used for input buffer only
 
     if ( ! (mode & std::ios::in) || ! opened)
         return EOF;
+    if ( reader) {
+        // the batches are returned without copying
+        char* data;
+        int num = reader->read( data);
+        if ( num <= 0)
+            return EOF;
+        setg( data, data, data + num);
+        return * reinterpret_cast<unsigned char *>( gptr());
+    }
     // Josuttis' implementation of inbuf
     int n_putback = gptr() - eback();
     if ( n_putback > 4)
@@ -124,7 +497,10 @@ int gzstreambuf::flush_buffer() {
     // Separate the writing of the buffer from overflow() and
     // sync() operation.
     int w = pptr() - pbase();
-    if ( gzwrite( file, pbase(), w) != w)
+    if ( writer) {
+        if ( w && ! writer->write( w))
+            return EOF;
+    } else if ( gzwrite( file, pbase(), w) != w)
         return EOF;
     pbump( -w);
     return w;
@@ -146,6 +522,20 @@ int gzstreambuf::sync() {
     // Changed to use flush_buffer() instead of overflow( EOF)
     // which caused improper behavior with std::endl and flush(),
     // bug reported by Vincent Ricard.
+    // Block gzip output: only full members are written and passed on to
+    // the file, the rest stays in the buffer. Otherwise every std::endl
+    // would end a short member. The last member is written by close().
+    if ( writer) {
+        const int w = pptr() - pbase();
+        const int full = w / bgzfwriter::blockSize * bgzfwriter::blockSize;
+        if ( full == 0)
+            return 0;
+        if ( ! writer->write( full))
+            return -1;
+        memmove( pbase(), pbase() + full, w - full);
+        pbump( -full);
+        return writer->flush() ? 0 : -1;
+    }
     if ( pptr() && pptr() > pbase()) {
         if ( flush_buffer() == EOF)
             return -1;
@@ -153,6 +543,42 @@ int gzstreambuf::sync() {
     return 0;
 }
 
+std::streampos gzstreambuf::seekoff( std::streamoff off,
+                                     std::ios_base::seekdir dir,
+                                     std::ios_base::openmode which) {
+    // only input streams can be positioned. For compressed files gzseek
+    // decompresses up to the requested position (and rewinds if needed).
+    if ( ! (mode & std::ios::in) || ! opened || ! (which & std::ios_base::in))
+        return std::streampos(std::streamoff(-1));
+    if ( dir == std::ios_base::cur) {
+        // the characters in the buffer have been read from the file
+        // but not from the stream
+        z_off_t pos = reader ? reader->tell() : gztell( file);
+        if ( pos < 0)
+            return std::streampos(std::streamoff(-1));
+        pos -= egptr() - gptr();
+        if ( off == 0)
+            return std::streampos(std::streamoff(pos));
+        off += pos;
+    } else if ( dir == std::ios_base::end) {
+        return std::streampos(std::streamoff(-1));
+    }
+    return seekpos( std::streampos(off), which);
+}
+
+std::streampos gzstreambuf::seekpos( std::streampos pos,
+                                     std::ios_base::openmode which) {
+    if ( ! (mode & std::ios::in) || ! opened || ! (which & std::ios_base::in))
+        return std::streampos(std::streamoff(-1));
+    if ( reader) {
+        if ( ! reader->seek( z_off_t(std::streamoff(pos))))
+            return std::streampos(std::streamoff(-1));
+    } else if ( gzseek( file, z_off_t(std::streamoff(pos)), SEEK_SET) < 0)
+        return std::streampos(std::streamoff(-1));
+    setg( buffer + 4, buffer + 4, buffer + 4);
+    return pos;
+}
+
 // --------------------------------------
 // class gzstreambase:
 // --------------------------------------
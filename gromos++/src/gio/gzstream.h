@@ -52,6 +52,8 @@
 // standard C++ with new header file names and std:: namespace
 #include <iostream>
 #include <fstream>
+#include <vector>
+#include <cstdio>
 #include <zlib.h>
 
 #ifdef GZSTREAM_NAMESPACE
@@ -62,19 +64,84 @@ namespace GZSTREAM_NAMESPACE {
 // Internal classes to implement gzstream. See below for user classes.
 // ----------------------------------------------------------------------------
 
+// ----------------------------------------------------------------------------
+// Block gzip (BGZF, as written by bgzip of htslib): a gzip file made of
+// independent members holding at most 64 KiB of uncompressed data each.
+// The members of a batch are compressed and decompressed in parallel 
+// (OpenMP) and the member offsets allow positioning without decompressing
+// the file up to the position. Any gzip reader can read these files.
+// A member is only ended when a member is full (64 KiB) or on close.
+// Flushing the stream (std::flush, std::endl) writes the full members
+// collected so far and passes them on to the file; less than a member
+// stays buffered, so flushing does not produce short members.
+// ----------------------------------------------------------------------------
+
+class bgzfreader {
+private:
+    FILE*              file;
+    std::vector<char>  compressed;   // members of the current batch
+    std::vector<char>  data;         // uncompressed data of the batch
+    z_off_t            position;     // uncompressed offset of end of data
+    z_off_t            skip;         // bytes to skip after positioning
+    // offsets of the members (built on the first positioning)
+    std::vector<z_off_t> index_compressed;
+    std::vector<z_off_t> index_uncompressed;
+
+    int  read_member( std::vector<int>& start, std::vector<int>& isize);
+    bool build_index();
+public:
+    bgzfreader() : file(0), position(0), skip(0) {}
+    ~bgzfreader() { close(); }
+    // true if the file starts with a BGZF member
+    static bool is_bgzf( const char* name);
+    bool open( const char* name);
+    void close();
+    // decompress the next batch of members. data points to the uncompressed
+    // bytes, the number of bytes is returned (0 at the end, -1 on errors).
+    int read( char*& data);
+    // uncompressed offset of the end of the data returned by read (or of
+    // the position after seek)
+    z_off_t tell() const { return position + skip; }
+    // position at an uncompressed offset
+    bool seek( z_off_t pos);
+};
+
+class bgzfwriter {
+private:
+    FILE*              file;
+    std::vector<char>  data;         // uncompressed data of a batch
+public:
+    // uncompressed bytes per member
+    static const int blockSize = 0xff00;
+    bgzfwriter() : file(0) {}
+    ~bgzfwriter() { close(); }
+    bool open( const char* name);
+    // writes the end of file marker
+    bool close();
+    // the uncompressed data are collected here
+    char* buffer() { return &data[0]; }
+    int capacity() const { return data.size(); }
+    // compress and write the first n bytes of the buffer
+    bool write( int n);
+    // passes the written members on to the file
+    bool flush();
+};
+
 class gzstreambuf : public std::streambuf {
 private:
-    static const int bufferSize = 47+256;    // size of data buff
-    // totals 512 bytes under g++ for igzstream at the end.
+    static const int bufferSize = 4 + 64 * 1024;    // size of data buff
+    // (4 bytes putback area)
 
     gzFile           file;               // file handle for compressed file
     char             buffer[bufferSize]; // data buffer
     char             opened;             // open/close state of stream
     int              mode;               // I/O mode
+    bgzfreader*      reader;             // block gzip input (or 0)
+    bgzfwriter*      writer;             // block gzip output
 
     int flush_buffer();
 public:
-    gzstreambuf() : opened(0) {
+    gzstreambuf() : file(0), opened(0), reader(0), writer(0) {
         setp( buffer, buffer + (bufferSize-1));
         setg( buffer + 4,     // beginning of putback area
               buffer + 4,     // read position
@@ -89,6 +156,12 @@ public:
     virtual int     overflow( int c = EOF);
     virtual int     underflow();
     virtual int     sync();
+    // positioning of input streams (offsets in uncompressed bytes)
+    virtual std::streampos seekoff( std::streamoff off,
+                                    std::ios_base::seekdir dir,
+                                    std::ios_base::openmode which = std::ios_base::in);
+    virtual std::streampos seekpos( std::streampos pos,
+                                    std::ios_base::openmode which = std::ios_base::in);
 };
 
 class gzstreambase : virtual public std::ios {
@@ -109,6 +182,9 @@ public:
 // User classes. Use igzstream and ogzstream analogously to ifstream and
 // ofstream respectively. They read and write files based on the gz* 
 // function interface of the zlib. Files are compatible with gzip compression.
+// igzstream reads block gzip files with the parallel bgzfreader, ogzstream
+// always writes block gzip files. Flushing an ogzstream only writes the
+// full members, the rest is written when a batch is full or on close.
 // ----------------------------------------------------------------------------
 
 class igzstream : public gzstreambase, public std::istream {
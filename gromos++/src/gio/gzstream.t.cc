@@ -0,0 +1,165 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gio_gzstream.t.cc
+
+// writes a block gzip file, reads it sequentially with igzstream and 
+// gzread (compatibility with other gzip readers) and checks positioning. 
+// Plain gzip files are read through gzread as before.
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <iostream>
+
+#include "gzstream.h"
+
+using namespace std;
+
+static string readAll(const char *name) {
+  igzstream is(name);
+  assert(is.is_open());
+  ostringstream os;
+  os << is.rdbuf();
+  return os.str();
+}
+
+static void checkSeek(const char *name, const string &ref) {
+  igzstream is(name);
+  srand(1);
+  for (int k = 0; k < 500; ++k) {
+    size_t pos = size_t(rand()) % ref.size();
+    if (k == 0) pos = 0;
+    if (k == 1) pos = ref.size() - 10;
+    is.clear();
+    is.seekg(pos);
+    assert(is.tellg() == streampos(pos));
+    char buf[200];
+    is.read(buf, 200);
+    size_t n = is.gcount();
+    assert(n == min(size_t(200), ref.size() - pos));
+    assert(ref.compare(pos, n, string(buf, n)) == 0);
+  }
+}
+
+static string fileContents(const char *name) {
+  ifstream in(name, ios::binary);
+  return string((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+}
+
+int main() {
+  const char *bgzf = "gzstream_test.gz";
+  const char *plain = "gzstream_plain_test.gz";
+
+  // something that looks like a trajectory
+  ostringstream os;
+  for (int i = 0; i < 200000; ++i)
+    os << "TIMESTEP\n" << i << " " << 0.002 * i << "\nEND\n"
+          << double(rand()) / RAND_MAX << "\n";
+  const string ref = os.str();
+
+  // flushing writes the full members only, less than a member stays
+  // buffered until close
+  {
+    const int full = bgzfwriter::blockSize;
+    ogzstream out(bgzf);
+    out << ref.substr(0, 1000) << flush;
+    vector<char> buf(4 * full);
+    gzFile gz = gzopen(bgzf, "rb");
+    assert(gzread(gz, &buf[0], buf.size()) == 0);
+    gzclose(gz);
+    out << ref.substr(1000, 2 * full) << flush;
+    gz = gzopen(bgzf, "rb");
+    assert(gzread(gz, &buf[0], buf.size()) == 2 * full);
+    gzclose(gz);
+    assert(ref.compare(0, 2 * full, string(&buf[0], 2 * full)) == 0);
+  }
+
+  clock_t start = clock();
+  ogzstream out(bgzf);
+  for (size_t i = 0; i < ref.size(); i += 1000)
+    out << ref.substr(i, 1000);
+  out.close();
+  const double t_write = double(clock() - start) / CLOCKS_PER_SEC;
+
+  // std::endl on every line gives the same members as no flushing
+  {
+    ogzstream lines(plain);
+    istringstream is(ref);
+    string line;
+    while (getline(is, line))
+      lines << line << endl;
+    lines.close();
+    assert(fileContents(plain) == fileContents(bgzf));
+  }
+
+  gzFile gz = gzopen(plain, "wb");
+  gzwrite(gz, ref.data(), ref.size());
+  gzclose(gz);
+
+  assert(bgzfreader::is_bgzf(bgzf));
+  assert(!bgzfreader::is_bgzf(plain));
+
+  // every gzip reader can read the members
+  gz = gzopen(bgzf, "rb");
+  string other(ref.size() + 1, ' ');
+  assert(gzread(gz, &other[0], other.size()) == int(ref.size()));
+  gzclose(gz);
+  other.resize(ref.size());
+  assert(other == ref);
+
+  start = clock();
+  assert(readAll(bgzf) == ref);
+  const double t_bgzf = double(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  assert(readAll(plain) == ref);
+  const double t_plain = double(clock() - start) / CLOCKS_PER_SEC;
+
+  checkSeek(bgzf, ref);
+  checkSeek(plain, ref);
+
+  // concatenated files: more end of file markers (empty members) in a row
+  // than members in a batch
+  {
+    const string file = fileContents(bgzf);
+    const string eof = file.substr(file.size() - 28);
+    ofstream cat(plain, ios::binary);
+    cat << file;
+    for (int i = 0; i < 1000; ++i) cat << eof;
+    cat << file;
+    cat.close();
+    assert(readAll(plain) == ref + ref);
+  }
+
+  cout << "uncompressed size: " << ref.size() << endl
+          << "block gzip write : " << t_write << " s" << endl
+          << "block gzip read  : " << t_bgzf << " s" << endl
+          << "plain gzip read  : " << t_plain << " s" << endl;
+
+  remove(bgzf);
+  remove(plain);
+  return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// gio_mmapstream.cc
+
+#include <cstdio>
+#include "mmapstream.h"
+#include "../../config.h"
+
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+#define GIO_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using gio::mmapstreambuf;
+using gio::immapstream;
+
+bool mmapstreambuf::mappable(const char *name) {
+#ifdef GIO_MMAP
+  struct stat st;
+  if (stat(name, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+    return false;
+  // gzip magic number
+  FILE *f = fopen(name, "rb");
+  if (f == NULL) return false;
+  unsigned char magic[2] = {0, 0};
+  const size_t n = fread(magic, 1, 2, f);
+  fclose(f);
+  return !(n == 2 && magic[0] == 0x1f && magic[1] == 0x8b);
+#else
+  return false;
+#endif
+}
+
+mmapstreambuf *mmapstreambuf::open(const char *name) {
+  if (is_open()) return 0;
+#ifdef GIO_MMAP
+  const int fd = ::open(name, O_RDONLY);
+  if (fd < 0) return 0;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+    ::close(fd);
+    return 0;
+  }
+  void *p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after closing the file
+  ::close(fd);
+  if (p == MAP_FAILED) return 0;
+#ifdef HAVE_MADVISE
+  madvise(p, st.st_size, MADV_SEQUENTIAL);
+#endif
+  d_data = static_cast<char *> (p);
+  d_size = st.st_size;
+  setg(d_data, d_data, d_data + d_size);
+  return this;
+#else
+  return 0;
+#endif
+}
+
+mmapstreambuf *mmapstreambuf::close() {
+  if (!is_open()) return 0;
+#ifdef GIO_MMAP
+  munmap(d_data, d_size);
+#endif
+  d_data = 0;
+  d_size = 0;
+  setg(0, 0, 0);
+  return this;
+}
+
+mmapstreambuf::int_type mmapstreambuf::underflow() {
+  // the whole file is in the get area
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+  return traits_type::eof();
+}
+
+std::streamsize mmapstreambuf::showmanyc() {
+  return gptr() < egptr() ? egptr() - gptr() : -1;
+}
+
+mmapstreambuf::pos_type mmapstreambuf::seekoff(off_type off,
+        std::ios_base::seekdir dir, std::ios_base::openmode which) {
+  if (!is_open() || !(which & std::ios_base::in))
+    return pos_type(off_type(-1));
+  off_type pos = off;
+  if (dir == std::ios_base::cur)
+    pos += gptr() - eback();
+  else if (dir == std::ios_base::end)
+    pos += d_size;
+  if (pos < 0 || pos > off_type(d_size))
+    return pos_type(off_type(-1));
+  setg(d_data, d_data + pos, d_data + d_size);
+  return pos_type(pos);
+}
+
+mmapstreambuf::pos_type mmapstreambuf::seekpos(pos_type pos,
+        std::ios_base::openmode which) {
+  return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+void immapstream::open(const char *name) {
+  if (d_buf.open(name))
+    clear();
+  else
+    setstate(std::ios_base::failbit);
+}
+
+void immapstream::close() {
+  if (!d_buf.close())
+    setstate(std::ios_base::failbit);
+}
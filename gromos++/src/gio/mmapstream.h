@@ -0,0 +1,144 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// gio_mmapstream.h
+
+#ifndef INCLUDED_GIO_MMAPSTREAM
+#define INCLUDED_GIO_MMAPSTREAM
+
+#include <cstddef>
+#include <iostream>
+
+namespace gio{
+
+  /**
+   * Class mmapstreambuf
+   * A read-only stream buffer on a memory mapped file.
+   *
+   * The whole file is the get area of the buffer, so reading (e.g. with
+   * std::getline) takes the characters directly from the mapped pages 
+   * without read calls and intermediate buffers. The pages are mapped 
+   * with a hint for sequential access. Positioning (seekg/tellg) is done
+   * by moving the read position within the mapping.
+   *
+   * @class mmapstreambuf
+   * @ingroup gio
+   * @sa gio::immapstream
+   */
+  class mmapstreambuf : public std::streambuf{
+    char *d_data;
+    std::size_t d_size;
+    // not implemented
+    mmapstreambuf(const mmapstreambuf &);
+    mmapstreambuf &operator=(const mmapstreambuf &);
+  public:
+    /**
+     * Constructor
+     */
+    mmapstreambuf() : d_data(0), d_size(0) {}
+    /**
+     * Destructor, unmaps the file
+     */
+    ~mmapstreambuf() { close(); }
+    /**
+     * true if the file is a regular, non-empty file which is not 
+     * compressed and mapping files is supported on this platform
+     */
+    static bool mappable(const char *name);
+    /**
+     * map a file, returns 0 on failure
+     */
+    mmapstreambuf *open(const char *name);
+    /**
+     * unmap the file
+     */
+    mmapstreambuf *close();
+    /**
+     * true if a file is mapped
+     */
+    bool is_open()const { return d_data != 0; }
+    /**
+     * the mapped file. The characters are shared by all threads, 
+     * any range of them can be parsed independently of the stream.
+     */
+    const char *data()const { return d_data; }
+    /**
+     * size of the mapped file
+     */
+    std::size_t size()const { return d_size; }
+
+  protected:
+    virtual int_type underflow();
+    virtual std::streamsize showmanyc();
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+            std::ios_base::openmode which = std::ios_base::in);
+    virtual pos_type seekpos(pos_type pos,
+            std::ios_base::openmode which = std::ios_base::in);
+  };
+
+  /**
+   * Class immapstream
+   * An input stream on a memory mapped file, used like std::ifstream.
+   *
+   * gio::Ginstream reads regular uncompressed files through this stream.
+   *
+   * @class immapstream
+   * @ingroup gio
+   * @sa gio::mmapstreambuf
+   */
+  class immapstream : public std::istream{
+    mmapstreambuf d_buf;
+  public:
+    /**
+     * Constructor
+     */
+    immapstream() : std::istream(&d_buf) {}
+    /**
+     * Constructor that maps a file
+     */
+    immapstream(const char *name) : std::istream(&d_buf) { open(name); }
+    /**
+     * map a file, sets the failbit on failure
+     */
+    void open(const char *name);
+    /**
+     * unmap the file
+     */
+    void close();
+    /**
+     * true if a file is mapped
+     */
+    bool is_open()const { return d_buf.is_open(); }
+    /**
+     * the stream buffer
+     */
+    mmapstreambuf *rdbuf() { return &d_buf; }
+    /**
+     * the mapped file
+     */
+    const char *data()const { return d_buf.data(); }
+    /**
+     * size of the mapped file
+     */
+    std::size_t size()const { return d_buf.size(); }
+  };
+}
+#endif
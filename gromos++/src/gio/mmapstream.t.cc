@@ -0,0 +1,138 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// gio_mmapstream.t.cc
+
+// writes a text file and reads it line by line with immapstream and 
+// igzstream, checks positioning and that Ginstream reads the same blocks
+// from the mapped file. Compressed and empty files are not mapped.
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#include "mmapstream.h"
+#include "gzstream.h"
+#include "Ginstream.h"
+
+using namespace std;
+
+static double readLines(istream &is, vector<string> &lines) {
+  const clock_t start = clock();
+  string s;
+  while (getline(is, s))
+    lines.push_back(s);
+  return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main() {
+  const char *name = "mmapstream_test.trc", *gz = "mmapstream_test.trc.gz",
+          *empty = "mmapstream_test.empty";
+  {
+    ofstream os(name);
+    os << "TITLE\nmmapstream test\nEND\n";
+    char line[64];
+    for (int f = 0; f < 20; ++f) {
+      os << "TIMESTEP\n" << f << " " << 0.002 * f << "\nEND\n"
+              << "POSITIONRED\n# comment\n";
+      for (int i = 0; i < 20000; ++i) {
+        sprintf(line, "%15.9f%15.9f%15.9f\n", 0.001 * i, 0.1 * f, -0.5 * i);
+        os << line;
+      }
+      os << "END\n";
+    }
+    // no newline at the end
+    os << "GENBOX\nEND";
+  }
+  {
+    ogzstream os(gz);
+    os << "TITLE\ncompressed\nEND\n";
+  }
+  ofstream(empty).close();
+
+  assert(gio::mmapstreambuf::mappable(name));
+  assert(!gio::mmapstreambuf::mappable(gz));
+  assert(!gio::mmapstreambuf::mappable(empty));
+  assert(!gio::mmapstreambuf::mappable("mmapstream_test.missing"));
+
+  // sequential reading
+  vector<string> ref, lines;
+  igzstream gis(name);
+  const double t_gz = readLines(gis, ref);
+  gio::immapstream mis(name);
+  assert(mis.is_open());
+  const double t_mmap = readLines(mis, lines);
+  assert(lines == ref);
+  assert(mis.eof());
+
+  // positioning
+  const string data(mis.data(), mis.size());
+  srand(1);
+  for (int k = 0; k < 200; ++k) {
+    size_t pos = size_t(rand()) % data.size();
+    mis.clear();
+    mis.seekg(pos);
+    assert(mis.tellg() == streampos(pos));
+    string s;
+    getline(mis, s);
+    assert(s == data.substr(pos, data.find('\n', pos) - pos));
+  }
+  mis.clear();
+  mis.seekg(-3, ios::end);
+  assert(mis.get() == 'E' && mis.unget() && mis.get() == 'E');
+  mis.seekg(0, ios::end);
+  assert(mis.get() == EOF);
+  mis.close();
+  assert(!mis.is_open());
+
+  // blocks through Ginstream (mapped)
+  gio::Ginstream gin(name);
+  assert(gin.title() == "mmapstream test\n");
+  vector<string> block;
+  int frames = 0;
+  while (!gin.stream().eof()) {
+    gin.getblock(block);
+    if (block[0] == "POSITIONRED") {
+      assert(block.size() == 20002 && block.back() == "END");
+      ++frames;
+    }
+  }
+  assert(frames == 20 && block[0] == "GENBOX");
+  gin.close();
+
+  // compressed files are still read through igzstream
+  gio::Ginstream ginz(gz);
+  assert(ginz.title() == "compressed\n");
+  ginz.close();
+
+  cout << lines.size() << " lines read in " << t_mmap << " s (mapped), "
+          << t_gz << " s (igzstream)" << endl;
+
+  remove(name);
+  remove(gz);
+  remove(empty);
+  return 0;
+}
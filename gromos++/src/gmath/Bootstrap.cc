@@ -0,0 +1,129 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_Bootstrap.cc
+
+#include "Bootstrap.h"
+#include "../gromos/Exception.h"
+#include <gsl/gsl_rng.h>
+#include <cmath>
+#include <exception>
+#include <vector>
+
+#ifdef OMP
+#include <omp.h>
+#endif
+
+namespace gmath
+{
+  // the seed of the random numbers of a bootstrap sample (splitmix64), such
+  // that neighbouring samples get unrelated streams
+  static unsigned long sample_seed(unsigned long seed, unsigned int sample) {
+    unsigned long long z = seed + 0x9E3779B97F4A7C15ULL * (sample + 1ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (unsigned long) ((z ^ (z >> 31)) & 0xffffffffUL);
+  }
+
+  // draw the indices of all series of a bootstrap sample
+  static void draw(gsl_rng *rng, unsigned long seed, unsigned int sample,
+          unsigned int block, const std::vector<unsigned int> &length,
+          std::vector<std::vector<unsigned int> > &index) {
+    gsl_rng_set(rng, sample_seed(seed, sample));
+    index.resize(length.size());
+    for (unsigned int s = 0; s < length.size(); ++s) {
+      const unsigned int n = length[s];
+      index[s].resize(n);
+      unsigned int pos = 0;
+      while (pos < n) {
+        const unsigned int start = gsl_rng_uniform_int(rng, n);
+        for (unsigned int k = 0; k < block && pos < n; ++k, ++pos)
+          index[s][pos] = (start + k) % n;
+      }
+    }
+  }
+
+  Bootstrap::Bootstrap(unsigned int samples, unsigned int block,
+          unsigned long seed) : d_samples(samples), d_block(block),
+  d_seed(seed), d_size(0) {
+    if (block == 0)
+      throw gromos::Exception("Bootstrap", "Block length has to be at least 1!");
+  }
+
+  unsigned int Bootstrap::addSeries(unsigned int length) {
+    if (length == 0)
+      throw gromos::Exception("Bootstrap", "Cannot resample an empty series!");
+    d_length.push_back(length);
+    return d_length.size() - 1;
+  }
+
+  void Bootstrap::index(unsigned int sample,
+          std::vector<std::vector<unsigned int> > &index)const {
+    gsl_rng *rng = gsl_rng_alloc(gsl_rng_mt19937);
+    draw(rng, d_seed, sample, d_block, d_length, index);
+    gsl_rng_free(rng);
+  }
+
+  void Bootstrap::run(const Estimator &estimator) {
+    if (d_length.empty())
+      throw gromos::Exception("Bootstrap", "No series to resample!");
+    d_size = estimator.size();
+    d_estimates.assign(d_samples * d_size, 0.0);
+    // exceptions cannot leave the parallel region, the first failing
+    // sample is rethrown
+    std::vector<std::exception_ptr> errors(d_samples);
+
+#ifdef OMP
+#pragma omp parallel
+#endif
+    {
+      gsl_rng *rng = gsl_rng_alloc(gsl_rng_mt19937);
+      std::vector<std::vector<unsigned int> > index;
+#ifdef OMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (int b = 0; b < int(d_samples); ++b) {
+        try {
+          draw(rng, d_seed, b, d_block, d_length, index);
+          estimator.estimate(index, &d_estimates[b * d_size]);
+        } catch (...) {
+          errors[b] = std::current_exception();
+        }
+      }
+      gsl_rng_free(rng);
+    }
+    for (unsigned int b = 0; b < d_samples; ++b)
+      if (errors[b]) std::rethrow_exception(errors[b]);
+  }
+
+  double Bootstrap::error(unsigned int q)const {
+    if (q >= d_size || d_samples == 0)
+      throw gromos::Exception("Bootstrap", "No estimates for this quantity!");
+    double ave = 0.0, ssum = 0.0;
+    for (unsigned int b = 0; b < d_samples; ++b)
+      ave += d_estimates[b * d_size + q];
+    ave /= d_samples;
+    for (unsigned int b = 0; b < d_samples; ++b) {
+      const double d = d_estimates[b * d_size + q] - ave;
+      ssum += d * d;
+    }
+    return sqrt(ssum / d_samples);
+  }
+}
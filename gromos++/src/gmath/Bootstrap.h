@@ -0,0 +1,134 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_Bootstrap
+
+#ifndef INCLUDED_GMATH_BOOTSTRAP
+#define INCLUDED_GMATH_BOOTSTRAP
+
+#include <vector>
+
+namespace gmath
+{
+  /**
+   * Class Bootstrap
+   * A class to estimate the statistical error of any quantity calculated
+   * from one or more time series by bootstrapping
+   *
+   * The series (e.g. the energies of the simulations at different 
+   * @f$\lambda@f$) are only known by their lengths. For every bootstrap
+   * sample, the indices of a random resample of every series are drawn and
+   * passed to an Estimator, which calculates its quantities from the 
+   * original data at these indices, so the data is not copied.
+   *
+   * For correlated series, a (circular) block bootstrap can be used: 
+   * blocks of consecutive indices of the given length, starting at random
+   * positions, are drawn until the length of the series is reached. A 
+   * block length of about the statistical inefficiency keeps the 
+   * correlation within the blocks.
+   *
+   * The samples are distributed over the OpenMP threads. The random
+   * numbers of every sample come from an own stream, seeded from the seed
+   * and the number of the sample, so the result does not depend on the 
+   * number of threads.
+   *
+   * @class Bootstrap
+   * @ingroup gmath
+   * @sa gmath::Stat
+   */
+  class Bootstrap
+    {
+    public:
+      /**
+       * Class Estimator
+       * The quantities to bootstrap. estimate() is called by several 
+       * threads at the same time, so it should only read shared data.
+       */
+      class Estimator
+        {
+        public:
+          virtual ~Estimator() {}
+          /**
+           * the number of quantities
+           */
+          virtual unsigned int size()const = 0;
+          /**
+           * calculate the quantities from a resample
+           * @param index the indices drawn for every series
+           * @param res the quantities (size() values)
+           */
+          virtual void estimate(const std::vector<std::vector<unsigned int> > &index,
+                  double *res)const = 0;
+        };
+
+      /**
+       * Constructor
+       * @param samples the number of bootstrap samples
+       * @param block the block length (1: resample single values)
+       * @param seed the seed of the random numbers
+       */
+      Bootstrap(unsigned int samples, unsigned int block = 1,
+              unsigned long seed = 4711);
+      /**
+       * add a series to be resampled
+       * @param length the number of values of the series
+       * @return the number of the series
+       */
+      unsigned int addSeries(unsigned int length);
+      /**
+       * the number of bootstrap samples
+       */
+      unsigned int samples()const { return d_samples; }
+      /**
+       * the indices of the resampled series of a bootstrap sample
+       */
+      void index(unsigned int sample,
+              std::vector<std::vector<unsigned int> > &index)const;
+      /**
+       * evaluate the estimator for all bootstrap samples
+       */
+      void run(const Estimator &estimator);
+      /**
+       * the number of quantities of the last run
+       */
+      unsigned int size()const { return d_size; }
+      /**
+       * the value of quantity q in a bootstrap sample of the last run
+       */
+      double estimate(unsigned int sample, unsigned int q)const {
+        return d_estimates[sample * d_size + q];
+      }
+      /**
+       * the standard deviation of quantity q over the bootstrap samples
+       */
+      double error(unsigned int q)const;
+
+    private:
+      unsigned int d_samples;
+      unsigned int d_block;
+      unsigned long d_seed;
+      std::vector<unsigned int> d_length;
+      unsigned int d_size;
+      // the estimates (sample-major)
+      std::vector<double> d_estimates;
+    };
+}
+
+#endif
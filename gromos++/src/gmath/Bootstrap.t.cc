@@ -0,0 +1,138 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_Bootstrap.t.cc
+
+// bootstraps the average of a random series and checks the error against
+// the standard error, the block structure of the indices and that the
+// estimates do not depend on the number of threads and that exceptions of
+// the estimator are passed on
+
+#include "Bootstrap.h"
+#include "../gromos/Exception.h"
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#ifdef OMP
+#include <omp.h>
+#endif
+
+using gmath::Bootstrap;
+
+using namespace std;
+
+// the averages of two series
+class Average : public Bootstrap::Estimator {
+  const vector<vector<double> > &d_data;
+public:
+  Average(const vector<vector<double> > &data) : d_data(data) {}
+  unsigned int size()const { return d_data.size(); }
+  void estimate(const vector<vector<unsigned int> > &index, double *res)const {
+    for (unsigned int s = 0; s < d_data.size(); ++s) {
+      double sum = 0.0;
+      for (unsigned int i = 0; i < index[s].size(); ++i)
+        sum += d_data[s][index[s][i]];
+      res[s] = sum / index[s].size();
+    }
+  }
+};
+
+// fails with an exception that is not a gromos::Exception
+class Failing : public Bootstrap::Estimator {
+public:
+  unsigned int size()const { return 1; }
+  void estimate(const vector<vector<unsigned int> > &, double *)const {
+    throw bad_alloc();
+  }
+};
+
+int main() {
+  try {
+    srand(4711);
+    const unsigned int n[] = {2000, 777};
+    vector<vector<double> > data(2);
+    for (unsigned int s = 0; s < 2; ++s) {
+      for (unsigned int i = 0; i < n[s]; ++i)
+        data[s].push_back(double(rand()) / RAND_MAX);
+    }
+    Average ave(data);
+
+    // uniform numbers: standard error sqrt(1/12 / n)
+    Bootstrap boot(2000);
+    boot.addSeries(n[0]);
+    boot.addSeries(n[1]);
+#ifdef OMP
+    omp_set_num_threads(1);
+#endif
+    boot.run(ave);
+    for (unsigned int s = 0; s < 2; ++s) {
+      const double ref = sqrt(1.0 / 12.0 / n[s]);
+      cout << "series " << s << ": bootstrap error " << boot.error(s)
+              << " standard error " << ref << endl;
+      assert(fabs(boot.error(s) - ref) < 0.1 * ref);
+    }
+
+    // the same estimates with several threads
+    vector<double> first;
+    for (unsigned int b = 0; b < boot.samples(); ++b)
+      first.push_back(boot.estimate(b, 0));
+#ifdef OMP
+    omp_set_num_threads(4);
+#endif
+    boot.run(ave);
+    for (unsigned int b = 0; b < boot.samples(); ++b)
+      assert(boot.estimate(b, 0) == first[b]);
+
+    // the indices of a sample give its estimate
+    vector<vector<unsigned int> > index;
+    boot.index(17, index);
+    double res[2];
+    ave.estimate(index, res);
+    assert(res[0] == boot.estimate(17, 0) && res[1] == boot.estimate(17, 1));
+
+    // blocks of consecutive indices
+    Bootstrap block(10, 50, 12);
+    block.addSeries(n[1]);
+    block.index(3, index);
+    assert(index.size() == 1 && index[0].size() == n[1]);
+    for (unsigned int i = 0; i < n[1]; ++i) {
+      assert(index[0][i] < n[1]);
+      if (i % 50)
+        assert(index[0][i] == (index[0][i - 1] + 1) % n[1]);
+    }
+
+    // exceptions of the estimator reach the caller of run
+    bool thrown = false;
+    try {
+      block.run(Failing());
+    } catch (const bad_alloc &) {
+      thrown = true;
+    }
+    assert(thrown);
+    return 0;
+  } catch (const gromos::Exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+}
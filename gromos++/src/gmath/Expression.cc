@@ -174,33 +174,79 @@ namespace gmath
 	throw(gromos::Exception("Error in Expression", os.str()));
       }
     }
+    compile();
   }
 
-  void Expression::setValues(std::vector<double>& v)
+  void Expression::compile()
   {
-    // first check how many we expect
+    // the variables a1 .. an
     int max=-1;
-    std::vector<int> vars;
-    std::vector<int> varNumber;
-  
+    std::vector<std::vector<Instruction> > val(d_op.size());
     for(unsigned int i=0; i< d_op.size(); i++){
-      if(d_op[i].substr(0,1)=="a"){
-        vars.push_back(i);
-	int num=atoi(d_op[i].substr(1, d_op[i].size()-1).c_str())-1;
-	varNumber.push_back(num);
-	if(num>max) max=num;
+      Instruction ins;
+      ins.op=op_const;
+      ins.var=-1;
+      ins.value=d_val[i];
+      if(is_variable(d_op[i])){
+	ins.op=op_var;
+	ins.var=atoi(d_op[i].substr(1, d_op[i].size()-1).c_str())-1;
+	if(ins.var<0){
+	  std::ostringstream os;
+	  os << "Parse error: variable " << d_op[i] << " should be a1, a2, ..."
+	     << std::endl;
+	  throw(gromos::Exception("Expression", os.str()));
+	}
+	if(ins.var>max) max=ins.var;
+      }
+      val[i].push_back(ins);
+    }
+    d_var.assign(max+1, 0.0);
+
+    // calc changes the vectors with operators and code fragments
+    std::vector<std::string> op(d_op);
+    d_code.clear();
+    calc(op, val, 0, op.size(), d_code);
+
+    // the depth of the stack
+    int depth=0;
+    d_depth=0;
+    for(unsigned int i=0; i< d_code.size(); i++){
+      switch(d_code[i].op){
+	case op_const:
+	case op_var: depth++; break;
+	case op_add:
+	case op_sub:
+	case op_mul:
+	case op_div: depth--; break;
+	default: break;
       }
+      if(depth>int(d_depth)) d_depth=depth;
     }
-    if(max+1!=int(v.size())){
+    d_stack.resize(d_depth);
+  }
+
+  void Expression::setValues(std::vector<double>& v)
+  {
+    if(d_var.size()!=v.size()){
       std::ostringstream os;
       os << "Incorrect number of values supplied in function setValues.\n"
-	 << "Expected " << max+1 << " values. Got " << v.size() << std::endl;
+	 << "Expected " << d_var.size() << " values. Got " << v.size() 
+	 << std::endl;
       throw(gromos::Exception("Expression", os.str()));
     }
+    d_var=v;
+    d_new=1;
+  }
 
-    for(unsigned int i=0; i< vars.size(); i++){
-      d_val[vars[i]]=v[varNumber[i]];
+  void Expression::setValue(unsigned int i, double v)
+  {
+    if(i>=d_var.size()){
+      std::ostringstream os;
+      os << "Variable a" << i+1 << " does not appear in the expression"
+	 << std::endl;
+      throw(gromos::Exception("Expression", os.str()));
     }
+    d_var[i]=v;
     d_new=1;
   }
 
@@ -216,7 +262,10 @@ namespace gmath
   void Expression::writeExpressionValue(std::ostream& os)
   {
     for(unsigned int i=0; i< d_op.size(); i++){
-      if(is_number(d_op[i]))
+      if(is_variable(d_op[i]))
+	os << d_var[atoi(d_op[i].substr(1, d_op[i].size()-1).c_str())-1] 
+	   << " ";
+      else if(is_number(d_op[i]))
 	os << d_val[i] << " ";
       else
 	os << d_op[i] << " ";
@@ -228,21 +277,94 @@ namespace gmath
   {
     if(!d_new)
       return d_result;
-    else{
-      // as the calculation process changes the vectors with values
-      // and operators, we have to make copies of these 
-      std::vector<std::string> op;
-      std::vector<double> val;
-      for(unsigned int i=0; i< d_op.size(); i++){
-	op.push_back(d_op[i]);
-	val.push_back(d_val[i]);
+
+    double * x=&d_stack[0] - 1;
+    for(unsigned int i=0; i< d_code.size(); i++){
+      switch(d_code[i].op){
+	case op_const: *(++x) = d_code[i].value; break;
+	case op_var:   *(++x) = d_var[d_code[i].var]; break;
+	case op_add:   x[-1] += x[0]; --x; break;
+	case op_sub:   x[-1] -= x[0]; --x; break;
+	case op_mul:   x[-1] *= x[0]; --x; break;
+	case op_div:   x[-1] /= x[0]; --x; break;
+	case op_cos:   *x = cos(*x); break;
+	case op_sin:   *x = sin(*x); break;
+	case op_exp:   *x = exp(*x); break;
+	case op_log:   *x = log(*x); break;
       }
+    }
+    d_result=*x;
+    d_new=0;
+
+    return d_result;
+  }
+
+  void Expression::values(std::vector<const double *> const & v, 
+			  unsigned int n, double * res)const
+  {
+    if(v.size()<d_var.size()){
+      std::ostringstream os;
+      os << "Incorrect number of variables supplied in function values.\n"
+	 << "Expected " << d_var.size() << " values. Got " << v.size() 
+	 << std::endl;
+      throw(gromos::Exception("Expression", os.str()));
+    }
     
-      d_result=calc(op, val, 0,d_op.size());
+    // work on batches that keep the stack in the cache
+    const unsigned int batch=256;
+    std::vector<double> stack(d_depth*batch);
     
-      d_new=0;
+    for(unsigned int b=0; b<n; b+=batch){
+      const unsigned int m = (n-b < batch) ? n-b : batch;
+      double * x = &stack[0] - batch;
       
-      return d_result;
+      for(unsigned int i=0; i< d_code.size(); i++){
+	switch(d_code[i].op){
+	  case op_const:
+	    {
+	      x += batch;
+	      const double c=d_code[i].value;
+	      for(unsigned int k=0; k<m; ++k) x[k]=c;
+	      break;
+	    }
+	  case op_var:
+	    {
+	      x += batch;
+	      const double * y=v[d_code[i].var] + b;
+	      for(unsigned int k=0; k<m; ++k) x[k]=y[k];
+	      break;
+	    }
+	  case op_add:
+	    x -= batch;
+	    for(unsigned int k=0; k<m; ++k) x[k]+=x[k+batch];
+	    break;
+	  case op_sub:
+	    x -= batch;
+	    for(unsigned int k=0; k<m; ++k) x[k]-=x[k+batch];
+	    break;
+	  case op_mul:
+	    x -= batch;
+	    for(unsigned int k=0; k<m; ++k) x[k]*=x[k+batch];
+	    break;
+	  case op_div:
+	    x -= batch;
+	    for(unsigned int k=0; k<m; ++k) x[k]/=x[k+batch];
+	    break;
+	  case op_cos:
+	    for(unsigned int k=0; k<m; ++k) x[k]=cos(x[k]);
+	    break;
+	  case op_sin:
+	    for(unsigned int k=0; k<m; ++k) x[k]=sin(x[k]);
+	    break;
+	  case op_exp:
+	    for(unsigned int k=0; k<m; ++k) x[k]=exp(x[k]);
+	    break;
+	  case op_log:
+	    for(unsigned int k=0; k<m; ++k) x[k]=log(x[k]);
+	    break;
+	}
+      }
+      for(unsigned int k=0; k<m; ++k) res[b+k]=x[k];
     }
   }
   
@@ -266,9 +388,9 @@ namespace gmath
     }
   }
 
-  double Expression::calc(std::vector<std::string>& op, 
-			  std::vector<double>& val, 
-			  int f, int t)
+  void Expression::calc(std::vector<std::string>& op, 
+			std::vector<std::vector<Instruction> >& val, 
+			int f, int t, std::vector<Instruction> & code)
   {
     int i=t-1;
     int option=-2;
@@ -283,13 +405,15 @@ namespace gmath
       Expression::find_bracket(op, br_open_first, br_close_last);
       int tobesubstracted=br_close_last-br_open_first;
       if(br_open_first!=-1){
-	double c=Expression::calc(op, val, br_open_first+1,br_close_last);
+	std::vector<Instruction> c;
+	Expression::calc(op, val, br_open_first+1,br_close_last, c);
 	br_open_first=f;
 	br_close_last=val.size()-1;
 	Expression::find_bracket(op, br_open_first, br_close_last);
 
 	// now remove the elements between the brackets
-	std::vector<double>::iterator begin= val.begin() + br_open_first,
+	std::vector<std::vector<Instruction> >::iterator 
+	  begin= val.begin() + br_open_first,
 	  end = val.begin()+br_close_last;
 	std::vector<std::string>::iterator op_beg= op.begin() + br_open_first,
 	  op_end = op.begin()+br_close_last;
@@ -308,7 +432,7 @@ namespace gmath
     // special function
     special_functions(op, val, f, t);
 
-    // now do the calculation, search for an operator
+    // now find the operator to split at, search for an operator
     // we prefer a + or a -, but keep the position of * or / in case we do
     // not find the first    
     while( i>f && op[i]!="+" && op[i]!="-" ) {
@@ -317,24 +441,24 @@ namespace gmath
     }
     if(i==f) {
       if(option==-2){
-	// No operator, so just return the value
-        return val[i];
+	// No operator, so just the value
+	code.insert(code.end(), val[i].begin(), val[i].end());
+        return;
       }
       else i=option;
     }
     
-    double a=calc(op, val, f, i);
-    double b=calc(op, val, i+1, t);
+    calc(op, val, f, i, code);
+    calc(op, val, i+1, t, code);
 
-    if(op[i]=="*")
-	return a*b;
-    if(op[i]=="/")
-	return a/b;
-    if(op[i]=="-")
-	return a-b;
-    if(op[i]=="+")
-	return a+b;
-    return 0;
+    Instruction ins;
+    ins.var=-1;
+    ins.value=0.0;
+    if(op[i]=="*") ins.op=op_mul;
+    else if(op[i]=="/") ins.op=op_div;
+    else if(op[i]=="-") ins.op=op_sub;
+    else ins.op=op_add;
+    code.push_back(ins);
   }
   bool Expression::allowed_token(std::string s)
   {
@@ -350,15 +474,6 @@ namespace gmath
   {
     return s[0]=='a';
   }
-  bool Expression::is_function(std::string s, double on, double& res)
-  {
-    if(s=="cos"){ res=cos(on); return true;}
-    if(s=="sin"){ res=sin(on); return true;}
-    if(s=="exp"){ res=exp(on); return true;}
-    if(s=="log"){ res=log(on); return true;}
-        
-    return false;
-  }
   bool Expression::is_function(std::string s)
   {
     return s=="cos" || s=="sin" || s=="exp" || s=="log";
@@ -400,15 +515,26 @@ namespace gmath
   }
 
   void Expression::special_functions(std::vector<std::string>& op, 
-				     std::vector<double>& val, 
+				     std::vector<std::vector<Instruction> >& val,
 				     int f, int& t)
   {
-    double c=0;
     for(int j=f; j<t; j++){
-      if(is_function(op[j], val[j+1], c)){
+      if(is_function(op[j])){
+	if(j+1>=int(val.size()))
+	  throw(gromos::Exception("Expression", "Function " + op[j] + 
+				  " without argument"));
+	Instruction ins;
+	ins.var=-1;
+	ins.value=0.0;
+	if(op[j]=="cos") ins.op=op_cos;
+	else if(op[j]=="sin") ins.op=op_sin;
+	else if(op[j]=="exp") ins.op=op_exp;
+	else ins.op=op_log;
+	std::vector<Instruction> c(val[j+1]);
+	c.push_back(ins);
 
 	// now remove the element j+1 
-	std::vector<double>::iterator begin= val.begin() + j,
+	std::vector<std::vector<Instruction> >::iterator begin= val.begin() + j,
 	    end = val.begin()+j+1;
 	std::vector<std::string>::iterator op_beg= op.begin() + j,
 	    op_end = op.begin()+j+1;
@@ -24,6 +24,7 @@
 #define INCLUDED_GMATH_EXPRESSION
 
 #include <vector>
+#include <string>
 
 namespace gmath
 {
@@ -37,16 +38,64 @@ namespace gmath
    * * and / come before + and -. Brackets and the functions cos, sin, log 
    * and exp are also implemented
    *
+   * The expression is compiled once into a small stack program, such that
+   * repeated evaluations (e.g. for every frame of an energy trajectory) do
+   * not have to look at the strings again.
+   *
    * @class Expression
    * @author B.C. Oostenbrink
    * @ingroup gmath
    */
   class Expression
   {
+  public:
+    /**
+     * operation codes of the compiled expression
+     */
+    enum opcode_enum{
+      op_const, op_var, op_add, op_sub, op_mul, op_div,
+      op_cos, op_sin, op_exp, op_log
+    };
+    /**
+     * one instruction of the compiled expression. The expression is
+     * compiled to reverse polish notation, constants and variables are
+     * pushed onto a stack, operators and functions replace the topmost
+     * value(s) by their result.
+     */
+    struct Instruction
+    {
+      opcode_enum op;
+      /**
+       * variable index (a1 has index 0) for op_var
+       */
+      int var;
+      /**
+       * value for op_const
+       */
+      double value;
+    };
+
+  private:
     std::vector<double> d_val;
     std::vector<std::string> d_op;
     int d_new;
     double d_result;
+    /**
+     * the compiled expression
+     */
+    std::vector<Instruction> d_code;
+    /**
+     * the maximum depth of the stack needed to evaluate d_code
+     */
+    unsigned int d_depth;
+    /**
+     * the current values of the variables a1 .. an
+     */
+    std::vector<double> d_var;
+    /**
+     * the stack used by value()
+     */
+    std::vector<double> d_stack;
 
   public:
     /**
@@ -87,10 +136,35 @@ namespace gmath
      *                 that is specified in the expression.
      */
     void setValues(std::vector<double>& v);
+    /**
+     * Method to set a single variable
+     * @param i index of the variable (a1 has index 0)
+     * @param v value
+     */
+    void setValue(unsigned int i, double v);
+    /**
+     * The number of variables needed to evaluate the expression
+     */
+    unsigned int numVariables()const { return d_var.size(); }
     /**
      * Method that evaluates the expression with the current set of variables
      */
     double value();
+    /**
+     * Method that evaluates the expression for a batch of n sets of
+     * variables at once. Each instruction of the compiled expression is
+     * applied to the whole batch before the next one, which keeps the
+     * inner loops free of branches.
+     * @param v pointers to the n values of every variable (v[0] for a1, ...)
+     * @param n the number of sets (e.g. frames)
+     * @param res n results are written here
+     */
+    void values(std::vector<const double *> const & v, unsigned int n,
+		double * res)const;
+    /**
+     * Accessor to the compiled expression
+     */
+    std::vector<Instruction> const & code()const { return d_code; }
     /**
      * Method that writes the expression to an ostream. Good for debugging.
      */
@@ -105,10 +179,11 @@ namespace gmath
     void Tokenize(const std::string& str,
 		  std::vector<std::string>& tokens,
 		  const std::string& delimiters);
-    double calc(std::vector<std::string>& op, std::vector<double>& val, 
-		int f, int t);
+    void compile();
+    void calc(std::vector<std::string>& op,
+	      std::vector<std::vector<Instruction> >& val,
+	      int f, int t, std::vector<Instruction> & code);
     bool allowed_token(std::string s);
-    bool is_function(std::string s, double on, double& res);
     bool is_function(std::string s);
     bool is_operator(std::string s);
     bool is_variable(std::string s);
@@ -116,7 +191,7 @@ namespace gmath
     bool is_number(std::string s);
     void find_bracket(std::vector<std::string>&op, int &first, int &last);
     void special_functions(std::vector<std::string>& op,
-			   std::vector<double>& val,
+			   std::vector<std::vector<Instruction> >& val,
 			   int f, int& t);
   };
 }
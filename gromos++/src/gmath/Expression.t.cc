@@ -44,6 +44,19 @@ int main(int argc, char *argv[]) {
     Expression e(s);
     e.writeExpression(cout);
     cout << e.value() << endl;
+
+    // the batch evaluation has to give the same
+    if (e.numVariables() == 0) {
+      vector<const double *> v;
+      double r[3];
+      e.values(v, 3, r);
+      for (int i = 0; i < 3; i++) {
+        if (r[i] != e.value() && !(r[i] != r[i] && e.value() != e.value())) {
+          cerr << "batch evaluation gives " << r[i] << endl;
+          return 1;
+        }
+      }
+    }
   }  catch (gromos::Exception e) {
     cerr << e.what() << endl;
     return 1;
@@ -0,0 +1,229 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_LogSumExp.cc
+
+#include "LogSumExp.h"
+#include "../gromos/Exception.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace gmath
+{
+  // the number of samples collected before the sums are updated
+  static const unsigned int block_size = 256;
+
+  LogSumExp::LogSumExp(unsigned int states, bool x, bool cross) :
+  d_states(states), d_x(x), d_cross(cross), d_counter(0), d_fill(0) {
+    if (states == 0)
+      throw gromos::Exception("LogSumExp", "No states given!");
+    d_y.resize(states * block_size);
+    d_shift.assign(states, -std::numeric_limits<double>::infinity());
+    d_sum.assign(states, 0.0);
+    d_sum2.assign(states, 0.0);
+    if (x) {
+      d_xval.resize(states * block_size);
+      d_xsum.assign(states, 0.0);
+      d_xsum2.assign(states, 0.0);
+      d_xsum3.assign(states, 0.0);
+    }
+    if (cross)
+      d_cross_sum.assign(states * (states - 1) / 2, 0.0);
+  }
+
+  void LogSumExp::add(const double *y) {
+    if (d_x)
+      throw gromos::Exception("LogSumExp", "No observable given!");
+    for (unsigned int s = 0; s < d_states; ++s)
+      d_y[s * block_size + d_fill] = y[s];
+    ++d_counter;
+    if (++d_fill == block_size) flush();
+  }
+
+  void LogSumExp::add(const double *y, const double *x) {
+    if (!d_x)
+      throw gromos::Exception("LogSumExp", "Not set up for an observable!");
+    for (unsigned int s = 0; s < d_states; ++s) {
+      d_y[s * block_size + d_fill] = y[s];
+      d_xval[s * block_size + d_fill] = x[s];
+    }
+    ++d_counter;
+    if (++d_fill == block_size) flush();
+  }
+
+  void LogSumExp::add(double y) {
+    if (d_states != 1)
+      throw gromos::Exception("LogSumExp", "Single values need a single state!");
+    add(&y);
+  }
+
+  void LogSumExp::add(double y, double x) {
+    if (d_states != 1)
+      throw gromos::Exception("LogSumExp", "Single values need a single state!");
+    add(&y, &x);
+  }
+
+  void LogSumExp::add(const double *y, const double *x, unsigned int n) {
+    if (d_states != 1)
+      throw gromos::Exception("LogSumExp", "Series need a single state!");
+    if (d_x && x == NULL)
+      throw gromos::Exception("LogSumExp", "No observable given!");
+    for (unsigned int i = 0; i < n; ++i) {
+      d_y[d_fill] = y[i];
+      if (d_x) d_xval[d_fill] = x[i];
+      ++d_counter;
+      if (++d_fill == block_size) flush();
+    }
+  }
+
+  void LogSumExp::flush() {
+    if (d_fill == 0) return;
+    const unsigned int n = d_fill;
+    std::vector<double> scale(d_states, 1.0);
+
+    for (unsigned int s = 0; s < d_states; ++s) {
+      double *y = &d_y[s * block_size];
+      // shift the sums if the block has a larger maximum
+      double m = y[0];
+      for (unsigned int k = 1; k < n; ++k)
+        m = y[k] > m ? y[k] : m;
+      if (m > d_shift[s]) {
+        scale[s] = exp(d_shift[s] - m);
+        const double scale2 = scale[s] * scale[s];
+        d_shift[s] = m;
+        d_sum[s] *= scale[s];
+        d_sum2[s] *= scale2;
+        if (d_x) {
+          d_xsum[s] *= scale[s];
+          d_xsum2[s] *= scale2;
+          d_xsum3[s] *= scale2;
+        }
+      }
+
+      // the terms of the block, the exponentials replace the exponents
+      const double shift = d_shift[s];
+      double sum = 0.0, sum2 = 0.0;
+#ifdef OMP
+#pragma omp simd reduction(+:sum,sum2)
+#endif
+      for (unsigned int k = 0; k < n; ++k) {
+        y[k] = exp(y[k] - shift);
+        sum += y[k];
+        sum2 += y[k] * y[k];
+      }
+      d_sum[s] += sum;
+      d_sum2[s] += sum2;
+
+      if (d_x) {
+        const double *x = &d_xval[s * block_size];
+        double xsum = 0.0, xsum2 = 0.0, xsum3 = 0.0;
+#ifdef OMP
+#pragma omp simd reduction(+:xsum,xsum2,xsum3)
+#endif
+        for (unsigned int k = 0; k < n; ++k) {
+          const double xe = x[k] * y[k];
+          xsum += xe;
+          xsum2 += xe * xe;
+          xsum3 += xe * y[k];
+        }
+        d_xsum[s] += xsum;
+        d_xsum2[s] += xsum2;
+        d_xsum3[s] += xsum3;
+      }
+    }
+
+    if (d_cross) {
+      unsigned int c = 0;
+      for (unsigned int s = 0; s < d_states; ++s) {
+        const double *ys = &d_y[s * block_size];
+        for (unsigned int t = s + 1; t < d_states; ++t, ++c) {
+          const double *yt = &d_y[t * block_size];
+          double sum = 0.0;
+#ifdef OMP
+#pragma omp simd reduction(+:sum)
+#endif
+          for (unsigned int k = 0; k < n; ++k)
+            sum += ys[k] * yt[k];
+          d_cross_sum[c] = d_cross_sum[c] * scale[s] * scale[t] + sum;
+        }
+      }
+    }
+    d_fill = 0;
+  }
+
+  void LogSumExp::check(unsigned int s, const char *what)const {
+    if (s >= d_states) {
+      std::ostringstream os;
+      os << "State " << s << " out of range for " << what << "!";
+      throw gromos::Exception("LogSumExp", os.str());
+    }
+    if (d_counter == 0)
+      throw gromos::Exception("LogSumExp", std::string("No samples for ") +
+            what + "!");
+  }
+
+  double LogSumExp::lnexpave(unsigned int s) {
+    check(s, "lnexpave");
+    flush();
+    return d_shift[s] + log(d_sum[s]) - log(double(d_counter));
+  }
+
+  double LogSumExp::lnXexpave(unsigned int s, int &sign) {
+    check(s, "lnXexpave");
+    if (!d_x)
+      throw gromos::Exception("LogSumExp", "Not set up for an observable!");
+    flush();
+    sign = d_xsum[s] < 0.0 ? -1 : 1;
+    return d_shift[s] + log(fabs(d_xsum[s])) - log(double(d_counter));
+  }
+
+  double LogSumExp::relcovariance(unsigned int s, unsigned int t) {
+    check(s, "relcovariance");
+    check(t, "relcovariance");
+    flush();
+    if (s == t)
+      return d_counter * d_sum2[s] / (d_sum[s] * d_sum[s]) - 1.0;
+    if (!d_cross)
+      throw gromos::Exception("LogSumExp", "Not set up for covariances "
+            "between states!");
+    if (s > t) std::swap(s, t);
+    const unsigned int c = s * d_states - s * (s + 1) / 2 + t - s - 1;
+    return d_counter * d_cross_sum[c] / (d_sum[s] * d_sum[t]) - 1.0;
+  }
+
+  double LogSumExp::relXvariance(unsigned int s) {
+    check(s, "relXvariance");
+    if (!d_x)
+      throw gromos::Exception("LogSumExp", "Not set up for an observable!");
+    flush();
+    return d_counter * d_xsum2[s] / (d_xsum[s] * d_xsum[s]) - 1.0;
+  }
+
+  double LogSumExp::relXcovariance(unsigned int s) {
+    check(s, "relXcovariance");
+    if (!d_x)
+      throw gromos::Exception("LogSumExp", "Not set up for an observable!");
+    flush();
+    return d_counter * d_xsum3[s] / (d_xsum[s] * d_sum[s]) - 1.0;
+  }
+}
@@ -0,0 +1,146 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_LogSumExp
+
+#ifndef INCLUDED_GMATH_LOGSUMEXP
+#define INCLUDED_GMATH_LOGSUMEXP
+
+#include <vector>
+
+namespace gmath
+{
+  /**
+   * Class LogSumExp
+   * A class to calculate exponential averages of many states at once
+   *
+   * For every state @f$s@f$ the samples @f$y_s@f$ (e.g. 
+   * @f$-\beta(H_s - H_R)@f$ from a simulation at R) and, optionally, an 
+   * observable @f$x_s@f$ are added. The class gives
+   * @f$\ln\langle e^{y_s}\rangle@f$, @f$\ln|\langle x_s e^{y_s}\rangle|@f$ 
+   * and the relative (co)variances of @f$e^{y_s}@f$ and 
+   * @f$x_s e^{y_s}@f$ that enter the error estimates, without keeping the
+   * samples.
+   *
+   * Instead of adding up the logarithms term by term (B.A. Berg, Comput.
+   * Phys. Comm. 153 (2003) 397, as in Stat::lnexpave), the samples are
+   * collected in blocks. The maximum @f$m_s@f$ of a block shifts all sums
+   * @f$\sum e^{y_s - m_s}@f$ once per block and the terms of the block are
+   * plain exponentials and sums over contiguous arrays, which the compiler
+   * can vectorise. As the largest term of every sum is one, the sums 
+   * cannot overflow.
+   *
+   * If the states are sampled at the same frames, the covariances between
+   * the exponentials of different states can be accumulated as well.
+   *
+   * @class LogSumExp
+   * @ingroup gmath
+   * @sa gmath::Stat
+   */
+  class LogSumExp
+    {
+      unsigned int d_states;
+      bool d_x, d_cross;
+      int d_counter;
+      // the samples of the current block (state-major) and their number
+      std::vector<double> d_y, d_xval;
+      unsigned int d_fill;
+      // the shift and sums per state:
+      // e^(y-m), e^(2(y-m)), x e^(y-m), x^2 e^(2(y-m)), x e^(2(y-m))
+      std::vector<double> d_shift, d_sum, d_sum2, d_xsum, d_xsum2, d_xsum3;
+      // e^(y_s-m_s) e^(y_t-m_t) for t > s
+      std::vector<double> d_cross_sum;
+      
+      void flush();
+      void check(unsigned int s, const char *what)const;
+    public:
+      /**
+       * Constructor
+       * @param states the number of states
+       * @param x whether an observable is added with the samples
+       * @param cross whether the covariances between the states are needed
+       */
+      LogSumExp(unsigned int states = 1, bool x = false, bool cross = false);
+      /**
+       * add a sample of all states
+       * @param y the exponents, one per state
+       */
+      void add(const double *y);
+      /**
+       * add a sample of all states with the observable
+       * @param y the exponents, one per state
+       * @param x the observable, one per state
+       */
+      void add(const double *y, const double *x);
+      /**
+       * add a sample (single state)
+       */
+      void add(double y);
+      /**
+       * add a sample with the observable (single state)
+       */
+      void add(double y, double x);
+      /**
+       * add n samples (single state)
+       * @param y the exponents
+       * @param x the observables (if the class was set up for them)
+       * @param n the number of samples
+       */
+      void add(const double *y, const double *x, unsigned int n);
+      /**
+       * the number of states
+       */
+      unsigned int states()const { return d_states; }
+      /**
+       * the number of samples added
+       */
+      int n()const { return d_counter; }
+      /**
+       * @f$\ln\langle e^{y_s}\rangle@f$
+       */
+      double lnexpave(unsigned int s = 0);
+      /**
+       * @f$\ln|\langle x_s e^{y_s}\rangle|@f$
+       * @param sign the sign of @f$\langle x_s e^{y_s}\rangle@f$
+       */
+      double lnXexpave(unsigned int s, int &sign);
+      /**
+       * the relative covariance of the exponentials of two states,
+       * @f$\mathrm{cov}(e^{y_s}, e^{y_t}) / 
+       *     (\langle e^{y_s}\rangle\langle e^{y_t}\rangle)@f$.
+       * For @f$s \ne t@f$ the class has to be set up for covariances.
+       */
+      double relcovariance(unsigned int s, unsigned int t);
+      /**
+       * the relative variance of @f$e^{y_s}@f$
+       */
+      double relvariance(unsigned int s = 0) { return relcovariance(s, s); }
+      /**
+       * the relative variance of @f$x_s e^{y_s}@f$
+       */
+      double relXvariance(unsigned int s = 0);
+      /**
+       * the relative covariance of @f$x_s e^{y_s}@f$ and @f$e^{y_s}@f$
+       */
+      double relXcovariance(unsigned int s = 0);
+    };
+}
+
+#endif
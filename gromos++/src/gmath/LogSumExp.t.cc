@@ -0,0 +1,139 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_LogSumExp.t.cc
+
+// compares the exponential averages and relative (co)variances of three
+// states with Stat and with direct sums, also for exponents that would
+// overflow exp()
+
+#include "LogSumExp.h"
+#include "Stat.h"
+#include "../gromos/Exception.h"
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using gmath::LogSumExp;
+using gmath::Stat;
+
+using namespace std;
+
+double random(double range) {
+  return range * (double(rand()) / RAND_MAX - 0.5);
+}
+
+bool close(double a, double b, double eps) {
+  return fabs(a - b) < eps * (1.0 + fabs(b));
+}
+
+int main() {
+  try {
+    srand(4711);
+    const unsigned int states = 3, frames = 1000;
+    // the exponents are offset by 0, 800 and -800
+    const double offset[] = {0.0, 800.0, -800.0};
+    vector<vector<double> > y(states, vector<double>(frames));
+    vector<vector<double> > x(states, vector<double>(frames));
+    vector<Stat<double> > sy(states), sx(states);
+    for (unsigned int f = 0; f < frames; ++f) {
+      for (unsigned int s = 0; s < states; ++s) {
+        y[s][f] = offset[s] + random(6.0) + (s == 1 ? y[0][f] : 0.0);
+        x[s][f] = random(2.0) + 0.3;
+        sy[s].addval(y[s][f]);
+        sx[s].addval(x[s][f]);
+      }
+    }
+
+    LogSumExp all(states, true, false), cross(states, false, true);
+    for (unsigned int f = 0; f < frames; ++f) {
+      double yf[states], xf[states];
+      for (unsigned int s = 0; s < states; ++s) {
+        yf[s] = y[s][f];
+        xf[s] = x[s][f];
+      }
+      all.add(yf, xf);
+      cross.add(yf);
+    }
+    assert(all.n() == int(frames));
+
+    for (unsigned int s = 0; s < states; ++s) {
+      // averages
+      assert(close(all.lnexpave(s), sy[s].lnexpave(), 1e-12));
+      int sign = 0, ref_sign = 0;
+      const double lnx = all.lnXexpave(s, sign);
+      const double ref_lnx = Stat<double>::lnXexpave(sx[s], sy[s], ref_sign);
+      assert(sign == ref_sign && close(lnx, ref_lnx, 1e-10));
+
+      // the series as a single state, added at once
+      LogSumExp single(1, true);
+      single.add(&y[s][0], &x[s][0], frames);
+      assert(close(single.lnexpave(), sy[s].lnexpave(), 1e-12));
+
+      // relative variance from Stat: exp(lncov - 2 lnave)
+      int vsign = 1;
+      const double lnvar = Stat<double>::lnexpcovariance(sy[s], sy[s], vsign);
+      const double relvar = exp(lnvar - 2 * sy[s].lnexpave());
+      assert(close(all.relvariance(s), relvar, 1e-8));
+      assert(close(cross.relvariance(s), relvar, 1e-8));
+      assert(close(single.relvariance(), relvar, 1e-8));
+
+      // the observable, with weights relative to the maximum
+      double m = sy[s].max(), w = 0, w2 = 0, xw = 0, x2w2 = 0, xw2 = 0;
+      for (unsigned int f = 0; f < frames; ++f) {
+        const double e = exp(y[s][f] - m);
+        w += e;
+        w2 += e * e;
+        xw += x[s][f] * e;
+        x2w2 += x[s][f] * x[s][f] * e * e;
+        xw2 += x[s][f] * e * e;
+      }
+      assert(close(all.relXvariance(s), frames * x2w2 / (xw * xw) - 1, 1e-10));
+      assert(close(all.relXcovariance(s), frames * xw2 / (xw * w) - 1, 1e-10));
+      cout << "state " << s << ": ln<exp(y)> " << all.lnexpave(s)
+              << " ln|<x exp(y)>| " << lnx << " relative variance "
+              << all.relvariance(s) << endl;
+    }
+
+    // covariances between the states
+    for (unsigned int s = 0; s < states; ++s) {
+      for (unsigned int t = 0; t < states; ++t) {
+        if (s == t) continue;
+        int sign = 1;
+        const double lncov = Stat<double>::lnexpcovariance(sy[s], sy[t], sign);
+        const double ref = sign * exp(lncov - sy[s].lnexpave() - sy[t].lnexpave());
+        assert(close(cross.relcovariance(s, t), ref, 1e-8));
+      }
+    }
+
+    // no covariances set up
+    try {
+      all.relcovariance(0, 1);
+      assert(false);
+    } catch (const gromos::Exception &e) {
+    }
+    return 0;
+  } catch (const gromos::Exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+}
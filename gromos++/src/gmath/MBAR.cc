@@ -0,0 +1,409 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_MBAR.cc
+
+#include "MBAR.h"
+#include "LogSumExp.h"
+#include "../gromos/Exception.h"
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_eigen.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#ifdef OMP
+#include <omp.h>
+#endif
+
+namespace gmath
+{
+  // the number of corrections kept by L-BFGS
+  static const unsigned int lbfgs_memory = 10;
+
+  MBAR::MBAR(unsigned int states) : d_states(states), d_n(states, 0),
+  d_f(states, 0.0), d_solved(false), d_theta_done(false) {
+    if (states == 0)
+      throw gromos::Exception("MBAR", "No states given!");
+  }
+
+  void MBAR::add(unsigned int state, const double *u) {
+    if (state >= d_states)
+      throw gromos::Exception("MBAR", "Sample from an unknown state!");
+    d_u.insert(d_u.end(), u, u + d_states);
+    d_from.push_back(state);
+    ++d_n[state];
+    d_solved = false;
+    d_theta_done = false;
+  }
+
+  double MBAR::objective(const std::vector<double> &f,
+          std::vector<double> *grad, std::vector<double> *hess) {
+    const unsigned int K = d_states;
+    const int N = d_from.size();
+    std::vector<double> c(K);
+    for (unsigned int k = 0; k < K; ++k)
+      c[k] = f[k] + d_lnn[k];
+    d_lse.resize(N);
+    double F = 0.0;
+    if (grad) grad->assign(K, 0.0);
+    if (hess) hess->assign(K * K, 0.0);
+
+#ifdef OMP
+#pragma omp parallel
+#endif
+    {
+      std::vector<double> a(K), g(grad ? K : 0), h(hess ? K * K : 0);
+      double sum_lse = 0.0;
+#ifdef OMP
+#pragma omp for schedule(static)
+#endif
+      for (int n = 0; n < N; ++n) {
+        const double *u = &d_u[n * K];
+        double m = -std::numeric_limits<double>::infinity();
+        for (unsigned int k = 0; k < K; ++k) {
+          a[k] = c[k] - u[k];
+          m = a[k] > m ? a[k] : m;
+        }
+        double s = 0.0;
+        for (unsigned int k = 0; k < K; ++k) {
+          a[k] = exp(a[k] - m);
+          s += a[k];
+        }
+        d_lse[n] = m + log(s);
+        sum_lse += d_lse[n];
+        if (!grad) continue;
+        // the weights N_k exp(f_k - u_k) / sum_l N_l exp(f_l - u_l)
+        const double inv = 1.0 / s;
+        for (unsigned int k = 0; k < K; ++k) {
+          a[k] *= inv;
+          g[k] += a[k];
+        }
+        if (!hess) continue;
+        for (unsigned int k = 0; k < K; ++k) {
+          if (a[k] == 0.0) continue;
+          double *hk = &h[k * K];
+          for (unsigned int l = 0; l <= k; ++l)
+            hk[l] += a[k] * a[l];
+        }
+      }
+#ifdef OMP
+#pragma omp critical
+#endif
+      {
+        F += sum_lse;
+        for (unsigned int k = 0; k < g.size(); ++k)
+          (*grad)[k] += g[k];
+        for (unsigned int k = 0; k < h.size(); ++k)
+          (*hess)[k] += h[k];
+      }
+    }
+
+    for (unsigned int k = 0; k < K; ++k)
+      F -= d_n[k] * f[k];
+    if (hess) {
+      for (unsigned int k = 0; k < K; ++k) {
+        for (unsigned int l = 0; l < k; ++l) {
+          (*hess)[k * K + l] = -(*hess)[k * K + l];
+          (*hess)[l * K + k] = (*hess)[k * K + l];
+        }
+        (*hess)[k * K + k] = (*grad)[k] - (*hess)[k * K + k];
+      }
+    }
+    if (grad) {
+      for (unsigned int k = 0; k < K; ++k)
+        (*grad)[k] -= d_n[k];
+    }
+    return F;
+  }
+
+  void MBAR::pseudo_inverse(std::vector<double> &a, unsigned int n) {
+    gsl_matrix *m = gsl_matrix_alloc(n, n);
+    gsl_matrix *evec = gsl_matrix_alloc(n, n);
+    gsl_vector *eval = gsl_vector_alloc(n);
+    gsl_eigen_symmv_workspace *w = gsl_eigen_symmv_alloc(n);
+    for (unsigned int i = 0; i < n; ++i) {
+      for (unsigned int j = 0; j < n; ++j)
+        gsl_matrix_set(m, i, j, a[i * n + j]);
+    }
+    gsl_eigen_symmv(m, eval, evec, w);
+
+    double max = 0.0;
+    for (unsigned int k = 0; k < n; ++k)
+      max = std::max(max, fabs(gsl_vector_get(eval, k)));
+    std::fill(a.begin(), a.end(), 0.0);
+    for (unsigned int k = 0; k < n; ++k) {
+      const double e = gsl_vector_get(eval, k);
+      if (fabs(e) <= 1e-10 * max) continue;
+      for (unsigned int i = 0; i < n; ++i) {
+        const double vi = gsl_matrix_get(evec, i, k) / e;
+        for (unsigned int j = 0; j < n; ++j)
+          a[i * n + j] += vi * gsl_matrix_get(evec, j, k);
+      }
+    }
+    gsl_eigen_symmv_free(w);
+    gsl_vector_free(eval);
+    gsl_matrix_free(evec);
+    gsl_matrix_free(m);
+  }
+
+  int MBAR::solve(method_enum method, double tolerance, int maxiter) {
+    const unsigned int K = d_states;
+    unsigned int sampled = 0;
+    d_lnn.resize(K);
+    for (unsigned int k = 0; k < K; ++k) {
+      if (d_n[k]) ++sampled;
+      d_lnn[k] = d_n[k] ? log(double(d_n[k])) :
+              -std::numeric_limits<double>::infinity();
+    }
+    if (sampled == 0)
+      throw gromos::Exception("MBAR", "No samples!");
+
+    std::vector<double> f(K, 0.0), g, h, step(K), trial(K), g_new;
+    // the corrections of L-BFGS
+    std::vector<std::vector<double> > s_hist, y_hist;
+    double F = objective(f, &g, method == newton ? &h : NULL);
+    int it = 0;
+    bool converged = false;
+    for (; it < maxiter; ++it) {
+      double gmax = 0.0;
+      for (unsigned int k = 0; k < K; ++k) {
+        if (d_n[k]) gmax = std::max(gmax, fabs(g[k]) / d_n[k]);
+      }
+      if (gmax < tolerance) {
+        converged = true;
+        break;
+      }
+
+      // the search direction
+      if (method == newton) {
+        pseudo_inverse(h, K);
+        for (unsigned int k = 0; k < K; ++k) {
+          step[k] = 0.0;
+          for (unsigned int l = 0; l < K; ++l)
+            step[k] -= h[k * K + l] * g[l];
+        }
+      } else {
+        // two-loop recursion
+        step = g;
+        const unsigned int m = s_hist.size();
+        std::vector<double> alpha(m), rho(m);
+        for (int i = m - 1; i >= 0; --i) {
+          double sy = 0.0, sq = 0.0;
+          for (unsigned int k = 0; k < K; ++k) {
+            sy += s_hist[i][k] * y_hist[i][k];
+            sq += s_hist[i][k] * step[k];
+          }
+          rho[i] = 1.0 / sy;
+          alpha[i] = rho[i] * sq;
+          for (unsigned int k = 0; k < K; ++k)
+            step[k] -= alpha[i] * y_hist[i][k];
+        }
+        // scale the first step by the number of samples
+        double gamma = 1.0 / d_from.size();
+        if (m) {
+          double sy = 0.0, yy = 0.0;
+          for (unsigned int k = 0; k < K; ++k) {
+            sy += s_hist[m - 1][k] * y_hist[m - 1][k];
+            yy += y_hist[m - 1][k] * y_hist[m - 1][k];
+          }
+          gamma = sy / yy;
+        }
+        for (unsigned int k = 0; k < K; ++k)
+          step[k] *= gamma;
+        for (unsigned int i = 0; i < m; ++i) {
+          double yr = 0.0;
+          for (unsigned int k = 0; k < K; ++k)
+            yr += y_hist[i][k] * step[k];
+          const double beta = rho[i] * yr;
+          for (unsigned int k = 0; k < K; ++k)
+            step[k] += s_hist[i][k] * (alpha[i] - beta);
+        }
+        for (unsigned int k = 0; k < K; ++k)
+          step[k] = -step[k];
+      }
+
+      // backtracking line search (Armijo), allowing for the rounding
+      // errors of the sums close to the minimum
+      double slope = 0.0;
+      for (unsigned int k = 0; k < K; ++k)
+        slope += step[k] * g[k];
+      if (slope >= 0.0) break;
+      double t = 1.0, F_new = F;
+      bool accepted = false;
+      for (int ls = 0; ls < 50; ++ls, t *= 0.5) {
+        for (unsigned int k = 0; k < K; ++k)
+          trial[k] = f[k] + t * step[k];
+        F_new = objective(trial, NULL, NULL);
+        if (F_new <= F + 1e-4 * t * slope + 1e-14 * fabs(F)) {
+          accepted = true;
+          break;
+        }
+      }
+      if (!accepted) break;
+
+      F_new = objective(trial, &g_new, method == newton ? &h : NULL);
+      if (method == lbfgs) {
+        std::vector<double> s(K), y(K);
+        double sy = 0.0;
+        for (unsigned int k = 0; k < K; ++k) {
+          s[k] = trial[k] - f[k];
+          y[k] = g_new[k] - g[k];
+          sy += s[k] * y[k];
+        }
+        if (sy > 0.0) {
+          s_hist.push_back(s);
+          y_hist.push_back(y);
+          if (s_hist.size() > lbfgs_memory) {
+            s_hist.erase(s_hist.begin());
+            y_hist.erase(y_hist.begin());
+          }
+        }
+      }
+      f = trial;
+      g = g_new;
+      F = F_new;
+    }
+
+    d_f = f;
+    objective(d_f, NULL, NULL);
+    unsampled();
+    d_solved = true;
+    d_theta_done = false;
+    return converged ? it : -it;
+  }
+
+  void MBAR::unsampled() {
+    std::vector<unsigned int> states;
+    for (unsigned int k = 0; k < d_states; ++k) {
+      if (d_n[k] == 0) states.push_back(k);
+    }
+    if (states.empty()) return;
+    // exp(-f_k) = sum_n exp(-u_k(x_n)) / sum_l N_l exp(f_l - u_l(x_n))
+    LogSumExp sum(states.size());
+    std::vector<double> y(states.size());
+    for (unsigned int n = 0; n < d_from.size(); ++n) {
+      for (unsigned int i = 0; i < states.size(); ++i)
+        y[i] = -d_u[n * d_states + states[i]] - d_lse[n];
+      sum.add(&y[0]);
+    }
+    for (unsigned int i = 0; i < states.size(); ++i)
+      d_f[states[i]] = -(sum.lnexpave(i) + log(double(d_from.size())));
+  }
+
+  const std::vector<double> & MBAR::covariance() {
+    if (!d_solved)
+      throw gromos::Exception("MBAR", "Free energies not calculated yet!");
+    if (d_theta_done) return d_theta;
+    const unsigned int K = d_states;
+    const int N = d_from.size();
+
+    // W^T W with the normalised weights W_nk = exp(f_k - u_k(x_n)) / sum_l ...
+    std::vector<double> wtw(K * K, 0.0);
+#ifdef OMP
+#pragma omp parallel
+#endif
+    {
+      std::vector<double> w(K), m(K * K, 0.0);
+#ifdef OMP
+#pragma omp for schedule(static)
+#endif
+      for (int n = 0; n < N; ++n) {
+        for (unsigned int k = 0; k < K; ++k)
+          w[k] = exp(d_f[k] - d_u[n * K + k] - d_lse[n]);
+        for (unsigned int k = 0; k < K; ++k) {
+          for (unsigned int l = 0; l <= k; ++l)
+            m[k * K + l] += w[k] * w[l];
+        }
+      }
+#ifdef OMP
+#pragma omp critical
+#endif
+      for (unsigned int k = 0; k < K * K; ++k)
+        wtw[k] += m[k];
+    }
+    for (unsigned int k = 0; k < K; ++k) {
+      for (unsigned int l = 0; l < k; ++l)
+        wtw[l * K + k] = wtw[k * K + l];
+    }
+
+    // W = U S V^T: W^T W = V S^2 V^T
+    gsl_matrix *m = gsl_matrix_alloc(K, K);
+    gsl_matrix *v = gsl_matrix_alloc(K, K);
+    gsl_vector *eval = gsl_vector_alloc(K);
+    gsl_eigen_symmv_workspace *ws = gsl_eigen_symmv_alloc(K);
+    for (unsigned int i = 0; i < K; ++i) {
+      for (unsigned int j = 0; j < K; ++j)
+        gsl_matrix_set(m, i, j, wtw[i * K + j]);
+    }
+    gsl_eigen_symmv(m, eval, v, ws);
+    std::vector<double> sigma(K);
+    for (unsigned int k = 0; k < K; ++k)
+      sigma[k] = sqrt(std::max(0.0, gsl_vector_get(eval, k)));
+
+    // A = I - S V^T N V S, Theta = V S A^+ S V^T
+    std::vector<double> a(K * K);
+    for (unsigned int i = 0; i < K; ++i) {
+      for (unsigned int j = 0; j < K; ++j) {
+        double vnv = 0.0;
+        for (unsigned int k = 0; k < K; ++k)
+          vnv += gsl_matrix_get(v, k, i) * d_n[k] * gsl_matrix_get(v, k, j);
+        a[i * K + j] = (i == j ? 1.0 : 0.0) - sigma[i] * vnv * sigma[j];
+      }
+    }
+    pseudo_inverse(a, K);
+    std::vector<double> vs(K * K);
+    for (unsigned int i = 0; i < K; ++i) {
+      for (unsigned int j = 0; j < K; ++j)
+        vs[i * K + j] = gsl_matrix_get(v, i, j) * sigma[j];
+    }
+    d_theta.assign(K * K, 0.0);
+    for (unsigned int i = 0; i < K; ++i) {
+      for (unsigned int j = 0; j < K; ++j) {
+        double t = 0.0;
+        for (unsigned int p = 0; p < K; ++p) {
+          double ap = 0.0;
+          for (unsigned int q = 0; q < K; ++q)
+            ap += a[p * K + q] * vs[j * K + q];
+          t += vs[i * K + p] * ap;
+        }
+        d_theta[i * K + j] = t;
+      }
+    }
+    gsl_eigen_symmv_free(ws);
+    gsl_vector_free(eval);
+    gsl_matrix_free(v);
+    gsl_matrix_free(m);
+    d_theta_done = true;
+    return d_theta;
+  }
+
+  double MBAR::error(unsigned int i, unsigned int j) {
+    if (i >= d_states || j >= d_states)
+      throw gromos::Exception("MBAR", "Unknown state!");
+    const std::vector<double> &theta = covariance();
+    const unsigned int K = d_states;
+    return sqrt(std::max(0.0, theta[i * K + i] + theta[j * K + j]
+            - 2.0 * theta[i * K + j]));
+  }
+}
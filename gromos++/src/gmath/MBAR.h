@@ -0,0 +1,144 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_MBAR
+
+#ifndef INCLUDED_GMATH_MBAR
+#define INCLUDED_GMATH_MBAR
+
+#include <vector>
+
+namespace gmath
+{
+  /**
+   * Class MBAR
+   * The multistate Bennett acceptance ratio estimator
+   *
+   * The samples @f$x_n@f$ from simulations at the states 
+   * @f$k = 1 \ldots K@f$ are added with their reduced potentials
+   * @f$u_l(x_n) = \beta_l H_l(x_n)@f$ at all states @f$l@f$. The 
+   * dimensionless free energies follow from the minimum of the convex
+   * function (Shirts and Chodera, J. Chem. Phys. 129 (2008) 124105)
+   *
+   * @f[ F(f) = \sum_n \ln \sum_k N_k e^{f_k - u_k(x_n)} - \sum_k N_k f_k @f]
+   *
+   * which is found with Newton's method or with L-BFGS (for many states),
+   * both with a backtracking line search. The sums over the samples are 
+   * evaluated in a numerically stable way (shifted by the largest term per
+   * sample) and distributed over the OpenMP threads. The reduced 
+   * potentials are kept sample-major in one array.
+   *
+   * States without samples (@f$N_k = 0@f$) are allowed; their free 
+   * energies follow from the weights of the sampled states.
+   *
+   * The asymptotic covariance matrix of the free energies is calculated
+   * from the weight matrix @f$W_{nk}@f$ as
+   * @f$\Theta = W^T (I - W N W^T)^+ W@f$, evaluated with the 
+   * eigenvectors of the @f$K \times K@f$ matrix @f$W^T W@f$.
+   *
+   * @class MBAR
+   * @ingroup gmath
+   */
+  class MBAR
+    {
+    public:
+      /**
+       * the minimisation methods
+       */
+      enum method_enum { newton, lbfgs };
+
+      /**
+       * Constructor
+       * @param states the number of states
+       */
+      MBAR(unsigned int states);
+      /**
+       * add a sample
+       * @param state the state the sample was drawn from
+       * @param u the reduced potentials of the sample at all states
+       */
+      void add(unsigned int state, const double *u);
+      /**
+       * the number of states
+       */
+      unsigned int states()const { return d_states; }
+      /**
+       * the number of samples
+       */
+      unsigned int samples()const { return d_from.size(); }
+      /**
+       * the number of samples from a state
+       */
+      unsigned int samples(unsigned int state)const { return d_n[state]; }
+      /**
+       * calculate the free energies
+       * @param method the minimisation method
+       * @param tolerance convergence if the largest gradient divided by 
+       *                  the number of samples of the state is smaller
+       * @param maxiter maximum number of iterations
+       * @return the number of iterations, negative if not converged
+       */
+      int solve(method_enum method = newton, double tolerance = 1e-10,
+              int maxiter = 1000);
+      /**
+       * the dimensionless free energy of a state relative to the first one
+       */
+      double f(unsigned int state)const { return d_f[state] - d_f[0]; }
+      /**
+       * the asymptotic covariance matrix of the free energies
+       * (states x states, row-major)
+       */
+      const std::vector<double> & covariance();
+      /**
+       * the statistical error of @f$f_j - f_i@f$
+       */
+      double error(unsigned int i, unsigned int j);
+
+    private:
+      /**
+       * the objective function and (if not NULL) its gradient and Hessian
+       * (without the constant part); fills d_lse
+       */
+      double objective(const std::vector<double> &f, std::vector<double> *grad,
+              std::vector<double> *hess);
+      /**
+       * the free energies of the states without samples
+       */
+      void unsampled();
+      /**
+       * the pseudo inverse of a symmetric matrix
+       */
+      static void pseudo_inverse(std::vector<double> &a, unsigned int n);
+
+      unsigned int d_states;
+      std::vector<unsigned int> d_n;
+      std::vector<double> d_lnn;
+      // the reduced potentials (sample-major) and the states of the samples
+      std::vector<double> d_u;
+      std::vector<unsigned int> d_from;
+      std::vector<double> d_f;
+      // ln sum_k N_k exp(f_k - u_k(x_n)) per sample
+      std::vector<double> d_lse;
+      std::vector<double> d_theta;
+      bool d_solved, d_theta_done;
+    };
+}
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_MBAR.t.cc
+
+// harmonic oscillators with known free energies: compares Newton and
+// L-BFGS with the analytical result (also for a state without samples)
+// and the asymptotic error with the spread over independent repeats
+
+#include "MBAR.h"
+#include "../gromos/Exception.h"
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using gmath::MBAR;
+
+using namespace std;
+
+double gaussian() {
+  const double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+  const double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+int main() {
+  try {
+    srand(4711);
+    // force constants and minima, the last state is not sampled
+    const unsigned int states = 4;
+    const double kappa[] = {1.0, 2.0, 4.0, 3.0};
+    const double mu[] = {0.0, 0.5, 1.0, 0.25};
+    const unsigned int samples[] = {300, 400, 500, 0};
+    const unsigned int repeats = 40;
+
+    vector<double> mean(states, 0.0), mean2(states, 0.0), err(states, 0.0);
+    for (unsigned int r = 0; r < repeats; ++r) {
+      MBAR mbar(states);
+      for (unsigned int s = 0; s < states; ++s) {
+        for (unsigned int n = 0; n < samples[s]; ++n) {
+          const double x = mu[s] + gaussian() / sqrt(kappa[s]);
+          double u[states];
+          for (unsigned int k = 0; k < states; ++k)
+            u[k] = 0.5 * kappa[k] * (x - mu[k]) * (x - mu[k]);
+          mbar.add(s, u);
+        }
+      }
+      assert(mbar.samples() == 1200 && mbar.samples(3) == 0);
+
+      const int it_newton = mbar.solve(MBAR::newton);
+      assert(it_newton > 0);
+      vector<double> f(states);
+      for (unsigned int k = 0; k < states; ++k)
+        f[k] = mbar.f(k);
+      const int it_lbfgs = mbar.solve(MBAR::lbfgs);
+      assert(it_lbfgs > 0);
+      for (unsigned int k = 0; k < states; ++k) {
+        assert(fabs(mbar.f(k) - f[k]) < 1e-7);
+        mean[k] += f[k];
+        mean2[k] += f[k] * f[k];
+        err[k] += mbar.error(0, k);
+      }
+      assert(mbar.error(0, 0) == 0.0);
+      if (r == 0)
+        cout << "iterations: newton " << it_newton << " lbfgs " << it_lbfgs
+              << endl;
+    }
+
+    for (unsigned int k = 1; k < states; ++k) {
+      mean[k] /= repeats;
+      const double sd = sqrt(mean2[k] / repeats - mean[k] * mean[k]);
+      err[k] /= repeats;
+      const double exact = 0.5 * log(kappa[k] / kappa[0]);
+      cout << "state " << k << ": f " << mean[k] << " exact " << exact
+              << " spread " << sd << " error " << err[k] << endl;
+      assert(fabs(mean[k] - exact) < 4.0 * sd / sqrt(double(repeats)) + 1e-3);
+      assert(err[k] > 0.6 * sd && err[k] < 1.6 * sd);
+    }
+
+    // no free energies yet
+    MBAR empty(2);
+    try {
+      empty.solve();
+      assert(false);
+    } catch (const gromos::Exception &e) {
+    }
+    return 0;
+  } catch (const gromos::Exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+}
@@ -0,0 +1,168 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_MSD.cc
+
+#include "MSD.h"
+#include "../gromos/Exception.h"
+#include <gsl/gsl_fft_real.h>
+#include <gsl/gsl_fft_halfcomplex.h>
+#include <algorithm>
+#include <vector>
+
+#ifdef OMP
+#include <omp.h>
+#endif
+
+namespace gmath
+{
+  MSD::MSD(unsigned int num, unsigned int maxlag) : d_num(num),
+  d_maxlag(maxlag), d_frames(0), d_start(0) {
+    if (num == 0)
+      throw gromos::Exception("MSD", "No particles given!");
+    for (int i = 0; i < 3; ++i) d_dim.push_back(i);
+  }
+
+  void MSD::setDimensions(const std::vector<int> &dim) {
+    for (unsigned int i = 0; i < dim.size(); ++i) {
+      if (dim[i] < 0 || dim[i] > 2)
+        throw gromos::Exception("MSD", "Dimensions have to be 0, 1 or 2!");
+    }
+    d_dim = dim;
+  }
+
+  void MSD::add(const std::vector<gmath::Vec> &pos) {
+    if (pos.size() != d_num)
+      throw gromos::Exception("MSD", "Number of positions does not match "
+            "the number of particles!");
+    d_pos.insert(d_pos.end(), pos.begin(), pos.end());
+    ++d_frames;
+
+    // a block of maxlag new frames is complete, pair it with the old one
+    if (d_maxlag && d_pos.size() == (d_start + d_maxlag) * d_num) {
+      block(d_start + d_maxlag, d_start, d_sum, d_count);
+      d_pos.erase(d_pos.begin(), d_pos.begin() + d_start * d_num);
+      d_start = d_maxlag;
+    }
+  }
+
+  std::vector<double> MSD::msd()const {
+    std::vector<double> sum(d_sum), count(d_count);
+    // the frames which were not analysed yet
+    const unsigned int w = d_pos.size() / d_num;
+    if (w > d_start)
+      block(w, d_start, sum, count);
+
+    std::vector<double> res;
+    for (unsigned int m = 0; m < count.size() && count[m] > 0; ++m)
+      res.push_back(sum[m] / count[m] / d_num);
+    return res;
+  }
+
+  void MSD::block(unsigned int w, unsigned int s, std::vector<double> &sum,
+          std::vector<double> &count)const {
+    // the displacements x(j) - x(j-m) for the frames j >= s of the window of 
+    // w frames, and the lags m up to lmax
+    unsigned int lmax = w - 1;
+    if (d_maxlag && lmax > d_maxlag) lmax = d_maxlag;
+    if (sum.size() < lmax + 1) {
+      sum.resize(lmax + 1, 0.0);
+      count.resize(lmax + 1, 0.0);
+    }
+    for (unsigned int m = 0; m <= lmax; ++m)
+      count[m] += w - std::max(s, m);
+
+    // zero filling, such that the correlation does not wrap around
+    unsigned int n = 2;
+    while (n < w + lmax) n *= 2;
+    gsl_fft_real_wavetable *real = gsl_fft_real_wavetable_alloc(n);
+    gsl_fft_halfcomplex_wavetable *hc = gsl_fft_halfcomplex_wavetable_alloc(n);
+
+    int numThreads = 1;
+#ifdef OMP
+    numThreads = omp_get_max_threads();
+#endif
+    std::vector<std::vector<double> > thread_sum(numThreads);
+    const int num = d_num;
+
+#ifdef OMP
+#pragma omp parallel
+#endif
+    {
+      int t = 0;
+#ifdef OMP
+      t = omp_get_thread_num();
+#endif
+      std::vector<double> &my_sum = thread_sum[t];
+      my_sum.assign(lmax + 1, 0.0);
+      gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(n);
+      std::vector<double> x(w), sq(w + 1), a(n), b(n);
+
+#ifdef OMP
+#pragma omp for schedule(dynamic, 8)
+#endif
+      for (int p = 0; p < num; ++p) {
+        for (unsigned int d = 0; d < d_dim.size(); ++d) {
+          const int dim = d_dim[d];
+          // relative to the first frame, the sums of squares stay small
+          const double x0 = d_pos[p][dim];
+          sq[0] = 0.0;
+          for (unsigned int k = 0; k < w; ++k) {
+            x[k] = d_pos[k * num + p][dim] - x0;
+            sq[k + 1] = sq[k] + x[k] * x[k];
+          }
+
+          // the correlation sum_k x(k) x(k+m) for k+m >= s
+          std::fill(a.begin(), a.end(), 0.0);
+          std::fill(b.begin(), b.end(), 0.0);
+          std::copy(x.begin(), x.end(), a.begin());
+          std::copy(x.begin() + s, x.end(), b.begin() + s);
+          gsl_fft_real_transform(&a[0], 1, n, real, work);
+          gsl_fft_real_transform(&b[0], 1, n, real, work);
+          // the product of the complex conjugate of a with b
+          a[0] = a[0] * b[0];
+          for (unsigned int i = 1; i + 1 < n; i += 2) {
+            const double re = a[i] * b[i] + a[i + 1] * b[i + 1];
+            const double im = a[i] * b[i + 1] - a[i + 1] * b[i];
+            a[i] = re;
+            a[i + 1] = im;
+          }
+          a[n - 1] = a[n - 1] * b[n - 1];
+          gsl_fft_halfcomplex_inverse(&a[0], 1, n, hc, work);
+
+          for (unsigned int m = 1; m <= lmax; ++m) {
+            const unsigned int j0 = std::max(s, m);
+            my_sum[m] += (sq[w] - sq[j0]) + (sq[w - m] - sq[j0 - m]) - 2.0 * a[m];
+          }
+        }
+      }
+      gsl_fft_real_workspace_free(work);
+    }
+
+    // sum the threads in a fixed order
+    for (int t = 0; t < numThreads; ++t) {
+      for (unsigned int m = 0; m < thread_sum[t].size(); ++m)
+        sum[m] += thread_sum[t][m];
+    }
+
+    gsl_fft_real_wavetable_free(real);
+    gsl_fft_halfcomplex_wavetable_free(hc);
+  }
+}
@@ -0,0 +1,101 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_MSD
+
+#ifndef INCLUDED_GMATH_MSD
+#define INCLUDED_GMATH_MSD
+
+#include <vector>
+#include "Vec.h"
+
+namespace gmath
+{
+  /**
+   * Class MSD
+   * A class to calculate the mean square displacement of a set of
+   * particles as a function of the lag time
+   *
+   * @f[ \Delta(m) = \frac{1}{N_p}\sum_{p=1}^{N_p}\frac{1}{N-m}
+   *     \sum_{k=0}^{N-m-1}[\vec{r_p}(k+m) - \vec{r_p}(k)]^2 @f]
+   *
+   * The frames are added one after the other (unwrapped positions). The sum
+   * over the time origins is split into the squares and the
+   * correlation function of every coordinate,
+   * @f$\sum(x_{k+m}^2 + x_k^2) - 2\sum x_k x_{k+m}@f$, where the first
+   * term follows from cumulative sums and the correlation function is
+   * calculated with the fast Fourier transform (GSL), so the effort
+   * grows with @f$N\log N@f$ instead of @f$N^2@f$. The particles are
+   * distributed over the OpenMP threads.
+   *
+   * Without a maximum lag all frames are kept and the displacements for 
+   * all lags are calculated in the end. With a maximum lag @f$L@f$, only 
+   * the last @f$2L@f$ frames are kept: every block of @f$L@f$ new frames
+   * is paired with the block before it, which gives the same result for
+   * the lags up to @f$L@f$.
+   *
+   * @class MSD
+   * @ingroup gmath
+   * @sa gmath::Correlation
+   */
+  class MSD
+    {
+      unsigned int d_num;
+      unsigned int d_maxlag;
+      std::vector<int> d_dim;
+      // the frames which are not analysed yet (frame-major)
+      std::vector<gmath::Vec> d_pos;
+      unsigned int d_frames;
+      // the number of frames in d_pos which were analysed already
+      unsigned int d_start;
+      std::vector<double> d_sum;
+      std::vector<double> d_count;
+      
+      void block(unsigned int w, unsigned int s, std::vector<double> &sum,
+              std::vector<double> &count)const;
+    public:
+      /**
+       * Constructor
+       * @param num the number of particles
+       * @param maxlag the maximum lag (in frames), 0 to keep all frames
+       */
+      MSD(unsigned int num, unsigned int maxlag = 0);
+      /**
+       * the dimensions (0, 1, 2 for x, y, z) to consider, default all three
+       */
+      void setDimensions(const std::vector<int> &dim);
+      /**
+       * add the positions of the particles in the next frame
+       */
+      void add(const std::vector<gmath::Vec> &pos);
+      /**
+       * the number of frames added
+       */
+      unsigned int frames()const { return d_frames; }
+      /**
+       * the mean square displacement (summed over the dimensions and 
+       * averaged over the particles), for the lags 0 to 
+       * min(maxlag, frames - 1)
+       */
+      std::vector<double> msd()const;
+    };
+}
+
+#endif
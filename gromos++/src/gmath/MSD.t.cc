@@ -0,0 +1,107 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_MSD.t.cc
+
+// compares the mean square displacements of random walks with a
+// direct double loop, for all lags and for maximum lags
+
+#include "MSD.h"
+#include "Vec.h"
+#include "../gromos/Exception.h"
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using gmath::MSD;
+using gmath::Vec;
+
+using namespace std;
+
+double random(double range) {
+  return range * (double(rand()) / RAND_MAX - 0.5);
+}
+
+// the mean square displacement in x and z by a double loop
+vector<double> direct(const vector<vector<Vec> > &pos, unsigned int maxlag) {
+  const unsigned int frames = pos.size(), num = pos[0].size();
+  vector<double> res;
+  for (unsigned int m = 0; m < frames && m <= maxlag; ++m) {
+    double sum = 0.0;
+    for (unsigned int j = 0; j + m < frames; ++j) {
+      for (unsigned int p = 0; p < num; ++p) {
+        const Vec d = pos[j + m][p] - pos[j][p];
+        sum += d[0] * d[0] + d[2] * d[2];
+      }
+    }
+    res.push_back(sum / (frames - m) / num);
+  }
+  return res;
+}
+
+int main() {
+  try {
+    srand(4711);
+    const unsigned int num = 20, frames = 333;
+    vector<vector<Vec> > pos(frames, vector<Vec>(num));
+    for (unsigned int p = 0; p < num; ++p)
+      pos[0][p] = Vec(random(50.0), random(50.0), random(50.0));
+    for (unsigned int f = 1; f < frames; ++f) {
+      for (unsigned int p = 0; p < num; ++p)
+        pos[f][p] = pos[f - 1][p] + Vec(random(0.1), random(0.1), random(0.1));
+    }
+    vector<int> dim;
+    dim.push_back(0);
+    dim.push_back(2);
+
+    const unsigned int maxlags[] = {0, 1, 7, 50, 166, 332, 400};
+    for (unsigned int l = 0; l < 7; ++l) {
+      MSD msd(num, maxlags[l]);
+      msd.setDimensions(dim);
+      for (unsigned int f = 0; f < frames; ++f) {
+        msd.add(pos[f]);
+        // also in the middle of a block
+        if (f == 100) {
+          const vector<double> part = msd.msd();
+          vector<vector<Vec> > first(pos.begin(), pos.begin() + 101);
+          const vector<double> ref = direct(first, maxlags[l] ? maxlags[l] : frames);
+          assert(part.size() == ref.size());
+          for (unsigned int m = 0; m < ref.size(); ++m)
+            assert(fabs(part[m] - ref[m]) < 1e-9 * (1.0 + ref[m]));
+        }
+      }
+      const vector<double> res = msd.msd();
+      const vector<double> ref = direct(pos, maxlags[l] ? maxlags[l] : frames);
+      assert(res.size() == ref.size());
+      double dev = 0.0;
+      for (unsigned int m = 0; m < ref.size(); ++m)
+        dev = max(dev, fabs(res[m] - ref[m]) / (1.0 + ref[m]));
+      cout << "maximum lag " << maxlags[l] << ": " << res.size() 
+              << " lags, largest deviation " << dev << endl;
+      assert(dev < 1e-9);
+    }
+    return 0;
+  } catch (const gromos::Exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+}
@@ -42,6 +42,45 @@ namespace gmath
   {
     return gmath::Vec(v1[0]/v2[0], v1[1]/v2[1], v1[2]/v2[2]);
   }
+
+  // the minimum, maximum and ln(sum exp(x)) without stored values
+  inline void stat_minmax(double &min, double &max, double v)
+  {
+    if (v < min) min = v;
+    if (v > max) max = v;
+  }
+
+  inline void stat_minmax(gmath::Vec &min, gmath::Vec &max, gmath::Vec const &v)
+  {
+    for (int i = 0; i < 3; ++i) {
+      if (v[i] < min[i]) min[i] = v[i];
+      if (v[i] > max[i]) max[i] = v[i];
+    }
+  }
+
+  inline void stat_lnexpadd(double &sum, double v)
+  {
+    // for numerical reasons follow B.A. Berg, Comput. Phys. Comm. 153 (2003) 397
+    sum = std::max(sum, v) + log(1.0 + exp(std::min(sum, v) - std::max(sum, v)));
+  }
+
+  inline void stat_lnexpadd(gmath::Vec &, gmath::Vec const &)
+  {
+  }
+
+  // map a value periodically into the distribution
+  inline double stat_periodic(double d, double lower, double upper)
+  {
+    const double period = upper - lower;
+    while (d >= upper) d -= period;
+    while (d < lower) d += period;
+    return d;
+  }
+
+  inline gmath::Vec stat_periodic(gmath::Vec const &v, double, double)
+  {
+    return v;
+  }
   
   template<typename T>
   Stat<T>::Stat()
@@ -54,25 +93,115 @@ namespace gmath
       d_msddone(false),
       d_eedone(false),
       d_distdone(false),
-      d_dist(0, 1, 1)
+      d_dist(0, 1, 1),
+      d_periodic(false),
+      d_lower(0),
+      d_upper(1),
+      d_store(true),
+      d_last(0),
+      d_shift(0),
+      d_mean(0),
+      d_m2(0),
+      d_min(0),
+      d_max(0),
+      d_lnexpsum(0),
+      d_base(0),
+      d_nbase(0)
   { 
   }
+
+  template<typename T>
+  void Stat<T>::setStore(bool store)
+  {
+    if (d_counter)
+      throw gromos::Exception("Stat", "Storing of the values has to be set "
+              "before the first value is added.");
+    d_store = store;
+  }
+
+  template<typename T>
+  void Stat<T>::needStore(const char *what)const
+  {
+    throw gromos::Exception("Stat", std::string(what) + " needs the values, "
+            "which are not stored.");
+  }
   
   template<typename T>
   void Stat<T>::addval(T val)
   {
-    d_vals.push_back(val);
+    if (d_store)
+      d_vals.push_back(val);
+    else
+      stream(val);
+    d_last = val;
     d_counter++;
     d_avedone=false;
     d_lnexpavedone=false;
     d_msddone=false;
     d_eedone = false;
-    if (d_distdone) d_dist.add(val);
+    if (d_distdone) {
+      if (d_periodic)
+        d_dist.add(stat_periodic(val, d_lower, d_upper));
+      else
+        d_dist.add(val);
+    }
+  }
+
+  template<typename T>
+  void Stat<T>::stream(T val)
+  {
+    if (d_counter == 0) {
+      // the blocks are summed relative to the first value
+      d_shift = val;
+      d_min = d_max = d_lnexpsum = val;
+    } else {
+      stat_minmax(d_min, d_max, val);
+      stat_lnexpadd(d_lnexpsum, val);
+    }
+    // Welford's update of the average and the sum of squared deviations
+    const T delta = val - d_mean;
+    d_mean += delta / double(d_counter + 1);
+    d_m2 += delta * (val - d_mean);
+
+    // the blocks of 2^k and of 3 * 2^k values
+    const T x = val - d_shift;
+    addblock(0, 0, x);
+    d_base += x;
+    if (++d_nbase == 3) {
+      addblock(1, 0, d_base / 3.0);
+      d_base = 0;
+      d_nbase = 0;
+    }
+  }
+
+  template<typename T>
+  void Stat<T>::addblock(int chain, unsigned int level, T ave)
+  {
+    // a block is complete: add its average and combine it with the 
+    // previous one to a block of the next level
+    while (true) {
+      if (d_block[chain].size() <= level)
+        d_block[chain].resize(level + 1);
+      Block &b = d_block[chain][level];
+      b.sum += ave;
+      b.ssum += ave * ave;
+      b.n++;
+      if (!b.full) {
+        b.pending = ave;
+        b.full = true;
+        return;
+      }
+      ave = (b.pending + ave) / 2.0;
+      b.full = false;
+      ++level;
+    }
   }
   
   template<typename T>
   T Stat<T>::ave()const
   {
+    if (!d_store)
+      return d_mean;
     if(!d_avedone){
       d_ave = this->subave(0,d_counter);
       d_avedone=1;
@@ -83,6 +212,7 @@ namespace gmath
   template<typename T>
   T Stat<T>::subave(int b, int e)const
   {
+    if (!d_store) needStore("subave");
     T ave = 0;
     
     //calculate the average
@@ -95,6 +225,8 @@ namespace gmath
   template<typename T>
   T Stat<T>::lnexpave()const
   {
+    if (!d_store)
+      return d_lnexpsum - log(double(d_counter));
     if(!d_lnexpavedone){
       d_lnexpave = this->lnexpsubave(0,d_counter);
       d_lnexpavedone=1;
@@ -105,6 +237,7 @@ namespace gmath
   template<typename T>
   T Stat<T>::lnexpsubave(int b, int e)const
   {
+    if (!d_store) needStore("lnexpsubave");
     T  lnexpave = d_vals[b];
 
     //calculate the average
@@ -119,6 +252,7 @@ namespace gmath
 
   template<typename T>
   T Stat<T>::lnXexpave(Stat<T> X, Stat<T> Y, int &sign) {
+    if (!X.d_store || !Y.d_store) X.needStore("lnXexpave");
     if (X.d_counter != Y.d_counter)
       throw gromos::Exception("Stat", "Can't calculate the ln|<Xexp[Y]>|. Unequal number of elements.");
     // calculate the average ln|<Xexp(Y)>|
@@ -171,6 +305,7 @@ namespace gmath
 
   template<typename T>
   T Stat<T>::covariance(Stat<T> X, Stat<T> Y) {
+    if (!X.d_store || !Y.d_store) X.needStore("covariance");
     if (X.d_counter != Y.d_counter)
       throw gromos::Exception("Stat", "Can't calculate the covariance. Unequal number of elements.");
     T sumX = 0, sumY = 0, ssum = 0;
@@ -189,6 +324,7 @@ namespace gmath
 
   template<typename T>
   T Stat<T>::lnexpcovariance(Stat<T> X, Stat<T> Y, int & sign) {
+    if (!X.d_store || !Y.d_store) X.needStore("lnexpcovariance");
     //ln{Cov(exp(X),exp(Y))}=ln{<exp(X)exp(Y)>-<exp(X)><exp(Y)>}
     // for numerical reasons follow B.A. Berg, Comput. Phys. Comm. 153 (2003) 397
     if (X.d_counter != Y.d_counter)
@@ -217,6 +353,8 @@ namespace gmath
   template<typename T>
   T Stat<T>::msd()const
   {
+    if (!d_store)
+      return d_m2 / double(d_counter);
     if(!d_msddone){
       T sum=0, ssum=0;
       for(int i=0; i<d_counter; i++){
@@ -239,6 +377,8 @@ namespace gmath
   template<typename T>
   T Stat<T>::min()const
   {
+    if (!d_store)
+      return d_min;
     T m=d_vals[0];
     for(int i=1; i<d_counter; ++i)
       if(d_vals[i] < m) m = d_vals[i];
@@ -248,6 +388,8 @@ namespace gmath
   template<typename T>
   T Stat<T>::max()const
   {
+    if (!d_store)
+      return d_max;
     T m = d_vals[0];
     for(int i=1; i<d_counter; ++i)
       if(d_vals[i] > m) m=d_vals[i];
@@ -258,56 +400,84 @@ namespace gmath
   T Stat<T>::ee()const
   {
     if(!d_eedone){
-      // first prepare the blocks
-      double blksz=50;
-      int old=2;
-      while(4*blksz<d_counter){
-	d_blocksize.push_back(int(blksz));
-	old=int(blksz);
-	while(old==int(blksz)) blksz = blksz*1.07177;
-      }
-      
-      int Nblocks=d_blocksize.size();
-      T rmsd2, ave=0;
+      std::vector<T> rmsd2;
+      d_blocksize.clear();
       T runave=this->ave();
-      T runrmsd=this->rmsd();
-      std::vector<T> fit(Nblocks), x(Nblocks);
-      
-      for(int j=0; j<Nblocks; j++){
-	int Nblcki=d_counter/d_blocksize[j];
-	
-	// The rmsd of the property we are interested in, weighted by the
-	// average energy of the blocks
-	rmsd2=0;
-	for(int i=0; i<Nblcki; i++){
-	  ave = this->subave(i*d_blocksize[j],(i+1)*d_blocksize[j]);
-	  rmsd2+=(ave-runave)*(ave-runave);
-	}
-	rmsd2/=Nblcki;
-	fit[j]=(d_blocksize[j]*rmsd2) / runrmsd / runrmsd;
-	x[j]=1.0/d_blocksize[j];
-	
-      }
-      T sx=0, sf=0,sfx=0,sxx=0;
-      for(int i=0; i<Nblocks;i++){
-	sx+=x[i];
-	sf+=fit[i];
-	sfx+=x[i]*fit[i];
-	sxx+=x[i]*x[i];
-      }
-      
-      T a, b;
-      a=(sf*sx/Nblocks-sfx)/(sx*sx/Nblocks-sxx);
-      b = (sf - a*sx)/Nblocks;
+      if (d_store) {
+        // first prepare the blocks
+        double blksz=50;
+        int old=2;
+        while(4*blksz<d_counter){
+          d_blocksize.push_back(int(blksz));
+          old=int(blksz);
+          while(old==int(blksz)) blksz = blksz*1.07177;
+        }
+
+        for(unsigned int j=0; j<d_blocksize.size(); j++){
+          int Nblcki=d_counter/d_blocksize[j];
 
-      d_ee=sqrt(b/d_counter)*runrmsd;
+          // The rmsd of the property we are interested in, weighted by the
+          // average energy of the blocks
+          T r=0;
+          for(int i=0; i<Nblcki; i++){
+            T ave = this->subave(i*d_blocksize[j],(i+1)*d_blocksize[j]);
+            r+=(ave-runave)*(ave-runave);
+          }
+          rmsd2.push_back(r/Nblcki);
+        }
+      } else {
+        // the same from the sums of the block averages, in the order
+        // of the block sizes 2^k and 3 * 2^k
+        const T a = runave - d_shift;
+        for (unsigned int level = 0; level < d_block[0].size(); ++level) {
+          for (int chain = 0; chain < 2; ++chain) {
+            if (level >= d_block[chain].size()) continue;
+            const int blksz = (chain ? 3 : 1) << level;
+            if (blksz < 32 || 4 * blksz >= d_counter) continue;
+            const Block &b = d_block[chain][level];
+            d_blocksize.push_back(blksz);
+            rmsd2.push_back((b.ssum - 2.0 * a * b.sum + double(b.n) * a * a) 
+                    / double(b.n));
+          }
+        }
+      }
+      d_ee = eefit(d_blocksize, rmsd2);
+      d_eedone = true;
     }
     
     return d_ee;
   }
 
+  template<typename T>
+  T Stat<T>::eefit(std::vector<int> const &blocksize, 
+          std::vector<T> const &rmsd2)const
+  {
+    int Nblocks=blocksize.size();
+    T runrmsd=this->rmsd();
+    std::vector<T> fit(Nblocks), x(Nblocks);
+
+    for(int j=0; j<Nblocks; j++){
+      fit[j]=(blocksize[j]*rmsd2[j]) / runrmsd / runrmsd;
+      x[j]=1.0/blocksize[j];
+    }
+    T sx=0, sf=0,sfx=0,sxx=0;
+    for(int i=0; i<Nblocks;i++){
+      sx+=x[i];
+      sf+=fit[i];
+      sfx+=x[i]*fit[i];
+      sxx+=x[i]*x[i];
+    }
+
+    T a, b;
+    a=(sf*sx/Nblocks-sfx)/(sx*sx/Nblocks-sxx);
+    b = (sf - a*sx)/Nblocks;
+
+    return sqrt(b/d_counter)*runrmsd;
+  }
+
   template<typename T>
   T Stat<T>::stat_ineff(Stat<T> X, Stat<T> Y) {
+    if (!X.d_store || !Y.d_store) X.needStore("stat_ineff");
     if (X.d_counter != Y.d_counter)
       throw gromos::Exception("Stat", "Can't calculate the statistical inefficiency. Unequal number of elements.");
     // Get the length of the timeseries
@@ -432,6 +602,7 @@ namespace gmath
 
   template<typename T>
   std::vector<T> const & Stat<T>::data() const{
+    if (!d_store) needStore("data");
     return d_vals;
   }
 
@@ -447,7 +618,13 @@ namespace gmath
   template<typename T>
   gmath::Distribution const & Stat<T>::dist_init(double lower, double upper, int nsteps, bool periodic)
   {
+    if (!d_store && d_counter)
+      throw gromos::Exception("Stat", "Without stored values, the "
+              "distribution has to be initialised before the first value.");
     d_dist = gmath::Distribution(lower, upper, nsteps);
+    d_periodic = periodic;
+    d_lower = lower;
+    d_upper = upper;
     //put all values in it
     for(int i=0; i<d_counter; i++) {
       double d = d_vals[i];
@@ -471,6 +648,7 @@ namespace gmath
   template<typename T>
   void Stat<T>::subtract_average()
   {
+    if (!d_store) needStore("subtract_average");
     double ave=this->ave();
     for(int i=0; i<d_counter; i++)
       d_vals[i]-=ave;
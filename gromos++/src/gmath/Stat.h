@@ -38,6 +38,14 @@ namespace gmath
    * This class allows one to store a series of numbers and calculate 
    * the average, rmsd and an error estimate
    *
+   * If the series itself is not needed, the values need not be stored
+   * (setStore). The average and mean square deviation are then updated
+   * with every value (Welford), the minimum and maximum are kept and the
+   * averages of blocks of 2^k and 3 * 2^k values are summed level by 
+   * level (Flyvbjerg and Petersen, J. Chem. Phys. 91 (1989) 461), so the
+   * memory does not grow with the number of values. The distribution
+   * has to be initialised with bounds before the first value then.
+   *
    * @class Stat
    * @author B.C. Oostenbrink
    * @ingroup gmath
@@ -51,6 +59,28 @@ namespace gmath
     mutable T d_ave, d_lnexpave, d_msd, d_ee;
     mutable bool d_avedone, d_lnexpavedone, d_msddone, d_eedone, d_distdone;
     gmath::Distribution d_dist;
+    bool d_periodic;
+    double d_lower, d_upper;
+    // the statistics without stored values
+    bool d_store;
+    T d_last, d_shift, d_mean, d_m2, d_min, d_max, d_lnexpsum;
+    /**
+     * the sums of the block averages for a block size
+     */
+    struct Block {
+      T pending, sum, ssum;
+      bool full;
+      int n;
+      Block() : pending(0), sum(0), ssum(0), full(false), n(0) {}
+    };
+    // the levels of block sizes 2^k and 3 * 2^k
+    std::vector<Block> d_block[2];
+    T d_base;
+    int d_nbase;
+    void stream(T val);
+    void addblock(int chain, unsigned int level, T ave);
+    T eefit(std::vector<int> const &blocksize, std::vector<T> const &rmsd2)const;
+    void needStore(const char *what)const;
       
   public:
     /**
@@ -61,6 +91,16 @@ namespace gmath
      * Stat destructor
      */
     ~Stat(){}
+    /**
+     * Keep the values (default) or only what is needed for the average,
+     * rmsd, minimum, maximum, error estimate and distribution. Has to be
+     * set before the first value is added.
+     */
+    void setStore(bool store);
+    /**
+     * whether the values are stored
+     */
+    bool store()const { return d_store; }
     /**
      * Method to add another value to the series
      * @param val the value to add
@@ -136,7 +176,8 @@ namespace gmath
      * Tildesley. The series is devided into blocks, for which the average
      * is calculated. The rmsd of these averages is then calculated for 
      * different block sizes. An extrapolation to infinite block size then 
-     * gives the error estimate.
+     * gives the error estimate. Without stored values, the block sizes
+     * are 2^k and 3 * 2^k, starting from 32.
      * @return The error estimate
      */
     T ee()const;
@@ -159,6 +200,10 @@ namespace gmath
      * @return the value that was stored
      */
     T val(int i);
+    /**
+     * Accessor that returns the value added last
+     */
+    T last()const;
     /**
      * Accessor to return the number of elements that have been stored 
      * so far
@@ -220,8 +265,15 @@ namespace gmath
   template<typename T>
   inline T Stat<T>::val(int i)
   {
+    if (!d_store) needStore("val");
     return d_vals[i];
   }
+
+  template<typename T>
+  inline T Stat<T>::last()const
+  {
+    return d_last;
+  }
   
   template<typename T>
   inline int Stat<T>::n()const
@@ -0,0 +1,95 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_Stat.t.cc
+
+// compares the statistics with and without stored values for a
+// correlated series
+
+#include "Stat.h"
+#include "Vec.h"
+#include "../gromos/Exception.h"
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using gmath::Stat;
+using gmath::Vec;
+
+using namespace std;
+
+bool close(double a, double b, double eps) {
+  return fabs(a - b) <= eps * (1.0 + fabs(a));
+}
+
+int main() {
+  try {
+    srand(1234);
+    const int sizes[] = {300, 5000, 100000};
+    for (int s = 0; s < 3; ++s) {
+      Stat<double> stored, streamed;
+      streamed.setStore(false);
+      stored.dist_init(-3.0, 3.0, 30);
+      streamed.dist_init(-3.0, 3.0, 30);
+      // a correlated series, with an offset
+      double x = 0.0;
+      for (int i = 0; i < sizes[s]; ++i) {
+        x = 0.9 * x + double(rand()) / RAND_MAX - 0.5;
+        stored.addval(1000.0 + x);
+        streamed.addval(1000.0 + x);
+      }
+      assert(close(stored.ave(), streamed.ave(), 1e-12));
+      assert(close(stored.rmsd(), streamed.rmsd(), 1e-8));
+      assert(stored.min() == streamed.min() && stored.max() == streamed.max());
+      assert(stored.last() == streamed.last());
+      assert(close(stored.lnexpave(), streamed.lnexpave(), 1e-12));
+      // the error estimates use different block sizes, they agree for
+      // long series
+      if (sizes[s] > 1000)
+        assert(fabs(stored.ee() - streamed.ee()) < 0.25 * stored.ee());
+      cout << sizes[s] << " values: average " << streamed.ave() 
+              << " rmsd " << streamed.rmsd() << " error estimate "
+              << stored.ee() << " (stored) " << streamed.ee() 
+              << " (not stored)" << endl;
+      for (int i = 0; i < 30; ++i)
+        assert(stored.distribution()[i] == streamed.distribution()[i]);
+    }
+
+    Stat<Vec> v;
+    v.setStore(false);
+    v.addval(Vec(1.0, 2.0, 3.0));
+    v.addval(Vec(3.0, 2.0, 1.0));
+    assert(v.ave()[0] == 2.0 && v.rmsd()[0] == 1.0 && v.rmsd()[1] == 0.0);
+
+    // the values are not available
+    bool thrown = false;
+    try {
+      v.data();
+    } catch (const gromos::Exception &e) {
+      thrown = true;
+    }
+    assert(thrown);
+    return 0;
+  } catch (const gromos::Exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+}
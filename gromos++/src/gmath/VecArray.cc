@@ -0,0 +1,103 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_VecArray.cc
+
+#include <cstdlib>
+#include <new>
+#include <stdint.h>
+
+#include "VecArray.h"
+
+// the interleaved data() view relies on Vec being three plain doubles
+static_assert(sizeof(gmath::Vec) == 3 * sizeof(double),
+        "gmath::Vec has to consist of three doubles");
+
+gmath::VecArray::VecArray(int n) :
+d_data(NULL), d_block(NULL), d_size(0), d_capacity(0) {
+  resize(n);
+}
+
+gmath::VecArray::VecArray(const VecArray &v) :
+d_data(NULL), d_block(NULL), d_size(0), d_capacity(0) {
+  *this = v;
+}
+
+gmath::VecArray::~VecArray() {
+  for (int i = 0; i < d_capacity; ++i)
+    d_data[i].~Vec();
+  std::free(d_block);
+}
+
+gmath::VecArray &gmath::VecArray::operator=(const VecArray &v) {
+  if (this != &v) {
+    reserve(v.d_size);
+    for (int i = 0; i < v.d_size; ++i)
+      d_data[i] = v.d_data[i];
+    d_size = v.d_size;
+  }
+  return *this;
+}
+
+void gmath::VecArray::resize(int n) {
+  assert(n >= 0);
+  reserve(n);
+  for (int i = d_size; i < n; ++i)
+    d_data[i] = Vec(0.0, 0.0, 0.0);
+  d_size = n;
+}
+
+void gmath::VecArray::reserve(int n) {
+  if (n <= d_capacity) return;
+
+  void *block = std::malloc(n * sizeof (Vec) + alignment);
+  if (block == NULL) throw std::bad_alloc();
+  uintptr_t addr = reinterpret_cast<uintptr_t> (block);
+  addr = (addr + alignment - 1) & ~uintptr_t(alignment - 1);
+  Vec *data = reinterpret_cast<Vec *> (addr);
+
+  for (int i = 0; i < n; ++i)
+    new (data + i) Vec(i < d_size ? d_data[i] : Vec());
+  for (int i = 0; i < d_capacity; ++i)
+    d_data[i].~Vec();
+  std::free(d_block);
+
+  d_block = block;
+  d_data = data;
+  d_capacity = n;
+}
+
+void gmath::VecArray::getSoA(double *x, double *y, double *z)const {
+  const double *p = data();
+  for (int i = 0; i < d_size; ++i) {
+    x[i] = p[3 * i];
+    y[i] = p[3 * i + 1];
+    z[i] = p[3 * i + 2];
+  }
+}
+
+void gmath::VecArray::setSoA(const double *x, const double *y, const double *z) {
+  double *p = data();
+  for (int i = 0; i < d_size; ++i) {
+    p[3 * i] = x[i];
+    p[3 * i + 1] = y[i];
+    p[3 * i + 2] = z[i];
+  }
+}
@@ -0,0 +1,173 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_VecArray.h
+
+#ifndef INCLUDED_GMATH_VECARRAY
+#define INCLUDED_GMATH_VECARRAY
+
+#include <cassert>
+
+#include "Vec.h"
+
+namespace gmath{
+  /**
+   * Class VecArray
+   * a contiguous, cache line aligned array of gmath::Vec
+   *
+   * The coordinates of atom i are stored at data()[3*i], data()[3*i+1] and
+   * data()[3*i+2], so kernels can loop over the raw doubles of all atoms.
+   * Shrinking the array (resize() or clear()) keeps the memory, such that
+   * refilling it with the same number of atoms, e.g. when reading the next
+   * frame of a trajectory, does not allocate.
+   *
+   * References to elements stay valid until the array has to grow beyond
+   * its capacity().
+   *
+   * @class VecArray
+   * @ingroup gmath
+   * @sa gmath::Vec
+   */
+  class VecArray{
+    Vec *d_data;
+    void *d_block;
+    int d_size;
+    int d_capacity;
+
+  public:
+    /**
+     * alignment of the first element in bytes
+     */
+    static const int alignment = 64;
+    /**
+     * VecArray constructor
+     * @param n number of (zero) vectors
+     */
+    VecArray(int n = 0);
+    /**
+     * VecArray copy constructor
+     */
+    VecArray(const VecArray &v);
+    /**
+     * VecArray deconstructor
+     */
+    ~VecArray();
+    /**
+     * copies the elements of another VecArray
+     */
+    VecArray &operator=(const VecArray &v);
+    /**
+     * Accessor, returns the i-th vector
+     */
+    Vec &operator[](int i);
+    /**
+     * Accessor, returns the i-th vector as a const
+     */
+    const Vec &operator[](int i)const;
+    /**
+     * Accessor, returns the number of vectors
+     */
+    int size()const;
+    /**
+     * Accessor, returns the number of vectors that fit into the allocated
+     * memory
+     */
+    int capacity()const;
+    /**
+     * resizes the array, new vectors are set to zero. Memory is only
+     * released by the deconstructor.
+     */
+    void resize(int n);
+    /**
+     * makes sure that n vectors fit without reallocation
+     */
+    void reserve(int n);
+    /**
+     * sets the size to zero, keeping the memory
+     */
+    void clear();
+    /**
+     * appends a vector
+     */
+    void push_back(const Vec &v);
+    /**
+     * Accessor, returns the coordinates as 3 * size() interleaved
+     * doubles (x0, y0, z0, x1, ...)
+     */
+    double *data();
+    /**
+     * Accessor, returns the coordinates as 3 * size() interleaved
+     * doubles (x0, y0, z0, x1, ...) as a const
+     */
+    const double *data()const;
+    /**
+     * copies the coordinates to structure of arrays layout
+     * @param x, y, z arrays of at least size() doubles
+     */
+    void getSoA(double *x, double *y, double *z)const;
+    /**
+     * sets the coordinates from structure of arrays layout
+     * @param x, y, z arrays of at least size() doubles
+     */
+    void setSoA(const double *x, const double *y, const double *z);
+  };
+
+  inline Vec &VecArray::operator[](int i){
+    assert(i >= 0 && i < d_size);
+    return d_data[i];
+  }
+
+  inline const Vec &VecArray::operator[](int i)const{
+    assert(i >= 0 && i < d_size);
+    return d_data[i];
+  }
+
+  inline int VecArray::size()const{
+    return d_size;
+  }
+
+  inline int VecArray::capacity()const{
+    return d_capacity;
+  }
+
+  inline void VecArray::clear(){
+    d_size = 0;
+  }
+
+  inline void VecArray::push_back(const Vec &v){
+    if (d_size == d_capacity) {
+      // v may refer to an element of this array
+      const Vec tmp(v);
+      reserve(d_capacity ? 2 * d_capacity : 16);
+      d_data[d_size++] = tmp;
+    } else
+      d_data[d_size++] = v;
+  }
+
+  inline double *VecArray::data(){
+    return reinterpret_cast<double *>(d_data);
+  }
+
+  inline const double *VecArray::data()const{
+    return reinterpret_cast<const double *>(d_data);
+  }
+}
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// gmath_VecArray.t.cc
+
+#include <cassert>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <stdint.h>
+#include <vector>
+
+#include "Vec.h"
+#include "VecArray.h"
+
+using gmath::Vec;
+using gmath::VecArray;
+using namespace std;
+
+int main() {
+  VecArray a;
+  assert(a.size() == 0);
+  for (int i = 0; i < 100; ++i)
+    a.push_back(Vec(i, 2 * i, 3 * i));
+  assert(a.size() == 100 && a.capacity() >= 100);
+  assert(reinterpret_cast<uintptr_t>(a.data()) % VecArray::alignment == 0);
+
+  // interleaved layout
+  const double *d = a.data();
+  for (int i = 0; i < 100; ++i) {
+    assert(&a[i][0] == d + 3 * i);
+    assert(d[3 * i] == i && d[3 * i + 1] == 2 * i && d[3 * i + 2] == 3 * i);
+  }
+
+  // appending an element of the array itself while growing
+  a.resize(a.capacity());
+  a[0] = Vec(7, 8, 9);
+  a.push_back(a[0]);
+  assert(a[a.size() - 1][2] == 9);
+
+  // shrinking keeps the memory and references
+  const int cap = a.capacity();
+  Vec *first = &a[0];
+  a.clear();
+  for (int i = 0; i < 100; ++i)
+    a.push_back(Vec(i, 0, 0));
+  assert(a.capacity() == cap && &a[0] == first);
+
+  // growing sets zeros
+  a.resize(50);
+  a.resize(60);
+  assert(a[55][0] == 0 && a[49][0] == 49);
+
+  // structure of arrays
+  vector<double> x(a.size()), y(a.size()), z(a.size());
+  a.getSoA(&x[0], &y[0], &z[0]);
+  for (int i = 0; i < a.size(); ++i) {
+    assert(x[i] == a[i][0]);
+    y[i] = -x[i];
+  }
+  a.setSoA(&x[0], &y[0], &z[0]);
+  assert(a[10][1] == -10);
+
+  VecArray b(a);
+  b[1] = Vec(1, 1, 1);
+  assert(b.size() == a.size() && a[1][1] == -1);
+  a = b;
+  assert(a[1][1] == 1);
+
+  // refilling a large solvent, as done for every frame of a trajectory
+  const int n = 1000000, frames = 10;
+  clock_t t0 = clock();
+  vector<Vec *> p;
+  for (int f = 0; f < frames; ++f) {
+    for (unsigned int i = 0; i < p.size(); ++i) delete p[i];
+    p.resize(0);
+    for (int i = 0; i < n; ++i) p.push_back(new Vec(i, f, 0));
+  }
+  double sum0 = 0.0;
+  for (int i = 0; i < n; ++i) sum0 += (*p[i])[0];
+  for (unsigned int i = 0; i < p.size(); ++i) delete p[i];
+  clock_t t1 = clock();
+  VecArray c;
+  for (int f = 0; f < frames; ++f) {
+    c.clear();
+    for (int i = 0; i < n; ++i) c.push_back(Vec(i, f, 0));
+  }
+  double sum1 = 0.0;
+  for (int i = 0; i < n; ++i) sum1 += c[i][0];
+  clock_t t2 = clock();
+  assert(sum0 == sum1);
+
+  cout << "refilling " << n << " atoms " << frames << " times:\n"
+          << "  vector<Vec *> : " << double(t1 - t0) / CLOCKS_PER_SEC << " s\n"
+          << "  VecArray      : " << double(t2 - t1) / CLOCKS_PER_SEC << " s\n";
+
+  return 0;
+}
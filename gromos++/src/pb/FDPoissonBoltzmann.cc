@@ -39,6 +39,11 @@
 
 #include "FDPoissonBoltzmann_ICCG_PBC.h"
 #include "FDPoissonBoltzmann_ICCG_NPBC.h"
+#include "FDPoissonBoltzmann_MG.h"
+
+#ifdef OMP
+#include <omp.h>
+#endif
 
 using pb::FDPoissonBoltzmann;
 using pb::PB_Parameters;
@@ -537,6 +542,122 @@ bool FDPoissonBoltzmann::solveforpotential_npbc(int maxits, double acceptance, F
 
 
 
+bool FDPoissonBoltzmann::solveforpotential_mg(int maxits, double acceptance, FDPoissonBoltzmann_MG &mg, bool cg, ofstream &os){
+  // solve A phi = rho as in solveforpotential_pbc/_npbc, but with
+  // multigrid V-cycles on the permittivity grids, either as preconditioner
+  // of the conjugate gradient iteration (cg) or as stationary iteration
+  // phi += alpha V(rho - A phi) with a minimal residual step alpha.
+  // As there, rhogrid holds the residual afterwards.
+
+  bool converged = false;
+  std::vector<double> zvec(GPXGPYGPZ, 0.0);
+  std::vector<double> pvec(GPXGPYGPZ, 0.0);
+  std::vector<double> qvec(GPXGPYGPZ, 0.0);
+
+  mg.setup(epsCgrid, epsIgrid, epsJgrid, epsKgrid);
+  os << "# multigrid levels " << mg.levels() << endl;
+
+  double znorm = 0.0;
+#ifdef OMP
+#pragma omp parallel for reduction(+:znorm)
+#endif
+  for (int i=0; i < GPXGPYGPZ; ++i) znorm += fabs(rhogrid[i]);
+  os << "# @ ZNORM "  << znorm << endl;
+
+  // initial residual
+  mg.gqact(zvec, phigrid);
+  double anorm = 0.0;
+#ifdef OMP
+#pragma omp parallel for reduction(+:anorm)
+#endif
+  for (int i=0; i < GPXGPYGPZ; ++i) {
+    rhogrid[i] -= zvec[i];
+    anorm += fabs(rhogrid[i]);
+  }
+
+  double rdotz1 = 0.0;
+  int iter = 1;
+  while (true) {
+    //check for convergence
+    if (anorm <= acceptance * znorm) {
+      os << "# iter anorm acceptance*znorm " << iter << " " << anorm << " " << acceptance*znorm << endl;
+      os << "# CONVERGED AFTER " << iter << " iterations..." << endl;
+      os << "# Exit: solveforpotential()" << endl;
+      converged = true;
+      break;
+    }
+    else if (iter == maxits) {
+      os << "# NO CONVERGENCE AFTER " << iter << " iterations..." << endl;
+      os << "# RESULTS MAY NOT BE CORRECT!" << endl;
+      os << "# Iterations "  << iter << endl;
+      os << "# anorm " << anorm << endl;
+      os << "# acceptance * znorm " << (acceptance*znorm) << endl;
+      os << "# Exit: solveforpotential()" << endl;
+      break;
+    }
+    ++iter;
+
+    // Z = M^-1 R
+    mg.vcycle(zvec, rhogrid);
+
+    if (cg) {
+      double rdotz2 = 0.0;
+#ifdef OMP
+#pragma omp parallel for reduction(+:rdotz2)
+#endif
+      for (int i=0; i < GPXGPYGPZ; ++i) rdotz2 += rhogrid[i] * zvec[i];
+      const double bbeta = (iter == 2) ? 0.0 : rdotz2 / rdotz1;
+      rdotz1 = rdotz2;
+#ifdef OMP
+#pragma omp parallel for
+#endif
+      for (int i=0; i < GPXGPYGPZ; ++i) pvec[i] = bbeta * pvec[i] + zvec[i];
+    } else {
+      pvec.swap(zvec);
+    }
+
+    // Q = A * P
+    mg.gqact(qvec, pvec);
+    double aalpha;
+    if (cg) {
+      double pdotq = 0.0;
+#ifdef OMP
+#pragma omp parallel for reduction(+:pdotq)
+#endif
+      for (int i=0; i < GPXGPYGPZ; ++i) pdotq += pvec[i] * qvec[i];
+      aalpha = rdotz1 / pdotq;
+    } else {
+      // minimal residual step: the coarse grid operators are not Galerkin
+      // products, so the plain correction may overshoot across large
+      // permittivity jumps on fine grids
+      double rdotq = 0.0, qdotq = 0.0;
+#ifdef OMP
+#pragma omp parallel for reduction(+:rdotq,qdotq)
+#endif
+      for (int i=0; i < GPXGPYGPZ; ++i) {
+        rdotq += rhogrid[i] * qvec[i];
+        qdotq += qvec[i] * qvec[i];
+      }
+      aalpha = (qdotq > 0.0) ? rdotq / qdotq : 0.0;
+    }
+
+    anorm = 0.0;
+#ifdef OMP
+#pragma omp parallel for reduction(+:anorm)
+#endif
+    for (int i=0; i < GPXGPYGPZ; ++i) {
+      phigrid[i] += aalpha * pvec[i];
+      rhogrid[i] -= aalpha * qvec[i];
+      anorm += fabs(rhogrid[i]);
+    }
+
+    if (iter%10 == 0)
+      os << "#iteration: " << iter << " anorm " << anorm << endl;
+  }
+  return converged;
+}
+
+
 double FDPoissonBoltzmann::dGelec(ofstream &os, vector<double> *potentials){
 
   double potential_rest = 0;
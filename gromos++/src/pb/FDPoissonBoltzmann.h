@@ -29,6 +29,9 @@
 #ifndef INCLUDED_PB_FDPoissonBoltzmann_ICCG_NPBC
 #include "FDPoissonBoltzmann_ICCG_NPBC.h"
 #endif
+#ifndef INCLUDED_PB_FDPoissonBoltzmann_MG
+#include "FDPoissonBoltzmann_MG.h"
+#endif
 #ifndef INCLUDED_PB_PB_Parameters
 #include "PB_Parameters.h"
 #endif
@@ -132,6 +135,9 @@ class FDPoissonBoltzmann{
   void getgridstart(double& X, double& Y, double& Z);
   bool solveforpotential_pbc(int maxits, double acceptance,FDPoissonBoltzmann_ICCG_PBC iccg, ofstream &os);
   bool solveforpotential_npbc(int maxits, double acceptance,FDPoissonBoltzmann_ICCG_NPBC iccg, ofstream &os);
+  // multigrid (pbc or npbc, as given to mg): V-cycles as CG preconditioner
+  // (cg = true) or on their own
+  bool solveforpotential_mg(int maxits, double acceptance, FDPoissonBoltzmann_MG &mg, bool cg, ofstream &os);
   double dGelec(ofstream &os, vector<double> *potentials=NULL);
   double getdG();
   double getdG_restricted(ofstream &os, vector<double> *potentials=NULL);
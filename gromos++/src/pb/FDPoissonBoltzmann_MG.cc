@@ -0,0 +1,482 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// pb_FDPoissonBoltzmann_MG.cc
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "../gromos/Exception.h"
+
+#include "FDPoissonBoltzmann_MG.h"
+
+#ifdef OMP
+#include <omp.h>
+#endif
+
+using pb::FDPoissonBoltzmann_MG;
+
+namespace {
+
+  // the neighbours of the grid points (i,j,k) of a row (j,k)
+  struct Row {
+    int nx;
+    bool pbc;
+    const double *ex, *x;
+    // faces to and values of the rows j-1, j+1, k-1 and k+1 (NULL if none)
+    const double *eym, *xym, *eyp, *xyp;
+    const double *ezm, *xzm, *ezp, *xzp;
+
+    // sum over the neighbours weighted with the permittivities
+    inline double sum(int i)const {
+      double s = 0.0;
+      if (i > 0) s += ex[i - 1] * x[i - 1];
+      else if (pbc) s += ex[nx - 1] * x[nx - 1];
+      if (i < nx - 1) s += ex[i] * x[i + 1];
+      else if (pbc) s += ex[i] * x[0];
+      if (xym) s += eym[i] * xym[i];
+      if (xyp) s += eyp[i] * xyp[i];
+      if (xzm) s += ezm[i] * xzm[i];
+      if (xzp) s += ezp[i] * xzp[i];
+      return s;
+    }
+  };
+
+  Row make_row(int nx, int ny, int nz, bool pbc, const double *ex,
+	       const double *ey, const double *ez, const double *x, int j, int k) {
+    const int nxny = nx * ny;
+    const int row = k * nxny + j * nx;
+    Row r;
+    r.nx = nx;
+    r.pbc = pbc;
+    r.ex = ex + row;
+    r.x = x + row;
+    r.eym = r.xym = r.eyp = r.xyp = NULL;
+    r.ezm = r.xzm = r.ezp = r.xzp = NULL;
+    if (j > 0 || pbc) {
+      const int jm = k * nxny + ((j + ny - 1) % ny) * nx;
+      r.eym = ey + jm;
+      r.xym = x + jm;
+    }
+    if (j < ny - 1 || pbc) {
+      r.eyp = ey + row;
+      r.xyp = x + k * nxny + ((j + 1) % ny) * nx;
+    }
+    if (k > 0 || pbc) {
+      const int km = ((k + nz - 1) % nz) * nxny + j * nx;
+      r.ezm = ez + km;
+      r.xzm = x + km;
+    }
+    if (k < nz - 1 || pbc) {
+      r.ezp = ez + row;
+      r.xzp = x + ((k + 1) % nz) * nxny + j * nx;
+    }
+    return r;
+  }
+
+  // size of the coarse grid
+  int coarse_size(int n, bool pbc) {
+    return pbc ? (n + 1) / 2 : n / 2 + 1;
+  }
+
+  // the fine grid point of a coarse grid point
+  int fine_point(int I, int n) {
+    return std::min(2 * I, n - 1);
+  }
+
+  // trilinear interpolation along one axis: every fine grid point gets
+  // the values of the coarse points lo and hi (the same for coinciding 
+  // points), each with weight 0.5
+  void interpolation(int n, bool pbc, std::vector<int> &lo, std::vector<int> &hi) {
+    const int nc = coarse_size(n, pbc);
+    lo.resize(n);
+    hi.resize(n);
+    for (int f = 0; f < n; ++f) {
+      if (f % 2 == 0) {
+	lo[f] = hi[f] = f / 2;
+      } else if (f == n - 1 && !pbc) {
+	lo[f] = hi[f] = nc - 1;
+      } else {
+	lo[f] = (f - 1) / 2;
+	hi[f] = ((f + 1) / 2) % nc;
+      }
+    }
+  }
+
+  // weight of coarse point I in fine point f
+  inline double weight(const std::vector<int> &lo, const std::vector<int> &hi,
+		       int f, int I) {
+    if (lo[f] == hi[f]) return lo[f] == I ? 1.0 : 0.0;
+    return (lo[f] == I ? 0.5 : 0.0) + (hi[f] == I ? 0.5 : 0.0);
+  }
+
+  // the fine points contributing to a coarse point along one axis
+  int candidates(int I, int n, bool pbc, int *f) {
+    const int c = fine_point(I, n);
+    int num = 0;
+    if (c > 0) f[num++] = c - 1;
+    else if (pbc) f[num++] = n - 1;
+    f[num++] = c;
+    if (c < n - 1) f[num++] = c + 1;
+    else if (pbc) f[num++] = 0;
+    return num;
+  }
+}
+
+FDPoissonBoltzmann_MG::FDPoissonBoltzmann_MG(int GPX, int GPY, int GPZ, bool pbc, int nsmooth){
+  this->GPX = GPX;
+  this->GPY = GPY;
+  this->GPZ = GPZ;
+  this->GPXGPYGPZ = GPX*GPY*GPZ;
+  this->pbc = pbc;
+  this->nsmooth = nsmooth;
+  epsC = epsI = epsJ = epsK = NULL;
+}
+
+FDPoissonBoltzmann_MG::Stencil FDPoissonBoltzmann_MG::stencil(int level)const{
+  Stencil s;
+  if (level == 0) {
+    s.nx = GPX;
+    s.ny = GPY;
+    s.nz = GPZ;
+    s.c = &(*epsC)[0];
+    s.ex = &(*epsI)[0];
+    s.ey = &(*epsJ)[0];
+    s.ez = &(*epsK)[0];
+  } else {
+    const Level &l = coarse[level - 1];
+    s.nx = l.nx;
+    s.ny = l.ny;
+    s.nz = l.nz;
+    s.c = &l.c[0];
+    s.ex = &l.ex[0];
+    s.ey = &l.ey[0];
+    s.ez = &l.ez[0];
+  }
+  return s;
+}
+
+void FDPoissonBoltzmann_MG::setup(const std::vector<double> &epsCgrid,
+        const std::vector<double> &epsIgrid,
+        const std::vector<double> &epsJgrid,
+        const std::vector<double> &epsKgrid){
+  if (int(epsCgrid.size()) != GPXGPYGPZ || int(epsIgrid.size()) != GPXGPYGPZ ||
+      int(epsJgrid.size()) != GPXGPYGPZ || int(epsKgrid.size()) != GPXGPYGPZ)
+    throw gromos::Exception("FDPoissonBoltzmann_MG", "grid sizes do not match");
+  epsC = &epsCgrid;
+  epsI = &epsIgrid;
+  epsJ = &epsJgrid;
+  epsK = &epsKgrid;
+  res.resize(GPXGPYGPZ);
+
+  // coarsen as long as all axes have at least 5 points
+  coarse.clear();
+  int nx = GPX, ny = GPY, nz = GPZ;
+  while (std::min(nx, std::min(ny, nz)) >= 5) {
+    nx = coarse_size(nx, pbc);
+    ny = coarse_size(ny, pbc);
+    nz = coarse_size(nz, pbc);
+    coarse.push_back(Level());
+    coarse.back().nx = nx;
+    coarse.back().ny = ny;
+    coarse.back().nz = nz;
+  }
+  for (unsigned int l = 0; l < coarse.size(); ++l)
+    coarsen(stencil(l), coarse[l]);
+}
+
+void FDPoissonBoltzmann_MG::coarsen(const Stencil &f, Level &C)const{
+  const int nx = C.nx, ny = C.ny, nz = C.nz;
+  const int n = nx * ny * nz;
+  C.c.assign(n, 0.0);
+  C.ex.assign(n, 0.0);
+  C.ey.assign(n, 0.0);
+  C.ez.assign(n, 0.0);
+  C.x.assign(n, 0.0);
+  C.b.assign(n, 0.0);
+  C.r.assign(n, 0.0);
+
+  const int fn[3] = {f.nx, f.ny, f.nz};
+  const int cn[3] = {nx, ny, nz};
+  const int stride[3] = {1, f.nx, f.nx * f.ny};
+  const double *face[3] = {f.ex, f.ey, f.ez};
+  std::vector<double> *cface[3] = {&C.ex, &C.ey, &C.ez};
+
+  // the couplings: series of the fine faces between two coarse points,
+  // averaged over the fine lines next to it
+  for (int d = 0; d < 3; ++d) {
+    const int d1 = (d + 1) % 3, d2 = (d + 2) % 3;
+#ifdef OMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int K = 0; K < nz; ++K) {
+      int I3[3], f3[3];
+      I3[2] = K;
+      for (int J = 0; J < ny; ++J) {
+	I3[1] = J;
+	for (int I = 0; I < nx; ++I) {
+	  I3[0] = I;
+	  const int Id = I3[d];
+	  // no coupling beyond the last point without periodicity
+	  if (Id == cn[d] - 1 && !pbc) continue;
+	  const int start = fine_point(Id, fn[d]);
+	  const int end = Id + 1 < cn[d] ? fine_point(Id + 1, fn[d]) : fn[d];
+	  double acc = 0.0, wsum = 0.0;
+	  for (int a = -1; a <= 1; ++a) {
+	    f3[d1] = fine_point(I3[d1], fn[d1]) + a;
+	    if (f3[d1] < 0 || f3[d1] >= fn[d1]) {
+	      if (!pbc) continue;
+	      f3[d1] = (f3[d1] + fn[d1]) % fn[d1];
+	    }
+	    for (int b = -1; b <= 1; ++b) {
+	      f3[d2] = fine_point(I3[d2], fn[d2]) + b;
+	      if (f3[d2] < 0 || f3[d2] >= fn[d2]) {
+		if (!pbc) continue;
+		f3[d2] = (f3[d2] + fn[d2]) % fn[d2];
+	      }
+	      const double w = (a ? 0.25 : 0.5) * (b ? 0.25 : 0.5);
+	      double inv = 0.0;
+	      bool open = true;
+	      for (int p = start; p < end; ++p) {
+		const double e = face[d][p * stride[d] + f3[d1] * stride[d1] + f3[d2] * stride[d2]];
+		if (e <= 0.0) {
+		  open = false;
+		  break;
+		}
+		inv += 1.0 / e;
+	      }
+	      if (open && inv > 0.0) acc += w / inv;
+	      wsum += w;
+	    }
+	  }
+	  (*cface[d])[(K * ny + J) * nx + I] = 2.0 * acc / wsum;
+	}
+      }
+    }
+  }
+
+  // the diagonal: the couplings plus the restricted remainder of the 
+  // fine diagonal (boundary and ionic terms), i.e. of A * 1
+  Stencil cs;
+  cs.nx = nx;
+  cs.ny = ny;
+  cs.nz = nz;
+  cs.c = &C.c[0];
+  cs.ex = &C.ex[0];
+  cs.ey = &C.ey[0];
+  cs.ez = &C.ez[0];
+  std::vector<double> ones(f.nx * f.ny * f.nz, 1.0), rest(f.nx * f.ny * f.nz);
+  apply(f, &ones[0], &rest[0]);
+  std::vector<double>().swap(ones);
+  std::vector<double> crest(n);
+  restriction(f, &rest[0], cs, &crest[0]);
+  for (int i = 0; i < n; ++i)
+    C.c[i] = std::max(crest[i], 0.0);
+  // the couplings of the coarse grid: A * 1 with a zero diagonal
+  cs.c = &C.b[0];
+  std::fill(C.x.begin(), C.x.end(), 1.0);
+  apply(cs, &C.x[0], &crest[0]);
+  for (int i = 0; i < n; ++i)
+    C.c[i] -= crest[i];
+  std::fill(C.x.begin(), C.x.end(), 0.0);
+}
+
+void FDPoissonBoltzmann_MG::apply(const Stencil &s, const double *x, double *z)const{
+#ifdef OMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int k = 0; k < s.nz; ++k) {
+    for (int j = 0; j < s.ny; ++j) {
+      const Row r = make_row(s.nx, s.ny, s.nz, pbc, s.ex, s.ey, s.ez, x, j, k);
+      const int row = (k * s.ny + j) * s.nx;
+      for (int i = 0; i < s.nx; ++i)
+	z[row + i] = s.c[row + i] * x[row + i] - r.sum(i);
+    }
+  }
+}
+
+void FDPoissonBoltzmann_MG::residual(const Stencil &s, const double *x, const double *b, double *r)const{
+#ifdef OMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int k = 0; k < s.nz; ++k) {
+    for (int j = 0; j < s.ny; ++j) {
+      const Row nb = make_row(s.nx, s.ny, s.nz, pbc, s.ex, s.ey, s.ez, x, j, k);
+      const int row = (k * s.ny + j) * s.nx;
+      for (int i = 0; i < s.nx; ++i)
+	r[row + i] = b[row + i] - s.c[row + i] * x[row + i] + nb.sum(i);
+    }
+  }
+}
+
+void FDPoissonBoltzmann_MG::smooth(const Stencil &s, double *x, const double *b, bool forward)const{
+  const bool redblack = !pbc || (s.nx % 2 == 0 && s.ny % 2 == 0 && s.nz % 2 == 0);
+  if (redblack) {
+    // the points of one colour only depend on the ones of the other colour
+    for (int pass = 0; pass < 2; ++pass) {
+      const int colour = forward ? pass : 1 - pass;
+#ifdef OMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (int k = 0; k < s.nz; ++k) {
+	for (int j = 0; j < s.ny; ++j) {
+	  const Row r = make_row(s.nx, s.ny, s.nz, pbc, s.ex, s.ey, s.ez, x, j, k);
+	  const int row = (k * s.ny + j) * s.nx;
+	  for (int i = (colour + j + k) & 1; i < s.nx; i += 2)
+	    x[row + i] = (b[row + i] + r.sum(i)) / s.c[row + i];
+	}
+      }
+    }
+  } else {
+    // periodic with an odd number of points: lexicographic
+    for (int kk = 0; kk < s.nz; ++kk) {
+      const int k = forward ? kk : s.nz - 1 - kk;
+      for (int jj = 0; jj < s.ny; ++jj) {
+	const int j = forward ? jj : s.ny - 1 - jj;
+	const Row r = make_row(s.nx, s.ny, s.nz, pbc, s.ex, s.ey, s.ez, x, j, k);
+	const int row = (k * s.ny + j) * s.nx;
+	for (int ii = 0; ii < s.nx; ++ii) {
+	  const int i = forward ? ii : s.nx - 1 - ii;
+	  x[row + i] = (b[row + i] + r.sum(i)) / s.c[row + i];
+	}
+      }
+    }
+  }
+}
+
+void FDPoissonBoltzmann_MG::restriction(const Stencil &f, const double *r, const Stencil &c, double *b)const{
+  std::vector<int> lox, hix, loy, hiy, loz, hiz;
+  interpolation(f.nx, pbc, lox, hix);
+  interpolation(f.ny, pbc, loy, hiy);
+  interpolation(f.nz, pbc, loz, hiz);
+  // the transpose of the interpolation, scaled by 1/2 for the coarse
+  // grid spacing
+#ifdef OMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int K = 0; K < c.nz; ++K) {
+    int fz[3], fy[3], fx[3];
+    const int nfz = candidates(K, f.nz, pbc, fz);
+    for (int J = 0; J < c.ny; ++J) {
+      const int nfy = candidates(J, f.ny, pbc, fy);
+      for (int I = 0; I < c.nx; ++I) {
+	const int nfx = candidates(I, f.nx, pbc, fx);
+	double sum = 0.0;
+	for (int a = 0; a < nfz; ++a) {
+	  const double wz = weight(loz, hiz, fz[a], K);
+	  if (wz == 0.0) continue;
+	  for (int bb = 0; bb < nfy; ++bb) {
+	    const double wy = wz * weight(loy, hiy, fy[bb], J);
+	    if (wy == 0.0) continue;
+	    const double *rr = r + (fz[a] * f.ny + fy[bb]) * f.nx;
+	    for (int cc = 0; cc < nfx; ++cc)
+	      sum += wy * weight(lox, hix, fx[cc], I) * rr[fx[cc]];
+	  }
+	}
+	b[(K * c.ny + J) * c.nx + I] = 0.5 * sum;
+      }
+    }
+  }
+}
+
+void FDPoissonBoltzmann_MG::prolongation(const Stencil &c, const double *x, const Stencil &f, double *z)const{
+  std::vector<int> lox, hix, loy, hiy, loz, hiz;
+  interpolation(f.nx, pbc, lox, hix);
+  interpolation(f.ny, pbc, loy, hiy);
+  interpolation(f.nz, pbc, loz, hiz);
+#ifdef OMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int k = 0; k < f.nz; ++k) {
+    const int cz[2] = {loz[k], hiz[k]};
+    for (int j = 0; j < f.ny; ++j) {
+      const int cy[2] = {loy[j], hiy[j]};
+      const int row = (k * f.ny + j) * f.nx;
+      for (int i = 0; i < f.nx; ++i) {
+	const int cx[2] = {lox[i], hix[i]};
+	double sum = 0.0;
+	for (int a = 0; a < 2; ++a)
+	  for (int bb = 0; bb < 2; ++bb)
+	    for (int cc = 0; cc < 2; ++cc)
+	      sum += x[(cz[a] * c.ny + cy[bb]) * c.nx + cx[cc]];
+	z[row + i] += 0.125 * sum;
+      }
+    }
+  }
+}
+
+void FDPoissonBoltzmann_MG::cycle(int level, double *x, const double *b){
+  const Stencil s = stencil(level);
+  const int n = s.nx * s.ny * s.nz;
+  std::fill(x, x + n, 0.0);
+
+  if (level == levels() - 1) {
+    // coarsest grid: symmetric Gauss-Seidel sweeps
+    // (periodic: without the constant part, which is the null space)
+    if (pbc && level > 0) {
+      std::vector<double> &cb = coarse[level - 1].b;
+      double mean = 0.0;
+      for (int i = 0; i < n; ++i) mean += cb[i];
+      mean /= n;
+      for (int i = 0; i < n; ++i) cb[i] -= mean;
+    }
+    const int sweeps = 2 * std::max(s.nx, std::max(s.ny, s.nz));
+    for (int it = 0; it < sweeps; ++it) {
+      smooth(s, x, b, true);
+      smooth(s, x, b, false);
+    }
+    if (pbc) {
+      double mean = 0.0;
+      for (int i = 0; i < n; ++i) mean += x[i];
+      mean /= n;
+      for (int i = 0; i < n; ++i) x[i] -= mean;
+    }
+    return;
+  }
+
+  for (int it = 0; it < nsmooth; ++it)
+    smooth(s, x, b, true);
+
+  double *r = level == 0 ? &res[0] : &coarse[level - 1].r[0];
+  residual(s, x, b, r);
+  Level &C = coarse[level];
+  const Stencil cs = stencil(level + 1);
+  restriction(s, r, cs, &C.b[0]);
+  cycle(level + 1, &C.x[0], &C.b[0]);
+  prolongation(cs, &C.x[0], s, x);
+
+  for (int it = 0; it < nsmooth; ++it)
+    smooth(s, x, b, false);
+}
+
+void FDPoissonBoltzmann_MG::vcycle(std::vector<double> &zvec, const std::vector<double> &rvec){
+  if (epsC == NULL)
+    throw gromos::Exception("FDPoissonBoltzmann_MG", "setup() not called");
+  zvec.resize(GPXGPYGPZ);
+  cycle(0, &zvec[0], &rvec[0]);
+}
+
+void FDPoissonBoltzmann_MG::gqact(std::vector<double> &zvec, const std::vector<double> &pvec)const{
+  if (epsC == NULL)
+    throw gromos::Exception("FDPoissonBoltzmann_MG", "setup() not called");
+  zvec.resize(GPXGPYGPZ);
+  apply(stencil(0), &pvec[0], &zvec[0]);
+}
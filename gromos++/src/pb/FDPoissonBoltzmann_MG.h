@@ -0,0 +1,119 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// pb_FDPoissonBoltzmann_MG.h
+
+#ifndef INCLUDED_PB_FDPoissonBoltzmann_MG
+#define INCLUDED_PB_FDPoissonBoltzmann_MG
+
+#include <vector>
+
+namespace pb{
+
+
+// Geometric multigrid for the finite-difference Poisson(-Boltzmann) equation
+// on the permittivity grids of FDPoissonBoltzmann (epsCgrid: diagonal, 
+// epsI/J/Kgrid: couplings to the next grid point along x, y and z).
+//
+// A V-cycle starts with a zero guess and uses red-black Gauss-Seidel 
+// smoothing (red-black before, black-red after the coarse-grid correction,
+// such that the cycle is a symmetric operator and can be used as CG
+// preconditioner). Coarse grids keep every second grid point (plus the 
+// last one for NPBC); their couplings are the series permittivities of 
+// the fine faces averaged over the neighbouring fine lines, the remaining
+// diagonal part (boundary and ionic terms) is restricted. The residual
+// is restricted with the transpose of trilinear interpolation.
+// The smoothing and the grid transfers are OpenMP-parallel over the grid
+// planes. Periodic grids with an odd number of points along one axis are
+// smoothed lexicographically (serial) on that level.
+//
+// The fine grids are referenced, not copied, and have to stay alive and 
+// unchanged as long as the object is used after setup().
+
+class FDPoissonBoltzmann_MG{
+
+	// one grid level: size, coefficients and work arrays
+	struct Level{
+	  int nx, ny, nz;
+	  std::vector<double> c, ex, ey, ez;
+	  std::vector<double> x, b, r;
+	};
+
+	int GPX;
+	int GPY;
+	int GPZ;
+	int GPXGPYGPZ;
+	bool pbc;
+	int nsmooth;
+
+	// the fine grid coefficients
+	const std::vector<double> *epsC;
+	const std::vector<double> *epsI;
+	const std::vector<double> *epsJ;
+	const std::vector<double> *epsK;
+	// residual on the fine grid
+	std::vector<double> res;
+	// the coarse levels
+	std::vector<Level> coarse;
+
+	// the coefficients and size of a level
+	struct Stencil{
+	  int nx, ny, nz;
+	  const double *c, *ex, *ey, *ez;
+	};
+	Stencil stencil(int level)const;
+
+	void smooth(const Stencil &s, double *x, const double *b, bool forward)const;
+	void residual(const Stencil &s, const double *x, const double *b, double *r)const;
+	void apply(const Stencil &s, const double *x, double *z)const;
+	void restriction(const Stencil &f, const double *r, const Stencil &c, double *b)const;
+	void prolongation(const Stencil &c, const double *x, const Stencil &f, double *z)const;
+	void coarsen(const Stencil &f, Level &c)const;
+	void cycle(int level, double *x, const double *b);
+
+public:
+           //constructor
+           FDPoissonBoltzmann_MG(int GPX, int GPY, int GPZ, bool pbc, int nsmooth = 2);
+	   // deconstructor
+           ~FDPoissonBoltzmann_MG(){}
+
+           //methods
+
+	    // build the coarse grids from the permittivity grids
+	    void setup(const std::vector<double> &epsCgrid,
+            const std::vector<double> &epsIgrid,
+            const std::vector<double> &epsJgrid,
+            const std::vector<double> &epsKgrid);
+
+	    // number of grid levels (including the fine grid)
+	    int levels()const { return coarse.size() + 1; }
+
+	    // zvec = M^-1 rvec with one V-cycle (zero initial guess)
+	    void vcycle(std::vector<double> &zvec, const std::vector<double> &rvec);
+
+	    // zvec = A * pvec on the fine grid
+	    void gqact(std::vector<double> &zvec, const std::vector<double> &pvec)const;
+
+}; //class
+} //namespace
+
+
+#endif
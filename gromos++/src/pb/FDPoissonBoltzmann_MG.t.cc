@@ -0,0 +1,158 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// pb_FDPoissonBoltzmann_MG.t.cc
+// solves the finite-difference Poisson equation of a charged cluster of 
+// atoms with ICCG, with multigrid preconditioned CG and with multigrid 
+// V-cycles alone, for non-periodic and periodic grids, and compares the
+// electrostatic energies and the times. The numbers of grid points
+// (non-periodic; periodic grids use one point less) can be given as 
+// arguments, e.g. 129 257 for the benchmark.
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../gcore/System.h"
+#include "../gcore/Molecule.h"
+#include "../gcore/MoleculeTopology.h"
+#include "../gcore/AtomTopology.h"
+#include "../gcore/Solvent.h"
+#include "../gcore/SolventTopology.h"
+#include "../utils/AtomSpecifier.h"
+#include "../gmath/Vec.h"
+
+#ifdef OMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+#include "FDPoissonBoltzmann.h"
+#include "FDPoissonBoltzmann_ICCG_NPBC.h"
+#include "FDPoissonBoltzmann_ICCG_PBC.h"
+#include "FDPoissonBoltzmann_MG.h"
+
+using namespace pb;
+
+double wtime() {
+#ifdef OMP
+  return omp_get_wtime();
+#else
+  return double(clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+enum solver_enum { iccg, mgcg, mg };
+
+// solves on a grid of n^3 points and returns the energy
+double solve(gcore::System &sys, int n, double box, bool pbc, solver_enum solver,
+	     double &time) {
+  ofstream os;
+  utils::AtomSpecifier atoms(sys, "1:a");
+  const double epssolvent = 78.4;
+  FDPoissonBoltzmann pb(atoms, atoms, n, n, n, box / n, pbc, epssolvent, os);
+  pb.setupGrid(true, os);
+  const int maxits = 2000;
+  const double acceptance = 1e-6;
+  const double start = wtime();
+  bool converged = false;
+  if (solver == iccg) {
+    if (pbc) {
+      FDPoissonBoltzmann_ICCG_PBC ic(n, n, n);
+      converged = pb.solveforpotential_pbc(maxits, acceptance, ic, os);
+    } else {
+      FDPoissonBoltzmann_ICCG_NPBC ic(n, n, n);
+      converged = pb.solveforpotential_npbc(maxits, acceptance, ic, os);
+    }
+  } else {
+    FDPoissonBoltzmann_MG m(n, n, n, pbc);
+    converged = pb.solveforpotential_mg(maxits, acceptance, m, solver == mgcg, os);
+  }
+  time = wtime() - start;
+  assert(converged);
+  return pb.dGelec(os);
+}
+
+int main(int argc, char *argv[]) {
+  vector<int> sizes;
+  for (int i = 1; i < argc; ++i)
+    sizes.push_back(atoi(argv[i]));
+  if (sizes.empty()) sizes.push_back(33);
+
+  // a neutral cluster of 200 atoms in the middle of a 4 nm box
+  const int num = 200;
+  const double box = 4.0;
+  gcore::MoleculeTopology mt;
+  gcore::AtomTopology at;
+  srand(4711);
+  for (int i = 0; i < num; ++i) {
+    at.setName("A");
+    at.setCharge(i % 2 ? -0.5 : 0.5);
+    at.setradius(0.15 + 0.05 * rand() / RAND_MAX);
+    mt.addAtom(at);
+    mt.setResNum(i, 0);
+  }
+  mt.setResName(0, "CLU");
+  gcore::SolventTopology st;
+  at.setName("OW");
+  st.addAtom(at);
+  st.setSolvName("SOL");
+  gcore::System sys;
+  sys.addMolecule(gcore::Molecule(mt));
+  sys.addSolvent(gcore::Solvent(st));
+  sys.mol(0).initPos();
+  for (int i = 0; i < num; ++i) {
+    gmath::Vec v;
+    do {
+      for (int d = 0; d < 3; ++d)
+	v[d] = 1.6 * rand() / RAND_MAX - 0.8;
+    } while (v.abs() > 0.8);
+    sys.mol(0).pos(i) = v + gmath::Vec(0.5 * box, 0.5 * box, 0.5 * box);
+  }
+
+  const char *names[] = {"ICCG", "MG-CG", "MG"};
+  cout << setw(6) << "grid" << setw(6) << "bc" << setw(8) << "solver"
+	  << setw(18) << "energy" << setw(12) << "time (s)" << endl;
+  for (unsigned int s = 0; s < sizes.size(); ++s) {
+    for (int p = 0; p < 2; ++p) {
+      const bool pbc = p == 1;
+      const int n = pbc ? sizes[s] - 1 : sizes[s];
+      double e[3], t[3];
+      for (int solver = 0; solver < 3; ++solver) {
+	e[solver] = solve(sys, n, box, pbc, solver_enum(solver), t[solver]);
+	cout << setw(6) << n << setw(6) << (pbc ? "PBC" : "NPBC")
+		<< setw(8) << names[solver] << setw(18) << setprecision(10)
+		<< e[solver] << setw(12) << setprecision(4) << t[solver] << endl;
+      }
+      // the same solution within the convergence criterion
+      assert(fabs(e[1] - e[0]) < 1e-4 * fabs(e[0]));
+      assert(fabs(e[2] - e[0]) < 1e-4 * fabs(e[0]));
+    }
+  }
+  return 0;
+}
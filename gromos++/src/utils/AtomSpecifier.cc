@@ -24,6 +24,7 @@
 #include <cstdio>
 #include <string>
 #include <set>
+#include <algorithm>
 
 #include "../gcore/System.h"
 #include "../gcore/Molecule.h"
@@ -39,6 +40,44 @@
 using namespace gcore;
 using namespace std;
 
+namespace {
+  // key of the index of an AtomSpecifier. Like in findAtom, all solvent
+  // atoms count as one molecule. Virtual atoms have a negative atom number
+  // and therefore keys of their own.
+  inline long long key(int m, int a) {
+    return (static_cast<long long>(m < 0 ? -1 : m) << 32) |
+            static_cast<unsigned int>(a);
+  }
+
+  template<class Id>
+  inline long long key(const Id &s) {
+    return key(s.mol, s.atom);
+  }
+
+  // the atom number as returned by AtomSpecifier::atom(i)
+  template<class Id>
+  inline int number(const Id &s) {
+    return s.mol == -3 ? -1 : s.atom;
+  }
+
+  // true if atom s should come after m:a
+  template<class Id>
+  bool comesAfter(const Id &s, int m, int a) {
+    const int sa = number(s);
+    if(s.mol == m) return sa > a;
+    if(s.mol >= 0 && m >= 0) return s.mol > m;
+    if(s.mol <  0 && m <  0) return sa > a;
+    if(s.mol <  0 && m >= 0) return true;
+    if(s.mol >= 0 && m <  0) return false;
+    return false;
+  }
+
+  template<class Id>
+  bool before(const Id &s, const Id &t) {
+    return comesAfter(t, s.mol, number(s));
+  }
+}
+
 utils::AtomSpecifier::AtomSpecifier() {
   d_sys=NULL;
   d_nsm=-1;
@@ -52,27 +91,26 @@ std::string utils::SpecAtom::toString()const
   return os.str();
 }
 
+void utils::AtomSpecifier::_push(int m, int a)const
+{
+  d_specatom.push_back(Id(m, a));
+  d_view.clear();
+  _updateIndex();
+}
+
 void utils::AtomSpecifier::_appendAtom(int m, int a)
 {
   // check whether it is already in
-  if(findAtom(m, a) == -1){
-    if (m < 0)
-      d_specatom.push_back(new SolventSpecAtom(*d_sys, m, a));
-    else
-      d_specatom.push_back(new SpecAtom(*d_sys, m, a));
-  }
+  if(findAtom(m, a) == -1)
+    _push(m, a);
 }
 
 void utils::AtomSpecifier::_appendSolvent(int m, int a)const
 {
   // check whether it is already in
   assert(m<0);
-  if(findAtom(m, a) == -1){
-    // if (m < 0)
-    d_specatom.push_back(new SolventSpecAtom(*d_sys, m, a));
-    // else
-    // d_specatom.push_back(new SpecAtom(*d_sys, m, a));
-  }
+  if(findAtom(m, a) == -1)
+    _push(m, a);
 }
 
 bool utils::AtomSpecifier::_checkName(int m, int a, std::string s)const
@@ -114,11 +152,17 @@ int utils::AtomSpecifier::_expandSolvent()const
 
   // first remove all atoms that are in the list due to an earlier
   // expansion. These have d_mol[i] == -2
-  for(unsigned int i=0; i<d_specatom.size(); ++i){
-    if(d_specatom[i]->mol()==-2) {
-      _unexpandSolvent(i);
-      i--;
-    }
+  std::vector<Id>::iterator last = d_specatom.begin();
+  for(std::vector<Id>::iterator it = d_specatom.begin(),
+        to = d_specatom.end(); it != to; ++it){
+    if(it->mol != -2)
+      *last++ = *it;
+  }
+  if(last != d_specatom.end()){
+    d_specatom.erase(last, d_specatom.end());
+    d_index.valid = false;
+    _updateIndex();
+    d_view.clear();
   }
 
   // now add the atoms for every molecule
@@ -165,13 +209,6 @@ utils::AtomSpecifier::AtomSpecifier(gcore::System &sys, string s, int x)
 
 utils::AtomSpecifier::~AtomSpecifier()
 {
-  // delete all atoms from the spec
-  // (this is slightly undefined behaviour, as the deleted pointers
-  //  are left in the vector (for clear))
-  for(std::vector<SpecAtom *>::iterator it = d_specatom.begin(),
-	to = d_specatom.end(); it != to; ++it){
-    delete *it;
-  }
   if (d_not_atoms != NULL)
     delete d_not_atoms;
 }
@@ -186,9 +223,10 @@ void utils::AtomSpecifier::setSystem(gcore::System &sys)
   if (d_not_atoms != NULL)
     d_not_atoms->setSystem(sys);
 
-  // need to change the systems in the SpecAtom vector
-  for(unsigned int i=0; i<d_specatom.size(); ++i)
-    d_specatom[i]->setSystem(sys);
+  // need to change the systems of the virtual atoms
+  for(unsigned int i=0; i<d_virtual.size(); ++i)
+    d_virtual[i].setSystem(sys);
+  d_view.clear();
 }
 
 int utils::AtomSpecifier::addSpecifier(string s, int x)
@@ -216,15 +254,18 @@ int utils::AtomSpecifier::appendSpecifier(string s, int x)
     if(m >= 0){
         if(a >= d_sys->mol(m).topology().numAtoms())
             throw utils::AtomSpecifier::Exception(" atom number out of range.\n");
-        d_specatom.push_back(new SpecAtom(*d_sys, m, a));
-   }
-    else{
-        d_specatom.push_back(new SolventSpecAtom(*d_sys, m, a));
    }
+    if(m == -3){
+        d_virtual.push_back(atom.d_virtual[-1 - atom.d_specatom[0].atom]);
+        a = -int(d_virtual.size());
+    }
+    _push(m, a);
     return d_specatom.size();
 }
 
 int utils::AtomSpecifier::addAtom(int m, int a) {
+  if (m == -3)
+    throw utils::AtomSpecifier::Exception(" virtual atoms cannot be added by number.\n");
   if (d_sys != NULL) { // only check if we have a system!
     if (m >= d_sys->numMolecules())
       throw utils::AtomSpecifier::Exception(" molecule number out of range.\n");
@@ -272,18 +313,15 @@ int utils::AtomSpecifier::addMolecule(int m)
 
 int utils::AtomSpecifier::addAtomStrict(int m, int a)
 {
+  if(m == -3)
+    throw utils::AtomSpecifier::Exception(" virtual atoms cannot be added by number.\n");
   if(m >= int(d_sys->numMolecules()))
     throw utils::AtomSpecifier::Exception(" molecule number out of range.\n");
   if(m >= 0){
     if(a >= d_sys->mol(m).topology().numAtoms())
       throw utils::AtomSpecifier::Exception(" atom number out of range.\n");
-
-    d_specatom.push_back(new SpecAtom(*d_sys, m, a));
-
-  }
-  else{
-    d_specatom.push_back(new SolventSpecAtom(*d_sys, m, a));
   }
+  _push(m, a);
 
   return d_specatom.size();
 }
@@ -395,25 +433,15 @@ int utils::AtomSpecifier::addSolventType() const //since there is only 1 solvent
 
 bool utils::AtomSpecifier::_compare(int i, int m, int a)const
 {
-  if(d_specatom[i]->mol() == m) return d_specatom[i]->atom() > a;
-  if(d_specatom[i]->mol() >= 0 && m >= 0) return d_specatom[i]->mol() > m;
-  if(d_specatom[i]->mol() <  0 && m <  0) return d_specatom[i]->atom() > a;
-  if(d_specatom[i]->mol() <  0 && m >= 0) return true;
-  if(d_specatom[i]->mol() >= 0 && m <  0) return false;
-  return false;
+  return comesAfter(d_specatom[i], m, a);
 }
 
 void utils::AtomSpecifier::sort()
 {
-  for(unsigned int i=1; i < d_specatom.size(); ++i){
-    SpecAtom * t = d_specatom[i];
-    int j=i-1;
-    while ((j >= 0) && _compare(j, t->mol(), t->atom())){
-      d_specatom[j+1] = d_specatom[j];
-      j--;
-    }
-    d_specatom[j+1] = t;
-  }
+  std::stable_sort(d_specatom.begin(), d_specatom.end(), before<Id>);
+  d_index.valid = false;
+  _updateIndex();
+  d_view.clear();
 }
 
 int utils::AtomSpecifier::removeAtom(int m, int a)
@@ -424,31 +452,83 @@ int utils::AtomSpecifier::removeAtom(int m, int a)
 
 int utils::AtomSpecifier::removeAtom(int i)
 {
-  if(i < int(d_specatom.size()) && i >= 0){
-    vector<SpecAtom *>::iterator it=d_specatom.begin() + i;
-    SpecAtom * d = *it;
+  return _unexpandSolvent(i);
+}
 
-    d_specatom.erase(it);
-    delete d;
+int utils::AtomSpecifier::_unexpandSolvent(int i)const
+{
+  if(i < int(d_specatom.size()) && i >= 0){
+    _removeFromIndex(i);
+    // a removed virtual atom stays in d_virtual until clear()
+    d_specatom.erase(d_specatom.begin() + i);
+    _updateIndex();
+    d_view.clear();
   }
   return d_specatom.size();
 }
 
-int utils::AtomSpecifier::_unexpandSolvent(int i)const
+void utils::AtomSpecifier::_updateIndex()const
 {
-  if(i < int(d_specatom.size()) && i >= 0){
-    vector<SpecAtom *>::iterator it=d_specatom.begin() + i;
-    SpecAtom * d = *it;
+  if(!d_index.valid || d_index.size > d_specatom.size()){
+    d_index.slot.clear();
+    d_index.removed.clear();
+    d_index.size = 0;
+    d_index.duplicates = 0;
+    d_index.valid = true;
+  }
+  // the atoms appended since: their index slots follow the removed ones
+  const int shift = d_index.removed.size();
+  for(unsigned int i = d_index.size; i < d_specatom.size(); ++i){
+    if(!d_index.slot.insert(make_pair(key(d_specatom[i]), i + shift)).second)
+      ++d_index.duplicates;
+  }
+  d_index.size = d_specatom.size();
+}
 
-    d_specatom.erase(it);
-    delete d;
+void utils::AtomSpecifier::_removeFromIndex(int i)const
+{
+  if(!d_index.valid || unsigned(i) >= d_index.size || d_index.duplicates){
+    // the first remaining atom with this key would have to be searched
+    d_index.valid = false;
+    return;
   }
-  return d_specatom.size();
+  std::unordered_map<long long, int>::iterator it =
+    d_index.slot.find(key(d_specatom[i]));
+  if(it == d_index.slot.end()){
+    d_index.valid = false;
+    return;
+  }
+  const int slot = it->second;
+  vector<int>::iterator r = std::lower_bound(d_index.removed.begin(),
+          d_index.removed.end(), slot);
+  if(slot - (r - d_index.removed.begin()) != i){
+    d_index.valid = false;
+    return;
+  }
+  d_index.slot.erase(it);
+  d_index.removed.insert(r, slot);
+  --d_index.size;
+  // many removals make searches slower (and removing more expensive)
+  if(d_index.removed.size() > 64 + d_index.size / 16)
+    d_index.valid = false;
 }
 
 int utils::AtomSpecifier::findAtom(int m, int a)const
 {
-  vector<SpecAtom *>::iterator it=d_specatom.begin(),
+  // the index is kept up to date by the functions changing d_specatom,
+  // here it is only read (findAtom is called from parallel regions)
+  const long long k = key(m, a);
+  std::unordered_map<long long, int>::const_iterator found =
+    d_index.slot.find(k);
+  if(found == d_index.slot.end())
+    return -1;
+  const int slot = found->second - (std::lower_bound(d_index.removed.begin(),
+          d_index.removed.end(), found->second) - d_index.removed.begin());
+  if(slot < int(d_specatom.size()) && key(d_specatom[slot]) == k)
+    return slot;
+
+  // not expected: search
+  vector<Id>::const_iterator it=d_specatom.begin(),
     it_to = d_specatom.end();
 
   int counter=0;
@@ -456,12 +536,12 @@ int utils::AtomSpecifier::findAtom(int m, int a)const
   // function. So split up the cases
   if(m<0){
     for( ; it != it_to; ++it, ++counter)
-      if((*it)->mol() < 0 && (*it)->atom() == a)
+      if(it->mol < 0 && number(*it) == a)
 	return counter;
   }
 
   for( ; it != it_to; ++it, ++counter)
-    if((*it)->mol() == m && (*it)->atom() == a)
+    if(it->mol == m && number(*it) == a)
       return counter;
 
   return -1;
@@ -471,25 +551,16 @@ int utils::AtomSpecifier::findAtom(int m, int a)const
  * copy constructor.
  */
 utils::AtomSpecifier::AtomSpecifier(utils::AtomSpecifier const & as)
+  : d_solventType(as.d_solventType),
+    d_specatom(as.d_specatom),
+    d_virtual(as.d_virtual),
+    d_not_atoms(NULL),
+    d_sys(as.d_sys),
+    d_nsm(as.d_nsm),
+    d_index(as.d_index)
 {
-  if (this != &as){
-    d_not_atoms = NULL;
-    clear();
-
-    d_sys=as.d_sys;
-    d_nsm=as.d_nsm;
-
-    std::vector<SpecAtom *>::const_iterator
-      it = as.d_specatom.begin(),
-      to = as.d_specatom.end();
-    for( ; it != to; ++it){
-      d_specatom.push_back((*it)->clone());
-    }
-
-    if (as.d_not_atoms != NULL) {
-      d_not_atoms = new AtomSpecifier(*(as.d_not_atoms));
-    }
-    d_solventType = as.d_solventType;
+  if (as.d_not_atoms != NULL) {
+    d_not_atoms = new AtomSpecifier(*(as.d_not_atoms));
   }
 }
 
@@ -502,9 +573,10 @@ utils::AtomSpecifier & utils::AtomSpecifier::operator=(const utils::AtomSpecifie
     d_sys=as.d_sys;
     d_nsm=as.d_nsm;
 
-    for(unsigned int i=0; i < as.d_specatom.size(); ++i){
-      d_specatom.push_back(as.atom()[i]->clone());
-    }
+    d_specatom = as.d_specatom;
+    d_virtual = as.d_virtual;
+    d_index = as.d_index;
+
     if (d_not_atoms != NULL) {
       delete d_not_atoms;
     }
@@ -524,8 +596,15 @@ utils::AtomSpecifier utils::AtomSpecifier::operator+(const AtomSpecifier &as)
   utils::AtomSpecifier temp(*as.d_sys);
   temp = *this;
 
-  for(unsigned int i = 0; i < as.d_specatom.size(); ++i)
-    temp.addAtom(as.d_specatom[i]->mol(), as.d_specatom[i]->atom());
+  for(unsigned int i = 0; i < as.d_specatom.size(); ++i){
+    const Id &id = as.d_specatom[i];
+    if(id.mol == -3){
+      temp.d_virtual.push_back(as.d_virtual[-1 - id.atom]);
+      temp._push(-3, -int(temp.d_virtual.size()));
+    }
+    else
+      temp.addAtom(id.mol, id.atom);
+  }
 
   for(unsigned int i=0;i<as.d_solventType.size(); i++)
     temp.addSolventType(d_sys->sol(0).topology().atom(as.d_solventType[i]).name());
@@ -543,125 +622,237 @@ utils::AtomSpecifier utils::AtomSpecifier::operator+(const AtomSpecifier &as)
 
 gmath::Vec *utils::AtomSpecifier::coord(int i)
 {
-  if(_expand()) _expandSolvent();
-  return &d_specatom[i]->pos();
+  return &pos(i);
 }
 
 gmath::Vec & utils::AtomSpecifier::pos(int i)
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->pos();
+  const Id &id = d_specatom[i];
+  if(id.mol >= 0)
+    return d_sys->mol(id.mol).pos(id.atom);
+  if(id.mol == -3)
+    return d_virtual[-1 - id.atom].pos();
+  if(id.atom > d_sys->sol(0).numPos())
+    throw Exception(" solvent coordinate not read");
+  return d_sys->sol(0).pos(id.atom);
 }
 gmath::Vec const & utils::AtomSpecifier::pos(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->pos();
+  const Id &id = d_specatom[i];
+  if(id.mol >= 0)
+    return d_sys->mol(id.mol).pos(id.atom);
+  if(id.mol == -3)
+    return d_virtual[-1 - id.atom].pos();
+  if(id.atom > d_sys->sol(0).numPos())
+    throw Exception(" solvent coordinate not read");
+  return d_sys->sol(0).pos(id.atom);
 }
 gmath::Vec & utils::AtomSpecifier::cosDisplacement(int i)
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->cosDisplacement();
+  const Id &id = d_specatom[i];
+  if(id.mol >= 0)
+    return d_sys->mol(id.mol).cosDisplacement(id.atom);
+  if(id.mol == -3)
+    throw Exception(" accessing VA cos displacement");
+  if(id.atom > d_sys->sol(0).numPos())
+    throw Exception(" solvent coordinate not read");
+  return d_sys->sol(0).cosDisplacement(id.atom);
 }
 gmath::Vec const & utils::AtomSpecifier::cosDisplacement(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->cosDisplacement();
+  const Id &id = d_specatom[i];
+  if(id.mol >= 0)
+    return d_sys->mol(id.mol).cosDisplacement(id.atom);
+  if(id.mol == -3)
+    throw Exception(" accessing VA cos displacement");
+  if(id.atom > d_sys->sol(0).numPos())
+    throw Exception(" solvent coordinate not read");
+  return d_sys->sol(0).cosDisplacement(id.atom);
 }
 gmath::Vec & utils::AtomSpecifier::vel(int i)
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->vel();
+  const Id &id = d_specatom[i];
+  if(id.mol >= 0)
+    return d_sys->mol(id.mol).vel(id.atom);
+  if(id.mol == -3)
+    throw Exception(" accessing VA velocitiy");
+  if(id.atom > d_sys->sol(0).numVel())
+    throw Exception(" solvent coordinate not read");
+  return d_sys->sol(0).vel(id.atom);
 }
 gmath::Vec const & utils::AtomSpecifier::vel(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->vel();
+  const Id &id = d_specatom[i];
+  if(id.mol >= 0)
+    return d_sys->mol(id.mol).vel(id.atom);
+  if(id.mol == -3)
+    throw Exception(" accessing VA velocitiy");
+  if(id.atom > d_sys->sol(0).numVel())
+    throw Exception(" solvent coordinate not read");
+  return d_sys->sol(0).vel(id.atom);
+}
+
+std::vector<gmath::Vec> const & utils::AtomSpecifier::gatherPos()const
+{
+  if(_expand()) _expandSolvent();
+  const int num = d_specatom.size();
+  d_gathered.resize(num);
+  for(int i = 0; i < num; ++i){
+    const Id &id = d_specatom[i];
+    if(id.mol >= 0)
+      d_gathered[i] = d_sys->mol(id.mol).pos(id.atom);
+    else
+      d_gathered[i] = pos(i);
+  }
+  return d_gathered;
+}
+
+gcore::AtomTopology const & utils::AtomSpecifier::_topology(int i,
+        char const * what)const
+{
+  const Id &id = d_specatom[i];
+  if(id.mol >= 0)
+    return d_sys->mol(id.mol).topology().atom(id.atom);
+  if(id.mol == -3)
+    throw Exception(std::string(" accessing VA ") + what);
+  const SolventTopology &st = d_sys->sol(0).topology();
+  return st.atom(id.atom % st.numAtoms());
 }
 
 std::string utils::AtomSpecifier::name(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->name();
+  if(d_specatom[i].mol == -3) return "VA";
+  return _topology(i, "name").name();
 }
 
 int utils::AtomSpecifier::iac(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->iac();
+  return _topology(i, "iac").iac();
 }
 
 double utils::AtomSpecifier::radius(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->radius();
+  return _topology(i, "radius").radius();
 }
 
 double utils::AtomSpecifier::charge(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->charge();
+  return _topology(i, "charge").charge();
 }
 bool utils::AtomSpecifier::isPolarisable(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->isPolarisable();
+  return _topology(i, "polarisability").isPolarisable();
 }
 double utils::AtomSpecifier::poloffsiteGamma(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->poloffsiteGamma();
+  return _topology(i, "polarisability").poloffsiteGamma();
 }
 int utils::AtomSpecifier::poloffsiteI(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->poloffsiteI();
+  return _topology(i, "polarisability").poloffsiteI();
 }
 int utils::AtomSpecifier::poloffsiteJ(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->poloffsiteJ();
+  return _topology(i, "polarisability").poloffsiteJ();
 }
 double utils::AtomSpecifier::cosCharge(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->cosCharge();
+  return _topology(i, "cos charge").cosCharge();
 }
 double utils::AtomSpecifier::mass(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->mass();
+  return _topology(i, "mass").mass();
 }
 
 std::string utils::AtomSpecifier::resname(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->resname();
+  const Id &id = d_specatom[i];
+  if(id.mol >= 0)
+    return d_sys->mol(id.mol).topology().resName(
+            d_sys->mol(id.mol).topology().resNum(id.atom));
+  if(id.mol == -3)
+    throw Exception(" accessing VA resname");
+  return "SLV";
 }
 
 int utils::AtomSpecifier::resnum(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->resnum();
+  const Id &id = d_specatom[i];
+  if(id.mol >= 0)
+    return d_sys->mol(id.mol).topology().resNum(id.atom);
+  if(id.mol == -3)
+    throw Exception(" accessing VA resnum");
+  return id.atom / d_sys->sol(0).topology().numAtoms();
 }
 
 int utils::AtomSpecifier::mol(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->mol();
+  return d_specatom[i].mol;
 }
 
 int utils::AtomSpecifier::atom(int i)const
 {
   if(_expand()) _expandSolvent();
-  return d_specatom[i]->atom();
+  return number(d_specatom[i]);
+}
+
+utils::spec_type utils::AtomSpecifier::type(int i)const
+{
+  if(_expand()) _expandSolvent();
+  if(d_specatom[i].mol >= 0) return spec_solute;
+  if(d_specatom[i].mol == -3) return spec_virtual;
+  return spec_solvent;
+}
+
+utils::AtomSpecifier utils::AtomSpecifier::conf(int i)const
+{
+  if(type(i) != spec_virtual) return AtomSpecifier();
+  return d_virtual[-1 - d_specatom[i].atom].conf();
+}
+
+int utils::AtomSpecifier::virtualType(int i)const
+{
+  if(type(i) != spec_virtual) return 0;
+  return d_virtual[-1 - d_specatom[i].atom].virtualType();
+}
+
+utils::SpecAtom * utils::AtomSpecifier::cloneAtom(int i)const
+{
+  switch(type(i)){
+    case spec_solute:
+      return new SpecAtom(*d_sys, d_specatom[i].mol, d_specatom[i].atom);
+    case spec_solvent:
+      return new SolventSpecAtom(*d_sys, d_specatom[i].mol, d_specatom[i].atom);
+    default:
+      return new VirtualSpecAtom(d_virtual[-1 - d_specatom[i].atom]);
+  }
 }
 
 int utils::AtomSpecifier::gromosAtom(int i)const
 {
   if(_expand()) _expandSolvent();
-  int maxmol=d_specatom[i]->mol();
+  int maxmol=d_specatom[i].mol;
   if(maxmol<0) maxmol=d_sys->numMolecules();
-  int grom=d_specatom[i]->atom();
+  int grom=number(d_specatom[i]);
   for(int j=0; j< maxmol; ++j) grom+=d_sys->mol(j).numAtoms();
   return grom;
 }
@@ -680,14 +871,10 @@ unsigned int utils::AtomSpecifier::size()const
 
 void utils::AtomSpecifier::clear()
 {
-  std::vector<SpecAtom *>::iterator
-    it = d_specatom.begin(),
-    to = d_specatom.end();
-
-  for( ; it != to; ++it)
-    delete *it;
-
   d_specatom.clear();
+  d_virtual.clear();
+  d_view.clear();
+  d_index = Index();
   d_solventType.resize(0);
   d_nsm=-1;
 
@@ -710,28 +897,28 @@ std::vector<std::string> utils::AtomSpecifier::toString()const
   for(unsigned int i = 0; i < d_specatom.size(); ++i){
 
     // virtual atom
-    if (d_specatom[i]->type() == spec_virtual){
+    if (d_specatom[i].mol == -3){
       if (in_range){
 	in_range = false;
 	os << a_last + 1;
       }
-      os << "," << d_specatom[i]->toString();
+      os << "," << d_virtual[-1 - d_specatom[i].atom].toString();
       m = -999;
       a_last = -999;
       continue;
     }
 
     // new molecule?
-    if (d_specatom[i]->mol() != m){
+    if (d_specatom[i].mol != m){
       // std::cerr << "\t" << i << " new molecule" << std::endl;
-      m = d_specatom[i]->mol();
+      m = d_specatom[i].mol;
 
       if (in_range){
 	in_range = false;
 	os << "-" << a_last + 1;
       }
 
-      a_last = d_specatom[i]->atom();
+      a_last = d_specatom[i].atom;
 
       if (!first){
 	os << ";";
@@ -748,21 +935,21 @@ std::vector<std::string> utils::AtomSpecifier::toString()const
 	first = false;
       }
     }
-    else if (a_last == d_specatom[i]->atom()-1){
+    else if (a_last == d_specatom[i].atom-1){
       // std::cerr << "\t" << i << " not new molecule but in order" << std::endl;
-      a_last = d_specatom[i]->atom();
+      a_last = d_specatom[i].atom;
       in_range = true;
     }
     else if (in_range){
       // std::cerr << "\twere in range, but not anymore" << std::endl;
       in_range = false;
       os << "-" << a_last + 1 << ",";
-      a_last = d_specatom[i]->atom();
+      a_last = d_specatom[i].atom;
       os << a_last + 1;
     }
     else{
       // std::cerr << "\tjust an other unconnected atom" << std::endl;
-      a_last = d_specatom[i]->atom();
+      a_last = d_specatom[i].atom;
       os << "," << a_last + 1;
     }
   }
@@ -782,13 +969,12 @@ std::string utils::AtomSpecifier::toString(int i)const
   if(_expand()) _expandSolvent();
   ostringstream os;
   // virtual atom
-  if (d_specatom[i]->type() == spec_virtual){
-      os  << d_specatom[i]->toString();
+  if (d_specatom[i].mol == -3){
+      os  << d_virtual[-1 - d_specatom[i].atom].toString();
       return os.str();
   }
-  else if(d_specatom[i]->mol() < 0) os << "s";
-  else os << d_specatom[i]->mol()+1;
-  os << ":" << d_specatom[i]->atom()+1;
+  else if(d_specatom[i].mol < 0) os << "s";
+  else os << d_specatom[i].mol+1;
+  os << ":" << d_specatom[i].atom+1;
   return os.str();
 }
-
@@ -31,6 +31,7 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include "../gromos/Exception.h"
 
 
@@ -62,8 +63,10 @@ namespace utils
    * unified access to solute, solvent and virtual atoms.
    *
    * Description:
-   * An AtomSpecifier is a vector of SpecAtom *, through which all relevant
-   * information about the atom is accessible.
+   * A SpecAtom gives access to all relevant information about an atom. An
+   * AtomSpecifier stores its atoms as molecule and atom numbers (and virtual
+   * atoms as VirtualSpecAtom) and hands out SpecAtom objects through
+   * AtomSpecifier::atom().
    *
    * @class SpecAtom
    * @author M. Christen
@@ -535,12 +538,62 @@ namespace utils
   class AtomSpecifier{
     mutable std::vector<int> d_solventType; //chris said mutable was ok ;)
 
-    mutable std::vector<SpecAtom *> d_specatom;
+    /**
+     * an atom of the specifier: the molecule and atom number. Solvent
+     * atoms have a negative molecule number (-2 if they come from the
+     * expansion of a solvent type), virtual atoms have molecule -3 and
+     * atom -1 - i, where i is their index in d_virtual.
+     */
+    struct Id {
+      int mol;
+      int atom;
+      Id(int m, int a) : mol(m), atom(a) {}
+    };
+    mutable std::vector<Id> d_specatom;
+    /**
+     * the virtual atoms
+     */
+    mutable std::vector<VirtualSpecAtom> d_virtual;
+    /**
+     * SpecAtom objects for the atoms, built by atom() only
+     */
+    mutable std::vector<SpecAtom *> d_view;
+    mutable std::vector<SpecAtom> d_viewSolute;
+    mutable std::vector<SolventSpecAtom> d_viewSolvent;
+    /**
+     * buffer for gatherPos()
+     */
+    mutable std::vector<gmath::Vec> d_gathered;
     mutable AtomSpecifier * d_not_atoms;
 
     gcore::System *d_sys;
     mutable int d_nsm;
 
+    /**
+     * index of the atoms for findAtom: the slot of the first atom with a
+     * given molecule (all solvent and virtual atoms in one) and atom
+     * number. Atoms that were removed since the index was built are kept
+     * in removed (sorted, as index slots), the slots after them are
+     * shifted. The functions changing d_specatom keep the index up to
+     * date, findAtom only reads it and is safe in parallel regions.
+     */
+    struct Index {
+      std::unordered_map<long long, int> slot;
+      std::vector<int> removed;
+      /**
+       * number of atoms in d_specatom that are indexed
+       */
+      unsigned int size;
+      /**
+       * number of atoms that have the same key as an earlier one
+       */
+      int duplicates;
+      bool valid;
+
+      Index() : size(0), duplicates(0), valid(false) {}
+    };
+    mutable Index d_index;
+
   public:
     // Constructors
     /**
@@ -646,7 +699,9 @@ namespace utils
     /**
      * Method to find the index of a specific atom in the AtomSpecifier
      *
-     * Numbering is assumed to be gromos++ numbering, starting at 0
+     * Numbering is assumed to be gromos++ numbering, starting at 0. The
+     * atoms are looked up in a hash index, so adding n atoms (which checks
+     * whether they are in already) takes O(n) rather than O(n^2).
      * @param m Number of the molecule the atom belongs to
      * @param a Atom number within that molecule
      */
@@ -702,8 +757,8 @@ namespace utils
      */
     int addSolventType() const;
     /**
-     * Method to sort the atoms ascending order. Some applications might
-     * need the atoms to be ordered. This is just a simple bubble sort
+     * Method to sort the atoms ascending order (solvent atoms last). Some
+     * applications might need the atoms to be ordered. The sort is stable.
      */
     void sort();
     /**
@@ -732,15 +787,40 @@ namespace utils
      */
     int gromosAtom(int i)const;
     /**
-     * Accessor, returns a pointer to the vector containing the atom
-     * numbers.
+     * Accessor, returns a vector of SpecAtom pointers for the atoms.
+     *
+     * The atoms are not stored as SpecAtom objects: they are created by
+     * this function and are valid until the AtomSpecifier is changed.
+     * Changes to the vector do not change the AtomSpecifier. As it is
+     * built on demand, the function must not be called by several threads
+     * at the same time. Use the accessors taking an index (type(i),
+     * conf(i), ...) instead where possible.
      */
     std::vector<SpecAtom *> & atom();
     /**
-     * const Accessor, returns a pointer to the vector containing the atom
-     * numbers.
+     * const Accessor, returns a vector of SpecAtom pointers for the atoms
+     * (see above).
      */
     std::vector<SpecAtom *> const & atom()const;
+    /**
+     * Accessor, returns whether the i-th atom in the AtomSpecifier is a
+     * solute, solvent or virtual atom
+     */
+    spec_type type(int i)const;
+    /**
+     * Accessor, returns the atoms a virtual atom is based on (empty for
+     * other atoms)
+     */
+    AtomSpecifier conf(int i)const;
+    /**
+     * Accessor, returns the type of a virtual atom (0 for other atoms)
+     */
+    int virtualType(int i)const;
+    /**
+     * Returns a new SpecAtom for the i-th atom in the AtomSpecifier. It is
+     * owned by the caller.
+     */
+    SpecAtom * cloneAtom(int i)const;
     /**
      * Accessor, returns the number of atoms in the AtomSpecifier
      */
@@ -796,6 +876,15 @@ namespace utils
      * const accessor
      */
     gmath::Vec const & vel(int i)const;
+    /**
+     * Copies the coordinates of all atoms of the AtomSpecifier into a
+     * contiguous buffer, which is kept and reused. Call it once per frame
+     * (after the coordinates are read and gathered) and pass the buffer to
+     * the kernels rather than calling pos(i) for every atom and every use.
+     * @return the coordinates, in the order of the atoms. They are valid
+     *         until the next call.
+     */
+    std::vector<gmath::Vec> const & gatherPos()const;
     /**
      * Accesor, returns the atom name of the i-th atom in the AtomSpecifier
      */
@@ -984,6 +1073,24 @@ namespace utils
      * @param i remove the atoms with index 1 in the specifier
      */
     int _unexpandSolvent(int i)const;
+    /**
+     * appends the atom m:a (a virtual atom if m is -3) to d_specatom
+     */
+    void _push(int m, int a)const;
+    /**
+     * the topology of the (solute or solvent) atom i. Throws for virtual
+     * atoms, what is the property that was asked for.
+     */
+    gcore::AtomTopology const & _topology(int i, char const * what)const;
+    /**
+     * brings the index of findAtom up to date with d_specatom; to be called
+     * after every change of d_specatom
+     */
+    void _updateIndex()const;
+    /**
+     * takes the atom in slot i out of the index before it is removed
+     */
+    void _removeFromIndex(int i)const;
     /**
      * Tells you if the number of solvent molecules in the system has changed
      * if so, the accessors should re-expand the Solvent Types.
@@ -1007,14 +1114,34 @@ namespace utils
 };
   //inline functions and methods
 
-  inline std::vector<SpecAtom *> & AtomSpecifier::atom()
+  inline std::vector<SpecAtom *> const & AtomSpecifier::atom()const
   {
-    return d_specatom;
+    if (d_view.size() != d_specatom.size()) {
+      d_view.clear();
+      d_viewSolute.clear();
+      d_viewSolvent.clear();
+      d_viewSolute.reserve(d_specatom.size());
+      d_viewSolvent.reserve(d_specatom.size());
+      for (unsigned int i = 0; i < d_specatom.size(); ++i) {
+        const Id &id = d_specatom[i];
+        if (id.mol >= 0) {
+          d_viewSolute.push_back(SpecAtom(*d_sys, id.mol, id.atom));
+          d_view.push_back(&d_viewSolute.back());
+        } else if (id.mol == -3) {
+          d_view.push_back(&d_virtual[-1 - id.atom]);
+        } else {
+          d_viewSolvent.push_back(SolventSpecAtom(*d_sys, id.mol, id.atom));
+          d_view.push_back(&d_viewSolvent.back());
+        }
+      }
+    }
+    return d_view;
   }
 
-  inline std::vector<SpecAtom *> const & AtomSpecifier::atom()const
+  inline std::vector<SpecAtom *> & AtomSpecifier::atom()
   {
-    return d_specatom;
+    return const_cast<std::vector<SpecAtom *> &>(
+            static_cast<AtomSpecifier const &>(*this).atom());
   }
 
   inline gcore::System *AtomSpecifier::sys()const
@@ -24,12 +24,15 @@
 #include <string>
 #include <iostream>
 #include <cstdlib>
+#include <ctime>
 #include "../gio/InTopology.h"
 #include "../gcore/System.h"
 #include "../gcore/LJException.h"
 #include "../gcore/MoleculeTopology.h"
 #include "../gcore/Molecule.h"
 #include "../gcore/Solvent.h"
+#include "../gcore/SolventTopology.h"
+#include "../gcore/AtomTopology.h"
 #include "../gio/InG96.h"
 #include "AtomSpecifier.h"
 
@@ -39,7 +42,178 @@ using namespace utils;
 
 using namespace std;
 
+// a system of numMol molecules and numSolv three-site solvent molecules
+System makeSystem(int numMol, int numAtoms, int numSolv) {
+  MoleculeTopology mt;
+  AtomTopology at;
+  at.setName("C");
+  for (int i = 0; i < numAtoms; ++i) {
+    mt.addAtom(at);
+    mt.setResNum(i, i / 10);
+  }
+  mt.setResName(0, "RES");
+  SolventTopology st;
+  at.setName("OW");
+  st.addAtom(at);
+  at.setName("HW1");
+  st.addAtom(at);
+  at.setName("HW2");
+  st.addAtom(at);
+  System sys;
+  for (int m = 0; m < numMol; ++m) {
+    sys.addMolecule(Molecule(mt));
+    sys.mol(m).initPos();
+  }
+  sys.addSolvent(Solvent(st));
+  for (int i = 0; i < 3 * numSolv; ++i)
+    sys.sol(0).addPos(gmath::Vec(0.0, 0.0, 0.0));
+  return sys;
+}
+
+// compares the indexed search of the AtomSpecifier with a linear search in a
+// list of (molecule, atom) pairs, with random additions and removals
+void consistency() {
+  System sys = makeSystem(5, 40, 30);
+  AtomSpecifier as(sys);
+  vector<pair<int, int> > model;
+  srand(14);
+  for (int step = 0; step < 20000; ++step) {
+    const int m = rand() % 6 - 1, a = rand() % 40;
+    int found = -1;
+    for (unsigned int i = 0; i < model.size() && found < 0; ++i)
+      if (model[i].first == m && model[i].second == a) found = i;
+    assert(as.findAtom(m, a) == found);
+    switch (rand() % 4) {
+      case 0:
+      case 1:
+        as.addAtom(m, a);
+        if (found < 0) model.push_back(make_pair(m, a));
+        break;
+      case 2:
+        as.removeAtom(m, a);
+        if (found >= 0) model.erase(model.begin() + found);
+        break;
+      default:
+        if (model.size()) {
+          const int i = rand() % model.size();
+          as.removeAtom(i);
+          model.erase(model.begin() + i);
+        }
+    }
+    assert(as.size() == model.size());
+    if (step % 5000 == 4999) {
+      as.sort();
+      for (unsigned int i = 1; i < as.size(); ++i)
+        assert(as.mol(i - 1) < 0 ? as.mol(i) < 0 && as.atom(i - 1) < as.atom(i)
+              : (as.mol(i) < 0 || as.mol(i - 1) < as.mol(i) ||
+              (as.mol(i - 1) == as.mol(i) && as.atom(i - 1) < as.atom(i))));
+      model.clear();
+      for (unsigned int i = 0; i < as.size(); ++i)
+        model.push_back(make_pair(as.mol(i), as.atom(i)));
+    }
+  }
+}
+
+// the SpecAtom view, the copies and the gathered positions agree with the
+// accessors, also for virtual atoms
+void views() {
+  System sys = makeSystem(3, 40, 10);
+  for (int m = 0; m < 3; ++m)
+    for (int a = 0; a < 40; ++a)
+      sys.mol(m).pos(a) = gmath::Vec(m, a, 0.1 * a);
+  for (int i = 0; i < 30; ++i)
+    sys.sol(0).pos(i) = gmath::Vec(-1.0, i, 0.0);
+  AtomSpecifier as(sys, "2:5-9;va(cog,1:1-4);s:OW;1:3");
+  assert(as.size() == 5 + 1 + 10 + 1);
+  assert(as.type(0) == spec_solute && as.type(5) == spec_virtual &&
+          as.type(6) == spec_solvent);
+  assert(as.mol(5) == -3 && as.atom(5) == -1 && as.conf(5).size() == 4);
+  assert(as.pos(5)[0] == 0.0 && as.pos(5)[1] == 1.5);
+
+  AtomSpecifier bs(as);
+  AtomSpecifier cs(sys);
+  cs = as;
+  const vector<gmath::Vec> &pos = bs.gatherPos();
+  assert(pos.size() == as.size());
+  for (unsigned int i = 0; i < as.size(); ++i) {
+    assert(bs.mol(i) == as.mol(i) && bs.atom(i) == as.atom(i));
+    assert(cs.mol(i) == as.mol(i) && cs.atom(i) == as.atom(i));
+    assert(as.atom()[i]->type() == as.type(i));
+    assert(as.atom()[i]->mol() == as.mol(i) && as.atom()[i]->atom() == as.atom(i));
+    assert(pos[i][0] == as.pos(i)[0] && pos[i][1] == as.pos(i)[1] &&
+            pos[i][2] == as.pos(i)[2]);
+  }
+  assert(as.toString()[0] == bs.toString()[0]);
+  assert(as.toString(5) == as.atom()[5]->toString() &&
+          as.toString(5).find(",1:1-4)") != string::npos);
+
+  // copies of the virtual atom are independent of the original
+  as.clear();
+  sys.mol(0).pos(0) = gmath::Vec(4.0, 0.0, 0.0);
+  assert(bs.pos(5)[0] == 1.0 && cs.pos(5)[0] == 1.0);
+}
+
+// selects, searches, sorts and removes 10^6 atoms
+void benchmark() {
+  const int numMol = 100, numAtoms = 5000, numSolv = 166667;
+  System sys = makeSystem(numMol, numAtoms, numSolv);
+  AtomSpecifier as(sys);
+
+  clock_t start = clock();
+  // in reverse order, such that sorting has to do something
+  for (int m = numMol - 1; m >= 0; --m)
+    for (int a = numAtoms - 1; a >= 0; --a)
+      as.addAtom(m, a);
+  as.addSpecifier("s:a");
+  const unsigned int num = as.size();
+  assert(num == unsigned(numMol * numAtoms + 3 * numSolv));
+  const double t_select = double(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (int m = 0; m < numMol; ++m)
+    for (int a = 0; a < numAtoms; a += 10)
+      assert(as.findAtom(m, a) == (numMol - 1 - m) * numAtoms + numAtoms - 1 - a);
+  const double t_find = double(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  as.sort();
+  const double t_sort = double(clock() - start) / CLOCKS_PER_SEC;
+  assert(as.mol(0) == 0 && as.atom(0) == 0);
+  assert(as.mol(numAtoms) == 1 && as.atom(numAtoms) == 0);
+  assert(as.mol(num - 1) < 0);
+
+  start = clock();
+  AtomSpecifier copy(as);
+  const double t_copy = double(clock() - start) / CLOCKS_PER_SEC;
+  assert(copy.size() == num);
+
+  start = clock();
+  for (int i = 0; i < 10; ++i)
+    assert(copy.gatherPos().size() == num);
+  const double t_gather = double(clock() - start) / CLOCKS_PER_SEC / 10;
+
+  start = clock();
+  for (int a = 0; a < numAtoms; a += 2)
+    as.removeAtom(numMol / 2, a);
+  const double t_remove = double(clock() - start) / CLOCKS_PER_SEC;
+  assert(as.size() == num - numAtoms / 2);
+  assert(as.findAtom(numMol / 2, 1) == (numMol / 2) * numAtoms);
+
+  cout << num << " atoms: selected in " << t_select << " s, "
+          << numMol * numAtoms / 10 << " searches in " << t_find << " s, "
+          << "sorted in " << t_sort << " s, "
+          << "copied in " << t_copy << " s, "
+          << "gathered in " << t_gather << " s, "
+          << numAtoms / 2 << " removed in " << t_remove << " s" << endl;
+}
+
 int main(int argc, char *argv[]) {
+  if (argc == 1) {
+    consistency();
+    views();
+    benchmark();
+    return 0;
+  }
   if (argc != 4) {
     cerr << "Usage: " + string(argv[0]) + " <Topology> <atomspecifier> <coordinates>\n";
     exit(1);
@@ -338,8 +338,9 @@ void AtomSpecifier::parse_va(std::string s, int x)
       throw Exception(" Virtual Atom: type not recognised: " + t);
     vt = VirtualAtom::virtual_type(i);
   }
-  d_specatom.push_back(new VirtualSpecAtom(*d_sys, 
+  d_virtual.push_back(VirtualSpecAtom(*d_sys,
           s.substr(it+1, std::string::npos), x, vt));
+  _push(-3, -int(d_virtual.size()));
 }
 
 void AtomSpecifier::parse_minus(std::string s, int x) {
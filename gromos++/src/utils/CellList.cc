@@ -0,0 +1,252 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// utils_CellList.cc
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <vector>
+
+#include "CellList.h"
+#include "../gcore/System.h"
+#include "../gcore/Molecule.h"
+#include "../gcore/MoleculeTopology.h"
+#include "../gcore/AtomTopology.h"
+#include "../gcore/Solvent.h"
+#include "../gcore/SolventTopology.h"
+#include "../gcore/Box.h"
+#include "../bound/Boundary.h"
+#include "../gmath/Vec.h"
+
+using utils::CellList;
+using gmath::Vec;
+
+CellList::CellList(const gcore::System &sys, const bound::Boundary &pbc,
+        double cut, bool chargeGroups) :
+d_type(pbc.type()), d_cut(cut), d_chargeGroups(chargeGroups),
+d_gridded(false), d_periodic(false) {
+  d_n[0] = d_n[1] = d_n[2] = 1;
+
+  if (chargeGroups) {
+    // the solute charge groups, positioned like in 
+    // SimplePairlist::chargeGroupPosition
+    for (int m = 0; m < sys.numMolecules(); m++) {
+      const gcore::Molecule &mol = sys.mol(m);
+      int a1 = -1;
+      int a2 = 0;
+      while (a2 < mol.numAtoms()) {
+        for (; mol.topology().atom(a2).chargeGroup() != 1; a2++);
+        Vec v(0.0, 0.0, 0.0);
+        for (int k = a1 + 1; k <= a2; k++)
+          v += pbc.nearestImage(mol.pos(a1 + 1), mol.pos(k), sys.box());
+        addParticle(v / (a2 - a1), m, a1 + 1, a2 + 1);
+        a1 = a2;
+        a2++;
+      }
+    }
+    // the solvent molecules by their first atom
+    const int nsa = sys.sol(0).topology().numAtoms();
+    for (int i = 0; i < sys.sol(0).numPos(); i += nsa)
+      addParticle(sys.sol(0).pos(i), -1, i, i + nsa);
+  } else {
+    for (int m = 0; m < sys.numMolecules(); m++)
+      for (int a = 0; a < sys.mol(m).numPos(); a++)
+        addParticle(sys.mol(m).pos(a), m, a, a + 1);
+    for (int i = 0; i < sys.sol(0).numPos(); i++)
+      addParticle(sys.sol(0).pos(i), -1, i, i + 1);
+  }
+
+  if (cut > 0.0 && !d_pos.empty())
+    buildGrid(sys);
+}
+
+CellList::CellList(const std::vector<Vec> &pos, const gcore::System &sys,
+        const bound::Boundary &pbc, double cut) :
+d_type(pbc.type()), d_cut(cut), d_chargeGroups(false),
+d_gridded(false), d_periodic(false) {
+  d_n[0] = d_n[1] = d_n[2] = 1;
+  d_pos = pos;
+  d_mol.assign(pos.size(), -1);
+  d_begin.resize(pos.size());
+  d_end.resize(pos.size());
+  for (unsigned int p = 0; p < pos.size(); ++p) {
+    d_begin[p] = p;
+    d_end[p] = p + 1;
+  }
+  if (cut > 0.0 && !d_pos.empty())
+    buildGrid(sys);
+}
+
+void CellList::addParticle(const Vec &pos, int m, int begin, int end) {
+  d_pos.push_back(pos);
+  d_mol.push_back(m);
+  d_begin.push_back(begin);
+  d_end.push_back(end);
+}
+
+void CellList::buildGrid(const gcore::System &sys) {
+  // the cells are made a little wider than the cutoff, such that 
+  // rounding does not hide a particle at the cutoff
+  const double width = d_cut * (1.0 + 1e-8) + 1e-12;
+  Vec edge[3];
+  // the images of every particle (within the cells)
+  std::vector<Vec> shift(1, Vec(0.0, 0.0, 0.0));
+
+  // the boundary types: r (rectangular), c (triclinic), t (truncated
+  // octahedron), v (vacuum)
+  switch (d_type) {
+    case 'r':
+    case 'c':
+      edge[0] = sys.box().K();
+      edge[1] = sys.box().L();
+      edge[2] = sys.box().M();
+      d_periodic = true;
+      break;
+    case 't':
+    {
+      // the cube holds two truncated octahedra
+      const double a = sys.box().K().abs();
+      edge[0] = Vec(a, 0.0, 0.0);
+      edge[1] = Vec(0.0, a, 0.0);
+      edge[2] = Vec(0.0, 0.0, a);
+      shift.push_back(Vec(0.5 * a, 0.5 * a, 0.5 * a));
+      d_periodic = true;
+      break;
+    }
+    case 'v':
+    {
+      // the box around the particles
+      Vec min = d_pos[0], max = d_pos[0];
+      for (unsigned int p = 1; p < d_pos.size(); ++p) {
+        for (int i = 0; i < 3; ++i) {
+          min[i] = std::min(min[i], d_pos[p][i]);
+          max[i] = std::max(max[i], d_pos[p][i]);
+        }
+      }
+      for (int i = 0; i < 3; ++i) {
+        edge[i] = Vec(0.0, 0.0, 0.0);
+        edge[i][i] = std::max(max[i] - min[i], width);
+      }
+      d_origin = min;
+      break;
+    }
+    default:
+      return;
+  }
+
+  // the reciprocal vectors: the fractional coordinates of r are
+  // d_rec[i].dot(r - d_origin), the width of the cell along i is 
+  // 1 / |d_rec[i]|
+  const double volume = edge[0].dot(edge[1].cross(edge[2]));
+  if (!(fabs(volume) > 0.0)) return;
+  for (int i = 0; i < 3; ++i) {
+    d_rec[i] = edge[(i + 1) % 3].cross(edge[(i + 2) % 3]) / volume;
+    const double cells = 1.0 / (d_rec[i].abs() * width);
+    d_n[i] = cells >= 1.0 ? int(std::min(cells, 1e6)) : 1;
+  }
+
+  // not more cells than particles
+  const double entries = double(d_pos.size() * shift.size());
+  while (double(d_n[0]) * d_n[1] * d_n[2] > std::max(27.0, entries)) {
+    int i = 0;
+    if (d_n[1] > d_n[i]) i = 1;
+    if (d_n[2] > d_n[i]) i = 2;
+    d_n[i] = (d_n[i] + 1) / 2;
+  }
+  if (d_periodic && (d_n[0] < 3 || d_n[1] < 3 || d_n[2] < 3)) {
+    d_n[0] = d_n[1] = d_n[2] = 1;
+    return;
+  }
+
+  // sort the particles into the cells (counting sort, such that the 
+  // particles of a cell are in ascending order)
+  const int numCells = d_n[0] * d_n[1] * d_n[2];
+  std::vector<int> cellOf(d_pos.size() * shift.size());
+  d_cellStart.assign(numCells + 1, 0);
+  int index[3];
+  for (unsigned int p = 0; p < d_pos.size(); ++p) {
+    for (unsigned int s = 0; s < shift.size(); ++s) {
+      const int c = cell(d_pos[p] + shift[s], index);
+      cellOf[p * shift.size() + s] = c;
+      ++d_cellStart[c + 1];
+    }
+  }
+  for (int c = 0; c < numCells; ++c)
+    d_cellStart[c + 1] += d_cellStart[c];
+  d_cellParticle.resize(cellOf.size());
+  std::vector<int> fill(d_cellStart.begin(), d_cellStart.end() - 1);
+  for (unsigned int e = 0; e < cellOf.size(); ++e)
+    d_cellParticle[fill[cellOf[e]]++] = e / shift.size();
+
+  d_gridded = true;
+}
+
+int CellList::cell(const Vec &r, int *index)const {
+  const Vec d = r - d_origin;
+  for (int i = 0; i < 3; ++i) {
+    double s = d_rec[i].dot(d);
+    if (d_periodic) s -= floor(s);
+    int k = int(floor(s * d_n[i]));
+    if (k < 0) k = 0;
+    if (k >= d_n[i]) k = d_n[i] - 1;
+    index[i] = k;
+  }
+  return (index[0] * d_n[1] + index[1]) * d_n[2] + index[2];
+}
+
+void CellList::candidates(const Vec &r, std::vector<int> &particles)const {
+  particles.clear();
+  if (!d_gridded) {
+    particles.resize(d_pos.size());
+    for (unsigned int p = 0; p < d_pos.size(); ++p)
+      particles[p] = p;
+    return;
+  }
+
+  int index[3];
+  cell(r, index);
+  int range[3][2];
+  for (int i = 0; i < 3; ++i) {
+    if (d_periodic) {
+      range[i][0] = index[i] - 1;
+      range[i][1] = index[i] + 1;
+    } else {
+      range[i][0] = std::max(index[i] - 1, 0);
+      range[i][1] = std::min(index[i] + 1, d_n[i] - 1);
+    }
+  }
+  for (int i = range[0][0]; i <= range[0][1]; ++i) {
+    const int ci = (i + d_n[0]) % d_n[0];
+    for (int j = range[1][0]; j <= range[1][1]; ++j) {
+      const int cj = (j + d_n[1]) % d_n[1];
+      for (int k = range[2][0]; k <= range[2][1]; ++k) {
+        const int c = (ci * d_n[1] + cj) * d_n[2] + (k + d_n[2]) % d_n[2];
+        particles.insert(particles.end(), d_cellParticle.begin() + d_cellStart[c],
+                d_cellParticle.begin() + d_cellStart[c + 1]);
+      }
+    }
+  }
+  // a truncated octahedron has two images of a particle in the cells
+  std::sort(particles.begin(), particles.end());
+  particles.erase(std::unique(particles.begin(), particles.end()),
+          particles.end());
+}
@@ -0,0 +1,175 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// utils_CellList.h
+
+#ifndef INCLUDED_UTILS_CELLLIST
+#define INCLUDED_UTILS_CELLLIST
+
+#include <vector>
+#include "../gmath/Vec.h"
+
+namespace gcore{
+  class System;
+}
+
+namespace bound{
+  class Boundary;
+}
+
+namespace utils{
+  /**
+   * Class CellList
+   * A grid of cells for the neighbour search of utils::SimplePairlist
+   *
+   * The particles of a configuration (all atoms, or the charge groups
+   * and solvent molecules) are sorted into cells which are at least
+   * as wide as the cutoff, so the particles within the cutoff of a
+   * position are found in the 27 cells around it. The cells span the
+   * unit cell of rectangular and triclinic boxes. For truncated
+   * octahedra they span the cube, which holds two images of every 
+   * particle. In vacuum they span the particles.
+   *
+   * A cell list can also be built over any set of positions, like the
+   * atoms of an utils::AtomSpecifier (used by utils::RDF).
+   *
+   * The cell list only proposes candidates. The caller decides with
+   * the nearest image of the boundary, so the result does not change.
+   * If there are fewer than three cells along an edge, all particles
+   * are candidates.
+   *
+   * @class CellList
+   * @ingroup utils
+   * @sa utils::SimplePairlist
+   */
+  class CellList{
+    char d_type;
+    double d_cut;
+    bool d_chargeGroups;
+
+    // the particles, in the order of the system
+    std::vector<gmath::Vec> d_pos;
+    std::vector<int> d_mol;
+    std::vector<int> d_begin;
+    std::vector<int> d_end;
+
+    // the grid
+    bool d_gridded;
+    bool d_periodic;
+    gmath::Vec d_origin;
+    gmath::Vec d_rec[3];
+    int d_n[3];
+    std::vector<int> d_cellStart;
+    std::vector<int> d_cellParticle;
+    
+  public:
+    /**
+     * Constructor, sorts the particles of the current configuration 
+     * into the cells
+     * @param sys the system
+     * @param pbc its boundary
+     * @param cut the cutoff
+     * @param chargeGroups use the charge groups and solvent molecules
+     *        (centre of geometry of the solute charge groups, first atom 
+     *        of the solvent molecules) instead of the atoms
+     */
+    CellList(const gcore::System &sys, const bound::Boundary &pbc, 
+            double cut, bool chargeGroups);
+    /**
+     * Constructor, sorts a set of positions into the cells, e.g. the
+     * atoms of an utils::AtomSpecifier (see AtomSpecifier::gatherPos).
+     * The particles are the positions, mol() is -1 and begin() the index.
+     * @param pos the positions
+     * @param sys the system, for the box
+     * @param pbc its boundary
+     * @param cut the cutoff
+     */
+    CellList(const std::vector<gmath::Vec> &pos, const gcore::System &sys,
+            const bound::Boundary &pbc, double cut);
+    /**
+     * the cutoff
+     */
+    double cut()const;
+    /**
+     * true if the particles are charge groups and solvent molecules
+     */
+    bool chargeGroups()const;
+    /**
+     * number of particles
+     */
+    int numParticles()const;
+    /**
+     * position of particle p (as in the system, not shifted into the box)
+     */
+    const gmath::Vec &pos(int p)const;
+    /**
+     * molecule of particle p (-1 for solvent)
+     */
+    int mol(int p)const;
+    /**
+     * first atom of particle p
+     */
+    int begin(int p)const;
+    /**
+     * last atom of particle p plus one
+     */
+    int end(int p)const;
+    /**
+     * the particles which may be within the cutoff of r, in ascending 
+     * order
+     */
+    void candidates(const gmath::Vec &r, std::vector<int> &particles)const;
+    
+  private:
+    void addParticle(const gmath::Vec &pos, int m, int begin, int end);
+    void buildGrid(const gcore::System &sys);
+    int cell(const gmath::Vec &r, int *index)const;
+  };
+
+  inline double CellList::cut()const{
+    return d_cut;
+  }
+
+  inline bool CellList::chargeGroups()const{
+    return d_chargeGroups;
+  }
+
+  inline int CellList::numParticles()const{
+    return d_pos.size();
+  }
+
+  inline const gmath::Vec &CellList::pos(int p)const{
+    return d_pos[p];
+  }
+
+  inline int CellList::mol(int p)const{
+    return d_mol[p];
+  }
+
+  inline int CellList::begin(int p)const{
+    return d_begin[p];
+  }
+
+  inline int CellList::end(int p)const{
+    return d_end[p];
+  }
+}
+#endif
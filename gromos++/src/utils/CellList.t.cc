@@ -0,0 +1,231 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// utils_CellList.t.cc
+
+// compares the pairlists of SimplePairlist (cell list) with a loop over
+// all atoms for rectangular, triclinic, truncated octahedral and vacuum
+// boundaries and both cutoff schemes, and times them. A cell list over
+// a set of positions has to propose all positions within the cutoff.
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <ctime>
+#include <set>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "CellList.h"
+#include "SimplePairlist.h"
+#include "AtomSpecifier.h"
+#include "../gcore/System.h"
+#include "../gcore/Molecule.h"
+#include "../gcore/MoleculeTopology.h"
+#include "../gcore/AtomTopology.h"
+#include "../gcore/Solvent.h"
+#include "../gcore/SolventTopology.h"
+#include "../gcore/Box.h"
+#include "../bound/Boundary.h"
+#include "../bound/RectBox.h"
+#include "../bound/Triclinic.h"
+#include "../bound/TruncOct.h"
+#include "../bound/Vacuum.h"
+#include "../gmath/Vec.h"
+
+using namespace std;
+using namespace gcore;
+using namespace utils;
+using gmath::Vec;
+
+const int numSolute = 600, numSolvent = 2000;
+const double edge = 4.0;
+
+double random(double range) {
+  return range * rand() / RAND_MAX;
+}
+
+System makeSystem(const Box &box) {
+  MoleculeTopology mt;
+  AtomTopology at;
+  for (int i = 0; i < numSolute; ++i) {
+    at.setChargeGroup(i % 3 == 2 || i == numSolute - 1 ? 1 : 0);
+    mt.addAtom(at);
+    mt.setResNum(i, i / 10);
+  }
+  SolventTopology st;
+  at.setChargeGroup(0);
+  st.addAtom(at);
+  st.addAtom(at);
+  st.addAtom(at);
+  System sys;
+  sys.addMolecule(Molecule(mt));
+  sys.addSolvent(Solvent(st));
+  sys.mol(0).initPos();
+  srand(7);
+  const Vec K = box.K(), L = box.L(), M = box.M();
+  for (int a = 0; a < numSolute; ++a)
+    sys.mol(0).pos(a) = K * random(1.0) + L * random(1.0) + M * random(1.0);
+  for (int m = 0; m < numSolvent; ++m) {
+    // some molecules outside of the box
+    const Vec o = K * random(1.4) + L * random(1.4) + M * random(1.4) - 
+            (K + L + M) * 0.2;
+    sys.sol(0).addPos(o);
+    sys.sol(0).addPos(o + Vec(0.1, 0.0, 0.0));
+    sys.sol(0).addPos(o + Vec(-0.033, 0.094, 0.0));
+  }
+  sys.box() = box;
+  return sys;
+}
+
+// the pairlist as calculated before there were cell lists
+void reference(System &sys, bound::Boundary &pbc, double cut, bool cgb,
+        SpecAtom &atom, AtomSpecifier &pl) {
+  const double cut2 = cut * cut;
+  Vec ri = atom.pos();
+  if (cgb) {
+    if (atom.type() == spec_solvent) {
+      ri = sys.sol(0).pos(atom.atom() / 3 * 3);
+    } else {
+      int b = atom.atom(), e = atom.atom();
+      while (b > 0 && sys.mol(0).topology().atom(b - 1).chargeGroup() != 1) --b;
+      while (sys.mol(0).topology().atom(e).chargeGroup() != 1) ++e;
+      ri = Vec(0.0, 0.0, 0.0);
+      for (int k = b; k <= e; ++k)
+        ri += pbc.nearestImage(sys.mol(0).pos(b), sys.mol(0).pos(k), sys.box());
+      ri /= (e - b + 1);
+    }
+  }
+  for (int a = 0; a < numSolute; ) {
+    int e = a;
+    if (cgb) while (sys.mol(0).topology().atom(e).chargeGroup() != 1) ++e;
+    Vec v = sys.mol(0).pos(a);
+    if (cgb) {
+      v = Vec(0.0, 0.0, 0.0);
+      for (int k = a; k <= e; ++k)
+        v += pbc.nearestImage(sys.mol(0).pos(a), sys.mol(0).pos(k), sys.box());
+      v /= (e - a + 1);
+    }
+    if ((ri - pbc.nearestImage(ri, v, sys.box())).abs2() <= cut2)
+      for (int k = a; k <= e; ++k) pl.addAtom(0, k);
+    a = e + 1;
+  }
+  const int nsa = cgb ? 3 : 1;
+  for (int i = 0; i < sys.sol(0).numPos(); i += nsa) {
+    if ((ri - pbc.nearestImage(ri, sys.sol(0).pos(i), sys.box())).abs2() <= cut2)
+      for (int k = i; k < i + nsa; ++k) pl.addAtom(-1, k);
+  }
+  pl.removeAtom(atom.mol(), atom.atom());
+}
+
+void check(const string &name, const Box &box, char type, double cut) {
+  System sys = makeSystem(box);
+  bound::Boundary *pbc;
+  switch (type) {
+    case 'r': pbc = new bound::RectBox(&sys); break;
+    case 'c': pbc = new bound::Triclinic(&sys); break;
+    case 't': pbc = new bound::TruncOct(&sys); break;
+    default: pbc = new bound::Vacuum(&sys);
+  }
+  for (int cgb = 0; cgb < 2; ++cgb) {
+    AtomSpecifier atoms(sys);
+    for (int a = 0; a < numSolute; a += 7) atoms.addAtom(0, a);
+    for (int a = 0; a < 3 * numSolvent; a += 31) atoms.addAtom(-1, a);
+
+    clock_t start = clock();
+    vector<AtomSpecifier> ref(atoms.size(), AtomSpecifier(sys));
+    for (unsigned int i = 0; i < atoms.size(); ++i)
+      reference(sys, *pbc, cut, cgb, *atoms.atom()[i], ref[i]);
+    const double t_ref = double(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    unsigned int pairs = 0;
+    for (unsigned int i = 0; i < atoms.size(); ++i) {
+      SimplePairlist pl(sys, *pbc, cut);
+      pl.setType(cgb ? "CHARGEGROUP" : "ATOMIC");
+      pl.setAtom(*atoms.atom()[i]);
+      pl.calc();
+      assert(pl.size() == ref[i].size());
+      for (unsigned int j = 0; j < pl.size(); ++j)
+        assert(pl.mol(j) == ref[i].mol(j) && pl.atom(j) == ref[i].atom(j));
+      pairs += pl.size();
+    }
+    const double t_cells = double(clock() - start) / CLOCKS_PER_SEC;
+
+    // with a cell list built once
+    start = clock();
+    const CellList cells(sys, *pbc, cut, cgb);
+    for (unsigned int i = 0; i < atoms.size(); ++i) {
+      SimplePairlist pl(sys, *pbc, cut);
+      pl.setType(cgb ? "CHARGEGROUP" : "ATOMIC");
+      pl.setAtom(*atoms.atom()[i]);
+      pl.calc(cells);
+      assert(pl.size() == ref[i].size());
+    }
+    const double t_once = double(clock() - start) / CLOCKS_PER_SEC;
+
+    // a cell list over the positions of the atoms (as in utils::RDF)
+    if (!cgb) {
+      const vector<Vec> pos = atoms.gatherPos();
+      const CellList poscells(pos, sys, *pbc, cut);
+      vector<int> cand;
+      for (unsigned int i = 0; i < pos.size(); ++i) {
+        poscells.candidates(pos[i], cand);
+        for (unsigned int j = 0; j < pos.size(); ++j) {
+          if ((pos[i] - pbc->nearestImage(pos[i], pos[j], sys.box())).abs() <= cut)
+            assert(binary_search(cand.begin(), cand.end(), int(j)));
+        }
+      }
+    }
+
+    cout << name << (cgb ? " charge groups" : " atomic       ") 
+            << ": " << pairs << " pairs, " << t_ref << " s (all atoms), " 
+            << t_cells << " s (cell list), " << t_once 
+            << " s (shared cell list)" << endl;
+  }
+  delete pbc;
+}
+
+int main() {
+  Box rect(edge, 1.1 * edge, 0.9 * edge);
+  rect.setNtb(Box::rectangular);
+  check("rectangular", rect, 'r', 0.8);
+  check("rectangular", rect, 'r', 1.4);
+
+  Box tric(Vec(edge, 0.0, 0.0), Vec(0.3 * edge, edge, 0.0), 
+          Vec(0.2 * edge, -0.25 * edge, edge));
+  tric.setNtb(Box::triclinic);
+  tric.update_triclinic();
+  check("triclinic  ", tric, 'c', 0.8);
+  check("triclinic  ", tric, 'c', 1.4);
+
+  Box oct(1.3 * edge, 1.3 * edge, 1.3 * edge);
+  oct.setNtb(Box::truncoct);
+  check("truncoct   ", oct, 't', 0.8);
+  check("truncoct   ", oct, 't', 1.4);
+
+  // few cells: all atoms are candidates
+  check("small box  ", Box(2.5, 2.5, 2.5), 'r', 1.0);
+
+  check("vacuum     ", rect, 'v', 0.8);
+  return 0;
+}
@@ -49,6 +49,7 @@
 #include "../gcore/MoleculeTopology.h"
 #include "AtomSpecifier.h"
 #include "SimplePairlist.h"
+#include "CellList.h"
 #include "PropertyContainer.h"
 #include "Property.h"
 
@@ -402,7 +403,7 @@ namespace utils {
     // neighbours
 
     for (unsigned int i = 0; i < d_as->size(); i++) {
-      if (d_as->atom()[i]->type() == spec_virtual)
+      if (d_as->type(i) == spec_virtual)
         throw gromos::Exception("Energy", "Cannot calculate energy for a virtual atom");
 
       std::set<int> ex, third;
@@ -442,7 +443,7 @@ namespace utils {
       d_el_s.push_back(0.0);
 
       SimplePairlist spl(*d_sys, *d_pbc, d_cut);
-      spl.setAtom(*d_as->atom()[i]);
+      spl.setAtom(*d_as, i);
 
       //  spl.setAtom(m,a);
       spl.setType("CHARGEGROUP");
@@ -873,13 +874,16 @@ namespace utils {
       throw Energy::Exception(
         " Cannot calculate pairlist without setting atoms first");
     const int size = d_pl.size();
+    if (!size) return;
+    // one cell list for the pairlists of all atoms
+    const CellList cells(*d_sys, *d_pbc, d_cut, d_pl[0].chargeGroupBased());
 #ifdef OMP
 #pragma omp parallel for
 #endif
     for (int i = 0; i < size; ++i) {
       d_pl[i].setCutOff(d_cut);
       d_pl[i].clear();
-      d_pl[i].calc();
+      d_pl[i].calc(cells);
       d_pl[i].removeExclusions();
     }
   }
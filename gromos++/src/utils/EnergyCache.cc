@@ -0,0 +1,252 @@
+/*
+ * This file is part of GROMOS.
+ *
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ *
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// utils_EnergyCache.cc
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "EnergyCache.h"
+#include "EnergyTraj.h"
+#include "../gromos/Exception.h"
+
+using utils::EnergyCache;
+using utils::EnergyIndex;
+
+// frames collected in memory while writing
+static const unsigned int chunk_size = 4096;
+// alignment of the data
+static const std::streamoff page_size = 4096;
+// written after the header to check the byte order
+static const double check_value = 1234.5;
+
+EnergyCache::EnergyCache(EnergyTraj & etrj)
+  : d_etrj(etrj), d_frames(0), d_data(0), d_chunk_frames(0),
+    d_writing(false)
+{
+}
+
+EnergyCache::~EnergyCache()
+{
+  if (d_writing) {
+    d_stream.close();
+    std::remove((d_file + ".tmp").c_str());
+  }
+}
+
+void EnergyCache::create(std::string file)
+{
+  d_file = file;
+  d_columns.clear();
+  d_etrj.elements(d_columns);
+  if (d_columns.empty())
+    throw gromos::Exception("EnergyCache", "no data read yet, cannot "
+			    "create " + file);
+
+  d_frames = 0;
+  d_chunk_frames = 0;
+  d_chunks.clear();
+  d_chunk.resize(d_columns.size() * chunk_size);
+
+  d_stream.open((file + ".tmp").c_str(), std::ios::out | std::ios::trunc |
+		std::ios::binary);
+  if (!d_stream)
+    throw gromos::Exception("EnergyCache", "could not open " + file +
+			    ".tmp for writing");
+  d_writing = true;
+}
+
+void EnergyCache::add_frame()
+{
+  if (!d_writing)
+    throw gromos::Exception("EnergyCache", "cache not open for writing");
+
+  for (unsigned int c = 0; c < d_columns.size(); ++c)
+    d_chunk[c * chunk_size + d_chunk_frames] = d_etrj[d_columns[c]];
+  ++d_frames;
+  if (++d_chunk_frames == chunk_size) flush();
+}
+
+void EnergyCache::flush()
+{
+  if (d_chunk_frames == 0) return;
+  for (unsigned int c = 0; c < d_columns.size(); ++c)
+    d_stream.write(reinterpret_cast<const char *>(&d_chunk[c * chunk_size]),
+		   d_chunk_frames * sizeof(double));
+  if (!d_stream)
+    throw gromos::Exception("EnergyCache", "could not write to " + d_file +
+			    ".tmp");
+  d_chunks.push_back(d_chunk_frames);
+  d_chunk_frames = 0;
+}
+
+void EnergyCache::close()
+{
+  if (!d_writing) return;
+  flush();
+  d_stream.close();
+
+  // the header
+  std::ostringstream os;
+  os << "GROMOS ENERGY CACHE 1\n"
+     << "FRAMES " << d_frames << "\n";
+  std::string layout = d_etrj.layout();
+  os << "LAYOUT " << std::count(layout.begin(), layout.end(), '\n') << "\n"
+     << layout
+     << "COLUMNS " << d_columns.size() << "\n";
+  for (unsigned int c = 0; c < d_columns.size(); ++c)
+    os << d_etrj.return_blockname(d_columns[c].block) << " "
+       << d_columns[c].i + 1 << " " << d_columns[c].j + 1 << "\n";
+  os << "END\n";
+  std::string header = os.str();
+  d_data = ((header.size() + sizeof(double)) / page_size + 1) * page_size;
+
+  std::ofstream out(d_file.c_str(), std::ios::out | std::ios::trunc |
+		    std::ios::binary);
+  if (!out)
+    throw gromos::Exception("EnergyCache", "could not open " + d_file +
+			    " for writing");
+  out.write(header.c_str(), header.size());
+  out.write(reinterpret_cast<const char *>(&check_value), sizeof(double));
+  std::vector<char> pad(d_data - header.size() - sizeof(double), 0);
+  out.write(&pad[0], pad.size());
+
+  // sort the chunks into columns
+  std::ifstream in((d_file + ".tmp").c_str(), std::ios::in |
+		   std::ios::binary);
+  std::vector<double> buffer(chunk_size);
+  for (unsigned int c = 0; c < d_columns.size(); ++c) {
+    std::streamoff chunk_start = 0;
+    for (unsigned int k = 0; k < d_chunks.size(); ++k) {
+      in.seekg((chunk_start + std::streamoff(c) * d_chunks[k]) *
+	       std::streamoff(sizeof(double)));
+      in.read(reinterpret_cast<char *>(&buffer[0]),
+	      d_chunks[k] * sizeof(double));
+      out.write(reinterpret_cast<const char *>(&buffer[0]),
+		d_chunks[k] * sizeof(double));
+      chunk_start += std::streamoff(d_chunks[k]) * d_columns.size();
+    }
+  }
+  if (!in || !out)
+    throw gromos::Exception("EnergyCache", "could not write " + d_file);
+  in.close();
+  out.close();
+  std::remove((d_file + ".tmp").c_str());
+  d_writing = false;
+}
+
+void EnergyCache::open(std::string file)
+{
+  d_file = file;
+  d_stream.open(file.c_str(), std::ios::in | std::ios::binary);
+  if (!d_stream)
+    throw gromos::Exception("EnergyCache", "could not open " + file);
+
+  std::string line, key;
+  std::getline(d_stream, line);
+  if (line != "GROMOS ENERGY CACHE 1")
+    throw gromos::Exception("EnergyCache", file + " is not an energy cache");
+
+  unsigned int num = 0;
+  std::getline(d_stream, line);
+  std::istringstream is(line);
+  if (!(is >> key >> d_frames) || key != "FRAMES")
+    throw gromos::Exception("EnergyCache", "FRAMES expected in " + file);
+
+  std::getline(d_stream, line);
+  is.clear();
+  is.str(line);
+  if (!(is >> key >> num) || key != "LAYOUT")
+    throw gromos::Exception("EnergyCache", "LAYOUT expected in " + file);
+  std::string layout;
+  for (unsigned int i = 0; i < num && std::getline(d_stream, line); ++i)
+    layout += line + "\n";
+  if (layout != d_etrj.layout())
+    throw gromos::Exception("EnergyCache", file + " was written with a "
+			    "library with different block definitions");
+
+  std::getline(d_stream, line);
+  is.clear();
+  is.str(line);
+  if (!(is >> key >> num) || key != "COLUMNS")
+    throw gromos::Exception("EnergyCache", "COLUMNS expected in " + file);
+  d_columns.resize(num);
+  for (unsigned int c = 0; c < num; ++c) {
+    std::getline(d_stream, line);
+    is.clear();
+    is.str(line);
+    std::string block;
+    if (!(is >> block >> d_columns[c].i >> d_columns[c].j))
+      throw gromos::Exception("EnergyCache", "could not read element in " +
+			      file + ": " + line);
+    d_columns[c].block = d_etrj.return_blockindex(block);
+    --d_columns[c].i;
+    --d_columns[c].j;
+  }
+  std::getline(d_stream, line);
+  if (line != "END")
+    throw gromos::Exception("EnergyCache", "END expected in " + file);
+
+  double check = 0.0;
+  d_stream.read(reinterpret_cast<char *>(&check), sizeof(double));
+  if (!d_stream || check != check_value)
+    throw gromos::Exception("EnergyCache", file + " was written on a "
+			    "machine with a different byte order");
+  d_data = (std::streamoff(d_stream.tellg()) / page_size + 1) * page_size;
+}
+
+int EnergyCache::column(EnergyIndex const & ei)
+{
+  for (unsigned int c = 0; c < d_columns.size(); ++c)
+    if (d_columns[c] == ei) return c;
+  return -1;
+}
+
+void EnergyCache::columns(std::vector<EnergyIndex> const & l,
+			  std::vector<std::vector<double> > & columns)
+{
+  columns.resize(l.size());
+  for (unsigned int k = 0; k < l.size(); ++k) {
+    // constants
+    if (l[k].block == 0) {
+      columns[k].assign(d_frames, d_etrj[l[k]]);
+      continue;
+    }
+    int c = column(l[k]);
+    if (c < 0) {
+      std::ostringstream os;
+      os << d_etrj.return_blockname(l[k].block) << "[" << l[k].i + 1
+	 << "][" << l[k].j + 1 << "] is not in " << d_file;
+      throw gromos::Exception("EnergyCache", os.str());
+    }
+    columns[k].resize(d_frames);
+    if (d_frames == 0) continue;
+    d_stream.clear();
+    d_stream.seekg(d_data + std::streamoff(c) * d_frames *
+		   std::streamoff(sizeof(double)));
+    d_stream.read(reinterpret_cast<char *>(&columns[k][0]),
+		  d_frames * sizeof(double));
+    if (!d_stream)
+      throw gromos::Exception("EnergyCache", "could not read from " + d_file);
+  }
+}
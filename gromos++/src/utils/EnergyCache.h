@@ -0,0 +1,140 @@
+/*
+ * This file is part of GROMOS.
+ *
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ *
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// utils_EnergyCache.h
+
+#ifndef INCLUDED_UTILS_ENERGYCACHE
+#define INCLUDED_UTILS_ENERGYCACHE
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include "EnergyTraj.h"
+
+namespace utils{
+
+  /**
+   * Class EnergyCache
+   * A binary, column-wise copy of (free) energy trajectories
+   *
+   * Reading the text trajectories is dominated by parsing the numbers of
+   * all blocks of every frame, also if only a few of them are needed. The
+   * cache stores every element of the data array of an EnergyTraj
+   * (e.g. ENER[3] or NONBONDED[2][1]) as one contiguous array over all
+   * frames, such that an analysis only reads the elements it uses.
+   *
+   * The file starts with a text header (number of frames, the block
+   * definitions of the library used to write it and the list of elements),
+   * followed by the data in native byte order. The data starts at a
+   * multiple of 4096 bytes, column c at offset
+   * @f$ \mathrm{data} + 8 c N_{\mathrm{frames}} @f$, so the file can also
+   * be memory mapped. A cache can only be read with a library that has the
+   * same block definitions.
+   *
+   * When writing, the elements are taken from the first frame; the frames
+   * are collected in chunks in a temporary file and sorted into columns by
+   * close().
+   *
+   * @class EnergyCache
+   * @ingroup utils
+   */
+  class EnergyCache
+  {
+  public:
+    /**
+     * Constructor
+     * @param etrj the energy trajectory that defines the library and
+     *             provides the values when writing
+     */
+    EnergyCache(EnergyTraj & etrj);
+    /**
+     * Destructor
+     */
+    ~EnergyCache();
+    /**
+     * start writing a cache. The elements stored are the ones read in the
+     * current frame of the energy trajectory.
+     */
+    void create(std::string file);
+    /**
+     * add the current frame of the energy trajectory
+     */
+    void add_frame();
+    /**
+     * finish writing the cache
+     */
+    void close();
+    /**
+     * open a cache for reading
+     */
+    void open(std::string file);
+    /**
+     * the number of frames (written or in the opened cache)
+     */
+    unsigned int numFrames()const { return d_frames; }
+    /**
+     * the number of elements per frame
+     */
+    unsigned int numColumns()const { return d_columns.size(); }
+    /**
+     * read the values of the elements l for all frames. Constants
+     * (e.g. MASS) are taken from the energy trajectory.
+     * @param l elements of the data array (see EnergyTraj::leaves)
+     * @param columns the values (columns[k][frame] for l[k])
+     */
+    void columns(std::vector<EnergyIndex> const & l,
+		 std::vector<std::vector<double> > & columns);
+
+  private:
+    /**
+     * write the collected frames to the temporary file
+     */
+    void flush();
+    /**
+     * the column of element ei, -1 if it is not in the cache
+     */
+    int column(EnergyIndex const & ei);
+
+    EnergyTraj & d_etrj;
+    std::string d_file;
+    /**
+     * the elements stored in the cache
+     */
+    std::vector<EnergyIndex> d_columns;
+    unsigned int d_frames;
+    /**
+     * start of the data in the file
+     */
+    std::streamoff d_data;
+    /**
+     * frames collected for writing (column-wise) and their number
+     */
+    std::vector<double> d_chunk;
+    unsigned int d_chunk_frames;
+    /**
+     * the number of frames in the chunks of the temporary file
+     */
+    std::vector<unsigned int> d_chunks;
+    std::fstream d_stream;
+    bool d_writing;
+  };
+}
+
+#endif
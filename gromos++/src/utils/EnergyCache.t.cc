@@ -0,0 +1,137 @@
+/*
+ * This file is part of GROMOS.
+ *
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ *
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// utils_EnergyCache.t.cc
+
+// writes a cache of a small energy trajectory (more frames than fit in
+// one chunk), reopens it and compares the columns with the values of the
+// trajectory, then checks that a library with other block definitions
+// cannot read it.
+
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "EnergyCache.h"
+#include "EnergyTraj.h"
+#include "../gio/Ginstream.h"
+#include "../gromos/Exception.h"
+
+using namespace std;
+using namespace utils;
+
+const unsigned int num_frames = 5000;
+const int num = 2;
+
+// the value of element c in frame f, exactly representable
+double value(unsigned int f, unsigned int c) {
+  return f + 0.125 * c;
+}
+
+void library(EnergyTraj &etrj, int totals) {
+  ostringstream os;
+  os << "subblock TOTALS " << totals << " 1";
+  etrj.addBlock("block ENERGY03", "ENERTRJ");
+  etrj.addBlock(os.str(), "ENERTRJ");
+  etrj.addBlock("size NUM", "ENERTRJ");
+  etrj.addBlock("subblock PAIRS NUM 2", "ENERTRJ");
+}
+
+int main() {
+  const string file = "EnergyCache.t.cache";
+  try {
+    // the trajectory: 3 totals and num x 2 pairs per frame
+    const unsigned int num_columns = 3 + num * 2;
+    ostringstream traj;
+    traj.precision(12);
+    traj << "TITLE\nenergy cache test\nEND\n";
+    for (unsigned int f = 0; f < num_frames; ++f) {
+      traj << "ENERGY03\n";
+      for (unsigned int c = 0; c < 3; ++c)
+        traj << value(f, c) << "\n";
+      traj << num << "\n";
+      for (unsigned int c = 3; c < num_columns; ++c)
+        traj << value(f, c) << "\n";
+      traj << "END\n";
+    }
+
+    EnergyTraj etrj;
+    library(etrj, 3);
+    istringstream is(traj.str());
+    gio::Ginstream gin;
+    gin.stream(is);
+
+    EnergyCache cache(etrj);
+    assert(etrj.read_frame(gin, "ENERTRJ") == 0);
+    cache.create(file);
+    assert(cache.numColumns() == num_columns);
+    do {
+      cache.add_frame();
+    } while (etrj.read_frame(gin, "ENERTRJ") == 0);
+    cache.close();
+    assert(cache.numFrames() == num_frames);
+
+    // reopen and compare all columns
+    vector<EnergyIndex> l;
+    etrj.elements(l);
+    assert(l.size() == num_columns);
+
+    EnergyCache in(etrj);
+    in.open(file);
+    assert(in.numFrames() == num_frames);
+    assert(in.numColumns() == num_columns);
+    vector<vector<double> > columns;
+    in.columns(l, columns);
+    assert(columns.size() == num_columns);
+    for (unsigned int c = 0; c < num_columns; ++c) {
+      assert(columns[c].size() == num_frames);
+      for (unsigned int f = 0; f < num_frames; ++f)
+        assert(columns[c][f] == value(f, c));
+    }
+
+    // a single column, read out of order
+    vector<EnergyIndex> one(1, l[num_columns - 1]);
+    in.columns(one, columns);
+    assert(columns.size() == 1);
+    assert(columns[0][num_frames - 1] == value(num_frames - 1, num_columns - 1));
+
+    // a library with other block definitions cannot read the cache
+    EnergyTraj other;
+    library(other, 4);
+    EnergyCache wrong(other);
+    bool thrown = false;
+    try {
+      wrong.open(file);
+    } catch (const gromos::Exception &e) {
+      thrown = true;
+    }
+    assert(thrown);
+  } catch (const gromos::Exception &e) {
+    cerr << e.what() << endl;
+    remove(file.c_str());
+    return 1;
+  }
+  remove(file.c_str());
+  cout << "EnergyCache: " << num_frames << " frames read back" << endl;
+  return 0;
+}
@@ -129,10 +129,8 @@ double EnergyTraj::value(EnergyIndex const & ei)
 			      "unknown to me");
     
     if(d_recalc[ind]){
-      std::vector<double> v;
       for(unsigned int k=0; k<ei.dep.size(); k++)
-	v.push_back(value(ei.dep[k]));
-      d_e[ind].setValues(v);   
+	d_e[ind].setValue(k, value(ei.dep[k]));
       //      d_e[ind].writeExpressionValue(std::cout);
 
       d_recalc[ind]=false;
@@ -151,6 +149,79 @@ double EnergyTraj::operator[](std::string s)
   return value(ei);
 }
 
+double EnergyTraj::operator[](utils::EnergyIndex const & ei)
+{
+  return value(ei);
+}
+
+utils::EnergyIndex EnergyTraj::resolve(std::string s)
+{
+  utils::EnergyIndex ei = index(s);
+  if(ei.i == unknownvariable) 
+    throw gromos::Exception("EnergyTrajectory", 
+			    "Trying to access an unknown variable " +s);
+  return ei;
+}
+
+void EnergyTraj::leaves(utils::EnergyIndex const & ei, 
+			std::vector<utils::EnergyIndex> & l)
+{
+  if(ei.block>=0){
+    if(std::find(l.begin(), l.end(), ei) == l.end())
+      l.push_back(ei);
+  }
+  else{
+    for(unsigned int k=0; k<ei.dep.size(); k++)
+      leaves(ei.dep[k], l);
+  }
+}
+
+void EnergyTraj::values(utils::EnergyIndex const & ei, 
+			std::vector<utils::EnergyIndex> const & l,
+			std::vector<std::vector<double> > const & columns,
+			std::vector<double> & res)
+{
+  const unsigned int n = res.size();
+  if(n == 0) return;
+  
+  if(ei.block>=0){
+    std::vector<utils::EnergyIndex>::const_iterator it = 
+      std::find(l.begin(), l.end(), ei);
+    if(it == l.end())
+      throw gromos::Exception("EnergyTraj", "Variable " + back_index(ei) +
+			      " is not in the list of data elements");
+    std::vector<double> const & c = columns[it - l.begin()];
+    if(c.size() < n)
+      throw gromos::Exception("EnergyTraj", "Not enough frames stored for " +
+			      back_index(ei));
+    std::copy(c.begin(), c.begin() + n, res.begin());
+    return;
+  }
+
+  int ind = -ei.block -1;
+  if(ind >= int(d_e.size()))
+    throw gromos::Exception("EnergyTraj", 
+			    "Trying to calculate an expression that is "
+			    "unknown to me");
+
+  // the columns of the dependencies, expressions are calculated first
+  std::vector<std::vector<double> > dep(ei.dep.size());
+  std::vector<const double *> v(ei.dep.size());
+  for(unsigned int k=0; k<ei.dep.size(); k++){
+    if(ei.dep[k].block >= 0){
+      std::vector<utils::EnergyIndex>::const_iterator it = 
+	std::find(l.begin(), l.end(), ei.dep[k]);
+      if(it != l.end() && columns[it - l.begin()].size() >= n){
+	v[k] = &columns[it - l.begin()][0];
+	continue;
+      }
+    }
+    dep[k].resize(n);
+    values(ei.dep[k], l, columns, dep[k]);
+    v[k] = &dep[k][0];
+  }
+  d_e[ind].values(v, n, &res[0]);
+}
 
 bool EnergyTraj::value_ifpossible(utils::EnergyIndex const & ei, double &val, std::string prop)
 {  
@@ -749,3 +820,44 @@ int EnergyTraj::return_blockindex(std::string block_name) {
   }
   return d_block_map[block_name];
 }
+
+std::string EnergyTraj::return_blockname(int block_index) {
+  std::map<std::string, int>::const_iterator it = d_block_map.begin(),
+    to = d_block_map.end();
+  for(; it != to; ++it)
+    if(it->second == block_index) return it->first;
+  std::ostringstream os;
+  os << "Unknown block index " << block_index;
+  throw gromos::Exception("EnergyTraj", os.str());
+}
+
+std::string EnergyTraj::layout() {
+  std::ostringstream os;
+  std::map<std::string, int>::const_iterator it = d_file_map.begin(),
+    to = d_file_map.end();
+  for(; it != to; ++it){
+    const std::vector<EnergyBlock> & b = d_blocks[it->second];
+    for(unsigned int i=0; i<b.size(); i++){
+      os << it->first << " " << b[i].blockname << " " << b[i].first_type;
+      if(b[i].first_type != EnergyBlock::block)
+	os << " " << b[i].first_size << " " << b[i].second_type
+	   << " " << b[i].second_size;
+      os << "\n";
+    }
+  }
+  return os.str();
+}
+
+void EnergyTraj::elements(std::vector<EnergyIndex> & l) {
+  for(unsigned int b=1; b<d_data.size(); b++){
+    for(unsigned int i=0; i<d_data[b].size(); i++){
+      for(unsigned int j=0; j<d_data[b][i].size(); j++){
+	EnergyIndex ei;
+	ei.block = b;
+	ei.i = i;
+	ei.j = j;
+	l.push_back(ei);
+      }
+    }
+  }
+}
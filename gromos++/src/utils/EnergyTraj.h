@@ -268,6 +268,35 @@ namespace utils{
        * function addKnown
        */
       double operator[](std::string s);
+      /**
+       * Accessor to get the element in the data set that is referred to by
+       * an index obtained from resolve. This avoids looking up the name in
+       * every frame.
+       */
+      double operator[](EnergyIndex const & ei);
+      /**
+       * A function that resolves the name s (see operator[]) to an index
+       * once. Throws if the name is unknown.
+       */
+      EnergyIndex resolve(std::string s);
+      /**
+       * A function that adds the elements of the data array which the
+       * property ei is calculated from (ei itself if it is not an expression)
+       * to the list l, unless they are already in there.
+       */
+      void leaves(EnergyIndex const & ei, std::vector<EnergyIndex> & l);
+      /**
+       * A function that calculates the property ei for a batch of frames at
+       * once.
+       * @param ei the property
+       * @param l the list of elements of the data array (see leaves)
+       * @param columns the values of the elements in l for every frame of
+       *                the batch (columns[k][frame] for l[k])
+       * @param res the results, res.size() frames are calculated
+       */
+      void values(EnergyIndex const & ei, std::vector<EnergyIndex> const & l,
+		  std::vector<std::vector<double> > const & columns,
+		  std::vector<double> & res);
       /**
        * function to read in one frame from the energy trajectory.
        */
@@ -361,6 +390,23 @@ namespace utils{
       void clear_data();
       
       int find_property(std::string prop);
+
+      /**
+       * A function that returns the block definitions of the library
+       * (one line per block or subblock, for every file type). Used as the
+       * key of the cache files (see EnergyCache).
+       */
+      std::string layout();
+      /**
+       * A function that adds all elements of the data array that were read
+       * in the current frame (not the constants) to the list l.
+       */
+      void elements(std::vector<EnergyIndex> & l);
+      /**
+       * A function that returns the name of the data block with the
+       * given index (the inverse of return_blockindex)
+       */
+      std::string return_blockname(int block_index);
       
     private:
       /**
@@ -0,0 +1,179 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// utils_FrameLoop.cc
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#ifdef OMP
+#include <omp.h>
+#endif
+
+#include "FrameLoop.h"
+#include "groTime.h"
+#include "../args/Arguments.h"
+#include "../args/BoundaryParser.h"
+#include "../bound/Boundary.h"
+#include "../gcore/System.h"
+#include "../gmath/Vec.h"
+#include "../gio/InG96Prefetch.h"
+
+using utils::FrameLoop;
+using utils::FrameTask;
+using gcore::System;
+using bound::Boundary;
+
+class utils::FrameLoop_i {
+public:
+  // a frame which is analysed by a clone of the task
+  struct Slot {
+    System *sys;
+    Boundary *pbc;
+    FrameTask *task;
+    utils::Time time;
+    std::exception_ptr error;
+  };
+
+  const args::Arguments &d_args;
+  System &d_sys;
+  Boundary *d_pbc;
+  Boundary::MemPtr d_gathmethod;
+  utils::Time &d_time;
+  int d_skip;
+  int d_stride;
+  int d_batch;
+  std::string d_select;
+  std::vector<std::string> d_files;
+
+  FrameLoop_i(const args::Arguments &args, System &sys, Boundary *pbc,
+          Boundary::MemPtr gathmethod, utils::Time &time) :
+  d_args(args), d_sys(sys), d_pbc(pbc), d_gathmethod(gathmethod),
+  d_time(time), d_skip(0), d_stride(1), d_batch(1), d_select("SOLUTE") {
+  }
+
+  // these methods need the previous frame
+  bool serialGather() const {
+    return d_gathmethod == &Boundary::gathertime ||
+            d_gathmethod == &Boundary::gatherltime ||
+            d_gathmethod == &Boundary::gatherrtime ||
+            d_gathmethod == &Boundary::gfitgather;
+  }
+};
+
+FrameLoop::FrameLoop(const args::Arguments &args, System &sys, Boundary *pbc,
+        Boundary::MemPtr gathmethod, utils::Time &time) :
+d_this(new FrameLoop_i(args, sys, pbc, gathmethod, time)) {
+  d_this->d_skip = args.getValue<int>("skip", false, 0);
+  d_this->d_stride = args.getValue<int>("stride", false, 1);
+  d_this->d_files = args.getValues<std::string>("traj", args.count("traj"));
+  if (d_this->d_skip < 0 || d_this->d_stride < 1)
+    throw Exception("invalid skip or stride");
+#ifdef OMP
+  d_this->d_batch = 2 * omp_get_max_threads();
+#endif
+}
+
+FrameLoop::~FrameLoop() {
+  delete d_this;
+}
+
+void FrameLoop::select(const std::string &thing) {
+  d_this->d_select = thing;
+}
+
+int FrameLoop::batch()const {
+  return d_this->d_batch;
+}
+
+int FrameLoop::run(FrameTask &task) {
+  FrameLoop_i &d = *d_this;
+  const bool serial = d.serialGather();
+
+  std::vector<FrameLoop_i::Slot> slots(d.d_batch);
+  for (unsigned int s = 0; s < slots.size(); ++s) {
+    slots[s].sys = new System(d.d_sys);
+    slots[s].sys->primlist = d.d_sys.primlist;
+    slots[s].pbc = args::BoundaryParser::boundary(*slots[s].sys, d.d_args);
+    slots[s].task = task.clone(*slots[s].sys, slots[s].pbc);
+  }
+
+  int frames = 0;
+  try {
+    gio::InG96Prefetch ip(d.d_sys, d.d_time, d.d_skip, d.d_stride, d.d_batch);
+    ip.select(d.d_select);
+    ip.open(d.d_files);
+
+    while (!ip.eof()) {
+      // read a batch
+      int n = 0;
+      for (; n < d.d_batch && !ip.eof(); ++n) {
+        FrameLoop_i::Slot &slot = slots[n];
+        if (serial) {
+          ip >> d.d_sys >> slot.time;
+          (d.d_pbc->*d.d_gathmethod)();
+          slot.sys->copyConfiguration(d.d_sys);
+        } else {
+          ip >> *slot.sys >> slot.time;
+        }
+      }
+
+      // analyse it
+#ifdef OMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (int i = 0; i < n; ++i) {
+        FrameLoop_i::Slot &slot = slots[i];
+        try {
+          if (!serial)
+            (slot.pbc->*d.d_gathmethod)();
+          slot.task->analyse(*slot.sys, slot.time);
+        } catch (...) {
+          slot.error = std::current_exception();
+        }
+      }
+
+      // and collect the results in order
+      for (int i = 0; i < n; ++i) {
+        if (slots[i].error)
+          std::rethrow_exception(slots[i].error);
+        slots[i].task->collect(slots[i].time);
+      }
+      frames += n;
+      d.d_time = slots[n - 1].time;
+    }
+  } catch (...) {
+    for (unsigned int s = 0; s < slots.size(); ++s) {
+      delete slots[s].task;
+      delete slots[s].pbc;
+      delete slots[s].sys;
+    }
+    throw;
+  }
+
+  for (unsigned int s = 0; s < slots.size(); ++s) {
+    delete slots[s].task;
+    delete slots[s].pbc;
+    delete slots[s].sys;
+  }
+  return frames;
+}
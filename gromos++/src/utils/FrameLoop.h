@@ -0,0 +1,150 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// utils_FrameLoop.h
+
+#ifndef INCLUDED_UTILS_FRAMELOOP
+#define INCLUDED_UTILS_FRAMELOOP
+
+#include <string>
+#include "../bound/Boundary.h"
+#include "../gromos/Exception.h"
+
+namespace gcore{
+  class System;
+}
+
+namespace args{
+  class Arguments;
+}
+
+namespace utils{
+  class Time;
+
+  /**
+   * Class FrameTask
+   * The analysis of a single frame, as done by utils::FrameLoop
+   *
+   * A task is cloned for every frame which is analysed in parallel. The
+   * clone works on its own copy of the system and boundary. After the 
+   * (parallel) analysis, the results of the clones are collected in the 
+   * order of the frames, so this is the place to write output or to
+   * accumulate averages which depend on the order of the frames. The 
+   * clones only need to compute the values of a frame; statistics over 
+   * all frames are kept by the task of the program (e.g. 
+   * PropertyContainer::setStore(false) for the copies).
+   *
+   * @class FrameTask
+   * @ingroup utils
+   * @sa utils::FrameLoop
+   */
+  class FrameTask{
+  public:
+    /**
+     * Destructor
+     */
+    virtual ~FrameTask(){}
+    /**
+     * create a task which analyses frames in the given system
+     * @param sys the copy of the system the clone works on
+     * @param pbc the boundary of that system
+     */
+    virtual FrameTask *clone(gcore::System &sys, bound::Boundary *pbc) = 0;
+    /**
+     * analyse a frame (gathered). Called in parallel for different clones.
+     */
+    virtual void analyse(gcore::System &sys, const utils::Time &time) = 0;
+    /**
+     * collect the results of the frame analysed last by this clone. 
+     * Called for one clone after the other, in the order of the frames.
+     */
+    virtual void collect(const utils::Time &time) = 0;
+  };
+
+  class FrameLoop_i;
+  /**
+   * Class FrameLoop
+   * Loops over the frames of the trajectory files (\@traj) and analyses
+   * several of them in parallel
+   *
+   * The frames are read ahead (gio::InG96Prefetch) in batches of twice
+   * the number of OpenMP threads into copies of the system. Each copy 
+   * is gathered and analysed by a clone of the utils::FrameTask on its 
+   * own thread, then the clones collect their results in the order of 
+   * the frames, so the output is the same as for a serial loop. The 
+   * gathering methods which depend on the previous frame (gtime, gltime, 
+   * grtime and gfit) are done serially in the system of the program 
+   * before the frame is handed to a copy.
+   *
+   * The optional arguments \@skip and \@stride are taken into account.
+   * Without OpenMP the frames are analysed one after the other.
+   *
+   * @class FrameLoop
+   * @ingroup utils
+   * @sa utils::FrameTask
+   */
+  class FrameLoop{
+    FrameLoop_i *d_this;
+    // not implemented
+    FrameLoop(const FrameLoop &);
+    FrameLoop &operator=(const FrameLoop &);
+  public:
+    /**
+     * Constructor
+     * @param args the arguments of the program (\@traj, \@pbc, \@skip
+     *             and \@stride are used)
+     * @param sys the system
+     * @param pbc the boundary of the system
+     * @param gathmethod the gathering method (see args::GatherParser)
+     * @param time the time settings, updated while reading
+     */
+    FrameLoop(const args::Arguments &args, gcore::System &sys,
+            bound::Boundary *pbc, bound::Boundary::MemPtr gathmethod,
+            utils::Time &time);
+    /**
+     * Destructor
+     */
+    ~FrameLoop();
+    /**
+     * select SOLUTE, SOLVENT or ALL (see gio::InG96::select)
+     */
+    void select(const std::string &thing);
+    /**
+     * number of frames which are analysed in parallel
+     */
+    int batch()const;
+    /**
+     * read all frames and analyse them with clones of the task
+     * @return the number of frames analysed
+     */
+    int run(FrameTask &task);
+
+    /**
+     * @struct Exception
+     * FrameLoop exception
+     */
+    struct Exception: public gromos::Exception{
+      Exception(const std::string &what) : 
+        gromos::Exception("FrameLoop", what){}
+    };
+  };
+}
+#endif
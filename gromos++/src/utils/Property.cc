@@ -155,6 +155,12 @@ namespace utils {
     }
   }
 
+  Value const & Property::collect(Property const & copy) {
+    d_value = copy.d_value;
+    addValue(d_value);
+    return d_value;
+  }
+
   Value Property::nearestImageDistance(const Value & first, const Value & second) const{
     return second - first;
   }
@@ -171,12 +177,21 @@ namespace utils {
   }
 
   Value const & AverageProperty::calc() {
+    return average(NULL);
+  }
+
+  Value const & AverageProperty::collect(Property const & copy) {
+    return average(&dynamic_cast<AverageProperty const &>(copy));
+  }
+
+  Value const & AverageProperty::average(AverageProperty const * copy) {
     // empty
     d_single_scalar_stat = gmath::Stat<double>();
     d_single_vector_stat = gmath::Stat<gmath::Vec > ();
 
     for (unsigned int i = 0; i < d_property.size(); ++i) {
-      Value const & v = d_property[i]->calc();
+      Value const & v = copy ? d_property[i]->collect(*copy->d_property[i])
+              : d_property[i]->calc();
 
       switch (v.type()) {
         case val_scalar:
@@ -377,7 +392,7 @@ namespace utils {
   //---TorsionProperty Class------------------------------------
 
   TorsionProperty::TorsionProperty(gcore::System &sys, bound::Boundary * pbc) :
-  Property(sys, pbc) {
+  Property(sys, pbc), d_angle(0.0) {
     d_type = "Torsion";
     REQUIREDARGUMENTS = 1;
   }
@@ -420,8 +435,17 @@ namespace utils {
       d *= (-1);
     }
     
+    d_angle = d;
+    return continuous(d);
+  }
+
+  Value const & TorsionProperty::collect(Property const & copy) {
+    return continuous(dynamic_cast<TorsionProperty const &>(copy).d_angle);
+  }
+
+  Value const & TorsionProperty::continuous(double d) {
     if(d_scalar_stat.n() > 0) { // not the first caluclation => transformation needed
-      double lastValue = d_scalar_stat.val(d_scalar_stat.n() - 1);
+      double lastValue = d_scalar_stat.last();
       double x = (d - lastValue) / 360.0;
       // get the nearest integer of x
       int ix;
@@ -206,6 +206,14 @@ namespace utils
      * vector stat
      */
     gmath::Stat<gmath::Vec> & getVectorStat() { return d_vector_stat; }
+    /**
+     * keep the values of the property in the statistics (default) or only
+     * their averages (see gmath::Stat::setStore)
+     */
+    virtual void setStore(bool store) {
+      d_scalar_stat.setStore(store);
+      d_vector_stat.setStore(store);
+    }
     
     // methods
     
@@ -214,6 +222,13 @@ namespace utils
      * Override in derived classes.
      */
     virtual Value const & calc() = 0;
+    /**
+     * Continues the calculations with the value a copy of this property
+     * (of another system, e.g. on another thread) calculated for the next 
+     * frame. The value is added to the statistics as if calc() was 
+     * called for that frame.
+     */
+    virtual Value const & collect(Property const & copy);
     /**
      * Write a title string specifying the property.
      */
@@ -408,10 +423,23 @@ namespace utils
     {
       return d_property;
     }
+    /**
+     * keep the values (of this property and the averaged ones)
+     */
+    virtual void setStore(bool store)
+    {
+      Property::setStore(store);
+      for (unsigned int i = 0; i < d_property.size(); ++i)
+        d_property[i]->setStore(store);
+    }
     /**
      * Calculate all properties.
      */
     virtual Value const & calc();
+    /**
+     * Continue with the properties calculated by a copy.
+     */
+    virtual Value const & collect(Property const & copy);
     /**
      * Write a title string specifying the property.
      */
@@ -422,6 +450,12 @@ namespace utils
     virtual std::string toString()const;
 
   protected:
+    /**
+     * averages the values of the properties
+     * @param copy if not NULL, the values are collected from the copy 
+     * instead of calculated
+     */
+    Value const & average(AverageProperty const * copy);
     /**
      * the properties to average over
      */
@@ -678,6 +712,11 @@ namespace utils
      * Calculate the torsional angle.
      */
     virtual Value const & calc();
+    /**
+     * Continue with the angle calculated by a copy. The angle is shifted by
+     * multiples of 360 degrees to the previous one, as in calc().
+     */
+    virtual Value const & collect(Property const & copy);
     /**
      * calculate the nearest image distance
      */
@@ -688,6 +727,15 @@ namespace utils
      * needs to be overwritten for the specific properties.
      */
     virtual int findTopologyType(gcore::MoleculeTopology const &mol_topo);
+    /**
+     * shifts the angle by multiples of 360 degrees closest to the
+     * previously calculated one and adds it to the statistics
+     */
+    Value const & continuous(double d);
+    /**
+     * the angle in [-180, 180] calculated last
+     */
+    double d_angle;
   };
   
   /**
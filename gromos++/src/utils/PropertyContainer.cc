@@ -334,6 +334,19 @@ void PropertyContainer::parse_average(std::string s) {
     for(iterator it = begin(); it != end(); ++it)
       (*it)->calc();
   }
+
+  void PropertyContainer::collect(PropertyContainer const & copy)
+  {
+    assert(size() == copy.size());
+    for(unsigned int i = 0; i < size(); ++i)
+      (*this)[i]->collect(*copy[i]);
+  }
+
+  void PropertyContainer::setStore(bool store)
+  {
+    for(unsigned int i = 0; i < size(); ++i)
+      (*this)[i]->setStore(store);
+  }
   
   std::ostream &operator<<(std::ostream &os, PropertyContainer const & ps)
   {
@@ -109,6 +109,17 @@ namespace utils
      * Calculate all properties in the container.
      */
     void calc();
+    /**
+     * Continue all properties with the values calculated by a copy of the 
+     * container (see Property::collect).
+     */
+    void collect(PropertyContainer const & copy);
+    /**
+     * keep the values of all properties in their statistics or only the
+     * averages (see Property::setStore). Copies of which only the values
+     * are collected do not need to keep them.
+     */
+    void setStore(bool store);
 
     /**
      * @struct Exception
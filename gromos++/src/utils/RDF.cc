@@ -19,6 +19,7 @@
  */
 
 #include <cassert>
+#include <map>
 #include <set>
 #include <string>
 #include <iostream>
@@ -36,6 +37,13 @@
 #include "../gmath/Distribution.h"
 #include "../bound/Boundary.h"
 #include "../args/GatherParser.h"
+#include "CellList.h"
+#include "FrameLoop.h"
+#include "groTime.h"
+
+#ifdef OMP
+#include <omp.h>
+#endif
 
 #include <RDF.h>
 
@@ -104,6 +112,10 @@ namespace utils {
      * A boolean to determine if the dipole-dipole correlation function needs to be normalized
      */
     bool d_DCFnorm;
+    /**
+     * A boolean to analyse several frames in parallel (utils::FrameLoop)
+     */
+    bool d_parallelFrames;
   };
 
   RDF::RDF() {
@@ -112,6 +124,7 @@ namespace utils {
     d_this->d_cut = 1.5;
     d_this->d_doDCF = false;
     d_this->d_DCFnorm = false;
+    d_this->d_parallelFrames = false;
     d_this->d_rdf.resize(d_this->d_grid);
     d_this->d_dcf.resize(d_this->d_grid);
     d_this->d_local_mix.resize(d_this->d_grid);
@@ -125,6 +138,7 @@ namespace utils {
     d_this->d_cut = 1.5;
     d_this->d_doDCF = false;
     d_this->d_DCFnorm = false;
+    d_this->d_parallelFrames = false;
     d_this->d_rdf.resize(d_this->d_grid);
     d_this->d_dcf.resize(d_this->d_grid);
     d_this->d_local_mix.resize(d_this->d_grid);
@@ -179,6 +193,8 @@ namespace utils {
     d_this->d_grid = grid;
     d_this->d_rdf.resize(d_this->d_grid);
     d_this->d_dcf.resize(d_this->d_grid);
+    d_this->d_local_mix.resize(d_this->d_grid);
+    d_this->d_local_self.resize(d_this->d_grid);
   }
 
   void RDF::setCut(double cut) {
@@ -195,6 +211,11 @@ namespace utils {
     d_this->d_DCFnorm = dcfnorm;
   }
 
+  void RDF::setParallelFrames(bool parallel) {
+    assert(d_this != NULL);
+    d_this->d_parallelFrames = parallel;
+  }
+
   void RDF::clearRDF(void) {
     assert(d_this != NULL);
     for(unsigned int i = 0; i < d_this->d_rdf.size(); ++i) {
@@ -218,502 +239,482 @@ namespace utils {
     d_this->d_with.setSystem(*d_this->d_sys);
   }
 
-  void RDF::calculateAll(void) {
-    assert(d_this != NULL && d_this->d_sys != NULL);
+  /**
+   * The pairs of one frame: for every centre atom the with atoms within
+   * the cutoff are taken from a cell list (utils::CellList) over the with
+   * atoms, their distances are calculated by one call to 
+   * bound::Boundary::nearestImageDistances2 and binned. The centre atoms
+   * are distributed over the threads, every thread has its own 
+   * histograms, which are summed bin by bin afterwards.
+   *
+   * A kernel accumulates over the frames it is given. For the 
+   * frame-parallel analysis (RDF::setParallelFrames) every frame is 
+   * analysed by a copy of the kernel with its own system, whose results 
+   * are added in the order of the frames.
+   */
+  class RDFKernel {
+  public:
+    enum mode_type { ALL, INTER, LOCAL, INTER_PDENS };
 
-    clearRDF();
+    mode_type d_mode;
+    double d_cut;
+    unsigned int d_grid;
+    bool d_doDCF;
+    bool d_DCFnorm;
+    unsigned int d_numatoms;
+    gcore::System *d_sys;
+    bound::Boundary *d_pbc;
+    AtomSpecifier d_centre;
+    AtomSpecifier d_with;
 
-    gio::InG96 ic;
-    unsigned int count_frame = 0;
+    // accumulated over the frames, not normalised
+    std::vector<double> d_rdf;
+    std::vector<double> d_dcf;
+    std::vector<double> d_local_mix;
+    std::vector<double> d_local_self;
+    double d_c2w;
+    long long d_numC2W;
+    unsigned int d_frames;
+
+    RDFKernel(const iRDF &rdf, mode_type mode, unsigned int numatoms = 0) :
+    d_mode(mode), d_cut(rdf.d_cut), d_grid(rdf.d_grid),
+    d_doDCF(rdf.d_doDCF && mode == ALL), d_DCFnorm(rdf.d_DCFnorm),
+    d_numatoms(numatoms), d_sys(rdf.d_sys), d_pbc(NULL),
+    d_centre(rdf.d_centre), d_with(rdf.d_with) {
+      // checks the cutoff and grid
+      gmath::Distribution dist(0, d_cut, d_grid);
+      clear();
+    }
 
-    double correct=4*acos(-1.0)*d_this->d_cut/double(d_this->d_grid);
-    
-    // boundary conditions
-    bound::Boundary *pbc;
-    // gather method
-    bound::Boundary::MemPtr gathmethod;
-    
-    // loop over the different trajectory files
-    for (args::Arguments::const_iterator trj = d_this->d_args->lower_bound("traj"); trj != d_this->d_args->upper_bound("traj"); trj++) {
-      
-      // reading the boundary shape and gathering method
-      ic.open(trj->second.c_str());
-      ic.select("ALL");
-      ic >> *(d_this->d_sys);
-      // here we have to check whether we really got the atoms we want
-      // maybe the solvent is missing.
-      if (d_this->d_centre.size() == 0 || d_this->d_with.size() == 0) {
-        string argument = d_this->d_centre.size() == 0 ? "centre" : "with";
-        throw gromos::Exception("Rdf.cc", "No atoms specified for " + argument + " atoms!");
-      }
-	
-	// throw an error message if rdf is run w/ DCF on and solvent molecules or virtual atoms are chosen as centre or with
-      if (d_this->d_doDCF) {
-        for (unsigned int c = 0; c < d_this->d_centre.size(); c++) {
-	  int m = d_this->d_centre.mol(c);
-	  if (m < 0) {
-            throw gromos::Exception("Rdf.cc", "Rdf does not currently work with DCF turned on when there are solvent molecules or virtual atoms specified as @centre.");
-	  }
-        }
-        for (unsigned int c = 0; c < d_this->d_with.size(); c++) { 
-          int m = d_this->d_with.mol(c);
-            if (m < 0) {
-              throw gromos::Exception("Rdf.cc", "Rdf does not currently work with DCF turned on when there are solvent molecules or virtual atoms specified as @with.");
-          }
-        }
+    /**
+     * a copy working on another system (and its boundary)
+     */
+    RDFKernel(const RDFKernel &k, gcore::System &sys, bound::Boundary *pbc) :
+    d_mode(k.d_mode), d_cut(k.d_cut), d_grid(k.d_grid), d_doDCF(k.d_doDCF),
+    d_DCFnorm(k.d_DCFnorm), d_numatoms(k.d_numatoms), d_sys(&sys), 
+    d_pbc(pbc), d_centre(k.d_centre), d_with(k.d_with) {
+      d_centre.setSystem(sys);
+      d_with.setSystem(sys);
+      clear();
+    }
+
+    void clear() {
+      d_rdf.assign(d_grid, 0.0);
+      d_dcf.assign(d_grid, 0.0);
+      d_local_mix.assign(d_grid, 0.0);
+      d_local_self.assign(d_grid, 0.0);
+      d_c2w = 0.0;
+      d_numC2W = 0;
+      d_frames = 0;
+    }
+
+    void add(const RDFKernel &k) {
+      for (unsigned int i = 0; i < d_grid; ++i) {
+        d_rdf[i] += k.d_rdf[i];
+        d_dcf[i] += k.d_dcf[i];
+        d_local_mix[i] += k.d_local_mix[i];
+        d_local_self[i] += k.d_local_self[i];
       }
-      // parse boundary conditions
-      pbc = args::BoundaryParser::boundary(*d_this->d_sys, *d_this->d_args);
-      //parse gather method
-      gathmethod = args::GatherParser::parse(*d_this->d_sys, *d_this->d_sys, *d_this->d_args);
+      d_c2w += k.d_c2w;
+      d_numC2W += k.d_numC2W;
+      d_frames += k.d_frames;
+    }
 
-      ic.close();
+    void frame();
+
+  private:
+    // the histograms of a thread
+    struct Histograms {
+      // the pairs of centres which are not (0) or are (1) with atoms,
+      // or of the centres with the centres (2, LOCAL only)
+      std::vector<long long> count[3];
+      std::vector<double> dcf;
+      double c2w;
+      long long numC2W;
+      // per centre atom
+      std::vector<double> dcf_local;
+      std::vector<int> dcf_count;
+      // scratch
+      std::vector<int> candidates, index;
+      std::vector<gmath::Vec> pos, vec;
+      std::vector<double> dist;
+    };
+
+    void pairs(int c, const gmath::Vec &centre, const std::vector<gmath::Vec> &pos,
+            const CellList &cells, const std::vector<int> &mol,
+            const std::vector<int> &atom, bool intra, std::vector<long long> &count,
+            Histograms &h)const;
+    gmath::Vec dipole(int m, const gmath::Vec &r)const;
+  };
 
-      // reopen the same file for the calculation
-      ic.open(trj->second.c_str());
-      ic.select("ALL");
+  gmath::Vec RDFKernel::dipole(int m, const gmath::Vec &r)const {
+    gmath::Vec dip(0.0, 0.0, 0.0);
+    for (unsigned int i = 0; i < d_sys->mol(m).topology().numAtoms(); i++) {
+      const Vec tmp = d_pbc->nearestImage(r, d_sys->mol(m).pos(i), d_sys->box())
+              * d_sys->mol(m).topology().atom(i).charge();
+      dip += tmp;
+    }
+    if (d_DCFnorm) dip /= dip.abs();
+    return dip;
+  }
 
-      // loop over frames of the current trajectory file
-      while (!ic.eof()) {
+  void RDFKernel::pairs(int c, const gmath::Vec &centre, 
+          const std::vector<gmath::Vec> &pos, const CellList &cells, 
+          const std::vector<int> &mol, const std::vector<int> &atom,
+          bool intra, std::vector<long long> &count, Histograms &h)const {
+    const int cmol = d_centre.mol(c), catom = d_centre.atom(c);
+
+    // the candidates, without the centre atom itself (or its molecule)
+    cells.candidates(centre, h.candidates);
+    h.pos.clear();
+    h.index.clear();
+    for (unsigned int i = 0; i < h.candidates.size(); ++i) {
+      const int w = h.candidates[i];
+      if (mol[w] == cmol && (!intra || atom[w] == catom)) continue;
+      h.pos.push_back(pos[w]);
+      h.index.push_back(w);
+    }
+    const int n = h.pos.size();
+    if (!n) return;
+
+    // the distances
+    h.dist.resize(n);
+    double *dist = &h.dist[0];
+    if (d_doDCF) {
+      h.vec.resize(n);
+      d_pbc->nearestImageVectors(centre, &h.pos[0], n, d_sys->box(), &h.vec[0]);
+      for (int i = 0; i < n; ++i)
+        dist[i] = h.vec[i].abs();
+    } else {
+      d_pbc->nearestImageDistances2(centre, &h.pos[0], n, d_sys->box(), dist);
+      for (int i = 0; i < n; ++i)
+        dist[i] = sqrt(dist[i]);
+    }
 
-        // read the next frame
-        ic >> *(d_this->d_sys);
-        count_frame++;
-        // gather the system
-        (*pbc.*gathmethod)();
+    // and the bins, as in gmath::Distribution
+    const double step = d_cut / d_grid;
+    for (int i = 0; i < n; ++i) {
+      if (dist[i] < d_cut) {
+        const unsigned int q = int(dist[i] / step);
+        if (q < d_grid) ++count[q];
+      }
+    }
 
-        // calculate the volume
-        double vol_corr = 1;
-        if(pbc->type()=='t') vol_corr=0.5;
-        double vol = d_this->d_sys->box().K_L_M() * vol_corr;
+    if (d_doDCF) {
+      const gmath::Vec centre_dip = dipole(cmol, centre);
+      for (int i = 0; i < n; ++i) {
+        if (dist[i] < d_cut) {
+          const unsigned int q = int(dist[i] / step);
+          if (q < d_grid) {
+            const gmath::Vec with_dip = dipole(mol[h.index[i]], centre + h.vec[i]);
+            h.dcf_local[q] += centre_dip.dot(with_dip);
+            h.dcf_count[q] += 1;
+          }
+        }
+      }
+      // normalise the DCF by the number of pairs only
+      for (unsigned int k = 0; k < d_grid; ++k) {
+        if (h.dcf_count[k]) {
+          h.dcf[k] += h.dcf_local[k] / double(h.dcf_count[k]);
+          h.dcf_local[k] = 0.0;
+          h.dcf_count[k] = 0;
+        }
+      }
+    }
+  }
 
-        // loop over the centre atoms
+  void RDFKernel::frame() {
+    const int numCentres = d_centre.size();
+    const int numWith = d_with.size();
+    const std::vector<gmath::Vec> &centrePos = d_centre.gatherPos();
+    const std::vector<gmath::Vec> &withPos = d_with.gatherPos();
+
+    // the with atoms (and centre atoms) in cells of the size of the cutoff
+    CellList cells(withPos, *d_sys, *d_pbc, d_cut);
+    CellList centreCells(d_mode == LOCAL ? centrePos : std::vector<gmath::Vec>(),
+            *d_sys, *d_pbc, d_cut);
+    std::vector<int> withMol(numWith), withAtom(numWith);
+    for (int w = 0; w < numWith; ++w) {
+      withMol[w] = d_with.mol(w);
+      withAtom[w] = d_with.atom(w);
+    }
+    std::vector<int> centreMol(numCentres), centreAtom(numCentres);
+    std::vector<char> inwith(numCentres);
+    for (int c = 0; c < numCentres; ++c) {
+      centreMol[c] = d_centre.mol(c);
+      centreAtom[c] = d_centre.atom(c);
+      inwith[c] = d_with.findAtom(centreMol[c], centreAtom[c]) > -1;
+    }
+
+    // the with atoms of every molecule, for the intramolecular distances
+    std::map<int, std::vector<int> > molWith;
+    if (d_mode == INTER_PDENS) {
+      for (int w = 0; w < numWith; ++w)
+        molWith[withMol[w]].push_back(w);
+    }
+    static const std::vector<int> noWith;
+
+    int numThreads = 1;
 #ifdef OMP
-#pragma omp parallel for
+    numThreads = omp_get_max_threads();
 #endif
-        for (unsigned int c = 0; c < d_this->d_centre.size(); c++) {
-
-          // the distribution array
-          gmath::Distribution dist(0, d_this->d_cut, d_this->d_grid);
-
-          std::vector<double> dcf_local;
-          std::vector<int> dcf_count;
-	  dcf_local.resize(d_this->d_grid, 0.0);
-	  dcf_count.resize(d_this->d_grid, 0);
-
-          // the coordinates of the centre atom
-          const gmath::Vec & centre_coord = *(d_this->d_centre.coord(c));
-
-          // the dipole moment of the molecule to which it belongs
-          gmath::Vec centre_dip(0.0,0.0,0.0);
-          if(d_this->d_doDCF){
-            int m = d_this->d_centre.mol(c);
-            for(unsigned int i=0; i< d_this->d_sys->mol(m).topology().numAtoms(); i++){
-              const Vec tmp = pbc->nearestImage(centre_coord, d_this->d_sys->mol(m).pos(i), d_this->d_sys->box()) 
-                        * d_this->d_sys->mol(m).topology().atom(i).charge();
-              centre_dip += tmp;
-            }
-            if(d_this->d_DCFnorm) centre_dip /= centre_dip.abs();
-          }
-          // to know if this atom is also in the with set.
-          int inwith = 0;
-          if (d_this->d_with.findAtom(d_this->d_centre.mol(c), d_this->d_centre.atom(c))>-1) inwith = 1;
-
-          // loop over the with atoms
-          for (unsigned int w = 0; w < d_this->d_with.size(); w++) {
-
-            // only do the calculations if the centre and with atom are not identical
-            if (!(d_this->d_with.mol(w) == d_this->d_centre.mol(c) && d_this->d_with.atom(w) == d_this->d_centre.atom(c))) {
-              const Vec & tmp = pbc->nearestImage(centre_coord, *(d_this->d_with.coord(w)), d_this->d_sys->box());
-	      const double dis = (tmp - centre_coord).abs();
-	      
-              dist.add(dis);
-              // and maybe the dipole moment of the molecule to which it belongs
-              if(d_this->d_doDCF){
-                gmath::Vec with_dip(0.0,0.0,0.0);
-                int m = d_this->d_with.mol(w);
-                for(unsigned int i=0; i< d_this->d_sys->mol(m).topology().numAtoms(); i++){
-                  const Vec tmp2 = pbc->nearestImage(tmp, d_this->d_sys->mol(m).pos(i), d_this->d_sys->box())
-                                * d_this->d_sys->mol(m).topology().atom(i).charge();
-                  with_dip += tmp2;
-                }
-                if(d_this->d_DCFnorm) with_dip /= with_dip.abs();
-
-		if (dist.inrange(dis)) {
-                  //cerr << "adding " << centre_dip.dot(with_dip) << endl;
-		  dcf_local[dist.getbin(dis)] += centre_dip.dot(with_dip);
-		  dcf_count[dist.getbin(dis)] += 1;
-                }
-              }
-            }
+    std::vector<Histograms> hist(numThreads);
 
-          } /* end of loop over with atoms */
+#ifdef OMP
+#pragma omp parallel
+#endif
+    {
+      int t = 0;
+#ifdef OMP
+      t = omp_get_thread_num();
+#endif
+      Histograms &h = hist[t];
+      for (int i = 0; i < 3; ++i)
+        h.count[i].assign(d_grid, 0);
+      h.dcf.assign(d_grid, 0.0);
+      h.dcf_local.assign(d_grid, 0.0);
+      h.dcf_count.assign(d_grid, 0);
+      h.c2w = 0.0;
+      h.numC2W = 0;
 
-          const double dens = (d_this->d_with.size() - inwith) / vol;
-          for (unsigned int k = 0; k < d_this->d_grid; k++) {
-            const double r = dist.value(k);
-            const double rdf_val = double(dist[k]) / (dens * correct * r * r);
 #ifdef OMP
-#pragma omp critical
+#pragma omp for schedule(dynamic, 16)
 #endif
-            {
-              d_this->d_rdf[k] += rdf_val;
-              // normalize the DCF by the number of pairs only
-              if(d_this->d_doDCF && dist[k]!=0){
-                d_this->d_dcf[k] += dcf_local[k] / double(dcf_count[k]);
-              }
+      for (int c = 0; c < numCentres; ++c) {
+        const gmath::Vec &centre = centrePos[c];
+        pairs(c, centre, withPos, cells, withMol, withAtom, 
+                d_mode == ALL || d_mode == LOCAL, h.count[inwith[c] ? 1 : 0], h);
+        if (d_mode == LOCAL)
+          pairs(c, centre, centrePos, centreCells, centreMol, centreAtom,
+                true, h.count[2], h);
+
+        // the distances to the other with atoms of the same molecule
+        if (d_mode == INTER_PDENS) {
+          // find: operator[] would insert into the shared map
+          std::map<int, std::vector<int> >::const_iterator it =
+                  molWith.find(centreMol[c]);
+          const std::vector<int> &same = it == molWith.end() ? noWith : it->second;
+          for (unsigned int i = 0; i < same.size(); ++i) {
+            if (withAtom[same[i]] != centreAtom[c]) {
+              const Vec tmp = d_pbc->nearestImage(centre, withPos[same[i]], d_sys->box());
+              h.c2w += (tmp - centre).abs();
+              h.numC2W++;
             }
           }
-        } /* end of loop over centre atoms */
-
-      } /* end of loop over frames */
-
-      // close the current trajectory file
-      ic.close();
-
-    } /* end of loop over trajectory files */
-
-    // correct the distribution for the number of frames and the number of centre atoms
-    int divide = count_frame * d_this->d_centre.size();
-#ifdef OMP
-#pragma omp parallel for
-#endif 
-    for (unsigned int i = 0; i < d_this->d_grid; i++) {
-      d_this->d_rdf[i] /= double(divide);
-      if(d_this->d_doDCF) d_this->d_dcf[i] /= double(divide);
+        }
+      }
     }
 
-  } /* end of RDF::calculateAll() */
+    // sum the histograms of the threads
+    std::vector<long long> count[3];
+    for (int i = 0; i < 3; ++i)
+      count[i].assign(d_grid, 0);
+    for (int t = 0; t < numThreads; ++t) {
+      if (hist[t].count[0].empty()) continue;
+      for (unsigned int k = 0; k < d_grid; ++k) {
+        for (int i = 0; i < 3; ++i)
+          count[i][k] += hist[t].count[i][k];
+        d_dcf[k] += hist[t].dcf[k];
+      }
+      d_c2w += hist[t].c2w;
+      d_numC2W += hist[t].numC2W;
+    }
 
-  void RDF::calculateInter(void) {
-    assert(d_this != NULL && d_this->d_sys != NULL);
+    if (d_mode == LOCAL) {
+      for (unsigned int k = 0; k < d_grid; ++k) {
+        d_local_mix[k] += double(count[0][k] + count[1][k]);
+        d_local_self[k] += double(count[2][k]);
+      }
+    } else {
+      // the volume
+      double vol_corr = 1;
+      if (d_pbc->type() == 't') vol_corr = 0.5;
+      const double vol = d_sys->box().K_L_M() * vol_corr;
+      const double correct = 4 * acos(-1.0) * d_cut / double(d_grid);
+      // the density of the with atoms seen by a centre atom, which is not
+      // or which is a with atom itself
+      const double dens[2] = {numWith / vol, (numWith - 1) / vol};
+      const double partDens = double(d_numatoms) / vol;
+      const gmath::Distribution dist(0, d_cut, d_grid);
+
+      for (unsigned int k = 0; k < d_grid; k++) {
+        const double r = dist.value(k);
+        double rdf_val = 0.0;
+        for (int i = 0; i < 2; ++i) {
+          if (count[i][k])
+            rdf_val += double(count[i][k]) / (dens[i] * correct * r * r);
+        }
+        if (d_mode == INTER_PDENS)
+          d_rdf[k] += (rdf_val - numCentres) * partDens;
+        else
+          d_rdf[k] += rdf_val;
+      }
+    }
+    ++d_frames;
+  }
 
-    clearRDF();
+  /**
+   * A frame of utils::FrameLoop, analysed by a copy of the kernel
+   */
+  class RDFTask : public FrameTask {
+    RDFKernel &d_master;
+    RDFKernel d_kernel;
+  public:
+    RDFTask(RDFKernel &master) : d_master(master), 
+    d_kernel(master, *master.d_sys, master.d_pbc) {
+    }
+    RDFTask(RDFKernel &master, gcore::System &sys, bound::Boundary *pbc) :
+    d_master(master), d_kernel(master, sys, pbc) {
+    }
+    FrameTask *clone(gcore::System &sys, bound::Boundary *pbc) {
+      return new RDFTask(d_master, sys, pbc);
+    }
+    void analyse(gcore::System &sys, const utils::Time &time) {
+      d_kernel.clear();
+      d_kernel.frame();
+    }
+    void collect(const utils::Time &time) {
+      d_master.add(d_kernel);
+    }
+  };
 
+  /**
+   * Reads the trajectories and analyses every frame with the kernel
+   */
+  void run(iRDF &rdf, RDFKernel &kernel) {
+    const args::Arguments &args = *rdf.d_args;
     gio::InG96 ic;
-    unsigned int count_frame = 0;
-
-    double correct=4*acos(-1.0)*d_this->d_cut/double(d_this->d_grid);
-
-    // boundary conditions
-    bound::Boundary *pbc;
-    // gather method
-    bound::Boundary::MemPtr gathmethod;
+    bound::Boundary *pbc = NULL;
+    bound::Boundary::MemPtr gathmethod = &bound::Boundary::nogather;
     
     // loop over the different trajectory files
-    for (args::Arguments::const_iterator trj = d_this->d_args->lower_bound("traj"); trj != d_this->d_args->upper_bound("traj"); trj++) {
-
+    for (args::Arguments::const_iterator trj = args.lower_bound("traj"); trj != args.upper_bound("traj"); trj++) {
+      
+      // reading the boundary shape and gathering method
       ic.open(trj->second.c_str());
       ic.select("ALL");
-      ic >> *(d_this->d_sys);
+      ic >> *(rdf.d_sys);
       // here we have to check whether we really got the atoms we want
       // maybe the solvent is missing.
-      if (d_this->d_centre.size() == 0 || d_this->d_with.size() == 0) {
-        string argument = d_this->d_centre.size() == 0 ? "centre" : "with";
+      if (rdf.d_centre.size() == 0 || rdf.d_with.size() == 0) {
+        string argument = rdf.d_centre.size() == 0 ? "centre" : "with";
         throw gromos::Exception("Rdf.cc", "No atoms specified for " + argument + " atoms!");
       }
-      // parse boundary conditions
-      pbc = args::BoundaryParser::boundary(*d_this->d_sys, *d_this->d_args);
-      //parse gather method
-      gathmethod = args::GatherParser::parse(*d_this->d_sys, *d_this->d_sys, *d_this->d_args);
+	
+      // throw an error message if rdf is run w/ DCF on and solvent molecules or virtual atoms are chosen as centre or with
+      if (kernel.d_doDCF) {
+        for (unsigned int c = 0; c < rdf.d_centre.size(); c++) {
+          if (rdf.d_centre.mol(c) < 0) {
+            throw gromos::Exception("Rdf.cc", "Rdf does not currently work with DCF turned on when there are solvent molecules or virtual atoms specified as @centre.");
+          }
+        }
+        for (unsigned int c = 0; c < rdf.d_with.size(); c++) { 
+          if (rdf.d_with.mol(c) < 0) {
+            throw gromos::Exception("Rdf.cc", "Rdf does not currently work with DCF turned on when there are solvent molecules or virtual atoms specified as @with.");
+          }
+        }
+      }
+      if (kernel.d_mode == RDFKernel::LOCAL) {
+        // get the boundary from the read box format
+        pbc = args::BoundaryParser::boundary(*rdf.d_sys);
+      } else {
+        // parse boundary conditions
+        pbc = args::BoundaryParser::boundary(*rdf.d_sys, args);
+        //parse gather method
+        gathmethod = args::GatherParser::parse(*rdf.d_sys, *rdf.d_sys, args);
+      }
+      kernel.d_pbc = pbc;
       ic.close();
 
+      if (rdf.d_parallelFrames) {
+        // all trajectory files at once
+        utils::Time time;
+        utils::FrameLoop loop(args, *rdf.d_sys, pbc, gathmethod, time);
+        loop.select("ALL");
+        RDFTask task(kernel);
+        loop.run(task);
+        return;
+      }
+
       // reopen the same file for the calculation
       ic.open(trj->second.c_str());
       ic.select("ALL");
 
       // loop over frames of the current trajectory file
       while (!ic.eof()) {
-
         // read the next frame
-        ic >> *(d_this->d_sys);
-        count_frame++;
+        ic >> *(rdf.d_sys);
         // gather the system
         (*pbc.*gathmethod)();
-
-        // calculate the volume
-        double vol_corr = 1;
-        if(pbc->type()=='t') vol_corr=0.5;
-        double vol = d_this->d_sys->box().K_L_M() * vol_corr;
-
-        // loop over the centre atoms
-#ifdef OMP
-#pragma omp parallel for
-#endif
-        for (unsigned int c = 0; c < d_this->d_centre.size(); c++) {
-
-          // the distribution array
-          gmath::Distribution dist(0, d_this->d_cut, d_this->d_grid);
-
-          // the coordinates of the centre atom
-          const gmath::Vec & centre_coord = *(d_this->d_centre.coord(c));
-
-          // to know if this atom is also in the with set.
-          int inwith = 0;
-          if (d_this->d_with.findAtom(d_this->d_centre.mol(c), d_this->d_centre.atom(c))>-1) inwith = 1;
-
-          // loop over the with atoms
-          for (unsigned int w = 0; w < d_this->d_with.size(); w++) {
-
-            // only do the calculations if the centre and with atom are within different molecules
-            if (!(d_this->d_with.mol(w) == d_this->d_centre.mol(c))) {
-              const Vec & tmp = pbc->nearestImage(centre_coord, *(d_this->d_with.coord(w)), d_this->d_sys->box());
-              dist.add((tmp - centre_coord).abs());
-            }
-
-          } /* end of loop over with atoms */
-
-          const double dens = (d_this->d_with.size() - inwith) / vol;
-          for (unsigned int k = 0; k < d_this->d_grid; k++) {
-            const double r = dist.value(k);
-            const double rdf_val = double(dist[k]) / (dens * correct * r * r);
-#ifdef OMP
-#pragma omp critical
-#endif
-            {
-              d_this->d_rdf[k] += rdf_val;
-            }
-          }
-
-        } /* end of loop over centre atoms */
-
+        kernel.frame();
       } /* end of loop over frames */
 
       // close the current trajectory file
       ic.close();
-
     } /* end of loop over trajectory files */
+  }
+
+  void RDF::calculateAll(void) {
+    assert(d_this != NULL && d_this->d_sys != NULL);
+
+    clearRDF();
+    RDFKernel kernel(*d_this, RDFKernel::ALL);
+    run(*d_this, kernel);
 
     // correct the distribution for the number of frames and the number of centre atoms
-    int divide = count_frame * d_this->d_centre.size();
-#ifdef OMP
-#pragma omp parallel for
-#endif
+    int divide = kernel.d_frames * d_this->d_centre.size();
     for (unsigned int i = 0; i < d_this->d_grid; i++) {
-      d_this->d_rdf[i] /= double(divide);
+      d_this->d_rdf[i] = kernel.d_rdf[i] / double(divide);
+      if(d_this->d_doDCF) d_this->d_dcf[i] = kernel.d_dcf[i] / double(divide);
     }
+  } /* end of RDF::calculateAll() */
 
+  void RDF::calculateInter(void) {
+    assert(d_this != NULL && d_this->d_sys != NULL);
+
+    clearRDF();
+    RDFKernel kernel(*d_this, RDFKernel::INTER);
+    run(*d_this, kernel);
+
+    // correct the distribution for the number of frames and the number of centre atoms
+    int divide = kernel.d_frames * d_this->d_centre.size();
+    for (unsigned int i = 0; i < d_this->d_grid; i++) {
+      d_this->d_rdf[i] = kernel.d_rdf[i] / double(divide);
+    }
   } /* end of RDF::calculateInter() */
 
   void RDF::calculateLocal() {
     assert(d_this != NULL && d_this->d_sys != NULL);
 
     clearLocal();
-    
-    gio::InG96 ic;
-    unsigned int count_frame = 0;
-
-    // loop over the different trajectory files
-    for (args::Arguments::const_iterator trj = d_this->d_args->lower_bound("traj"); trj != d_this->d_args->upper_bound("traj"); trj++) {
-      
-      // open the trajectory file for reading the boxshape only
-      // it is faster to do it here, close the file and reopen it later again
-      // for the calculation
-      ic.open(trj->second.c_str());
-      ic.select("ALL");
-      ic >> *(d_this->d_sys);
-      // here we have to check whether we really got the atoms we want
-      // maybe the solvent is missing.
-      if (d_this->d_centre.size() == 0 || d_this->d_with.size() == 0) {
-        string argument = d_this->d_centre.size() == 0 ? "centre" : "with";
-        throw gromos::Exception("Rdf.cc", "No atoms specified for " + argument + " atoms!");
-      }
-      // get the boundary from the read box format
-      bound::Boundary *pbc = args::BoundaryParser::boundary(*d_this->d_sys);
-      ic.close();
-
-      // reopen the same file for the calculation
-      ic.open(trj->second.c_str());
-      ic.select("ALL");
-
-      // loop over frames of the current trajectory file
-      while (!ic.eof()) {
-
-        // read the next frame
-        ic >> *(d_this->d_sys);
-        count_frame++;
-
-        // loop over the center atoms
-#ifdef OMP
-#pragma omp parallel for
-#endif
-        for (unsigned int c = 0; c < d_this->d_centre.size(); c++) {
-
-          // the distribution array
-          gmath::Distribution dist(0, d_this->d_cut, d_this->d_grid);
-          gmath::Distribution dist2(0, d_this->d_cut, d_this->d_grid);
-
-          // the coordinates of the center atom
-          const gmath::Vec & centre_coord = *(d_this->d_centre.coord(c));
-
-          // loop over the with atoms
-          for (unsigned int w = 0; w < d_this->d_with.size(); w++) {
-            // only do the calculations if the center and with atom are not identical
-            if (!(d_this->d_with.mol(w) == d_this->d_centre.mol(c) && d_this->d_with.atom(w) == d_this->d_centre.atom(c))) {
-              const Vec & tmp = pbc->nearestImage(centre_coord, *(d_this->d_with.coord(w)), d_this->d_sys->box());
-              dist.add((tmp - centre_coord).abs());
-            }
-          } /* end of loop over with atoms */
-          
-          // loop over the center atoms
-          for (unsigned int w = 0; w < d_this->d_centre.size(); w++) {
-            // only do the calculations if the center and with atom are not identical
-            if (!(d_this->d_centre.mol(w) == d_this->d_centre.mol(c) && d_this->d_centre.atom(w) == d_this->d_centre.atom(c))) {
-              const Vec & tmp = pbc->nearestImage(centre_coord, *(d_this->d_centre.coord(w)), d_this->d_sys->box());
-              dist2.add((tmp - centre_coord).abs());
-            }
-          } /* end of loop over center atoms */
-          
-          for (unsigned int k = 0; k < d_this->d_grid; k++) {
-#ifdef OMP
-#pragma omp critical
-#endif
-            {
-              d_this->d_local_mix[k] += double(dist[k]);
-              d_this->d_local_self[k] += double(dist2[k]);
-            }
-          }
-        } /* end of loop over center atoms */
-      } /* end of loop over frames */
-      
-      // close the current trajectory file
-      ic.close();
-    } /* end of loop over trajectory files */
+    RDFKernel kernel(*d_this, RDFKernel::LOCAL);
+    run(*d_this, kernel);
 
     // correct the distribution for the number of frames and the number of centre atoms
-    int divide = count_frame * d_this->d_centre.size();
-    
-#ifdef OMP
-#pragma omp parallel for
-#endif 
+    int divide = kernel.d_frames * d_this->d_centre.size();
     for (unsigned int i = 0; i < d_this->d_grid; i++) {
-      d_this->d_local_mix[i] /= double(divide);
-      d_this->d_local_self[i] /= double(divide);
+      d_this->d_local_mix[i] = kernel.d_local_mix[i] / double(divide);
+      d_this->d_local_self[i] = kernel.d_local_self[i] / double(divide);
     }
-    
   } /* end of RDF::calculateLocal() */
 
   double RDF::calculateInterPDens(unsigned int numatoms) {
     assert(d_this != NULL && d_this->d_sys != NULL);
 
-    // remember the average centre to with distance, which is needed for
-    // the calculation of the inelastic (damped) neutron scattering intensities
-    // (term of the Debye-Waller factor)
-    double centre2with = 0.0;
-    int countC2W = 0;
-
     clearRDF();
-
-    gio::InG96 ic;
-    unsigned int count_frame = 0;
-
-    double correct=4*acos(-1.0)*d_this->d_cut/double(d_this->d_grid);
-
-    // boundary conditions
-    bound::Boundary *pbc;
-    // gather method
-    bound::Boundary::MemPtr gathmethod;
-    
-    // loop over the different trajectory files
-    for (args::Arguments::const_iterator trj = d_this->d_args->lower_bound("traj"); trj != d_this->d_args->upper_bound("traj"); trj++) {
-
-      ic.open(trj->second.c_str());
-      ic >> *(d_this->d_sys);
-      // here we have to check whether we really got the atoms we want
-      // maybe the solvent is missing.
-      if (d_this->d_centre.size() == 0 || d_this->d_with.size() == 0) {
-        string argument = d_this->d_centre.size() == 0 ? "centre" : "with";
-        throw gromos::Exception("Rdf.cc", "No atoms specified for " + argument + " atoms!");
-      }
-      // parse boundary conditions
-      pbc = args::BoundaryParser::boundary(*d_this->d_sys, *d_this->d_args);
-      //parse gather method
-      gathmethod = args::GatherParser::parse(*d_this->d_sys, *d_this->d_sys, *d_this->d_args);
-      ic.close();
-
-      // reopen the same file for the calculation
-      ic.open(trj->second.c_str());
-      ic.select("ALL");
-
-      // loop over frames of the current trajectory file
-      while (!ic.eof()) {
-
-        // read the next frame
-        ic >> *(d_this->d_sys);
-        count_frame++;
-        // gather the system
-        (*pbc.*gathmethod)();
-
-        // calculate the volume
-        double vol_corr = 1;
-        if(pbc->type()=='t') vol_corr=0.5;
-        double vol = d_this->d_sys->box().K_L_M() * vol_corr;
-        double partDens = (double)numatoms / vol;
-
-        // loop over the centre atoms
-#ifdef OMP
-#pragma omp parallel for
-#endif
-        for (unsigned int c = 0; c < d_this->d_centre.size(); c++) {
-
-          // the distribution array
-          gmath::Distribution dist(0, d_this->d_cut, d_this->d_grid);
-
-          // the coordinates of the centre atom
-          const gmath::Vec & centre_coord = *(d_this->d_centre.coord(c));
-
-          // to know if this atom is also in the with set.
-          int inwith = 0;
-          if (d_this->d_with.findAtom(d_this->d_centre.mol(c), d_this->d_centre.atom(c))>-1) inwith = 1;
-
-          // loop over the with atoms
-          for (unsigned int w = 0; w < d_this->d_with.size(); w++) {
-
-            // only do the calculations if the centre and with atom are within different molecules
-            if (!(d_this->d_with.mol(w) == d_this->d_centre.mol(c))) {
-              const Vec & tmp = pbc->nearestImage(centre_coord, *(d_this->d_with.coord(w)), d_this->d_sys->box());
-              dist.add((tmp - centre_coord).abs());
-            } else {
-              if(!(d_this->d_with.atom(w) == d_this->d_centre.atom(c))) {
-                const Vec & tmp = pbc->nearestImage(centre_coord, *(d_this->d_with.coord(w)), d_this->d_sys->box());
-                centre2with += (tmp - centre_coord).abs();
-                countC2W++;
-              }
-            }
-
-          } /* end of loop over with atoms */
-
-          const double dens = (d_this->d_with.size() - inwith) / vol;
-          for (unsigned int k = 0; k < d_this->d_grid; k++) {
-            const double r = dist.value(k);
-            const double rdf_val = double(dist[k]) / (dens * correct * r * r);
-#ifdef OMP
-#pragma omp critical
-#endif
-            {
-              d_this->d_rdf[k] += (rdf_val - 1.0) * partDens;
-            }
-          }
-
-        } /* end of loop over centre atoms */
-
-      } /* end of loop over frames */
-
-      // close the current trajectory file
-      ic.close();
-
-    } /* end of loop over trajectory files */
+    RDFKernel kernel(*d_this, RDFKernel::INTER_PDENS, numatoms);
+    run(*d_this, kernel);
 
     // correct the distribution for the number of frames and the number of centre atoms
-    int divide = count_frame * d_this->d_centre.size();
-#ifdef OMP
-#pragma omp parallel for
-#endif
+    int divide = kernel.d_frames * d_this->d_centre.size();
     for (unsigned int i = 0; i < d_this->d_grid; i++) {
-      d_this->d_rdf[i] /= double(divide);
+      d_this->d_rdf[i] = kernel.d_rdf[i] / double(divide);
     }
 
-    return centre2with/countC2W;
+    // the average centre to with distance, which is needed for
+    // the calculation of the inelastic (damped) neutron scattering intensities
+    // (term of the Debye-Waller factor)
+    return kernel.d_c2w / kernel.d_numC2W;
 
   } /* end of RDF::calculateInterPDens() */
 
@@ -39,6 +39,9 @@ namespace utils {
    * from a central particle of type I, relative to the probability for a homogenous
    * distribution of particle of type J around particle of type I.
    *
+   * Only the pairs within the cutoff are considered, they are found with a
+   * cell list (utils::CellList) and binned into a histogram per thread.
+   *
    * @class RDF
    * @ingroup utils
    * @author A. Eichenberger
@@ -161,6 +164,11 @@ namespace utils {
       * Normalize the dipole moment correlations between molecules ?
       */
      void DCFnorm(bool dcfnorm);
+     /**
+      * Analyse several frames in parallel (see utils::FrameLoop) instead
+      * of the centre atoms of one frame
+      */
+     void setParallelFrames(bool parallel);
      /**
       * Prints the contents of the d_rdf vector
       */
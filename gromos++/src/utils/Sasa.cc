@@ -0,0 +1,308 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// utils_Sasa.cc
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+#include "Sasa.h"
+#include "../gmath/Vec.h"
+#include "../gmath/Physics.h"
+#include "../gromos/Exception.h"
+
+using gmath::Vec;
+
+namespace utils{
+
+  Sasa::Sasa(const std::vector<double> &radius, method_type method)
+    : d_radius(radius), d_method(method), d_zslice(0.005){
+    setNumDots(960);
+  }
+
+  void Sasa::setZslice(double zslice){
+    if (zslice <= 0.0)
+      throw gromos::Exception("Sasa", "the distance between the slices "
+              "has to be positive");
+    d_zslice = zslice;
+  }
+
+  void Sasa::setNumDots(int n){
+    if (n < 1)
+      throw gromos::Exception("Sasa", "need at least one point per sphere");
+    
+    // a golden section spiral, which spreads the points evenly
+    const double golden = gmath::physConst.get_pi() * (3.0 - sqrt(5.0));
+    for (int d = 0; d < 3; ++d)
+      d_dot[d].resize(n);
+    for (int k = 0; k < n; ++k) {
+      const double z = 1.0 - (2.0 * k + 1.0) / n;
+      const double r = sqrt(1.0 - z * z);
+      d_dot[0][k] = r * cos(golden * k);
+      d_dot[1][k] = r * sin(golden * k);
+      d_dot[2][k] = z;
+    }
+  }
+
+  void Sasa::neighbours(const std::vector<Vec> &pos)const{
+    const int n = d_radius.size();
+    if (int(pos.size()) != n) {
+      std::ostringstream os;
+      os << "got " << pos.size() << " positions for " << n << " spheres";
+      throw gromos::Exception("Sasa", os.str());
+    }
+    d_start.assign(n + 1, 0);
+    d_neighbour.clear();
+    if (n == 0) return;
+
+    // the cells are as wide as the largest diameter, so all overlapping
+    // spheres are in neighbouring cells
+    double rmax = 0.0;
+    Vec lo = pos[0], hi = pos[0];
+    for (int i = 0; i < n; ++i) {
+      rmax = std::max(rmax, d_radius[i]);
+      for (int d = 0; d < 3; ++d) {
+        lo[d] = std::min(lo[d], pos[i][d]);
+        hi[d] = std::max(hi[d], pos[i][d]);
+      }
+    }
+    double width = std::max(2.0 * rmax, 1e-6);
+    int nc[3];
+    // very sparse sets would get more cells than atoms, widen them
+    while (true) {
+      double cells = 1.0;
+      for (int d = 0; d < 3; ++d) {
+        nc[d] = int((hi[d] - lo[d]) / width) + 1;
+        cells *= nc[d];
+      }
+      if (cells <= 8.0 * n + 27) break;
+      width *= 2.0;
+    }
+
+    // sort the spheres into the cells
+    std::vector<int> cell(n);
+    std::vector<int> cellStart(nc[0] * nc[1] * nc[2] + 1, 0);
+    for (int i = 0; i < n; ++i) {
+      int c[3];
+      for (int d = 0; d < 3; ++d)
+        c[d] = std::min(int((pos[i][d] - lo[d]) / width), nc[d] - 1);
+      cell[i] = (c[0] * nc[1] + c[1]) * nc[2] + c[2];
+      ++cellStart[cell[i] + 1];
+    }
+    for (unsigned int c = 1; c < cellStart.size(); ++c)
+      cellStart[c] += cellStart[c - 1];
+    std::vector<int> cellSphere(n);
+    {
+      std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+      for (int i = 0; i < n; ++i)
+        cellSphere[fill[cell[i]]++] = i;
+    }
+
+    std::vector<std::vector<int> > list(n);
+#ifdef OMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (int i = 0; i < n; ++i) {
+      const int ci = cell[i];
+      const int c[3] = {ci / (nc[1] * nc[2]), (ci / nc[2]) % nc[1], ci % nc[2]};
+      for (int x = std::max(c[0] - 1, 0); x <= std::min(c[0] + 1, nc[0] - 1); ++x) {
+        for (int y = std::max(c[1] - 1, 0); y <= std::min(c[1] + 1, nc[1] - 1); ++y) {
+          for (int z = std::max(c[2] - 1, 0); z <= std::min(c[2] + 1, nc[2] - 1); ++z) {
+            const int cc = (x * nc[1] + y) * nc[2] + z;
+            for (int k = cellStart[cc]; k < cellStart[cc + 1]; ++k) {
+              const int j = cellSphere[k];
+              if (j != i && (pos[j] - pos[i]).abs() < d_radius[j] + d_radius[i])
+                list[i].push_back(j);
+            }
+          }
+        }
+      }
+      std::sort(list[i].begin(), list[i].end());
+    }
+
+    for (int i = 0; i < n; ++i)
+      d_start[i + 1] = d_start[i] + list[i].size();
+    d_neighbour.reserve(d_start[n]);
+    for (int i = 0; i < n; ++i)
+      d_neighbour.insert(d_neighbour.end(), list[i].begin(), list[i].end());
+  }
+
+  void Sasa::calc(const std::vector<Vec> &pos, std::vector<double> &area)const{
+    neighbours(pos);
+    const int n = d_radius.size();
+    area.resize(n);
+
+#ifdef OMP
+#pragma omp parallel
+#endif
+    {
+      std::vector<double> arci, arcf;
+      std::vector<char> buried;
+#ifdef OMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+      for (int i = 0; i < n; ++i) {
+        if (d_method == SLICES)
+          area[i] = slices(pos, i, arci, arcf);
+        else
+          area[i] = dots(pos, i, buried);
+      }
+    }
+  }
+
+  double Sasa::slices(const std::vector<Vec> &pos, unsigned int ir,
+          std::vector<double> &arci, std::vector<double> &arcf)const{
+    const double PI = gmath::physConst.get_pi();
+    const double twoPI = 2 * PI;
+    const double rr = d_radius[ir];
+    const double rrsq = rr * rr;
+    const int num = numNeighbours(ir);
+
+    // no neighbours, the exact area of the sphere
+    if (num == 0) return 4 * PI * rrsq;
+
+    double area = 0.0;
+    std::vector<std::pair<double, double> > arcs;
+
+    // the number of slices and the starting position
+    const int nzp = (int) rint((rr * 2) / d_zslice);
+    double zgrid = pos[ir][2] - rr - d_zslice / 2;
+
+    for (int i = 0; i < nzp; ++i) {
+      bool buried = false;
+      double arcsum = 0;
+      zgrid += d_zslice;
+
+      // the radius of the circle of intersection of sphere ir with the
+      // current z-plane
+      const double rsec2r = rrsq - (zgrid - pos[ir][2]) * (zgrid - pos[ir][2]);
+      double rsecr = 0.0;
+      if (rsec2r > 0) rsecr = sqrt(rsec2r);
+
+      arci.clear();
+      arcf.clear();
+
+      for (int j = 0; j < num; ++j) {
+        const Vec &tmp = pos[neighbour(ir, j)];
+        const double dx = pos[ir][0] - tmp[0];
+        const double dy = pos[ir][1] - tmp[1];
+        const double dsq = dx * dx + dy * dy;
+        const double d = sqrt(dsq);
+
+        // the radius of the circle of the neighbour in this plane
+        const double rn = d_radius[neighbour(ir, j)];
+        const double rsec2n = rn * rn - ((zgrid - tmp[2]) * (zgrid - tmp[2]));
+        double rsecn = 0.0;
+        if (rsec2n > 0.0) rsecn = sqrt(rsec2n);
+
+        // does the neighbour cut this plane, and do the circles intersect
+        // or is one inside the other?
+        if (rsec2n > 0.0 && d < (rsecr + rsecn)) {
+          const double diff_rsec = rsecr - rsecn;
+          if (d > std::abs(diff_rsec)) {
+            // the arc of circle ir inside the neighbour goes from 
+            // beta - alpha to beta + alpha (law of cosines)
+            double trig_test = (dsq + rsec2r - rsec2n) / (2 * d * rsecr);
+            if (trig_test > 1.0) trig_test = 1.0;
+            if (trig_test < -1.0) trig_test = -1.0;
+            const double alpha = acos(trig_test);
+            double beta = atan(dy / dx);
+            if (dx < 0) beta += PI;
+
+            double ti = beta - alpha;
+            double tf = beta + alpha;
+            if (ti < 0.0) ti += twoPI;
+            if (ti > twoPI) ti -= twoPI;
+            if (tf < 0.0) tf += twoPI;
+            if (tf > twoPI) tf -= twoPI;
+
+            arci.push_back(ti);
+            if (tf < ti) {
+              // the arc crosses zero, split it
+              arcf.push_back(twoPI);
+              arci.push_back(0);
+            }
+            arcf.push_back(tf);
+          } else if (diff_rsec <= 0) {
+            // circle ir is inside the neighbour
+            buried = true;
+            break;
+          }
+        }
+      } // neighbours
+
+      if (buried) continue;
+
+      if (arci.size()) {
+        // sum the gaps between the arcs, sorted on their initial points
+        arcs.resize(arci.size());
+        for (unsigned int k = 0; k < arci.size(); ++k)
+          arcs[k] = std::make_pair(arci[k], arcf[k]);
+        std::sort(arcs.begin(), arcs.end());
+
+        arcsum = arcs[0].first;
+        double t = arcs[0].second;
+        for (unsigned int k = 1; k < arcs.size(); ++k) {
+          if (t < arcs[k].first) arcsum += arcs[k].first - t;
+          if (arcs[k].second > t) t = arcs[k].second;
+        }
+        arcsum += twoPI - t;
+      } else {
+        arcsum = twoPI;
+      }
+
+      // the accessible arc length times the radius of the circle times
+      // the slice thickness (as in program sasa; this is smaller than the
+      // area of the band on the sphere, see the class documentation)
+      area += arcsum * rsecr * d_zslice;
+    } // slices
+    return area;
+  }
+
+  double Sasa::dots(const std::vector<Vec> &pos, unsigned int i,
+          std::vector<char> &buried)const{
+    const int numDots = d_dot[0].size();
+    const double ri = d_radius[i];
+    const double *ux = &d_dot[0][0], *uy = &d_dot[1][0], *uz = &d_dot[2][0];
+    buried.assign(numDots, 0);
+    char *b = &buried[0];
+
+    for (int j = 0, num = numNeighbours(i); j < num; ++j) {
+      const int n = neighbour(i, j);
+      const double cx = pos[n][0] - pos[i][0];
+      const double cy = pos[n][1] - pos[i][1];
+      const double cz = pos[n][2] - pos[i][2];
+      const double rn2 = d_radius[n] * d_radius[n];
+      // branch free, so the compiler vectorises it
+      for (int k = 0; k < numDots; ++k) {
+        const double dx = ri * ux[k] - cx;
+        const double dy = ri * uy[k] - cy;
+        const double dz = ri * uz[k] - cz;
+        b[k] |= (dx * dx + dy * dy + dz * dz < rn2);
+      }
+    }
+    int free = 0;
+    for (int k = 0; k < numDots; ++k)
+      free += !b[k];
+    return 4 * gmath::physConst.get_pi() * ri * ri * free / numDots;
+  }
+}
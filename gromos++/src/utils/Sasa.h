@@ -0,0 +1,158 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// utils_Sasa.h
+
+#ifndef INCLUDED_UTILS_SASA
+#define INCLUDED_UTILS_SASA
+
+#include <vector>
+#include "../gmath/Vec.h"
+
+namespace utils{
+  /**
+   * Class Sasa
+   * Solvent-accessible surface areas of a set of spheres
+   *
+   * The spheres are the atoms with their radii already increased by the
+   * probe radius. Two methods are available:
+   * - SLICES: the algorithm of Lee and Richards [J. Mol. Biol., 55, 
+   *   379-400 (1971)]. Every sphere is cut into slices perpendicular to
+   *   the z-axis and the accessible arcs of the circles are summed. 
+   *   As in the original program sasa, every slice is weighted with the
+   *   radius of its circle instead of the radius of the sphere. This
+   *   underestimates the area of an atom with neighbours (by up to
+   *   @f$ 1 - \pi/4 @f$, about 21%, for a partly buried atom), while an
+   *   atom without neighbours gets the exact @f$ 4 \pi r^2 @f$. The area
+   *   of an atom therefore jumps when a first neighbour appears.
+   * - DOTS: the algorithm of Shrake and Rupley [J. Mol. Biol., 79,
+   *   351-371 (1973)]. A fixed set of points, evenly spread over the 
+   *   unit sphere, is scaled onto every sphere and the points which are 
+   *   not inside a neighbouring sphere are counted. This estimates the
+   *   true accessible area, so the two methods are not interchangeable:
+   *   for buried atoms DOTS gives larger areas than SLICES.
+   *
+   * The overlapping spheres are found with a grid of cells as wide as
+   * the largest diameter, so only the 27 cells around an atom are 
+   * searched. The areas of the atoms are calculated in parallel if 
+   * the library is compiled with OpenMP. No periodic boundary is 
+   * applied, the positions have to be gathered.
+   *
+   * @class Sasa
+   * @ingroup utils
+   * @sa utils::compute_atomic_radii_vdw
+   */
+  class Sasa{
+  public:
+    /**
+     * the method to calculate the areas
+     */
+    enum method_type { SLICES, DOTS };
+    
+  private:
+    std::vector<double> d_radius;
+    method_type d_method;
+    double d_zslice;
+    // the points on the unit sphere for DOTS
+    std::vector<double> d_dot[3];
+
+    // the grid of the last call to neighbours()
+    mutable std::vector<int> d_start;
+    mutable std::vector<int> d_neighbour;
+
+  public:
+    /**
+     * Constructor
+     * @param radius the radii of the spheres (atom radius plus probe)
+     * @param method SLICES or DOTS
+     */
+    Sasa(const std::vector<double> &radius, method_type method = SLICES);
+    /**
+     * the distance between the slices of method SLICES 
+     * (default: 0.005 nm)
+     */
+    void setZslice(double zslice);
+    /**
+     * the number of points per sphere of method DOTS (default: 960)
+     */
+    void setNumDots(int n);
+    /**
+     * the method
+     */
+    method_type method()const;
+    /**
+     * the number of spheres
+     */
+    unsigned int size()const;
+    /**
+     * the radius of sphere i
+     */
+    double radius(unsigned int i)const;
+    /**
+     * Finds the pairs of overlapping spheres, i.e. those closer than the
+     * sum of their radii. The neighbours of sphere i are in 
+     * neighbour(i, k) for k < numNeighbours(i), in ascending order.
+     */
+    void neighbours(const std::vector<gmath::Vec> &pos)const;
+    /**
+     * the number of neighbours of sphere i found by the last call to
+     * neighbours()
+     */
+    int numNeighbours(unsigned int i)const;
+    /**
+     * neighbour k of sphere i found by the last call to neighbours()
+     */
+    int neighbour(unsigned int i, int k)const;
+    /**
+     * Calculates the accessible area of every sphere
+     * @param pos the (gathered) positions of the spheres
+     * @param area the areas, resized to the number of spheres
+     */
+    void calc(const std::vector<gmath::Vec> &pos,
+            std::vector<double> &area)const;
+
+  private:
+    double slices(const std::vector<gmath::Vec> &pos, unsigned int i,
+            std::vector<double> &arci, std::vector<double> &arcf)const;
+    double dots(const std::vector<gmath::Vec> &pos, unsigned int i,
+            std::vector<char> &buried)const;
+  };
+
+  inline Sasa::method_type Sasa::method()const{
+    return d_method;
+  }
+
+  inline unsigned int Sasa::size()const{
+    return d_radius.size();
+  }
+
+  inline double Sasa::radius(unsigned int i)const{
+    return d_radius[i];
+  }
+
+  inline int Sasa::numNeighbours(unsigned int i)const{
+    return d_start[i + 1] - d_start[i];
+  }
+
+  inline int Sasa::neighbour(unsigned int i, int k)const{
+    return d_neighbour[d_start[i] + k];
+  }
+}
+#endif
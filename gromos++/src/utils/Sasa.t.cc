@@ -0,0 +1,174 @@
+/*
+ * This file is part of GROMOS.
+ * 
+ * Copyright (c) 2011, 2012, 2016, 2018, 2021, 2023 Biomos b.v.
+ * See <https://www.gromos.net> for details.
+ * 
+ * GROMOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// utils_Sasa.t.cc
+
+// checks the areas of isolated and of two overlapping spheres against
+// the analytical values, compares the neighbours with a loop over all
+// pairs and the two methods on a random cluster, and times them.
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include <iostream>
+
+#include "Sasa.h"
+#include "../gmath/Vec.h"
+
+using namespace std;
+using namespace utils;
+using gmath::Vec;
+
+const double pi = 4 * atan(1.0);
+
+double random(double range) {
+  return range * rand() / RAND_MAX;
+}
+
+// area of sphere 0 outside sphere 1
+double cap(double r0, double r1, double d) {
+  const double h = r0 - (d * d + r0 * r0 - r1 * r1) / (2 * d);
+  return 4 * pi * r0 * r0 - 2 * pi * r0 * h;
+}
+
+// the area of sphere 0 next to sphere 1 as the slices of Lee and Richards
+// sum it: the accessible arc of every circle times its radius
+double slicesRef(double r0, const Vec &p0, double r1, const Vec &p1,
+        double zslice) {
+  const double dx = p1[0] - p0[0], dy = p1[1] - p0[1];
+  const double d = sqrt(dx * dx + dy * dy);
+  const int nzp = (int) rint(2 * r0 / zslice);
+  double z = p0[2] - r0 - zslice / 2, area = 0.0;
+  for (int i = 0; i < nzp; ++i) {
+    z += zslice;
+    const double s0sq = r0 * r0 - (z - p0[2]) * (z - p0[2]);
+    if (s0sq <= 0.0) continue;
+    const double s0 = sqrt(s0sq);
+    const double s1sq = r1 * r1 - (z - p1[2]) * (z - p1[2]);
+    double arc = 2 * pi;
+    if (s1sq > 0.0) {
+      const double s1 = sqrt(s1sq);
+      if (d < s0 + s1) {
+        if (d > fabs(s0 - s1))
+          arc -= 2 * acos((d * d + s0sq - s1sq) / (2 * d * s0));
+        else if (s0 <= s1)
+          arc = 0.0;
+      }
+    }
+    area += arc * s0 * zslice;
+  }
+  return area;
+}
+
+void analytical() {
+  vector<double> radius(2);
+  radius[0] = 0.3;
+  radius[1] = 0.25;
+  vector<Vec> pos(2);
+  pos[1] = Vec(0.2, 0.3, 0.1);
+  const double d = pos[1].abs();
+
+  for (int m = 0; m < 2; ++m) {
+    Sasa sasa(radius, m == 0 ? Sasa::SLICES : Sasa::DOTS);
+    vector<double> area;
+
+    // apart
+    vector<Vec> far(pos);
+    far[1] = Vec(2.0, 0.0, 0.0);
+    sasa.calc(far, area);
+    assert(sasa.numNeighbours(0) == 0);
+    assert(fabs(area[0] - 4 * pi * 0.09) < 1e-12);
+
+    // overlapping
+    sasa.calc(pos, area);
+    assert(sasa.numNeighbours(0) == 1 && sasa.neighbour(0, 0) == 1);
+    if (m == 0) {
+      const double ref0 = slicesRef(0.3, pos[0], 0.25, pos[1], 0.005);
+      const double ref1 = slicesRef(0.25, pos[1], 0.3, pos[0], 0.005);
+      assert(fabs(area[0] - ref0) / ref0 < 1e-10);
+      assert(fabs(area[1] - ref1) / ref1 < 1e-10);
+    } else {
+      assert(fabs(area[0] - cap(0.3, 0.25, d)) / cap(0.3, 0.25, d) < 5e-3);
+      assert(fabs(area[1] - cap(0.25, 0.3, d)) / cap(0.25, 0.3, d) < 5e-3);
+    }
+
+    // buried
+    vector<Vec> near(pos);
+    near[1] = Vec(0.01, 0.0, 0.0);
+    vector<double> small(radius);
+    small[1] = 0.1;
+    Sasa inside(small, sasa.method());
+    inside.calc(near, area);
+    assert(area[1] == 0.0);
+  }
+}
+
+int main() {
+  analytical();
+
+  // a random, dense cluster of atoms
+  const int num = 3000;
+  srand(7);
+  vector<Vec> pos(num);
+  vector<double> radius(num);
+  for (int i = 0; i < num; ++i) {
+    pos[i] = Vec(random(3.0), random(3.0), random(3.0));
+    radius[i] = 0.15 + random(0.1);
+  }
+
+  Sasa slices(radius), dots(radius, Sasa::DOTS);
+  vector<double> areaSlices, areaDots;
+  clock_t start = clock();
+  slices.calc(pos, areaSlices);
+  const double tSlices = double(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  dots.calc(pos, areaDots);
+  const double tDots = double(clock() - start) / CLOCKS_PER_SEC;
+
+  // the neighbours are those of a loop over all pairs
+  for (int i = 0; i < num; ++i) {
+    int k = 0;
+    for (int j = 0; j < num; ++j) {
+      if (j != i && (pos[j] - pos[i]).abs() < radius[i] + radius[j]) {
+        assert(k < slices.numNeighbours(i) && slices.neighbour(i, k) == j);
+        ++k;
+      }
+    }
+    assert(k == slices.numNeighbours(i));
+  }
+
+  double sumSlices = 0.0, sumDots = 0.0;
+  for (int i = 0; i < num; ++i) {
+    sumSlices += areaSlices[i];
+    sumDots += areaDots[i];
+  }
+  // the slices sum the arcs times the radius of the circles, which gives
+  // less than the area of the sphere (pi^2 r^2 for a sphere cut by a
+  // neighbour only at its rim; isolated spheres get the exact 4 pi r^2)
+  assert(sumSlices < sumDots && sumSlices > 0.75 * sumDots);
+
+  cout << "total area: " << sumSlices << " (slices) " << sumDots
+       << " (dots)" << endl
+       << "time: " << tSlices << " s (slices) " << tDots << " s (dots)" 
+       << endl;
+  return 0;
+}
@@ -18,10 +18,12 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <cassert>
 #include <set>
+#include <vector>
 #include "../gcore/System.h"
 #include "../gcore/Molecule.h"
 #include "../gcore/LJException.h"
@@ -35,6 +37,7 @@
 #include "../gmath/Vec.h"
 #include "AtomSpecifier.h"
 #include "SimplePairlist.h"
+#include "CellList.h"
 
 namespace utils{
 
@@ -73,14 +76,19 @@ namespace utils{
     if(m==-3)
       throw gromos::Exception("SimplePairlist", "you cannot use the function setAtom(m,a) for a virtual atom. Ask for help");
     if(m<0)
-      d_atom = new SolventSpecAtom(*sys(), m, a);
+      d_atom.reset(new SolventSpecAtom(*sys(), m, a));
     else
-      d_atom = new SpecAtom(*sys(), m, a);
+      d_atom.reset(new SpecAtom(*sys(), m, a));
   }
 
   void SimplePairlist::setAtom(SpecAtom &s)
   {
-    d_atom = &s;
+    d_atom.reset(s.clone());
+  }
+
+  void SimplePairlist::setAtom(AtomSpecifier const &as, int i)
+  {
+    d_atom.reset(as.cloneAtom(i));
   }
   
   void SimplePairlist::calc()
@@ -91,6 +99,19 @@ namespace utils{
       calcAtomic();
   }
   
+  void SimplePairlist::calc(const CellList &cells)
+  {
+    if (cells.chargeGroups() != d_chargeGroupBased || 
+        cells.cut() * cells.cut() < d_cut2) {
+      calc();
+      return;
+    }
+    if(d_atom->type() == spec_solvent && d_atom->atom() >= sys()->sol(0).numPos())
+      throw gromos::Exception("SimplePairlist",
+				"Not enough solvent atoms in system");
+    calcCells(cells);
+  }
+
   void SimplePairlist::calc(const AtomSpecifier &B, double cutmin)
   {
     if(d_chargeGroupBased)
@@ -101,52 +122,16 @@ namespace utils{
 
   void SimplePairlist::calcCgb()
   {
-    gmath::Vec atom_i;
     if(d_atom->type() == spec_solvent && d_atom->atom() >= sys()->sol(0).numPos())
       throw gromos::Exception("SimplePairlist",
 				"Not enough solvent atoms in system");
 
-    atom_i = chargeGroupPosition(*d_atom);
-    
     // gather the system to get the charge groups connected
     // d_pbc->gather();
 
-    // now loop over all charge gropus and add those atoms that belong to
-    // a charge group that is within d_cut2
-    double d2;
-    gmath::Vec v;
-    
-    //first solute
-    for(int m=0; m<sys()->numMolecules(); m++){
-      int a1=-1;
-      int a2=0;
-      
-      
-      while(a2<sys()->mol(m).numAtoms()){
-	// search for the first chargeGroup==1
-	for(; sys()->mol(m).topology().atom(a2).chargeGroup()!=1; a2++);
-	v=chargeGroupPosition(m,a2);
-	v=d_pbc->nearestImage(atom_i, v, sys()->box());
-	d2=(atom_i - v).abs2();
-	if(d2 <=d_cut2)
-	  // now add everything from a1+1 to a2;
-	  for(int i=a1; i<a2; i++) addAtom(m,i+1);
-	a1 = a2;
-	a2++;
-      }
-    }
-
-    //and solvent
-    int nsa = sys()->sol(0).topology().numAtoms();
-    for(int i=0; i< sys()->sol(0).numPos(); i+=nsa){
-      v = d_pbc->nearestImage(atom_i, sys()->sol(0).pos(i), sys()->box());
-      d2 = (atom_i - v).abs2();
-      if(d2 <= d_cut2)
-	for(int j=0; j<nsa; j++) addAtom(-1,i+j);
-    }
-    
-    // and remove the atom itself
-    removeAtom(d_atom->mol(), d_atom->atom());
+    // now loop over all charge groups near the atom and add those atoms 
+    // that belong to a charge group that is within d_cut2
+    calcCells(CellList(*sys(), *d_pbc, sqrt(d_cut2), true));
   }
   
   void SimplePairlist::calcAtomic()
@@ -157,27 +142,33 @@ namespace utils{
       throw gromos::Exception("SimplePairlist",
 				"Not enough solvent atoms in system");
 
-    gmath::Vec atom_i = d_atom->pos();
-    
-    // now loop over all atoms and add those atoms that are within d_cut2
+    // now loop over all atoms near the atom and add those atoms that are
+    // within d_cut2
+    calcCells(CellList(*sys(), *d_pbc, sqrt(d_cut2), false));
+  }
+
+  void SimplePairlist::calcCells(const CellList &cells)
+  {
+    gmath::Vec atom_i;
+    if (cells.chargeGroups())
+      atom_i = chargeGroupPosition(*d_atom);
+    else
+      atom_i = d_atom->pos();
+
+    // the candidates are in the order of the system (solute, solvent). 
+    // The distances are those of the nearest image like for the loop
+    // over all atoms.
+    std::vector<int> particles;
+    cells.candidates(atom_i, particles);
     double d2;
     gmath::Vec v;
-    
-    // first solute
-    for(int m=0; m<sys()->numMolecules(); m++){
-      for(int a=0; a<sys()->mol(m).numPos(); a++){
-	v=d_pbc->nearestImage(atom_i, sys()->mol(m).pos(a), sys()->box());
-	d2=(atom_i - v).abs2();
-	if(d2<=d_cut2)
-	  addAtom(m,a);
-      }
-    }
-    // and solvent
-    for(int i=0; i<sys()->sol(0).numPos(); i++){
-      v=d_pbc->nearestImage(atom_i, sys()->sol(0).pos(i), sys()->box());
-      d2=(atom_i - v).abs2();
-      if(d2<=d_cut2)
-	addAtom(-1,i);
+    for (unsigned int i = 0; i < particles.size(); ++i) {
+      const int p = particles[i];
+      v = d_pbc->nearestImage(atom_i, cells.pos(p), sys()->box());
+      d2 = (atom_i - v).abs2();
+      if (d2 <= d_cut2)
+        for (int a = cells.begin(p); a < cells.end(p); ++a)
+          addAtom(cells.mol(p), a);
     }
     // now remove the atom itself
     removeAtom(d_atom->mol(), d_atom->atom());
@@ -22,6 +22,8 @@
 #ifndef INCLUDED_UTILS_SIMPLEPAIRLIST
 #define INCLUDED_UTILS_SIMPLEPAIRLIST
 
+#include <memory>
+
 #include "AtomSpecifier.h"
 namespace bound{
   class Boundary;
@@ -29,6 +31,7 @@ namespace bound{
 
 namespace utils{
   class AtomSpecifier;
+  class CellList;
   /**
    * Class SimplePairlist
    *
@@ -36,6 +39,13 @@ namespace utils{
    * to add all atoms within a certain cutoff from a reference atom.
    * Different cutoff schemes can be applied. And excluded atoms or 
    * 1,4 neighbours can be removed from the AtomSpecifier.
+   *
+   * The atoms (or charge groups) of the system are searched in a 
+   * utils::CellList. calc() builds a cell list for the one pairlist,
+   * which costs a pass over the coordinates. Programs calculating many
+   * pairlists of a configuration build the cell list once and pass it to
+   * calc(const CellList &), a pairlist then costs the neighbours of the
+   * reference atom only.
    * @class SimplePairlist
    * @author B.C. Oostenbrink
    * @ingroup utils
@@ -57,7 +67,7 @@ namespace utils{
     /**
      * The reference atom
      */
-    SpecAtom *d_atom;
+    std::shared_ptr<SpecAtom> d_atom;
     
   public:
     /**
@@ -89,6 +99,10 @@ namespace utils{
      *        group based cutoff scheme.
      */
     void setType(std::string s);
+    /**
+     * true if the charge group based scheme is used (see setType())
+     */
+    bool chargeGroupBased()const;
     /**
      * A function to set the reference atom for which the SimplePairlist is 
      * calculated
@@ -99,14 +113,28 @@ namespace utils{
     /**
      * A function to set the reference atom for which the SimplePairlist is
      * calculated
-     * @param  s an AtomSpecifier containing 1 atom
+     * @param  s the atom (it is copied)
      */
     void setAtom(SpecAtom &s);
+    /**
+     * A function to set the reference atom for which the SimplePairlist is
+     * calculated
+     * @param  as an AtomSpecifier
+     * @param  i the index of the reference atom in as
+     */
+    void setAtom(AtomSpecifier const &as, int i);
     /**
      * Calculates the SimplePairlist according to the scheme which has been 
      * set by setType();
      */
     void calc();
+    /**
+     * Calculates the SimplePairlist with a cell list of the current
+     * configuration (built for the system and boundary of the pairlist 
+     * with at least its cutoff). If the cell list is for the other 
+     * scheme, calc() is used.
+     */
+    void calc(const CellList &cells);
     /**
      * Calculates a charge group based atomic pairlist. Excluded atoms and 
      * 1,4 neighbours will be included. The system is first
@@ -144,6 +172,11 @@ namespace utils{
      */
     void remove14Exclusions();
   protected:
+    /**
+     * Adds the atoms of the particles of the cell list within the cutoff
+     * of the position of the reference atom (or its charge group)
+     */
+    void calcCells(const CellList &cells);
     /**
      * Function to calculate the position of a charge group to which the 
      * specified atom belongs. For solute this is the centre of geometry of 
@@ -163,6 +196,10 @@ namespace utils{
      */
     gmath::Vec chargeGroupPosition(SpecAtom &s);
   };
+
+  inline bool SimplePairlist::chargeGroupBased()const{
+    return d_chargeGroupBased;
+  }
 }
 
 #endif 